@@ -0,0 +1,143 @@
+/**
+ * @file bench_common.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Scaffolding shared by the benchmarks: the clock, the random numbers, the command line and the JSON output.
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "bench_common.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/* -------------------- Private Structs -------------------- */
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/* -------------------- Private (static) Function Declarations */
+
+static const bench_option_t *find_option(const char *p_name, const bench_option_t *p_options, size_t number_of_options);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+uint64_t bench_now_ns(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000ull) + (uint64_t)now.tv_nsec;
+}
+
+uint64_t bench_next_random(uint64_t *p_state) {
+
+    uint64_t bits = (*p_state += 0x9e3779b97f4a7c15ull);
+
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ull;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebull;
+
+    return bits ^ (bits >> 31);
+}
+
+int bench_parse_options(int argc, char *argv[], const bench_option_t *p_options, size_t number_of_options, void *p_config) {
+
+    for (int arg = 1; arg < argc; arg++) {
+        const bench_option_t *p_option = find_option(argv[arg], p_options, number_of_options);
+        unsigned char *p_member = NULL;
+
+        if((p_option == NULL) || (arg+1 >= argc)) {
+            return -1;
+        }
+        p_member = (unsigned char *)p_config + p_option->offset;
+        arg++;
+
+        switch (p_option->type) {
+            case BENCH_OPTION_SIZE:
+                *(size_t *)p_member = (size_t)strtoull(argv[arg], NULL, 10);
+                break;
+            case BENCH_OPTION_UINT:
+                *(unsigned int *)p_member = (unsigned int)strtoul(argv[arg], NULL, 10);
+                break;
+            case BENCH_OPTION_UINT64:
+                *(uint64_t *)p_member = (uint64_t)strtoull(argv[arg], NULL, 10);
+                break;
+            case BENCH_OPTION_DOUBLE:
+                *(double *)p_member = strtod(argv[arg], NULL);
+                break;
+            case BENCH_OPTION_STRING:
+                *(const char **)p_member = argv[arg];
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+void bench_print_usage(const char *p_program, const bench_option_t *p_options, size_t number_of_options) {
+
+    fprintf(stderr, "usage: %s", p_program);
+    for (size_t option = 0; option < number_of_options; option++) {
+        fprintf(stderr, " [%s %s]", p_options[option].p_name, p_options[option].p_value_name);
+    }
+    fprintf(stderr, "\n");
+}
+
+FILE *bench_json_open(const char *p_path, const char *p_benchmark) {
+
+    FILE *p_out = stdout;
+
+    if((p_path != NULL) && ((p_out = fopen(p_path, "w")) == NULL)) {
+        perror(p_path);
+        return NULL;
+    }
+    fprintf(p_out, "{\n  \"benchmark\": \"%s\",\n  \"config\": {", p_benchmark);
+
+    return p_out;
+}
+
+void bench_json_results(FILE *p_out) {
+
+    fprintf(p_out, "},\n  \"results\": [\n");
+}
+
+int bench_json_close(FILE *p_out) {
+
+    int status = 0;
+
+    fprintf(p_out, "  ]\n}\n");
+    if((fflush(p_out) != 0) || ferror(p_out)) {
+        status = -1;
+    }
+    if((p_out != stdout) && (fclose(p_out) != 0)) {
+        status = -1;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Helper function to find an option by name.
+ *
+ * @param[in] p_name Option as typed.
+ * @param[in] p_options Options of the benchmark.
+ * @param[in] number_of_options Number of entries of p_options.
+ * @return const bench_option_t* The option, NULL if the benchmark has none of that name.
+ */
+static const bench_option_t *find_option(const char *p_name, const bench_option_t *p_options, size_t number_of_options) {
+
+    for (size_t option = 0; option < number_of_options; option++) {
+        if(strcmp(p_name, p_options[option].p_name) == 0) {
+            return &p_options[option];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file bench_common.h
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Scaffolding shared by the benchmarks: the clock, the random numbers, the command line and the JSON output.
+ *
+ * Every benchmark describes its options with a table of bench_option_t, parses the command line into its
+ * configuration with bench_parse_options and prints the usage from the same table. Its JSON is written
+ * between bench_json_open, which prints the name of the benchmark and opens the config object,
+ * bench_json_results, which closes it and opens the results array, and bench_json_close, so only the config
+ * fields and the result lines are left to the benchmark.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t and offsetof */
+#include <stdint.h> /* For int types */
+#include <stdio.h> /* For FILE */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** Number of entries of an option table. */
+#define BENCH_NUMBER_OF_OPTIONS(options) (sizeof(options) / sizeof((options)[0]))
+
+/** Initializer of an option table entry that sets member of config_type. */
+#define BENCH_OPTION(p_name, p_value_name, type, config_type, member) { (p_name), (p_value_name), (type), offsetof(config_type, member) }
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/**
+ * @brief Type of the configuration member an option sets.
+ *
+ */
+typedef enum _bench_option_type {
+    BENCH_OPTION_SIZE,                  /**< size_t, parsed with strtoull */
+    BENCH_OPTION_UINT,                  /**< unsigned int, parsed with strtoul */
+    BENCH_OPTION_UINT64,                /**< uint64_t, parsed with strtoull */
+    BENCH_OPTION_DOUBLE,                /**< double, parsed with strtod */
+    BENCH_OPTION_STRING,                /**< const char *, pointing into argv */
+} bench_option_type_t;
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/**
+ * @brief Command line option of a benchmark, which always takes a value.
+ *
+ */
+typedef struct _bench_option {
+    const char *p_name;                 /**< Option as typed, with its dashes, "--ops" */
+    const char *p_value_name;           /**< Name of the value in the usage, "N" */
+    bench_option_type_t type;           /**< Type of the member it sets */
+    size_t offset;                      /**< Offset of the member in the configuration */
+} bench_option_t;
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Read the monotonic clock.
+ *
+ * @return uint64_t Current time in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Next number of a splitmix64 sequence.
+ *
+ * @param[in,out] p_state State of the sequence.
+ * @return uint64_t The number.
+ */
+uint64_t bench_next_random(uint64_t *p_state);
+
+/**
+ * @brief Parse the command line into a benchmark configuration. Options that are not given keep their value.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[in] p_options Options of the benchmark.
+ * @param[in] number_of_options Number of entries of p_options.
+ * @param[out] p_config Configuration the offsets of the options are into.
+ * @return int 0 on success, -1 on an unknown option or a missing value.
+ */
+int bench_parse_options(int argc, char *argv[], const bench_option_t *p_options, size_t number_of_options, void *p_config);
+
+/**
+ * @brief Print the usage of a benchmark on stderr, every option with the name of its value.
+ *
+ * @param[in] p_program Name the benchmark was run as, argv[0].
+ * @param[in] p_options Options of the benchmark.
+ * @param[in] number_of_options Number of entries of p_options.
+ */
+void bench_print_usage(const char *p_program, const bench_option_t *p_options, size_t number_of_options);
+
+/**
+ * @brief Open the JSON output and print up to the fields of the config object.
+ *
+ * @param[in] p_path File to write to, NULL for stdout.
+ * @param[in] p_benchmark Name of the benchmark.
+ * @return FILE* The stream to print the config fields to, NULL if the file cannot be opened.
+ */
+FILE *bench_json_open(const char *p_path, const char *p_benchmark);
+
+/**
+ * @brief Close the config object and open the results array, one result per line after it.
+ *
+ * @param[in] p_out Stream of bench_json_open.
+ */
+void bench_json_results(FILE *p_out);
+
+/**
+ * @brief Close the results array and the JSON output.
+ *
+ * @param[in] p_out Stream of bench_json_open, closed unless it is stdout.
+ * @return int 0 on success, -1 if the output could not be written.
+ */
+int bench_json_close(FILE *p_out);
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _BENCH_COMMON_H_ */
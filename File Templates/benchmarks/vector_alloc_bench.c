@@ -0,0 +1,241 @@
+/**
+ * @file vector_alloc_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of short lived vectors on the default allocator, the size class pool and the arena.
+ *
+ * Creates batches of small vector_double_nolock_t, pushes --values values into each, then releases the batch:
+ * one destroy per vector for the default allocator and the pool, one vector_arena_reset for the arena.
+ * Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_alloc_bench [--vectors N] [--batch N] [--values N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_allocator.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of vectors created per measurement. */
+#define DEFAULT_VECTORS         (2000000)
+/** definition for the default number of vectors alive at once. */
+#define DEFAULT_BATCH           (1000)
+/** definition for the default number of values pushed into every vector. */
+#define DEFAULT_VALUES          (16)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the capacity every vector starts with, small so the pushes grow it. */
+#define INITIAL_CAPACITY        (4)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t vectors;                     /**< Number of vectors created per measurement. */
+    size_t batch;                       /**< Number of vectors alive at once. */
+    size_t values;                      /**< Number of values pushed into every vector. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_allocator;            /**< Name of the allocator. */
+    size_t vectors;                     /**< Number of vectors created. */
+    uint64_t total_ns;                  /**< Wall time of creating, filling and releasing all vectors. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--vectors", "N", BENCH_OPTION_SIZE, bench_config_t, vectors),
+    BENCH_OPTION("--batch", "N", BENCH_OPTION_SIZE, bench_config_t, batch),
+    BENCH_OPTION("--values", "N", BENCH_OPTION_SIZE, bench_config_t, values),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_allocator, size_t vectors, uint64_t total_ns);
+static int bench_allocator(const bench_config_t *p_config, const char *p_name, const vector_allocator_t *p_allocator,
+                           vector_arena_t *p_arena, vector_double_nolock_t **p_batch);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_VECTORS, DEFAULT_BATCH, DEFAULT_VALUES, NULL};
+    vector_double_nolock_t **p_batch = NULL;
+    vector_arena_t *p_arena = NULL;
+    vector_pool_t *p_pool = NULL;
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    p_batch = (vector_double_nolock_t **)malloc(config.batch * sizeof(vector_double_nolock_t *));
+    p_arena = vector_arena_create(0);
+    p_pool = vector_pool_create();
+    if((p_batch == NULL) || (p_arena == NULL) || (p_pool == NULL)) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    status = bench_allocator(&config, "default", vector_allocator_default(), NULL, p_batch) ||
+             bench_allocator(&config, "pool", vector_pool_allocator(p_pool), NULL, p_batch) ||
+             bench_allocator(&config, "arena", vector_arena_allocator(p_arena), p_arena, p_batch);
+
+    vector_pool_destroy(p_pool);
+    vector_arena_destroy(p_arena);
+    free(p_batch);
+
+    if(status) {
+        fprintf(stderr, "vector create or push failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->batch == 0) || (p_config->vectors < p_config->batch) || (p_config->values > INT32_MAX)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_allocator Name of the allocator.
+ * @param[in] vectors Number of vectors created.
+ * @param[in] total_ns Wall time of creating, filling and releasing all vectors.
+ */
+static void add_result(const char *p_allocator, size_t vectors, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_allocator = p_allocator;
+    s_results[s_number_of_results].vectors = vectors;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Time batches of short lived vectors on one allocator.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_name Name of the allocator.
+ * @param[in] p_allocator The allocator.
+ * @param[in] p_arena The arena behind the allocator, reset instead of destroying every vector. NULL otherwise.
+ * @param[in] p_batch Room for the vectors of one batch.
+ * @return 0 on success, -1 if a create or a push failed.
+ */
+static int bench_allocator(const bench_config_t *p_config, const char *p_name, const vector_allocator_t *p_allocator,
+                           vector_arena_t *p_arena, vector_double_nolock_t **p_batch) {
+
+    size_t batches = p_config->vectors / p_config->batch;
+    uint64_t start_ns = bench_now_ns();
+
+    for (size_t batch = 0; batch < batches; batch++) {
+        for (size_t vector = 0; vector < p_config->batch; vector++) {
+            if((p_batch[vector] = vector_double_nolock_create_with_allocator(INITIAL_CAPACITY, p_allocator)) == NULL) {
+                return -1;
+            }
+            for (size_t value = 0; value < p_config->values; value++) {
+                if(vector_double_nolock_push_fast(p_batch[vector], (double)value)) {
+                    return -1;
+                }
+            }
+        }
+        if(p_arena != NULL) {
+            vector_arena_reset(p_arena);
+            continue;
+        }
+        for (size_t vector = 0; vector < p_config->batch; vector++) {
+            vector_double_nolock_destroy(p_batch[vector]);
+        }
+    }
+
+    add_result(p_name, batches * p_config->batch, bench_now_ns() - start_ns);
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_alloc");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"vectors\": %zu, \"batch\": %zu, \"values\": %zu", p_config->vectors, p_config->batch, p_config->values);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"allocator\": \"%s\", \"vectors\": %zu, \"total_ns\": %llu, \"ns_per_vector\": %.3f, \"vectors_per_sec\": %.0f}%s\n",
+                p_result->p_allocator, p_result->vectors, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->vectors, (double)p_result->vectors * 1e9 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
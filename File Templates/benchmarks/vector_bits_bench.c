@@ -0,0 +1,415 @@
+/**
+ * @file vector_bits_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the packed bit vector against a vector_uint8_t_t used as an array of flags.
+ *
+ * Builds two selections of --bits flags, every third flag and a random tenth of the flags, by pushing into a
+ * vector_bits_t and into a vector_uint8_t_t. Then times counting the selected flags, combining the selections
+ * with AND, OR, XOR and ANDNOT, and visiting every selected index of the random selection. Every result of the bit vector is
+ * checked against the flags. Results are printed as JSON on stdout (or to --output), with the bytes each kind
+ * takes.
+ *
+ * Usage: vector_bits_bench [--bits N] [--repeats N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_bits.h"
+#include "vector_simd.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of flags of a selection. */
+#define DEFAULT_BITS            (16 * 1024 * 1024)
+/** definition for the default number of times every operation is repeated. */
+#define DEFAULT_REPEATS         (10)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (32)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t bits;                        /**< Number of flags of a selection. */
+    size_t repeats;                     /**< Number of times every operation is repeated. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the vector kind. */
+    const char *p_op;                   /**< Name of the operation. */
+    size_t bits;                        /**< Number of flags per operation. */
+    size_t bytes;                       /**< Bytes one selection takes. */
+    uint64_t total_ns;                  /**< Wall time of one operation, the best of the repeats. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--bits", "N", BENCH_OPTION_SIZE, bench_config_t, bits),
+    BENCH_OPTION("--repeats", "N", BENCH_OPTION_SIZE, bench_config_t, repeats),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, const char *p_op, size_t bits, size_t bytes, uint64_t total_ns);
+static int bench_build(const bench_config_t *p_config, vector_bits_t *p_bits[2], vector_uint8_t_t *p_flags[2]);
+static int bench_count(const bench_config_t *p_config, vector_bits_t *p_bits, vector_uint8_t_t *p_flags);
+static int bench_combine(const bench_config_t *p_config, vector_bits_t *p_bits[2], vector_uint8_t_t *p_flags[2]);
+static int bench_visit(const bench_config_t *p_config, vector_bits_t *p_bits, vector_uint8_t_t *p_flags);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_BITS, DEFAULT_REPEATS, NULL};
+    vector_bits_t *p_bits[2] = {NULL, NULL};
+    vector_uint8_t_t *p_flags[2] = {NULL, NULL};
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    status = bench_build(&config, p_bits, p_flags);
+    if(status == 0) {
+        status = bench_count(&config, p_bits[1], p_flags[1]);
+    }
+    if(status == 0) {
+        status = bench_combine(&config, p_bits, p_flags);
+    }
+    if(status == 0) {
+        status = bench_visit(&config, p_bits[1], p_flags[1]);
+    }
+    for (int selection = 0; selection < 2; selection++) {
+        vector_bits_destroy(p_bits[selection]);
+        vector_uint8_t_destroy(p_flags[selection]);
+    }
+    if(status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->bits == 0) || (p_config->repeats == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] p_op Name of the operation.
+ * @param[in] bits Number of flags per operation.
+ * @param[in] bytes Bytes one selection takes.
+ * @param[in] total_ns Wall time of one operation.
+ */
+static void add_result(const char *p_kind, const char *p_op, size_t bits, size_t bytes, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].p_op = p_op;
+    s_results[s_number_of_results].bits = bits;
+    s_results[s_number_of_results].bytes = bytes;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Time pushing the two selections into both kinds: every third flag, and a random tenth of the flags.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[out] p_bits Set to the bit vectors of the selections.
+ * @param[out] p_flags Set to the flag vectors of the selections.
+ * @return 0 on success, -1 on a failed create or push.
+ */
+static int bench_build(const bench_config_t *p_config, vector_bits_t *p_bits[2], vector_uint8_t_t *p_flags[2]) {
+
+    uint64_t bits_ns = 0;
+    uint64_t flags_ns = 0;
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    for (int selection = 0; selection < 2; selection++) {
+        uint64_t state = 0x853c49e6748fea9bull;
+
+        p_bits[selection] = vector_bits_create(0);
+        p_flags[selection] = vector_uint8_t_create(16);
+        if((p_bits[selection] == NULL) || (p_flags[selection] == NULL)) {
+            return -1;
+        }
+        start_ns = bench_now_ns();
+        for (size_t index = 0; (status == 0) && (index < p_config->bits); index++) {
+            status = p_bits[selection]->vptr->push(p_bits[selection], (selection == 0) ? (index % 3 == 0) : (bench_next_random(&state) % 10 == 0));
+        }
+        bits_ns += bench_now_ns() - start_ns;
+        /* The same seed again, so the flags get the same random selection. */
+        state = 0x853c49e6748fea9bull;
+        start_ns = bench_now_ns();
+        for (size_t index = 0; (status == 0) && (index < p_config->bits); index++) {
+            status = p_flags[selection]->vptr->push(p_flags[selection], (selection == 0) ? (index % 3 == 0) : (bench_next_random(&state) % 10 == 0));
+        }
+        flags_ns += bench_now_ns() - start_ns;
+    }
+
+    add_result("bits", "push", 2 * p_config->bits, p_bits[0]->capacity / 8, bits_ns);
+    add_result("uint8_flags", "push", 2 * p_config->bits, p_flags[0]->capacity, flags_ns);
+
+    return status;
+}
+
+/**
+ * @brief Time counting the set flags.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_bits The bit vector.
+ * @param[in] p_flags The flag vector of the same selection.
+ * @return 0 on success, -1 if the counts differ.
+ */
+static int bench_count(const bench_config_t *p_config, vector_bits_t *p_bits, vector_uint8_t_t *p_flags) {
+
+    uint64_t best_bits_ns = UINT64_MAX;
+    uint64_t best_flags_ns = UINT64_MAX;
+    size_t bits_count = 0;
+    size_t flags_count = 0;
+
+    for (size_t repeat = 0; repeat < p_config->repeats; repeat++) {
+        uint64_t start_ns = bench_now_ns();
+        uint64_t elapsed_ns = 0;
+
+        p_bits->vptr->popcount(p_bits, &bits_count);
+        elapsed_ns = bench_now_ns() - start_ns;
+        best_bits_ns = (elapsed_ns < best_bits_ns) ? elapsed_ns : best_bits_ns;
+
+        start_ns = bench_now_ns();
+        flags_count = vector_uint8_t_size(p_flags) - vector_simd_uint8_t_count(p_flags->data, vector_uint8_t_size(p_flags), 0);
+        elapsed_ns = bench_now_ns() - start_ns;
+        best_flags_ns = (elapsed_ns < best_flags_ns) ? elapsed_ns : best_flags_ns;
+    }
+    add_result("bits", "popcount", p_config->bits, p_bits->capacity / 8, best_bits_ns);
+    add_result("uint8_flags", "count", p_config->bits, p_flags->capacity, best_flags_ns);
+
+    if(bits_count != flags_count) {
+        fprintf(stderr, "popcount %zu, flags count %zu\n", bits_count, flags_count);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Time combining the second selection into a copy of the first with each boolean op, and check the result.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_bits The bit vectors of the selections.
+ * @param[in] p_flags The flag vectors of the selections.
+ * @return 0 on success, -1 if a result differs.
+ */
+static int bench_combine(const bench_config_t *p_config, vector_bits_t *p_bits[2], vector_uint8_t_t *p_flags[2]) {
+
+    static const char *const op_names[4] = {"and", "or", "xor", "andnot"};
+    vector_bits_t *p_result_bits = vector_bits_create(p_config->bits);
+    uint8_t *p_result_flags = (uint8_t *)malloc(p_config->bits);
+    size_t words = (p_config->bits + VECTOR_BITS_PER_WORD - 1) / VECTOR_BITS_PER_WORD;
+    int status = 0;
+
+    if((p_result_bits == NULL) || (p_result_flags == NULL) || p_result_bits->vptr->resize(p_result_bits, p_config->bits)) {
+        status = -1;
+    }
+    for (int op = 0; (status == 0) && (op < 4); op++) {
+        uint64_t best_bits_ns = UINT64_MAX;
+        uint64_t best_flags_ns = UINT64_MAX;
+
+        for (size_t repeat = 0; repeat < p_config->repeats; repeat++) {
+            uint64_t start_ns = 0;
+            uint64_t elapsed_ns = 0;
+
+            memcpy(p_result_bits->words, p_bits[0]->words, words * sizeof(uint64_t));
+            start_ns = bench_now_ns();
+            switch(op) {
+                case 0: status = p_result_bits->vptr->and_bits(p_result_bits, p_bits[1]); break;
+                case 1: status = p_result_bits->vptr->or_bits(p_result_bits, p_bits[1]); break;
+                case 2: status = p_result_bits->vptr->xor_bits(p_result_bits, p_bits[1]); break;
+                default: status = p_result_bits->vptr->andnot_bits(p_result_bits, p_bits[1]); break;
+            }
+            elapsed_ns = bench_now_ns() - start_ns;
+            best_bits_ns = (elapsed_ns < best_bits_ns) ? elapsed_ns : best_bits_ns;
+
+            memcpy(p_result_flags, p_flags[0]->data, p_config->bits);
+            start_ns = bench_now_ns();
+            switch(op) {
+                case 0:
+                    for (size_t index = 0; index < p_config->bits; index++) {
+                        p_result_flags[index] &= p_flags[1]->data[index];
+                    }
+                    break;
+                case 1:
+                    for (size_t index = 0; index < p_config->bits; index++) {
+                        p_result_flags[index] |= p_flags[1]->data[index];
+                    }
+                    break;
+                case 2:
+                    for (size_t index = 0; index < p_config->bits; index++) {
+                        p_result_flags[index] ^= p_flags[1]->data[index];
+                    }
+                    break;
+                default:
+                    for (size_t index = 0; index < p_config->bits; index++) {
+                        p_result_flags[index] &= (uint8_t)(p_flags[1]->data[index] ^ 1u);
+                    }
+                    break;
+            }
+            elapsed_ns = bench_now_ns() - start_ns;
+            best_flags_ns = (elapsed_ns < best_flags_ns) ? elapsed_ns : best_flags_ns;
+        }
+        add_result("bits", op_names[op], p_config->bits, p_bits[0]->capacity / 8, best_bits_ns);
+        add_result("uint8_flags", op_names[op], p_config->bits, p_flags[0]->capacity, best_flags_ns);
+
+        for (size_t index = 0; (status == 0) && (index < p_config->bits); index++) {
+            if(vector_bits_at(p_result_bits, index) != p_result_flags[index]) {
+                fprintf(stderr, "%s: bit %zu differs\n", op_names[op], index);
+                status = -1;
+            }
+        }
+    }
+
+    vector_bits_destroy(p_result_bits);
+    free(p_result_flags);
+
+    return status;
+}
+
+/**
+ * @brief Time visiting every selected index, with find_first_set against a scan of the flags.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_bits The bit vector.
+ * @param[in] p_flags The flag vector of the same selection.
+ * @return 0 on success, -1 if the visited indices differ.
+ */
+static int bench_visit(const bench_config_t *p_config, vector_bits_t *p_bits, vector_uint8_t_t *p_flags) {
+
+    uint64_t best_bits_ns = UINT64_MAX;
+    uint64_t best_flags_ns = UINT64_MAX;
+    uint64_t bits_sum = 0;
+    uint64_t flags_sum = 0;
+
+    for (size_t repeat = 0; repeat < p_config->repeats; repeat++) {
+        uint64_t start_ns = bench_now_ns();
+        uint64_t elapsed_ns = 0;
+        size_t index = 0;
+
+        bits_sum = 0;
+        while(p_bits->vptr->find_first_set(p_bits, index, &index) == 0) {
+            bits_sum += index;
+            index++;
+        }
+        elapsed_ns = bench_now_ns() - start_ns;
+        best_bits_ns = (elapsed_ns < best_bits_ns) ? elapsed_ns : best_bits_ns;
+
+        start_ns = bench_now_ns();
+        flags_sum = 0;
+        for (index = 0; index < p_config->bits; index++) {
+            if(p_flags->data[index] != 0) {
+                flags_sum += index;
+            }
+        }
+        elapsed_ns = bench_now_ns() - start_ns;
+        best_flags_ns = (elapsed_ns < best_flags_ns) ? elapsed_ns : best_flags_ns;
+    }
+    add_result("bits", "visit_set", p_config->bits, p_bits->capacity / 8, best_bits_ns);
+    add_result("uint8_flags", "visit_set", p_config->bits, p_flags->capacity, best_flags_ns);
+
+    if(bits_sum != flags_sum) {
+        fprintf(stderr, "visit: index sums differ\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_bits");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"bits\": %zu, \"repeats\": %zu, \"simd_level\": \"%s\"", p_config->bits, p_config->repeats,
+            vector_simd_level_name(vector_simd_get_level()));
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"op\": \"%s\", \"bits\": %zu, \"bytes\": %zu, \"total_ns\": %llu, \"ns_per_bit\": %.4f}%s\n",
+                p_result->p_kind, p_result->p_op, p_result->bits, p_result->bytes, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->bits, (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,257 @@
+/**
+ * @file vector_growth_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the memory and the push throughput of the growth policies on a huge vector.
+ *
+ * Pushes --values values one at a time into an empty vector_uint32_t_nolock_t under every growth policy, on the
+ * default allocator and on vector_allocator_mmap, then shrinks it with shrink_to_fit. Reports the time per push,
+ * the number of reallocations and of those that moved the data to another address, the capacity and the part
+ * of it left unused at the end, and the time of shrink_to_fit. Both allocators move big blocks with mremap,
+ * without copying the values, which is what keeps the small steps of the chunk policies cheap.
+ * Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_growth_bench [--values N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_allocator.h"
+#include "vector_growth.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of values pushed, the size of our biggest vectors. */
+#define DEFAULT_VALUES          (100000000)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the values of a step of the chunk policy, 4 MiB of uint32_t. */
+#define CHUNK_VALUES            (1u << 20)
+/** definition for the largest step of the capped policy, 64 MiB of uint32_t. */
+#define CAPPED_MAX_STEP         (1u << 24)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t values;                      /**< Number of values pushed. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Result of one policy on one allocator.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_policy;               /**< Name of the growth policy. */
+    const char *p_allocator;            /**< Name of the allocator. */
+    uint64_t push_ns;                   /**< Wall time of all the pushes. */
+    uint64_t shrink_ns;                 /**< Wall time of shrink_to_fit. */
+    size_t reallocs;                    /**< Number of times the capacity changed while pushing. */
+    size_t moves;                       /**< Number of those that moved the data to another address. */
+    size_t capacity;                    /**< Capacity after the pushes. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--values", "N", BENCH_OPTION_SIZE, bench_config_t, values),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static size_t capped_growth(size_t capacity, size_t min_capacity, void *p_context);
+static int bench_policy(const bench_config_t *p_config, const char *p_policy, const vector_growth_t *p_growth, int reserve,
+                        const char *p_allocator, const vector_allocator_t *allocator);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    static size_t s_capped_max_step = CAPPED_MAX_STEP;
+    static const vector_growth_t s_one_and_half = VECTOR_GROWTH_FACTOR(3, 2, VECTOR_GROWTH_DEFAULT_MIN_CAPACITY);
+    static const vector_growth_t s_chunk = VECTOR_GROWTH_CHUNK(CHUNK_VALUES, VECTOR_GROWTH_DEFAULT_MIN_CAPACITY);
+    static const vector_growth_t s_capped = VECTOR_GROWTH_CALLBACK(capped_growth, &s_capped_max_step, VECTOR_GROWTH_DEFAULT_MIN_CAPACITY);
+    const char *p_allocators[2] = {"default", "mmap"};
+    const vector_allocator_t *allocators[2] = {vector_allocator_default(), vector_allocator_mmap(0)};
+    bench_config_t config = {DEFAULT_VALUES, NULL};
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    for (size_t allocator = 0; (allocator < 2) && (status == 0); allocator++) {
+        status = bench_policy(&config, "double", vector_growth_default(), 0, p_allocators[allocator], allocators[allocator]) ||
+                 bench_policy(&config, "x1.5", &s_one_and_half, 0, p_allocators[allocator], allocators[allocator]) ||
+                 bench_policy(&config, "chunk_4MiB", &s_chunk, 0, p_allocators[allocator], allocators[allocator]) ||
+                 bench_policy(&config, "double_capped_64MiB", &s_capped, 0, p_allocators[allocator], allocators[allocator]) ||
+                 bench_policy(&config, "reserved", vector_growth_default(), 1, p_allocators[allocator], allocators[allocator]);
+    }
+
+    if(status) {
+        fprintf(stderr, "vector create or push failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->values == 0) || (p_config->values > UINT32_MAX)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Growth callback that doubles small vectors and adds a fixed step to big ones.
+ *
+ * @param[in] capacity Capacity of the vector.
+ * @param[in] min_capacity Capacity the vector needs at least, raised to by the policy.
+ * @param[in] p_context The largest step, a size_t.
+ * @return The new capacity.
+ */
+static size_t capped_growth(size_t capacity, size_t min_capacity, void *p_context) {
+
+    size_t max_step = *(const size_t *)p_context;
+
+    (void)min_capacity;
+
+    return capacity + ((capacity < max_step) ? capacity : max_step);
+}
+
+/**
+ * @brief Push the values into a new vector under one policy and record the result.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_policy Name of the policy.
+ * @param[in] p_growth The policy.
+ * @param[in] reserve Non-zero to reserve room for every value before the pushes.
+ * @param[in] p_allocator Name of the allocator.
+ * @param[in] allocator The allocator.
+ * @return 0 on success, -1 if the create or a push failed.
+ */
+static int bench_policy(const bench_config_t *p_config, const char *p_policy, const vector_growth_t *p_growth, int reserve,
+                        const char *p_allocator, const vector_allocator_t *allocator) {
+
+    vector_uint32_t_nolock_t *vector = vector_uint32_t_nolock_create_with_allocator(0, allocator);
+    bench_result_t result = {p_policy, p_allocator, 0, 0, 0, 0, 0};
+    uintptr_t data = 0;
+    size_t capacity = 0;
+    uint64_t start_ns = 0;
+
+    if((vector == NULL) || (s_number_of_results >= MAX_RESULTS) || vector_uint32_t_nolock_set_growth(vector, p_growth)) {
+        vector_uint32_t_nolock_destroy(vector);
+        return -1;
+    }
+
+    start_ns = bench_now_ns();
+    if(reserve && vector->vptr->reserve(vector, p_config->values)) {
+        vector_uint32_t_nolock_destroy(vector);
+        return -1;
+    }
+    for (size_t value = 0; value < p_config->values; value++) {
+        if(vector_uint32_t_nolock_push_fast(vector, (uint32_t)value)) {
+            vector_uint32_t_nolock_destroy(vector);
+            return -1;
+        }
+        /* Only taken when the push grew the vector, so the check costs every policy the same. */
+        if(vector->capacity != capacity) {
+            if(((uintptr_t)vector->data != data) && (data != 0)) {
+                result.moves++;
+            }
+            result.reallocs++;
+            capacity = vector->capacity;
+            data = (uintptr_t)vector->data;
+        }
+    }
+    result.push_ns = bench_now_ns() - start_ns;
+    result.capacity = vector->capacity;
+
+    start_ns = bench_now_ns();
+    vector->vptr->shrink_to_fit(vector);
+    result.shrink_ns = bench_now_ns() - start_ns;
+
+    vector_uint32_t_nolock_destroy(vector);
+
+    result.push_ns = (result.push_ns == 0) ? 1 : result.push_ns;
+    s_results[s_number_of_results++] = result;
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_growth");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"values\": %zu, \"value_bytes\": %zu", p_config->values, sizeof(uint32_t));
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"policy\": \"%s\", \"allocator\": \"%s\", \"ns_per_push\": %.3f, \"reallocs\": %zu, \"moves\": %zu, "
+                "\"capacity\": %zu, \"capacity_mib\": %.1f, \"unused_pct\": %.1f, \"shrink_us\": %.1f}%s\n",
+                p_result->p_policy, p_result->p_allocator, (double)p_result->push_ns / (double)p_config->values, p_result->reallocs,
+                p_result->moves, p_result->capacity, (double)(p_result->capacity * sizeof(uint32_t)) / (1024.0 * 1024.0),
+                100.0 * (double)(p_result->capacity - p_config->values) / (double)p_result->capacity, (double)p_result->shrink_ns / 1000.0,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,480 @@
+/**
+ * @file vector_hash_map_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the open-addressing hash map against a chained hash map.
+ *
+ * For maps of 1024 keys up to --keys keys (times 16), inserts random uint64_t keys into a
+ * hash_map_uint64_t_uint64_t_t, with and without reserve, then looks up every key in random order and as many
+ * keys that are not there. The same is done with a chained map, an array of buckets holding a list of nodes
+ * each, using the same hash. Lookups run through the virtual table of the MUTEX map, through get_fast of the
+ * NOLOCK map, and through the chained map, and every looked up value is checked. Results are printed as JSON on
+ * stdout (or to --output).
+ *
+ * Usage: vector_hash_map_bench [--keys N] [--lookups N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_hash_map.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of keys of the largest map. */
+#define DEFAULT_KEYS            (1024 * 1024)
+/** definition for the default number of lookups per measurement. */
+#define DEFAULT_LOOKUPS         (4 * 1024 * 1024)
+/** definition for the number of keys of the smallest map. */
+#define MIN_KEYS                (1024)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (128)
+
+/** Macro to generate the lookup measurement of one way to look up the open-addressing map. */
+#define BENCH_LOOKUP_FUNCS(name, get_call) \
+    static int bench_lookup_##name(hash_map_##name##_t *p_map, const char *p_kind, const uint64_t *p_keys, size_t keys, \
+                                   const uint64_t *p_order, size_t lookups, int hit) { \
+        uint64_t found = 0; \
+        uint64_t start_ns = bench_now_ns(); \
+        for (size_t lookup = 0; lookup < lookups; lookup++) { \
+            uint64_t key = p_keys[p_order[lookup]] + (hit ? 0 : 1); \
+            uint64_t value = 0; \
+            if (get_call == 0) { \
+                found += value; \
+            } \
+        } \
+        add_result(p_kind, hit ? "get_hit" : "get_miss", keys, lookups, bench_now_ns() - start_ns); \
+        return check_found(p_kind, p_order, lookups, hit, found); \
+    }
+
+/** Lookup call of the MUTEX map, through the virtual table. */
+#define BENCH_GET_uint64_t_uint64_t p_map->vptr->get(p_map, key, &value)
+/** Lookup call of the NOLOCK map, the inlined direct call. */
+#define BENCH_GET_uint64_t_uint64_t_nolock hash_map_uint64_t_uint64_t_nolock_get_fast(p_map, key, &value)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t keys;                        /**< Number of keys of the largest map. */
+    size_t lookups;                     /**< Number of lookups per measurement. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the map kind. */
+    const char *p_op;                   /**< Name of the operation. */
+    size_t keys;                        /**< Number of keys in the map. */
+    size_t ops;                         /**< Number of inserts or lookups. */
+    uint64_t total_ns;                  /**< Wall time of the operation. */
+} bench_result_t;
+
+/**
+ * @brief Node of the chained map.
+ *
+ */
+typedef struct _chained_node {
+    struct _chained_node *p_next;       /**< Next node of the bucket. */
+    uint64_t key;                       /**< The key. */
+    uint64_t value;                     /**< The value. */
+} chained_node_t;
+
+/**
+ * @brief Chained hash map, a power of two buckets each holding a list, grown at one key per bucket.
+ *
+ */
+typedef struct _chained_map {
+    chained_node_t **p_buckets;         /**< First node of every bucket. */
+    size_t buckets;                     /**< Number of buckets. */
+    size_t size;                        /**< Number of keys. */
+} chained_map_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--keys", "N", BENCH_OPTION_SIZE, bench_config_t, keys),
+    BENCH_OPTION("--lookups", "N", BENCH_OPTION_SIZE, bench_config_t, lookups),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, const char *p_op, size_t keys, size_t ops, uint64_t total_ns);
+static int check_found(const char *p_kind, const uint64_t *p_order, size_t lookups, int hit, uint64_t found);
+static int chained_insert(chained_map_t *p_map, uint64_t key, uint64_t value);
+static int chained_get(const chained_map_t *p_map, uint64_t key, uint64_t *out);
+static void chained_destroy(chained_map_t *p_map);
+static int bench_hash_map(const bench_config_t *p_config, size_t keys, const uint64_t *p_keys, const uint64_t *p_order);
+static int bench_chained(const bench_config_t *p_config, size_t keys, const uint64_t *p_keys, const uint64_t *p_order);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+HASH_MAP(uint64_t, uint64_t)
+HASH_MAP_WITH_LOCK(uint64_t_uint64_t_nolock, uint64_t, uint64_t, HASH_MAP_HASH_DEFAULT, HASH_MAP_EQUAL_DEFAULT, NOLOCK)
+
+BENCH_LOOKUP_FUNCS(uint64_t_uint64_t, BENCH_GET_uint64_t_uint64_t)
+BENCH_LOOKUP_FUNCS(uint64_t_uint64_t_nolock, BENCH_GET_uint64_t_uint64_t_nolock)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_KEYS, DEFAULT_LOOKUPS, NULL};
+    uint64_t *p_keys = NULL;
+    uint64_t *p_order = NULL;
+    uint64_t state = 0x853c49e6748fea9bull;
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    /* Even keys only, so key + 1 is never there. */
+    p_keys = (uint64_t *)malloc(config.keys * sizeof(uint64_t));
+    p_order = (uint64_t *)malloc(config.lookups * sizeof(uint64_t));
+    if((p_keys == NULL) || (p_order == NULL)) {
+        free(p_keys);
+        free(p_order);
+        return EXIT_FAILURE;
+    }
+    for (size_t key = 0; key < config.keys; key++) {
+        p_keys[key] = bench_next_random(&state) & ~(uint64_t)1;
+    }
+
+    for (size_t keys = MIN_KEYS; (status == 0) && (keys <= config.keys); keys *= 16) {
+        for (size_t lookup = 0; lookup < config.lookups; lookup++) {
+            p_order[lookup] = bench_next_random(&state) % keys;
+        }
+        status = bench_hash_map(&config, keys, p_keys, p_order);
+        if(status == 0) {
+            status = bench_chained(&config, keys, p_keys, p_order);
+        }
+    }
+    free(p_keys);
+    free(p_order);
+    if(status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->keys < MIN_KEYS) || (p_config->lookups == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the map kind.
+ * @param[in] p_op Name of the operation.
+ * @param[in] keys Number of keys in the map.
+ * @param[in] ops Number of inserts or lookups.
+ * @param[in] total_ns Wall time of the operation.
+ */
+static void add_result(const char *p_kind, const char *p_op, size_t keys, size_t ops, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].p_op = p_op;
+    s_results[s_number_of_results].keys = keys;
+    s_results[s_number_of_results].ops = ops;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Check the sum of the values found by a lookup run. Every key maps to its index, and a miss finds nothing.
+ *
+ * @param[in] p_kind Name of the map kind.
+ * @param[in] p_order Index of the key of every lookup.
+ * @param[in] lookups Number of lookups.
+ * @param[in] hit Nonzero if the keys were there.
+ * @param[in] found Sum of the values found.
+ * @return 0 if the sum is right, else -1.
+ */
+static int check_found(const char *p_kind, const uint64_t *p_order, size_t lookups, int hit, uint64_t found) {
+
+    uint64_t expected = 0;
+
+    for (size_t lookup = 0; hit && (lookup < lookups); lookup++) {
+        /* Values are index + 1 so that a hit on key 0 counts. */
+        expected += p_order[lookup] + 1;
+    }
+    if(found != expected) {
+        fprintf(stderr, "%s: %s found 0x%llx, expected 0x%llx\n", p_kind, hit ? "get_hit" : "get_miss",
+                (unsigned long long)found, (unsigned long long)expected);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Insert a key into the chained map, or set its value, doubling the buckets at one key per bucket.
+ *
+ * @param[in] p_map The map.
+ * @param[in] key The key.
+ * @param[in] value The value.
+ * @return 0 on success, -1 on fail.
+ */
+static int chained_insert(chained_map_t *p_map, uint64_t key, uint64_t value) {
+
+    chained_node_t *p_node = NULL;
+    size_t bucket = 0;
+
+    if(p_map->size >= p_map->buckets) {
+        size_t buckets = (p_map->buckets == 0) ? 16 : p_map->buckets * 2;
+        chained_node_t **p_buckets = (chained_node_t **)calloc(buckets, sizeof(chained_node_t *));
+
+        if(p_buckets == NULL) {
+            return -1;
+        }
+        for (size_t old = 0; old < p_map->buckets; old++) {
+            while(p_map->p_buckets[old] != NULL) {
+                p_node = p_map->p_buckets[old];
+                p_map->p_buckets[old] = p_node->p_next;
+                bucket = (size_t)hash_map_hash_bits(&p_node->key, sizeof(p_node->key)) & (buckets - 1);
+                p_node->p_next = p_buckets[bucket];
+                p_buckets[bucket] = p_node;
+            }
+        }
+        free(p_map->p_buckets);
+        p_map->p_buckets = p_buckets;
+        p_map->buckets = buckets;
+    }
+
+    bucket = (size_t)hash_map_hash_bits(&key, sizeof(key)) & (p_map->buckets - 1);
+    for (p_node = p_map->p_buckets[bucket]; p_node != NULL; p_node = p_node->p_next) {
+        if(p_node->key == key) {
+            p_node->value = value;
+            return 0;
+        }
+    }
+    p_node = (chained_node_t *)malloc(sizeof(chained_node_t));
+    if(p_node == NULL) {
+        return -1;
+    }
+    p_node->key = key;
+    p_node->value = value;
+    p_node->p_next = p_map->p_buckets[bucket];
+    p_map->p_buckets[bucket] = p_node;
+    p_map->size++;
+
+    return 0;
+}
+
+/**
+ * @brief Get the value of a key of the chained map.
+ *
+ * @param[in] p_map The map.
+ * @param[in] key The key.
+ * @param[out] out Set to the value.
+ * @return 0 if the key is there, else -1.
+ */
+static int chained_get(const chained_map_t *p_map, uint64_t key, uint64_t *out) {
+
+    size_t bucket = (size_t)hash_map_hash_bits(&key, sizeof(key)) & (p_map->buckets - 1);
+
+    for (const chained_node_t *p_node = p_map->p_buckets[bucket]; p_node != NULL; p_node = p_node->p_next) {
+        if(p_node->key == key) {
+            *out = p_node->value;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Free every node and bucket of the chained map.
+ *
+ * @param[in] p_map The map.
+ */
+static void chained_destroy(chained_map_t *p_map) {
+
+    for (size_t bucket = 0; bucket < p_map->buckets; bucket++) {
+        while(p_map->p_buckets[bucket] != NULL) {
+            chained_node_t *p_node = p_map->p_buckets[bucket];
+
+            p_map->p_buckets[bucket] = p_node->p_next;
+            free(p_node);
+        }
+    }
+    free(p_map->p_buckets);
+    memset(p_map, 0, sizeof(*p_map));
+}
+
+/**
+ * @brief Time inserting keys into the open-addressing maps, with and without reserve, and looking them up.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] keys Number of keys.
+ * @param[in] p_keys The keys.
+ * @param[in] p_order Index of the key of every lookup.
+ * @return 0 on success, -1 on a failed insert or a wrong lookup.
+ */
+static int bench_hash_map(const bench_config_t *p_config, size_t keys, const uint64_t *p_keys, const uint64_t *p_order) {
+
+    hash_map_uint64_t_uint64_t_t *p_map = hash_map_uint64_t_uint64_t_create(0);
+    hash_map_uint64_t_uint64_t_nolock_t *p_nolock_map = hash_map_uint64_t_uint64_t_nolock_create(0);
+    uint64_t start_ns = 0;
+    int status = ((p_map == NULL) || (p_nolock_map == NULL)) ? -1 : 0;
+
+    start_ns = bench_now_ns();
+    for (size_t key = 0; (status == 0) && (key < keys); key++) {
+        status = p_map->vptr->insert(p_map, p_keys[key], key + 1);
+    }
+    add_result("hash_map", "insert", keys, keys, bench_now_ns() - start_ns);
+
+    if(status == 0) {
+        status = p_nolock_map->vptr->reserve(p_nolock_map, keys);
+    }
+    start_ns = bench_now_ns();
+    for (size_t key = 0; (status == 0) && (key < keys); key++) {
+        status = p_nolock_map->vptr->insert(p_nolock_map, p_keys[key], key + 1);
+    }
+    add_result("hash_map_nolock", "insert_reserved", keys, keys, bench_now_ns() - start_ns);
+
+    if((status == 0) && ((hash_map_uint64_t_uint64_t_size(p_map) != keys) || (hash_map_uint64_t_uint64_t_nolock_size(p_nolock_map) != keys))) {
+        fprintf(stderr, "hash_map: %zu keys, expected %zu\n", hash_map_uint64_t_uint64_t_size(p_map), keys);
+        status = -1;
+    }
+    if(status == 0) {
+        status = bench_lookup_uint64_t_uint64_t(p_map, "hash_map", p_keys, keys, p_order, p_config->lookups, 1);
+    }
+    if(status == 0) {
+        status = bench_lookup_uint64_t_uint64_t(p_map, "hash_map", p_keys, keys, p_order, p_config->lookups, 0);
+    }
+    if(status == 0) {
+        status = bench_lookup_uint64_t_uint64_t_nolock(p_nolock_map, "hash_map_nolock", p_keys, keys, p_order, p_config->lookups, 1);
+    }
+    if(status == 0) {
+        status = bench_lookup_uint64_t_uint64_t_nolock(p_nolock_map, "hash_map_nolock", p_keys, keys, p_order, p_config->lookups, 0);
+    }
+
+    hash_map_uint64_t_uint64_t_destroy(p_map);
+    hash_map_uint64_t_uint64_t_nolock_destroy(p_nolock_map);
+
+    return status;
+}
+
+/**
+ * @brief Time inserting keys into the chained map and looking them up.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] keys Number of keys.
+ * @param[in] p_keys The keys.
+ * @param[in] p_order Index of the key of every lookup.
+ * @return 0 on success, -1 on a failed insert or a wrong lookup.
+ */
+static int bench_chained(const bench_config_t *p_config, size_t keys, const uint64_t *p_keys, const uint64_t *p_order) {
+
+    chained_map_t map = {NULL, 0, 0};
+    uint64_t start_ns = bench_now_ns();
+    int status = 0;
+
+    for (size_t key = 0; (status == 0) && (key < keys); key++) {
+        status = chained_insert(&map, p_keys[key], key + 1);
+    }
+    add_result("chained", "insert", keys, keys, bench_now_ns() - start_ns);
+
+    for (int hit = 1; (status == 0) && (hit >= 0); hit--) {
+        uint64_t found = 0;
+
+        start_ns = bench_now_ns();
+        for (size_t lookup = 0; lookup < p_config->lookups; lookup++) {
+            uint64_t value = 0;
+
+            if(chained_get(&map, p_keys[p_order[lookup]] + (hit ? 0 : 1), &value) == 0) {
+                found += value;
+            }
+        }
+        add_result("chained", hit ? "get_hit" : "get_miss", keys, p_config->lookups, bench_now_ns() - start_ns);
+        status = check_found("chained", p_order, p_config->lookups, hit, found);
+    }
+
+    chained_destroy(&map);
+
+    return status;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_hash_map");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"keys\": %zu, \"lookups\": %zu, \"group_width\": %d", p_config->keys, p_config->lookups,
+            HASH_MAP_GROUP_WIDTH);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"op\": \"%s\", \"keys\": %zu, \"ops\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.3f}%s\n",
+                p_result->p_kind, p_result->p_op, p_result->keys, p_result->ops, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->ops, (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
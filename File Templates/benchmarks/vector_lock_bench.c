@@ -0,0 +1,307 @@
+/**
+ * @file vector_lock_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the vector lock policies.
+ *
+ * Times push, sequential get, random get and pop through the virtual table of vector_double_t (MUTEX),
+ * vector_double_spinlock_t (SPINLOCK) and vector_double_nolock_t (NOLOCK) on one thread, then pushes
+ * from 1 up to --threads threads into one shared vector for the policies that are safe to share.
+ * Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_lock_bench [--ops N] [--threads N] [--seed N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of operations timed per measurement. */
+#define DEFAULT_OPS             (1000000)
+/** definition for the default max number of threads pushing into a shared vector. */
+#define DEFAULT_THREADS         (8)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (64)
+/** definition for the max number of threads. */
+#define MAX_THREADS             (256)
+/** definition for the capacity every timed vector starts with. */
+#define INITIAL_CAPACITY        (16)
+
+/** Macro to generate the single threaded measurements of one lock policy. */
+#define BENCH_POLICY_FUNCS(name) \
+    static void bench_##name(const bench_config_t *p_config, const char *p_policy, const int *p_indexes) { \
+        vector_##name##_t *p_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        volatile double sink = 0; \
+        double value = 0; \
+        uint64_t start_ns = 0; \
+        if (p_vector == NULL) { \
+            return; \
+        } \
+        /* push */ \
+        start_ns = bench_now_ns(); \
+        for (size_t op = 0; op < p_config->ops; op++) { \
+            p_vector->vptr->push(p_vector, (double)op); \
+        } \
+        add_result(p_policy, "push", 1, p_config->ops, bench_now_ns() - start_ns); \
+        /* sequential get */ \
+        start_ns = bench_now_ns(); \
+        for (size_t op = 0; op < p_config->ops; op++) { \
+            p_vector->vptr->get(p_vector, op, &value); \
+            sink += value; \
+        } \
+        add_result(p_policy, "get_sequential", 1, p_config->ops, bench_now_ns() - start_ns); \
+        /* random get */ \
+        start_ns = bench_now_ns(); \
+        for (size_t op = 0; op < p_config->ops; op++) { \
+            p_vector->vptr->get(p_vector, p_indexes[op], &value); \
+            sink += value; \
+        } \
+        add_result(p_policy, "get_random", 1, p_config->ops, bench_now_ns() - start_ns); \
+        /* pop */ \
+        start_ns = bench_now_ns(); \
+        for (size_t op = 0; op < p_config->ops; op++) { \
+            p_vector->vptr->pop(p_vector); \
+        } \
+        add_result(p_policy, "pop", 1, p_config->ops, bench_now_ns() - start_ns); \
+        (void)sink; \
+        vector_##name##_destroy(p_vector); \
+    }
+
+/** Macro to generate the shared push measurement of a lock policy that is safe to share between threads. */
+#define BENCH_SHARED_POLICY_FUNCS(name) \
+    static void *push_worker_##name(void *p_arg) { \
+        push_worker_t *p_worker = (push_worker_t *)p_arg; \
+        vector_##name##_t *p_vector = (vector_##name##_t *)p_worker->p_vector; \
+        for (size_t op = 0; op < p_worker->ops; op++) { \
+            p_vector->vptr->push(p_vector, (double)op); \
+        } \
+        return NULL; \
+    } \
+    static void bench_shared_##name(const bench_config_t *p_config, const char *p_policy, unsigned int threads) { \
+        vector_##name##_t *p_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        if (p_vector == NULL) { \
+            return; \
+        } \
+        run_threads(p_vector, push_worker_##name, p_config->ops / threads, threads, p_policy); \
+        vector_##name##_destroy(p_vector); \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t ops;                         /**< Number of operations timed per measurement. */
+    unsigned int threads;               /**< Max number of threads pushing into a shared vector. */
+    unsigned int seed;                  /**< Seed for the random get indexes. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_policy;               /**< Name of the lock policy. */
+    const char *p_name;                 /**< Name of the operation. */
+    unsigned int threads;               /**< Number of threads doing the operation. */
+    size_t ops;                         /**< Number of timed operations, across all threads. */
+    uint64_t total_ns;                  /**< Wall time of all operations. */
+} bench_result_t;
+
+/**
+ * @brief Work of one thread pushing into a shared vector.
+ *
+ */
+typedef struct _push_worker {
+    void *p_vector;                     /**< The shared vector. */
+    size_t ops;                         /**< Number of values to push. */
+} push_worker_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--ops", "N", BENCH_OPTION_SIZE, bench_config_t, ops),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--seed", "N", BENCH_OPTION_UINT, bench_config_t, seed),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_policy, const char *p_name, unsigned int threads, size_t ops, uint64_t total_ns);
+static void run_threads(void *p_vector, void *(*p_worker)(void *), size_t ops_per_thread, unsigned int threads, const char *p_policy);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_POLICY_FUNCS(double)
+BENCH_POLICY_FUNCS(double_spinlock)
+BENCH_POLICY_FUNCS(double_nolock)
+BENCH_SHARED_POLICY_FUNCS(double)
+BENCH_SHARED_POLICY_FUNCS(double_spinlock)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_OPS, DEFAULT_THREADS, 1, NULL};
+    int *p_indexes = NULL;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    /* Random indexes are drawn up front so the generator stays out of the timed loops. */
+    if((p_indexes = (int *)malloc(config.ops * sizeof(int))) == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    srand(config.seed);
+    for (size_t op = 0; op < config.ops; op++) {
+        p_indexes[op] = (int)(((size_t)rand() * ((size_t)RAND_MAX + 1) + (size_t)rand()) % config.ops);
+    }
+
+    bench_double_nolock(&config, "nolock", p_indexes);
+    bench_double_spinlock(&config, "spinlock", p_indexes);
+    bench_double(&config, "mutex", p_indexes);
+
+    for (unsigned int threads = 1; threads <= config.threads; threads *= 2) {
+        bench_shared_double_spinlock(&config, "spinlock", threads);
+        bench_shared_double(&config, "mutex", threads);
+    }
+
+    free(p_indexes);
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->ops == 0) || (p_config->ops > INT32_MAX) || (p_config->threads == 0) || (p_config->threads > MAX_THREADS)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_policy Name of the lock policy.
+ * @param[in] p_name Name of the operation.
+ * @param[in] threads Number of threads doing the operation.
+ * @param[in] ops Number of timed operations, across all threads.
+ * @param[in] total_ns Wall time of all operations.
+ */
+static void add_result(const char *p_policy, const char *p_name, unsigned int threads, size_t ops, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_policy = p_policy;
+    s_results[s_number_of_results].p_name = p_name;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].ops = ops;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Time threads pushing into one shared vector.
+ *
+ * @param[in] p_vector The shared vector.
+ * @param[in] p_worker Thread function pushing into the vector.
+ * @param[in] ops_per_thread Number of values every thread pushes.
+ * @param[in] threads Number of threads.
+ * @param[in] p_policy Name of the lock policy of the vector.
+ */
+static void run_threads(void *p_vector, void *(*p_worker)(void *), size_t ops_per_thread, unsigned int threads, const char *p_policy) {
+
+    pthread_t thread_ids[MAX_THREADS];
+    push_worker_t workers[MAX_THREADS];
+    unsigned int started = 0;
+    uint64_t start_ns = 0;
+
+    start_ns = bench_now_ns();
+    for (started = 0; started < threads; started++) {
+        workers[started].p_vector = p_vector;
+        workers[started].ops = ops_per_thread;
+        if(pthread_create(&thread_ids[started], NULL, p_worker, &workers[started])) {
+            break;
+        }
+    }
+    for (unsigned int thread = 0; thread < started; thread++) {
+        pthread_join(thread_ids[thread], NULL);
+    }
+
+    add_result(p_policy, "push_shared", started, ops_per_thread * started, bench_now_ns() - start_ns);
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_lock");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"ops\": %zu, \"threads\": %u, \"seed\": %u", p_config->ops, p_config->threads, p_config->seed);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"policy\": \"%s\", \"op\": \"%s\", \"threads\": %u, \"ops\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f}%s\n",
+                p_result->p_policy, p_result->p_name, p_result->threads, p_result->ops, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->ops, (double)p_result->ops * 1e9 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,445 @@
+/**
+ * @file vector_parallel_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of parallel_for and parallel_reduce on the shared work-stealing pool.
+ *
+ * Runs a compute bound map (a few steps of the logistic map on every value) and a sum over one
+ * vector_double_t, sequentially on the calling thread and with vector_double_parallel_for and
+ * vector_double_parallel_reduce on a pool of --threads threads. The sum is also timed with the SIMD
+ * vector_double_sum. A run of small parallel_for calls doing little per value then compares the per call cost
+ * of the shared pool with starting and joining the threads on every call. The parallel results are checked
+ * against the sequential ones. Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_parallel_bench [--values N] [--threads N] [--calls N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_thread_pool.h"
+#include "bench_common.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of values of the large vector. */
+#define DEFAULT_VALUES          (8000000)
+/** definition for the default number of small parallel_for calls. */
+#define DEFAULT_CALLS           (20000)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the number of values of the vector of the small calls. */
+#define SMALL_VALUES            (65536)
+/** definition for the grain of the small calls. */
+#define SMALL_GRAIN             (4096)
+/** definition for the number of logistic map steps of the map, per value. */
+#define MAP_STEPS               (16)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t values;                      /**< Number of values of the large vector. */
+    unsigned int threads;               /**< Number of threads of the pool, 0 for one per CPU. */
+    size_t calls;                       /**< Number of small parallel_for calls. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< How the work ran. */
+    const char *p_op;                   /**< Name of the operation. */
+    unsigned int threads;               /**< Number of threads. */
+    size_t values;                      /**< Number of values processed. */
+    uint64_t total_ns;                  /**< Wall time of the operation. */
+} bench_result_t;
+
+/**
+ * @brief Slice of a vector for one started thread.
+ *
+ */
+typedef struct _spawn_slice {
+    double *p_values;                   /**< First value of the slice. */
+    size_t count;                       /**< Number of values. */
+} spawn_slice_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--values", "N", BENCH_OPTION_SIZE, bench_config_t, values),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--calls", "N", BENCH_OPTION_SIZE, bench_config_t, calls),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, const char *p_op, unsigned int threads, size_t values, uint64_t total_ns);
+static void fill(double *p_values, size_t count);
+static void map_values(double *p_values, size_t count, size_t start, void *p_context);
+static void halve_values(double *p_values, size_t count, size_t start, void *p_context);
+static double add_values(double accumulator, double value, void *p_context);
+static int bench_map(const bench_config_t *p_config, vector_double_t *p_vector, unsigned int threads);
+static int bench_sum(const bench_config_t *p_config, vector_double_t *p_vector, unsigned int threads);
+static void *spawn_main(void *p_arg);
+static int bench_small_calls(const bench_config_t *p_config, unsigned int threads);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_VALUES, 0, DEFAULT_CALLS, NULL};
+    vector_double_t *p_vector = NULL;
+    unsigned int threads = 0;
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    if(vector_thread_pool_start(config.threads)) {
+        fprintf(stderr, "pool: start failed\n");
+        return EXIT_FAILURE;
+    }
+    threads = vector_thread_pool_threads();
+
+    p_vector = vector_double_create(config.values);
+    if((p_vector == NULL) || p_vector->vptr->resize(p_vector, config.values)) {
+        vector_double_destroy(p_vector);
+        return EXIT_FAILURE;
+    }
+
+    status = bench_map(&config, p_vector, threads);
+    if(status == 0) {
+        status = bench_sum(&config, p_vector, threads);
+    }
+    if(status == 0) {
+        status = bench_small_calls(&config, threads);
+    }
+    vector_double_destroy(p_vector);
+    vector_thread_pool_stop();
+    if(status) {
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->values == 0) || (p_config->calls == 0) || (p_config->threads > VECTOR_THREAD_POOL_MAX_THREADS)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind How the work ran.
+ * @param[in] p_op Name of the operation.
+ * @param[in] threads Number of threads.
+ * @param[in] values Number of values processed.
+ * @param[in] total_ns Wall time of the operation.
+ */
+static void add_result(const char *p_kind, const char *p_op, unsigned int threads, size_t values, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].p_op = p_op;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].values = values;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Set the values to a spread in (0, 1), the range the logistic map stays in.
+ *
+ * @param[out] p_values The values.
+ * @param[in] count Number of values.
+ */
+static void fill(double *p_values, size_t count) {
+
+    for (size_t index = 0; index < count; index++) {
+        p_values[index] = 0.05 + 0.9 * (double)(index % 1000) / 1000.0;
+    }
+}
+
+/**
+ * @brief Run MAP_STEPS steps of the logistic map on every value of a chunk, the parallel_for function.
+ *
+ * @param[in,out] p_values The values of the chunk.
+ * @param[in] count Number of values.
+ * @param[in] start Index of the first value, unused.
+ * @param[in] p_context Unused.
+ */
+static void map_values(double *p_values, size_t count, size_t start, void *p_context) {
+
+    (void)start;
+    (void)p_context;
+
+    for (size_t index = 0; index < count; index++) {
+        double value = p_values[index];
+
+        for (int step = 0; step < MAP_STEPS; step++) {
+            value = 3.9 * value * (1.0 - value);
+        }
+        p_values[index] = value;
+    }
+}
+
+/**
+ * @brief Move every value of a chunk halfway to 0.5, the cheap parallel_for function of the small calls.
+ *
+ * @param[in,out] p_values The values of the chunk.
+ * @param[in] count Number of values.
+ * @param[in] start Index of the first value, unused.
+ * @param[in] p_context Unused.
+ */
+static void halve_values(double *p_values, size_t count, size_t start, void *p_context) {
+
+    (void)start;
+    (void)p_context;
+
+    for (size_t index = 0; index < count; index++) {
+        p_values[index] = 0.5 * p_values[index] + 0.25;
+    }
+}
+
+/**
+ * @brief Add a value to the accumulator, the parallel_reduce function.
+ *
+ * @param[in] accumulator Sum so far.
+ * @param[in] value The value.
+ * @param[in] p_context Unused.
+ * @return double The sum.
+ */
+static double add_values(double accumulator, double value, void *p_context) {
+
+    (void)p_context;
+
+    return accumulator + value;
+}
+
+/**
+ * @brief Time the map on the calling thread and with parallel_for, and check both give the same values.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_vector The vector.
+ * @param[in] threads Number of threads of the pool.
+ * @return 0 on success, -1 on a failed call or a differing value.
+ */
+static int bench_map(const bench_config_t *p_config, vector_double_t *p_vector, unsigned int threads) {
+
+    double *p_expected = (double *)malloc(p_config->values * sizeof(double));
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    if(p_expected == NULL) {
+        return -1;
+    }
+
+    fill(p_expected, p_config->values);
+    start_ns = bench_now_ns();
+    map_values(p_expected, p_config->values, 0, NULL);
+    add_result("sequential", "map", 1, p_config->values, bench_now_ns() - start_ns);
+
+    fill(p_vector->data, p_config->values);
+    start_ns = bench_now_ns();
+    status = vector_double_parallel_for(p_vector, map_values, NULL, 0);
+    add_result("pool", "map", threads, p_config->values, bench_now_ns() - start_ns);
+
+    if((status == 0) && (memcmp(p_expected, p_vector->data, p_config->values * sizeof(double)) != 0)) {
+        fprintf(stderr, "pool: map differs from the sequential one\n");
+        status = -1;
+    }
+
+    free(p_expected);
+
+    return status;
+}
+
+/**
+ * @brief Time the sum on the calling thread, with parallel_reduce and with the SIMD sum, and check they agree.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_vector The vector.
+ * @param[in] threads Number of threads of the pool.
+ * @return 0 on success, -1 on a failed call or a differing sum.
+ */
+static int bench_sum(const bench_config_t *p_config, vector_double_t *p_vector, unsigned int threads) {
+
+    double expected = 0.0;
+    double pool_sum = 0.0;
+    double simd_sum = 0.0;
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    start_ns = bench_now_ns();
+    for (size_t index = 0; index < p_config->values; index++) {
+        expected += p_vector->data[index];
+    }
+    add_result("sequential", "sum", 1, p_config->values, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    status = vector_double_parallel_reduce(p_vector, add_values, 0.0, NULL, 0, &pool_sum);
+    add_result("pool", "sum", threads, p_config->values, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    status |= vector_double_sum(p_vector, &simd_sum);
+    add_result("simd", "sum", 1, p_config->values, bench_now_ns() - start_ns);
+
+    /* The three add in different orders, so they only agree to rounding. */
+    if((status == 0) && ((fabs(pool_sum - expected) > 1e-9 * fabs(expected)) || (fabs(simd_sum - expected) > 1e-9 * fabs(expected)))) {
+        fprintf(stderr, "sum: %.17g and %.17g, expected %.17g\n", pool_sum, simd_sum, expected);
+        status = -1;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Entry point of the threads started per call, runs the small call function on their slice.
+ *
+ * @param[in] p_arg The spawn_slice_t of the thread.
+ * @return NULL
+ */
+static void *spawn_main(void *p_arg) {
+
+    spawn_slice_t *p_slice = (spawn_slice_t *)p_arg;
+
+    halve_values(p_slice->p_values, p_slice->count, 0, NULL);
+
+    return NULL;
+}
+
+/**
+ * @brief Time many parallel_for calls on a small vector, and the same calls with threads started and joined on
+ * every call, the calling thread taking one slice.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] threads Number of threads of the pool.
+ * @return 0 on success, -1 on a failed call.
+ */
+static int bench_small_calls(const bench_config_t *p_config, unsigned int threads) {
+
+    vector_double_t *p_vector = vector_double_create(SMALL_VALUES);
+    spawn_slice_t slices[VECTOR_THREAD_POOL_MAX_THREADS];
+    pthread_t thread_ids[VECTOR_THREAD_POOL_MAX_THREADS];
+    size_t slice_values = SMALL_VALUES / threads;
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    if((p_vector == NULL) || p_vector->vptr->resize(p_vector, SMALL_VALUES)) {
+        vector_double_destroy(p_vector);
+        return -1;
+    }
+    fill(p_vector->data, SMALL_VALUES);
+
+    start_ns = bench_now_ns();
+    for (size_t call = 0; (status == 0) && (call < p_config->calls); call++) {
+        status = vector_double_parallel_for(p_vector, halve_values, NULL, SMALL_GRAIN);
+    }
+    add_result("pool", "small_for", threads, p_config->calls * SMALL_VALUES, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    for (size_t call = 0; (status == 0) && (call < p_config->calls); call++) {
+        unsigned int started = 1;
+
+        for (; started < threads; started++) {
+            slices[started].p_values = p_vector->data + started * slice_values;
+            slices[started].count = (started + 1 < threads) ? slice_values : SMALL_VALUES - started * slice_values;
+            if(pthread_create(&thread_ids[started], NULL, spawn_main, &slices[started])) {
+                status = -1;
+                break;
+            }
+        }
+        halve_values(p_vector->data, slice_values, 0, NULL);
+        for (unsigned int thread = 1; thread < started; thread++) {
+            pthread_join(thread_ids[thread], NULL);
+        }
+    }
+    add_result("spawn", "small_for", threads, p_config->calls * SMALL_VALUES, bench_now_ns() - start_ns);
+
+    vector_double_destroy(p_vector);
+
+    return status;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_parallel");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"values\": %zu, \"threads\": %u, \"calls\": %zu", p_config->values, p_config->threads, p_config->calls);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"op\": \"%s\", \"threads\": %u, \"values\": %zu, \"total_ns\": %llu, \"ns_per_value\": %.4f}%s\n",
+                p_result->p_kind, p_result->p_op, p_result->threads, p_result->values, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->values, (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
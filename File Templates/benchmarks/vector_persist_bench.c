@@ -0,0 +1,287 @@
+/**
+ * @file vector_persist_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of loading a saved vector by mapping it against pushing the values back one at a time.
+ *
+ * Saves a vector_uint64_t_t of --elements values to --path, then loads it back four ways: reading the file and
+ * pushing every value (the old checkpoint reload), mapping it read-only, mapping it copy-on-write, and mapping it
+ * with the checksum verified. Every loaded vector is summed afterwards, timed separately since that is when a
+ * mapping reads the file. The file is removed at the end. Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_persist_bench [--elements N] [--path FILE] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_persist.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of values saved, 128 MiB. */
+#define DEFAULT_ELEMENTS        (16 * 1024 * 1024)
+/** definition for the default file the vector is saved to. */
+#define DEFAULT_PATH            "vector_persist_bench.bin"
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the number of values read from the file at once by the push load. */
+#define READ_CHUNK              (4096)
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t elements;                    /**< Number of values saved. */
+    const char *p_path;                 /**< File the vector is saved to. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_op;                   /**< Name of the operation. */
+    size_t elements;                    /**< Number of values. */
+    uint64_t total_ns;                  /**< Wall time of the save or of the load until the vector is there. */
+    uint64_t sum_ns;                    /**< Wall time of summing the values afterwards. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--elements", "N", BENCH_OPTION_SIZE, bench_config_t, elements),
+    BENCH_OPTION("--path", "FILE", BENCH_OPTION_STRING, bench_config_t, p_path),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_op, size_t elements, uint64_t total_ns, uint64_t sum_ns);
+static vector_uint64_t_t *load_by_push(const char *p_path);
+static int bench_load(const bench_config_t *p_config, const char *p_op, unsigned int flags, uint64_t expected_sum);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_ELEMENTS, DEFAULT_PATH, NULL};
+    vector_uint64_t_t *p_vector = NULL;
+    uint64_t expected_sum = 0;
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    p_vector = vector_uint64_t_create(config.elements);
+    if((p_vector == NULL) || p_vector->vptr->resize(p_vector, config.elements)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t index = 0; index < config.elements; index++) {
+        p_vector->data[index] = (uint64_t)index * 0x9e3779b97f4a7c15ull;
+        expected_sum += p_vector->data[index];
+    }
+    start_ns = bench_now_ns();
+    status = vector_uint64_t_save(p_vector, config.p_path);
+    add_result("save", config.elements, bench_now_ns() - start_ns, 0);
+    vector_uint64_t_destroy(p_vector);
+    if(status != 0) {
+        perror(config.p_path);
+        return EXIT_FAILURE;
+    }
+
+    status = bench_load(&config, "load_push", 0, expected_sum);
+    if(status == 0) {
+        status = bench_load(&config, "map_read_only", VECTOR_MAP_READ_ONLY, expected_sum);
+    }
+    if(status == 0) {
+        status = bench_load(&config, "map_copy_on_write", VECTOR_MAP_COPY_ON_WRITE, expected_sum);
+    }
+    if(status == 0) {
+        status = bench_load(&config, "map_verify", VECTOR_MAP_READ_ONLY | VECTOR_MAP_VERIFY, expected_sum);
+    }
+    remove(config.p_path);
+    if(status != 0) {
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if(p_config->elements == 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_op Name of the operation.
+ * @param[in] elements Number of values.
+ * @param[in] total_ns Wall time of the save or of the load until the vector is there.
+ * @param[in] sum_ns Wall time of summing the values afterwards.
+ */
+static void add_result(const char *p_op, size_t elements, uint64_t total_ns, uint64_t sum_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_op = p_op;
+    s_results[s_number_of_results].elements = elements;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_results[s_number_of_results].sum_ns = sum_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Load a saved vector the old way, reading the values after the header and pushing them one at a time.
+ *
+ * @param[in] p_path The file.
+ * @return vector_uint64_t_t* The vector, NULL on fail.
+ */
+static vector_uint64_t_t *load_by_push(const char *p_path) {
+
+    uint64_t values[READ_CHUNK];
+    vector_uint64_t_t *p_vector = vector_uint64_t_create(16);
+    FILE *p_file = fopen(p_path, "rb");
+    size_t read = 0;
+    int status = -1;
+
+    if((p_vector != NULL) && (p_file != NULL) && (fseek(p_file, VECTOR_PERSIST_HEADER_BYTES, SEEK_SET) == 0)) {
+        status = 0;
+        while((status == 0) && ((read = fread(values, sizeof(uint64_t), READ_CHUNK, p_file)) > 0)) {
+            for (size_t value = 0; (value < read) && (status == 0); value++) {
+                status = p_vector->vptr->push(p_vector, values[value]);
+            }
+        }
+    }
+    if(p_file != NULL) {
+        fclose(p_file);
+    }
+    if(status != 0) {
+        vector_uint64_t_destroy(p_vector);
+        return NULL;
+    }
+
+    return p_vector;
+}
+
+/**
+ * @brief Time one way of loading the saved vector, then summing it, and check the sum.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_op Name of the operation, load_push pushes and the others map with flags.
+ * @param[in] flags Flags of the map.
+ * @param[in] expected_sum Sum of the saved values.
+ * @return 0 on success, -1 on a failed load or a wrong sum.
+ */
+static int bench_load(const bench_config_t *p_config, const char *p_op, unsigned int flags, uint64_t expected_sum) {
+
+    vector_uint64_t_t *p_vector = NULL;
+    uint64_t start_ns = bench_now_ns();
+    uint64_t total_ns = 0;
+    uint64_t sum = 0;
+
+    if(strcmp(p_op, "load_push") == 0) {
+        p_vector = load_by_push(p_config->p_path);
+    }
+    else {
+        p_vector = vector_uint64_t_map(p_config->p_path, flags);
+    }
+    total_ns = bench_now_ns() - start_ns;
+    if((p_vector == NULL) || (p_vector->size != p_config->elements)) {
+        fprintf(stderr, "%s: load failed\n", p_op);
+        vector_uint64_t_destroy(p_vector);
+        return -1;
+    }
+
+    start_ns = bench_now_ns();
+    vector_uint64_t_sum(p_vector, &sum);
+    add_result(p_op, p_config->elements, total_ns, bench_now_ns() - start_ns);
+    vector_uint64_t_destroy(p_vector);
+
+    if(sum != expected_sum) {
+        fprintf(stderr, "%s: sum 0x%llx, expected 0x%llx\n", p_op, (unsigned long long)sum, (unsigned long long)expected_sum);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_persist");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"elements\": %zu, \"bytes\": %zu", p_config->elements, p_config->elements * sizeof(uint64_t));
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"op\": \"%s\", \"elements\": %zu, \"total_ns\": %llu, \"sum_ns\": %llu, \"gb_per_sec\": %.3f}%s\n",
+                p_result->p_op, p_result->elements, (unsigned long long)p_result->total_ns, (unsigned long long)p_result->sum_ns,
+                (double)(p_result->elements * sizeof(uint64_t)) / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
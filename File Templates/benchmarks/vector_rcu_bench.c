@@ -0,0 +1,372 @@
+/**
+ * @file vector_rcu_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of reader scaling on the RCU vector against the locked vectors.
+ *
+ * Gets random indexes from 1 up to --threads reader threads (doubling) on one shared vector of --elements values,
+ * a vector_uint64_t_rcu_t, and the locked vector_uint64_t_t (MUTEX) and vector_uint64_t_spinlock_t (SPINLOCK)
+ * for comparison. A writer thread pushes a value every --push-interval microseconds while the readers run, so the
+ * RCU vector retires buffers under the readers. Every value is its index, so a torn or stale read fails the run.
+ * Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_rcu_bench [--ops N] [--elements N] [--threads N] [--push-interval US] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_rcu.h"
+#include "vector_atomic.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of gets per measurement, across all threads. */
+#define DEFAULT_OPS             (16000000)
+/** definition for the default number of values in the vector before the readers start. */
+#define DEFAULT_ELEMENTS        (100000)
+/** definition for the default max number of reader threads. */
+#define DEFAULT_THREADS         (32)
+/** definition for the default time between two pushes of the writer, in microseconds. */
+#define DEFAULT_PUSH_INTERVAL   (50)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (64)
+/** definition for the max number of reader threads. */
+#define MAX_THREADS             (VECTOR_RCU_MAX_READERS)
+
+/** Macro to generate the reader scaling measurement of one vector type. */
+#define BENCH_READERS_FUNCS(name) \
+    static void *get_worker_##name(void *p_arg) { \
+        get_worker_t *p_worker = (get_worker_t *)p_arg; \
+        vector_##name##_t *p_vector = (vector_##name##_t *)p_worker->p_vector; \
+        uint64_t state = p_worker->seed; \
+        uint64_t value = 0; \
+        for (size_t op = 0; op < p_worker->ops; op++) { \
+            size_t index = (size_t)(bench_next_random(&state) % p_worker->elements); \
+            if (p_vector->vptr->get(p_vector BENCH_GET_READER_##name, index, &value) || (value != index)) { \
+                p_worker->failures++; \
+            } \
+            p_worker->checksum += value; \
+        } \
+        return NULL; \
+    } \
+    static void *push_worker_##name(void *p_arg) { \
+        push_worker_t *p_worker = (push_worker_t *)p_arg; \
+        vector_##name##_t *p_vector = (vector_##name##_t *)p_worker->p_vector; \
+        struct timespec interval = {0, (long)p_worker->interval_us * 1000}; \
+        while (!VECTOR_ATOMIC_LOAD_SIZE(&p_worker->stop)) { \
+            if (p_vector->vptr->push(p_vector, p_worker->next_value)) { \
+                p_worker->failures++; \
+            } \
+            p_worker->next_value++; \
+            p_worker->pushes++; \
+            nanosleep(&interval, NULL); \
+        } \
+        return NULL; \
+    } \
+    static int bench_readers_##name(const bench_config_t *p_config, const char *p_kind, unsigned int threads) { \
+        vector_##name##_t *p_vector = vector_##name##_create(16); \
+        int status = 0; \
+        if (p_vector == NULL) { \
+            return -1; \
+        } \
+        for (size_t value = 0; (value < p_config->elements) && (status == 0); value++) { \
+            status = p_vector->vptr->push(p_vector, value); \
+        } \
+        if (status == 0) { \
+            status = run_threads(p_config, p_vector, get_worker_##name, push_worker_##name, threads, p_kind); \
+        } \
+        vector_##name##_destroy(p_vector); \
+        return status; \
+    }
+
+/** The RCU get takes the reader number the thread registered. */
+#define BENCH_GET_READER_uint64_t_rcu , p_worker->reader
+/** The locked get takes no reader number. */
+#define BENCH_GET_READER_uint64_t_spinlock
+/** The locked get takes no reader number. */
+#define BENCH_GET_READER_uint64_t
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t ops;                         /**< Number of gets per measurement, across all threads. */
+    size_t elements;                    /**< Number of values in the vector before the readers start. */
+    unsigned int threads;               /**< Max number of reader threads. */
+    unsigned int push_interval_us;      /**< Time between two pushes of the writer. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the vector kind. */
+    unsigned int threads;               /**< Number of reader threads. */
+    size_t ops;                         /**< Number of gets, across all threads. */
+    size_t pushes;                      /**< Number of pushes the writer made meanwhile. */
+    uint64_t total_ns;                  /**< Wall time of all gets. */
+} bench_result_t;
+
+/**
+ * @brief Work of one reader thread.
+ *
+ */
+typedef struct _get_worker {
+    void *p_vector;                     /**< The shared vector. */
+    size_t reader;                      /**< Reader number, for the RCU vector. */
+    uint64_t seed;                      /**< Seed of the random indexes. */
+    size_t ops;                         /**< Number of gets. */
+    size_t elements;                    /**< Gets pick indexes below this. */
+    size_t failures;                    /**< Number of gets that failed or read a wrong value. */
+    uint64_t checksum;                  /**< Sum of the values read, keeps the gets from being optimized out. */
+} get_worker_t;
+
+/**
+ * @brief Work of the writer thread.
+ *
+ */
+typedef struct _push_worker {
+    void *p_vector;                     /**< The shared vector. */
+    unsigned int interval_us;           /**< Time between two pushes. */
+    size_t stop;                        /**< Set once the readers are done. */
+    uint64_t next_value;                /**< Value of the next push, its index. */
+    size_t pushes;                      /**< Number of pushes made. */
+    size_t failures;                    /**< Number of pushes that failed. */
+} push_worker_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--ops", "N", BENCH_OPTION_SIZE, bench_config_t, ops),
+    BENCH_OPTION("--elements", "N", BENCH_OPTION_SIZE, bench_config_t, elements),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--push-interval", "US", BENCH_OPTION_UINT, bench_config_t, push_interval_us),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, unsigned int threads, size_t ops, size_t pushes, uint64_t total_ns);
+static int register_readers(void *p_vector, get_worker_t *p_workers, unsigned int threads, const char *p_kind);
+static int run_threads(const bench_config_t *p_config, void *p_vector, void *(*p_get_worker)(void *), void *(*p_push_worker)(void *),
+                       unsigned int threads, const char *p_kind);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_READERS_FUNCS(uint64_t_rcu)
+BENCH_READERS_FUNCS(uint64_t_spinlock)
+BENCH_READERS_FUNCS(uint64_t)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_OPS, DEFAULT_ELEMENTS, DEFAULT_THREADS, DEFAULT_PUSH_INTERVAL, NULL};
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    for (unsigned int threads = 1; threads <= config.threads; threads *= 2) {
+        if(bench_readers_uint64_t_rcu(&config, "rcu", threads) ||
+           bench_readers_uint64_t_spinlock(&config, "spinlock", threads) ||
+           bench_readers_uint64_t(&config, "mutex", threads)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    /* Every reader takes a reader slot of the RCU vector, the writer takes none. */
+    if((p_config->ops == 0) || (p_config->elements == 0) || (p_config->threads == 0) || (p_config->threads > MAX_THREADS) ||
+       (p_config->ops < p_config->threads) || (p_config->push_interval_us == 0) || (p_config->push_interval_us >= 1000000)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] threads Number of reader threads.
+ * @param[in] ops Number of gets, across all threads.
+ * @param[in] pushes Number of pushes the writer made meanwhile.
+ * @param[in] total_ns Wall time of all gets.
+ */
+static void add_result(const char *p_kind, unsigned int threads, size_t ops, size_t pushes, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].ops = ops;
+    s_results[s_number_of_results].pushes = pushes;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Give every reader of the RCU vector a reader number, the locked vectors need none.
+ *
+ * @param[in] p_vector The shared vector.
+ * @param[in,out] p_workers The readers.
+ * @param[in] threads Number of readers.
+ * @param[in] p_kind Name of the vector kind.
+ * @return 0 on success, -1 if a reader could not register.
+ */
+static int register_readers(void *p_vector, get_worker_t *p_workers, unsigned int threads, const char *p_kind) {
+
+    if(strcmp(p_kind, "rcu") != 0) {
+        return 0;
+    }
+
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        if(vector_uint64_t_rcu_register_reader((vector_uint64_t_rcu_t *)p_vector, &p_workers[thread].reader)) {
+            fprintf(stderr, "%s: reader %u could not register\n", p_kind, thread);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Time reader threads getting from one shared vector while a writer pushes into it.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_vector The shared vector.
+ * @param[in] p_get_worker Thread function getting from the vector.
+ * @param[in] p_push_worker Thread function pushing into the vector.
+ * @param[in] threads Number of reader threads.
+ * @param[in] p_kind Name of the vector kind.
+ * @return 0 on success, -1 if a thread could not be started, a get read a wrong value or a push failed.
+ */
+static int run_threads(const bench_config_t *p_config, void *p_vector, void *(*p_get_worker)(void *), void *(*p_push_worker)(void *),
+                       unsigned int threads, const char *p_kind) {
+
+    pthread_t thread_ids[MAX_THREADS];
+    pthread_t writer_id;
+    get_worker_t workers[MAX_THREADS];
+    push_worker_t writer = {p_vector, p_config->push_interval_us, 0, p_config->elements, 0, 0};
+    unsigned int started = 0;
+    size_t failures = 0;
+    uint64_t start_ns = 0;
+    uint64_t total_ns = 0;
+
+    memset(workers, 0, sizeof(workers));
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        workers[thread].p_vector = p_vector;
+        workers[thread].seed = thread + 1;
+        workers[thread].ops = p_config->ops / threads;
+        workers[thread].elements = p_config->elements;
+    }
+    if(register_readers(p_vector, workers, threads, p_kind) ||
+       pthread_create(&writer_id, NULL, p_push_worker, &writer)) {
+        return -1;
+    }
+
+    start_ns = bench_now_ns();
+    for (started = 0; started < threads; started++) {
+        if(pthread_create(&thread_ids[started], NULL, p_get_worker, &workers[started])) {
+            break;
+        }
+    }
+    for (unsigned int thread = 0; thread < started; thread++) {
+        pthread_join(thread_ids[thread], NULL);
+        failures += workers[thread].failures;
+    }
+    total_ns = bench_now_ns() - start_ns;
+
+    VECTOR_ATOMIC_STORE_SIZE(&writer.stop, 1);
+    pthread_join(writer_id, NULL);
+    failures += writer.failures;
+
+    add_result(p_kind, started, workers[0].ops * started, writer.pushes, total_ns);
+
+    if((started != threads) || (failures != 0)) {
+        fprintf(stderr, "%s: %u of %u threads started, %zu gets or pushes failed\n", p_kind, started, threads, failures);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_rcu");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"ops\": %zu, \"elements\": %zu, \"threads\": %u, \"push_interval_us\": %u",
+            p_config->ops, p_config->elements, p_config->threads, p_config->push_interval_us);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"op\": \"get_shared\", \"threads\": %u, \"ops\": %zu, \"pushes\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.3f, \"mops_per_sec\": %.3f}%s\n",
+                p_result->p_kind, p_result->threads, p_result->ops, p_result->pushes, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->ops, (double)p_result->ops * 1e3 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,558 @@
+/**
+ * @file vector_ring_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the lock-free ring buffers against a mutex vector used as a queue.
+ *
+ * Moves --ops values from producer threads to consumer threads through a queue of --capacity values: the SPSC
+ * ring with one producer and one consumer, the MPMC ring and a vector_uint64_t_t guarded by its mutex with 1 up to
+ * --threads producers and as many consumers (doubling). Each ring also runs moving --batch values per call. The
+ * mutex vector is used the way a vector stands in for a queue: producers push to the back and consumers take
+ * from a read index, clearing the vector once they have taken everything. Consumers check the values of each
+ * producer arrive in the order it sent them, and the count and sum of everything taken, so a lost or duplicated
+ * value fails the run. A full or empty queue yields the thread. Results are printed as JSON on stdout (or to
+ * --output).
+ *
+ * Usage: vector_ring_bench [--ops N] [--threads N] [--capacity N] [--batch N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_ring.h"
+#include "bench_common.h"
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of values moved per measurement, across all producers. */
+#define DEFAULT_OPS             (4000000)
+/** definition for the default max number of producers, and of consumers. */
+#define DEFAULT_THREADS         (4)
+/** definition for the default number of values the queues hold. */
+#define DEFAULT_CAPACITY        (1024)
+/** definition for the default number of values moved per call by the batch runs. */
+#define DEFAULT_BATCH           (32)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (64)
+/** definition for the max number of producers, and of consumers. */
+#define MAX_THREADS             (32)
+/** definition for the max number of values moved per call. */
+#define MAX_BATCH               (1024)
+/** definition for the shift of the producer number in a value, the low bits hold the op number. */
+#define THREAD_SHIFT            (40)
+
+/** Macro to generate the queue functions of one ring type, one value per call and batch. */
+#define BENCH_RING_FUNCS(name) \
+    static size_t enqueue_##name(void *p_queue, const uint64_t *p_values, size_t count) { \
+        ring_##name##_t *p_ring = (ring_##name##_t *)p_queue; \
+        (void)count; \
+        return (p_ring->vptr->enqueue(p_ring, p_values[0]) == 0) ? 1 : 0; \
+    } \
+    static size_t dequeue_##name(void *p_queue, uint64_t *p_values, size_t count) { \
+        ring_##name##_t *p_ring = (ring_##name##_t *)p_queue; \
+        (void)count; \
+        return (p_ring->vptr->dequeue(p_ring, p_values) == 0) ? 1 : 0; \
+    } \
+    static size_t enqueue_batch_##name(void *p_queue, const uint64_t *p_values, size_t count) { \
+        ring_##name##_t *p_ring = (ring_##name##_t *)p_queue; \
+        return p_ring->vptr->enqueue_batch(p_ring, p_values, count); \
+    } \
+    static size_t dequeue_batch_##name(void *p_queue, uint64_t *p_values, size_t count) { \
+        ring_##name##_t *p_ring = (ring_##name##_t *)p_queue; \
+        return p_ring->vptr->dequeue_batch(p_ring, p_values, count); \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t ops;                         /**< Number of values moved per measurement, across all producers. */
+    unsigned int threads;               /**< Max number of producers, and of consumers. */
+    size_t capacity;                    /**< Number of values the queues hold. */
+    size_t batch;                       /**< Number of values moved per call by the batch runs. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the queue kind. */
+    unsigned int threads;               /**< Number of producers, and of consumers. */
+    size_t batch;                       /**< Number of values moved per call. */
+    size_t ops;                         /**< Number of values moved. */
+    uint64_t total_ns;                  /**< Wall time until the last value was taken. */
+} bench_result_t;
+
+/**
+ * @brief Calls of one queue kind, moving up to count values and giving the number moved.
+ *
+ */
+typedef struct _queue_ops {
+    size_t (*enqueue)(void *p_queue, const uint64_t *p_values, size_t count); /**< Add values */
+    size_t (*dequeue)(void *p_queue, uint64_t *p_values, size_t count);       /**< Take values */
+} queue_ops_t;
+
+/**
+ * @brief A vector_uint64_t_t and the read index of the consumers, the vector's mutex guards both.
+ *
+ */
+typedef struct _mutex_queue {
+    vector_uint64_t_t *p_vector;        /**< Values pushed and not cleared yet. */
+    size_t head;                        /**< Index of the next value to take. */
+    size_t capacity;                    /**< Max number of values pushed before a clear. */
+} mutex_queue_t;
+
+/**
+ * @brief Work of one producer or consumer thread.
+ *
+ */
+typedef struct _queue_worker {
+    void *p_queue;                      /**< The shared queue. */
+    const queue_ops_t *p_ops;           /**< Calls of the queue. */
+    unsigned int thread;                /**< Number of the producer, tags the values it sends. */
+    unsigned int producers;             /**< Number of producers, for the consumer's order check. */
+    size_t ops;                         /**< Number of values a producer sends. */
+    size_t batch;                       /**< Number of values moved per call. */
+    size_t total;                       /**< Number of values the consumers take together. */
+    size_t *p_taken;                    /**< Number of values taken by all consumers. */
+    size_t taken;                       /**< Number of values this consumer took. */
+    uint64_t sum;                       /**< Sum of the values this consumer took. */
+    size_t errors;                      /**< Number of values out of order. */
+} queue_worker_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--ops", "N", BENCH_OPTION_SIZE, bench_config_t, ops),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--capacity", "N", BENCH_OPTION_SIZE, bench_config_t, capacity),
+    BENCH_OPTION("--batch", "N", BENCH_OPTION_SIZE, bench_config_t, batch),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, unsigned int threads, size_t batch, size_t ops, uint64_t total_ns);
+static size_t enqueue_mutex(void *p_queue, const uint64_t *p_values, size_t count);
+static size_t dequeue_mutex(void *p_queue, uint64_t *p_values, size_t count);
+static void *producer_worker(void *p_arg);
+static void *consumer_worker(void *p_arg);
+static int run_queue(const bench_config_t *p_config, void *p_queue, const queue_ops_t *p_ops, const char *p_kind,
+                     unsigned int threads, size_t batch);
+static int bench_spsc(const bench_config_t *p_config, size_t batch);
+static int bench_mpmc(const bench_config_t *p_config, unsigned int threads, size_t batch);
+static int bench_mutex(const bench_config_t *p_config, unsigned int threads);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+RING_BUFFER(uint64_t)
+
+BENCH_RING_FUNCS(uint64_t_spsc)
+BENCH_RING_FUNCS(uint64_t_mpmc)
+
+/** Calls of the SPSC ring, one value at a time. */
+static const queue_ops_t s_spsc_ops = {enqueue_uint64_t_spsc, dequeue_uint64_t_spsc};
+/** Calls of the SPSC ring, in batches. */
+static const queue_ops_t s_spsc_batch_ops = {enqueue_batch_uint64_t_spsc, dequeue_batch_uint64_t_spsc};
+/** Calls of the MPMC ring, one value at a time. */
+static const queue_ops_t s_mpmc_ops = {enqueue_uint64_t_mpmc, dequeue_uint64_t_mpmc};
+/** Calls of the MPMC ring, in batches. */
+static const queue_ops_t s_mpmc_batch_ops = {enqueue_batch_uint64_t_mpmc, dequeue_batch_uint64_t_mpmc};
+/** Calls of the mutex vector. */
+static const queue_ops_t s_mutex_ops = {enqueue_mutex, dequeue_mutex};
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_OPS, DEFAULT_THREADS, DEFAULT_CAPACITY, DEFAULT_BATCH, NULL};
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    if(bench_spsc(&config, 1) || bench_spsc(&config, config.batch)) {
+        return EXIT_FAILURE;
+    }
+    for (unsigned int threads = 1; threads <= config.threads; threads *= 2) {
+        if(bench_mpmc(&config, threads, 1) ||
+           bench_mpmc(&config, threads, config.batch) ||
+           bench_mutex(&config, threads)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    /* The op number has to fit below THREAD_SHIFT. */
+    if((p_config->ops == 0) || (p_config->ops >= ((uint64_t)1 << THREAD_SHIFT)) || (p_config->threads == 0) ||
+       (p_config->threads > MAX_THREADS) || (p_config->ops < p_config->threads) || (p_config->capacity == 0) ||
+       (p_config->batch == 0) || (p_config->batch > MAX_BATCH)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the queue kind.
+ * @param[in] threads Number of producers, and of consumers.
+ * @param[in] batch Number of values moved per call.
+ * @param[in] ops Number of values moved.
+ * @param[in] total_ns Wall time until the last value was taken.
+ */
+static void add_result(const char *p_kind, unsigned int threads, size_t batch, size_t ops, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].batch = batch;
+    s_results[s_number_of_results].ops = ops;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Push a value to the mutex vector, unless it holds capacity values since the last clear.
+ *
+ * @param[in] p_queue The mutex_queue_t.
+ * @param[in] p_values The value.
+ * @param[in] count Unused, always one value.
+ * @return size_t 1 if the value was pushed, else 0.
+ */
+static size_t enqueue_mutex(void *p_queue, const uint64_t *p_values, size_t count) {
+
+    mutex_queue_t *p_mutex_queue = (mutex_queue_t *)p_queue;
+    vector_uint64_t_t *p_vector = p_mutex_queue->p_vector;
+    size_t pushed = 0;
+
+    (void)count;
+    VECTOR_LOCK(MUTEX, &p_vector->lock);
+    if(p_vector->size < p_mutex_queue->capacity) {
+        /* What push does once it has the lock. */
+        p_vector->data[p_vector->size++] = p_values[0];
+        pushed = 1;
+    }
+    VECTOR_UNLOCK(MUTEX, &p_vector->lock);
+
+    return pushed;
+}
+
+/**
+ * @brief Take the value at the read index of the mutex vector, clearing the vector once every value is taken.
+ *
+ * @param[in] p_queue The mutex_queue_t.
+ * @param[out] p_values Set to the value.
+ * @param[in] count Unused, always one value.
+ * @return size_t 1 if a value was taken, else 0.
+ */
+static size_t dequeue_mutex(void *p_queue, uint64_t *p_values, size_t count) {
+
+    mutex_queue_t *p_mutex_queue = (mutex_queue_t *)p_queue;
+    vector_uint64_t_t *p_vector = p_mutex_queue->p_vector;
+    size_t taken = 0;
+
+    (void)count;
+    VECTOR_LOCK(MUTEX, &p_vector->lock);
+    if(p_mutex_queue->head < p_vector->size) {
+        p_values[0] = p_vector->data[p_mutex_queue->head++];
+        taken = 1;
+        if(p_mutex_queue->head == p_vector->size) {
+            p_vector->size = 0;
+            p_mutex_queue->head = 0;
+        }
+    }
+    VECTOR_UNLOCK(MUTEX, &p_vector->lock);
+
+    return taken;
+}
+
+/**
+ * @brief Send tagged values through the queue, yielding while it is full.
+ *
+ * @param[in] p_arg The queue_worker_t of the thread.
+ * @return NULL
+ */
+static void *producer_worker(void *p_arg) {
+
+    queue_worker_t *p_worker = (queue_worker_t *)p_arg;
+    uint64_t values[MAX_BATCH];
+    uint64_t tag = (uint64_t)p_worker->thread << THREAD_SHIFT;
+    size_t op = 0;
+
+    while(op < p_worker->ops) {
+        size_t count = (p_worker->ops - op < p_worker->batch) ? p_worker->ops - op : p_worker->batch;
+        size_t sent = 0;
+
+        for (size_t index = 0; index < count; index++) {
+            values[index] = tag | (op + index);
+        }
+        while(sent < count) {
+            size_t moved = p_worker->p_ops->enqueue(p_worker->p_queue, &values[sent], count - sent);
+
+            if(moved == 0) {
+                sched_yield();
+            }
+            sent += moved;
+        }
+        op += count;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Take values from the queue until the consumers together took every value, yielding while it is empty,
+ * and check the values of each producer come in the order it sent them.
+ *
+ * @param[in] p_arg The queue_worker_t of the thread.
+ * @return NULL
+ */
+static void *consumer_worker(void *p_arg) {
+
+    queue_worker_t *p_worker = (queue_worker_t *)p_arg;
+    uint64_t values[MAX_BATCH];
+    size_t next_op[MAX_THREADS] = {0};
+
+    while(VECTOR_ATOMIC_LOAD_SIZE(p_worker->p_taken) < p_worker->total) {
+        size_t moved = p_worker->p_ops->dequeue(p_worker->p_queue, values, p_worker->batch);
+
+        if(moved == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t index = 0; index < moved; index++) {
+            unsigned int thread = (unsigned int)(values[index] >> THREAD_SHIFT);
+            size_t op = (size_t)(values[index] & (((uint64_t)1 << THREAD_SHIFT) - 1));
+
+            if((thread >= p_worker->producers) || (op < next_op[thread])) {
+                p_worker->errors++;
+            }
+            else {
+                next_op[thread] = op + 1;
+            }
+            p_worker->sum += values[index];
+        }
+        p_worker->taken += moved;
+        VECTOR_ATOMIC_FETCH_ADD_SIZE(p_worker->p_taken, moved);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Time threads producers and threads consumers moving the values through one queue, and check them.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_queue The queue.
+ * @param[in] p_ops Calls of the queue.
+ * @param[in] p_kind Name of the queue kind.
+ * @param[in] threads Number of producers, and of consumers.
+ * @param[in] batch Number of values moved per call.
+ * @return 0 on success, -1 if a thread could not be started or a value was lost, duplicated or reordered.
+ */
+static int run_queue(const bench_config_t *p_config, void *p_queue, const queue_ops_t *p_ops, const char *p_kind,
+                     unsigned int threads, size_t batch) {
+
+    pthread_t thread_ids[2 * MAX_THREADS];
+    queue_worker_t workers[2 * MAX_THREADS];
+    size_t ops_per_thread = p_config->ops / threads;
+    size_t shared_taken = 0;
+    size_t taken = 0;
+    size_t errors = 0;
+    uint64_t sum = 0;
+    uint64_t expected_sum = 0;
+    unsigned int started = 0;
+    uint64_t start_ns = 0;
+
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        expected_sum += ((uint64_t)thread << THREAD_SHIFT) * ops_per_thread + (ops_per_thread * (ops_per_thread - 1)) / 2;
+    }
+
+    start_ns = bench_now_ns();
+    for (started = 0; started < 2 * threads; started++) {
+        queue_worker_t *p_worker = &workers[started];
+
+        memset(p_worker, 0, sizeof(*p_worker));
+        p_worker->p_queue = p_queue;
+        p_worker->p_ops = p_ops;
+        p_worker->thread = started % threads;
+        p_worker->producers = threads;
+        p_worker->ops = ops_per_thread;
+        p_worker->batch = batch;
+        p_worker->total = ops_per_thread * threads;
+        p_worker->p_taken = &shared_taken;
+        if(pthread_create(&thread_ids[started], NULL, (started < threads) ? producer_worker : consumer_worker, p_worker)) {
+            break;
+        }
+    }
+    if(started != 2 * threads) {
+        /* A missing producer would leave the consumers waiting for ever, they stop once told everything is taken. */
+        VECTOR_ATOMIC_STORE_SIZE(&shared_taken, ops_per_thread * threads);
+    }
+    for (unsigned int thread = 0; thread < started; thread++) {
+        pthread_join(thread_ids[thread], NULL);
+        if(thread >= threads) {
+            taken += workers[thread].taken;
+            sum += workers[thread].sum;
+            errors += workers[thread].errors;
+        }
+    }
+
+    add_result(p_kind, threads, batch, ops_per_thread * threads, bench_now_ns() - start_ns);
+
+    if(started != 2 * threads) {
+        fprintf(stderr, "%s: %u of %u threads started\n", p_kind, started, 2 * threads);
+        return -1;
+    }
+    if((taken != ops_per_thread * threads) || (sum != expected_sum) || (errors != 0)) {
+        fprintf(stderr, "%s: %zu values taken of %zu, sum 0x%llx of 0x%llx, %zu out of order\n", p_kind, taken,
+                ops_per_thread * threads, (unsigned long long)sum, (unsigned long long)expected_sum, errors);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Time the SPSC ring with one producer and one consumer.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] batch Number of values moved per call.
+ * @return 0 on success, -1 on fail.
+ */
+static int bench_spsc(const bench_config_t *p_config, size_t batch) {
+
+    ring_uint64_t_spsc_t *p_ring = ring_uint64_t_spsc_create(p_config->capacity);
+    int status = 0;
+
+    if(p_ring == NULL) {
+        return -1;
+    }
+    status = run_queue(p_config, p_ring, (batch == 1) ? &s_spsc_ops : &s_spsc_batch_ops, (batch == 1) ? "spsc" : "spsc_batch", 1, batch);
+    ring_uint64_t_spsc_destroy(p_ring);
+
+    return status;
+}
+
+/**
+ * @brief Time the MPMC ring with threads producers and threads consumers.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] threads Number of producers, and of consumers.
+ * @param[in] batch Number of values moved per call.
+ * @return 0 on success, -1 on fail.
+ */
+static int bench_mpmc(const bench_config_t *p_config, unsigned int threads, size_t batch) {
+
+    ring_uint64_t_mpmc_t *p_ring = ring_uint64_t_mpmc_create(p_config->capacity);
+    int status = 0;
+
+    if(p_ring == NULL) {
+        return -1;
+    }
+    status = run_queue(p_config, p_ring, (batch == 1) ? &s_mpmc_ops : &s_mpmc_batch_ops, (batch == 1) ? "mpmc" : "mpmc_batch", threads, batch);
+    ring_uint64_t_mpmc_destroy(p_ring);
+
+    return status;
+}
+
+/**
+ * @brief Time the mutex vector with threads producers and threads consumers.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] threads Number of producers, and of consumers.
+ * @return 0 on success, -1 on fail.
+ */
+static int bench_mutex(const bench_config_t *p_config, unsigned int threads) {
+
+    mutex_queue_t queue = {vector_uint64_t_create(p_config->capacity), 0, p_config->capacity};
+    int status = 0;
+
+    if(queue.p_vector == NULL) {
+        return -1;
+    }
+    status = run_queue(p_config, &queue, &s_mutex_ops, "mutex_vector", threads, 1);
+    vector_uint64_t_destroy(queue.p_vector);
+
+    return status;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_ring");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"ops\": %zu, \"threads\": %u, \"capacity\": %zu, \"batch\": %zu", p_config->ops,
+            p_config->threads, p_config->capacity, p_config->batch);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"threads\": %u, \"batch\": %zu, \"ops\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.3f, \"mops_per_sec\": %.3f}%s\n",
+                p_result->p_kind, p_result->threads, p_result->batch, p_result->ops, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->ops, (double)p_result->ops * 1e3 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,356 @@
+/**
+ * @file vector_sharded_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the sharded vector against the locked vectors for collecting results of many threads.
+ *
+ * Pushes from 1 up to --threads threads (doubling), each thread into its own shard of one
+ * vector_uint64_t_sharded_t, and into one shared vector_uint64_t_t (MUTEX) and vector_uint64_t_spinlock_t
+ * (SPINLOCK) for comparison. The sharded vector is then collected into one vector_uint64_t_t, which is timed
+ * separately and checked, so a lost push or a bad copy fails the run. Results are printed as JSON on stdout
+ * (or to --output).
+ *
+ * Usage: vector_sharded_bench [--ops N] [--threads N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_sharded.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of values pushed per measurement, across all threads. */
+#define DEFAULT_OPS             (16000000)
+/** definition for the default max number of threads pushing. */
+#define DEFAULT_THREADS         (32)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (64)
+/** definition for the max number of threads, one shard each. */
+#define MAX_THREADS             (VECTOR_SHARDED_MAX_SHARDS)
+/** definition for the capacity every locked vector starts with. */
+#define INITIAL_CAPACITY        (16)
+/** definition for the shift of the thread number in a pushed value, the low bits hold the op number. */
+#define THREAD_SHIFT            (40)
+
+/** Macro to generate the push measurement of one locked vector type. */
+#define BENCH_LOCKED_FUNCS(name) \
+    static void *push_worker_##name(void *p_arg) { \
+        push_worker_t *p_worker = (push_worker_t *)p_arg; \
+        vector_##name##_t *p_vector = (vector_##name##_t *)p_worker->p_vector; \
+        uint64_t tag = (uint64_t)p_worker->thread << THREAD_SHIFT; \
+        for (size_t op = 0; op < p_worker->ops; op++) { \
+            if (p_vector->vptr->push(p_vector, tag | op)) { \
+                p_worker->failures++; \
+            } \
+        } \
+        return NULL; \
+    } \
+    static int bench_locked_##name(const bench_config_t *p_config, const char *p_kind, unsigned int threads) { \
+        vector_##name##_t *p_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        int status = 0; \
+        if (p_vector == NULL) { \
+            return -1; \
+        } \
+        status = run_threads(p_vector, push_worker_##name, p_config->ops / threads, threads, p_kind); \
+        if ((status == 0) && (p_vector->size != (p_config->ops / threads) * threads)) { \
+            fprintf(stderr, "%s: %zu values, expected %zu\n", p_kind, p_vector->size, (p_config->ops / threads) * threads); \
+            status = -1; \
+        } \
+        vector_##name##_destroy(p_vector); \
+        return status; \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t ops;                         /**< Number of values pushed per measurement, across all threads. */
+    unsigned int threads;               /**< Max number of threads pushing. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the vector kind. */
+    const char *p_op;                   /**< Name of the operation. */
+    unsigned int threads;               /**< Number of threads. */
+    size_t ops;                         /**< Number of values pushed or collected. */
+    uint64_t total_ns;                  /**< Wall time of the operation. */
+} bench_result_t;
+
+/**
+ * @brief Work of one thread pushing.
+ *
+ */
+typedef struct _push_worker {
+    void *p_vector;                     /**< The shared vector. */
+    unsigned int thread;                /**< Number of the thread, tags the pushed values. */
+    size_t ops;                         /**< Number of values to push. */
+    size_t failures;                    /**< Number of pushes that failed. */
+} push_worker_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--ops", "N", BENCH_OPTION_SIZE, bench_config_t, ops),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, const char *p_op, unsigned int threads, size_t ops, uint64_t total_ns);
+static int run_threads(void *p_vector, void *(*p_worker)(void *), size_t ops_per_thread, unsigned int threads, const char *p_kind);
+static void *push_worker_uint64_t_sharded(void *p_arg);
+static int bench_sharded(const bench_config_t *p_config, unsigned int threads);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_LOCKED_FUNCS(uint64_t_spinlock)
+BENCH_LOCKED_FUNCS(uint64_t)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_OPS, DEFAULT_THREADS, NULL};
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    for (unsigned int threads = 1; threads <= config.threads; threads *= 2) {
+        if(bench_sharded(&config, threads) ||
+           bench_locked_uint64_t_spinlock(&config, "spinlock", threads) ||
+           bench_locked_uint64_t(&config, "mutex", threads)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    /* The op number has to fit below THREAD_SHIFT. */
+    if((p_config->ops == 0) || (p_config->ops >= ((uint64_t)1 << THREAD_SHIFT)) || (p_config->threads == 0) ||
+       (p_config->threads > MAX_THREADS) || (p_config->ops < p_config->threads)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] p_op Name of the operation.
+ * @param[in] threads Number of threads.
+ * @param[in] ops Number of values pushed or collected.
+ * @param[in] total_ns Wall time of the operation.
+ */
+static void add_result(const char *p_kind, const char *p_op, unsigned int threads, size_t ops, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].p_op = p_op;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].ops = ops;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Time threads pushing into one vector.
+ *
+ * @param[in] p_vector The vector.
+ * @param[in] p_worker Thread function pushing into the vector.
+ * @param[in] ops_per_thread Number of values every thread pushes.
+ * @param[in] threads Number of threads.
+ * @param[in] p_kind Name of the vector kind.
+ * @return 0 on success, -1 if a thread could not be started or a push failed.
+ */
+static int run_threads(void *p_vector, void *(*p_worker)(void *), size_t ops_per_thread, unsigned int threads, const char *p_kind) {
+
+    pthread_t thread_ids[MAX_THREADS];
+    push_worker_t workers[MAX_THREADS];
+    unsigned int started = 0;
+    size_t failures = 0;
+    uint64_t start_ns = 0;
+
+    start_ns = bench_now_ns();
+    for (started = 0; started < threads; started++) {
+        workers[started].p_vector = p_vector;
+        workers[started].thread = started;
+        workers[started].ops = ops_per_thread;
+        workers[started].failures = 0;
+        if(pthread_create(&thread_ids[started], NULL, p_worker, &workers[started])) {
+            break;
+        }
+    }
+    for (unsigned int thread = 0; thread < started; thread++) {
+        pthread_join(thread_ids[thread], NULL);
+        failures += workers[thread].failures;
+    }
+
+    add_result(p_kind, "push", started, ops_per_thread * started, bench_now_ns() - start_ns);
+
+    if((started != threads) || (failures != 0)) {
+        fprintf(stderr, "%s: %u of %u threads started, %zu pushes failed\n", p_kind, started, threads, failures);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Push tagged values into a shard of the sharded vector.
+ *
+ * @param[in] p_arg The push_worker_t of the thread.
+ * @return NULL
+ */
+static void *push_worker_uint64_t_sharded(void *p_arg) {
+
+    push_worker_t *p_worker = (push_worker_t *)p_arg;
+    vector_uint64_t_sharded_t *p_vector = (vector_uint64_t_sharded_t *)p_worker->p_vector;
+    uint64_t tag = (uint64_t)p_worker->thread << THREAD_SHIFT;
+    size_t shard = 0;
+
+    if(vector_uint64_t_sharded_acquire_shard(p_vector, &shard)) {
+        p_worker->failures = p_worker->ops;
+        return NULL;
+    }
+    for (size_t op = 0; op < p_worker->ops; op++) {
+        if(p_vector->vptr->push(p_vector, shard, tag | op)) {
+            p_worker->failures++;
+        }
+    }
+    vector_uint64_t_sharded_release_shard(p_vector, shard);
+
+    return NULL;
+}
+
+/**
+ * @brief Time threads pushing into their shards, then the collect of the shards, and check every collected
+ * value is there exactly once with the values of each thread in the order it pushed them.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] threads Number of threads.
+ * @return 0 on success, -1 on a failed push or collect, or a missing, duplicated or reordered value.
+ */
+static int bench_sharded(const bench_config_t *p_config, unsigned int threads) {
+
+    vector_uint64_t_sharded_t *p_vector = vector_uint64_t_sharded_create();
+    vector_uint64_t_t *p_collected = NULL;
+    size_t ops_per_thread = p_config->ops / threads;
+    size_t next_op[MAX_THREADS] = {0};
+    uint64_t start_ns = 0;
+    int status = 0;
+
+    if(p_vector == NULL) {
+        return -1;
+    }
+
+    status = run_threads(p_vector, push_worker_uint64_t_sharded, ops_per_thread, threads, "sharded");
+    if(status == 0) {
+        start_ns = bench_now_ns();
+        p_collected = vector_uint64_t_sharded_collect(p_vector, 0);
+        add_result("sharded", "collect", threads, ops_per_thread * threads, bench_now_ns() - start_ns);
+        if((p_collected == NULL) || (p_collected->size != ops_per_thread * threads)) {
+            fprintf(stderr, "sharded: collect failed\n");
+            status = -1;
+        }
+    }
+    for (size_t index = 0; (status == 0) && (index < p_collected->size); index++) {
+        uint64_t value = vector_uint64_t_at(p_collected, index);
+        unsigned int thread = (unsigned int)(value >> THREAD_SHIFT);
+
+        if((thread >= threads) || ((value & (((uint64_t)1 << THREAD_SHIFT) - 1)) != next_op[thread])) {
+            fprintf(stderr, "sharded: unexpected value 0x%llx at index %zu\n", (unsigned long long)value, index);
+            status = -1;
+        }
+        else {
+            next_op[thread]++;
+        }
+    }
+
+    vector_uint64_t_destroy(p_collected);
+    vector_uint64_t_sharded_destroy(p_vector);
+
+    return status;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_sharded");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"ops\": %zu, \"threads\": %u", p_config->ops, p_config->threads);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"op\": \"%s\", \"threads\": %u, \"ops\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.3f, \"mops_per_sec\": %.3f}%s\n",
+                p_result->p_kind, p_result->p_op, p_result->threads, p_result->ops, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->ops, (double)p_result->ops * 1e3 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
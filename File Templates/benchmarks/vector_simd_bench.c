@@ -0,0 +1,281 @@
+/**
+ * @file vector_simd_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the vector numeric kernels at every SIMD level the CPU supports.
+ *
+ * Runs sum, min, max, argmin, argmax, dot, axpy, scale, find and count over vector_double_nolock_t and
+ * vector_uint32_t_nolock_t at every supported level, starting with the scalar loops, and times a sum
+ * looping over vptr->get as the baseline the kernels replace. The default size fits in L2 so the numbers
+ * show compute, pass a larger --elements to see memory bandwidth. Compilers may vectorize the scalar loops
+ * of the integer kernels for the baseline instruction set on their own. Results are printed as JSON on
+ * stdout (or to --output).
+ *
+ * Usage: vector_simd_bench [--elements N] [--repeat N] [--seed N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_simd.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of elements in every vector. */
+#define DEFAULT_ELEMENTS        (16384)
+/** definition for the default number of calls per measurement. */
+#define DEFAULT_REPEAT          (2000)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (128)
+
+/** Time repeat runs of the statements given after bytes_per_element and record them under vector and op. */
+#define TIME_KERNEL(p_config, p_vector_name, p_op, level, bytes_per_element, ...) \
+    do { \
+        uint64_t start_ns = bench_now_ns(); \
+        for (size_t pass = 0; pass < (p_config)->repeat; pass++) { \
+            __VA_ARGS__; \
+        } \
+        add_result((p_vector_name), (p_op), (level), (p_config)->elements * (p_config)->repeat, \
+                   (bytes_per_element), bench_now_ns() - start_ns); \
+    } while (0)
+
+/** Macro to generate the measurements of one vector type. */
+#define BENCH_KERNEL_FUNCS(name, data_type, sum_type) \
+    static int bench_##name(const bench_config_t *p_config, const char *p_vector_name) { \
+        vector_##name##_t *p_x = vector_##name##_create(1); \
+        vector_##name##_t *p_y = vector_##name##_create(1); \
+        volatile sum_type sum_sink = 0; \
+        volatile data_type value_sink = 0; \
+        volatile size_t index_sink = 0; \
+        sum_type sum = 0; \
+        data_type value = 0; \
+        size_t index = 0; \
+        size_t size = p_config->elements; \
+        if ((p_x == NULL) || (p_y == NULL) || p_x->vptr->resize(p_x, size) || p_y->vptr->resize(p_y, size)) { \
+            vector_##name##_destroy(p_x); \
+            vector_##name##_destroy(p_y); \
+            return -1; \
+        } \
+        /* Small values keep the integer sums exact and the scaled values in range. */ \
+        for (size_t idx = 0; idx < size; idx++) { \
+            p_x->data[idx] = (data_type)(rand() % 100 + 1); \
+            p_y->data[idx] = (data_type)(rand() % 100 + 1); \
+        } \
+        TIME_KERNEL(p_config, p_vector_name, "sum_vtable_get", "none", sizeof(data_type), \
+            sum = 0; \
+            for (size_t idx = 0; idx < size; idx++) { \
+                p_x->vptr->get(p_x, idx, &value); \
+                sum += (sum_type)value; \
+            } \
+            sum_sink = sum); \
+        for (int level = VECTOR_SIMD_LEVEL_SCALAR; level < VECTOR_SIMD_LEVEL_COUNT; level++) { \
+            const char *p_level = vector_simd_level_name((vector_simd_level_t)level); \
+            if (vector_simd_set_level((vector_simd_level_t)level)) { \
+                continue; \
+            } \
+            TIME_KERNEL(p_config, p_vector_name, "sum", p_level, sizeof(data_type), \
+                vector_##name##_sum(p_x, &sum); sum_sink = sum); \
+            TIME_KERNEL(p_config, p_vector_name, "min", p_level, sizeof(data_type), \
+                vector_##name##_min(p_x, &value); value_sink = value); \
+            TIME_KERNEL(p_config, p_vector_name, "max", p_level, sizeof(data_type), \
+                vector_##name##_max(p_x, &value); value_sink = value); \
+            TIME_KERNEL(p_config, p_vector_name, "argmin", p_level, sizeof(data_type), \
+                vector_##name##_argmin(p_x, &index); index_sink = index); \
+            TIME_KERNEL(p_config, p_vector_name, "argmax", p_level, sizeof(data_type), \
+                vector_##name##_argmax(p_x, &index); index_sink = index); \
+            TIME_KERNEL(p_config, p_vector_name, "dot", p_level, 2 * sizeof(data_type), \
+                vector_##name##_dot(p_x, p_y, &sum); sum_sink = sum); \
+            TIME_KERNEL(p_config, p_vector_name, "axpy", p_level, 3 * sizeof(data_type), \
+                vector_##name##_axpy(p_y, (data_type)1, p_x)); \
+            TIME_KERNEL(p_config, p_vector_name, "scale", p_level, 2 * sizeof(data_type), \
+                vector_##name##_scale(p_y, (data_type)1)); \
+            /* 0 is never in the data, so find and count always scan everything. */ \
+            TIME_KERNEL(p_config, p_vector_name, "find", p_level, sizeof(data_type), \
+                vector_##name##_find(p_x, (data_type)0, &index); index_sink = index); \
+            TIME_KERNEL(p_config, p_vector_name, "count", p_level, sizeof(data_type), \
+                vector_##name##_count(p_x, (data_type)1, &index); index_sink = index); \
+        } \
+        (void)sum_sink; \
+        (void)value_sink; \
+        (void)index_sink; \
+        vector_##name##_destroy(p_x); \
+        vector_##name##_destroy(p_y); \
+        return 0; \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t elements;                    /**< Number of elements in every vector. */
+    size_t repeat;                      /**< Number of calls per measurement. */
+    unsigned int seed;                  /**< Seed for the generated values. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_vector_name;          /**< Name of the vector type. */
+    const char *p_name;                 /**< Name of the kernel. */
+    const char *p_level;                /**< SIMD level the kernel ran at. */
+    size_t elements;                    /**< Number of elements processed, across all calls. */
+    size_t bytes_per_element;           /**< Bytes read and written per element. */
+    uint64_t total_ns;                  /**< Wall time of all calls. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--elements", "N", BENCH_OPTION_SIZE, bench_config_t, elements),
+    BENCH_OPTION("--repeat", "N", BENCH_OPTION_SIZE, bench_config_t, repeat),
+    BENCH_OPTION("--seed", "N", BENCH_OPTION_UINT, bench_config_t, seed),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_vector_name, const char *p_name, const char *p_level, size_t elements, size_t bytes_per_element, uint64_t total_ns);
+static int print_json(const bench_config_t *p_config, vector_simd_level_t detected_level);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_KERNEL_FUNCS(double_nolock, double, double)
+BENCH_KERNEL_FUNCS(uint32_t_nolock, uint32_t, uint64_t)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_ELEMENTS, DEFAULT_REPEAT, 1, NULL};
+    vector_simd_level_t detected_level = vector_simd_get_level();
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    srand(config.seed);
+    if(bench_double_nolock(&config, "vector_double_nolock_t") || bench_uint32_t_nolock(&config, "vector_uint32_t_nolock_t")) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    vector_simd_set_level(detected_level);
+
+    if(print_json(&config, detected_level)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->elements == 0) || (p_config->elements > INT32_MAX) || (p_config->repeat == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_vector_name Name of the vector type.
+ * @param[in] p_name Name of the kernel.
+ * @param[in] p_level SIMD level the kernel ran at.
+ * @param[in] elements Number of elements processed, across all calls.
+ * @param[in] bytes_per_element Bytes read and written per element.
+ * @param[in] total_ns Wall time of all calls.
+ */
+static void add_result(const char *p_vector_name, const char *p_name, const char *p_level, size_t elements, size_t bytes_per_element, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_vector_name = p_vector_name;
+    s_results[s_number_of_results].p_name = p_name;
+    s_results[s_number_of_results].p_level = p_level;
+    s_results[s_number_of_results].elements = elements;
+    s_results[s_number_of_results].bytes_per_element = bytes_per_element;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Print every result as JSON, with its speedup over the scalar level of the same kernel.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @param[in] detected_level Widest SIMD level the CPU supports.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config, vector_simd_level_t detected_level) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_simd");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"elements\": %zu, \"repeat\": %zu, \"seed\": %u, \"detected_level\": \"%s\"",
+            p_config->elements, p_config->repeat, p_config->seed, vector_simd_level_name(detected_level));
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+        double speedup = 0;
+
+        /* The scalar run of the same kernel comes first, so it is already in the list. */
+        for (size_t scalar = 0; scalar <= result; scalar++) {
+            if((strcmp(s_results[scalar].p_vector_name, p_result->p_vector_name) == 0) && (strcmp(s_results[scalar].p_name, p_result->p_name) == 0)
+               && (strcmp(s_results[scalar].p_level, "scalar") == 0)) {
+                speedup = (double)s_results[scalar].total_ns / (double)p_result->total_ns;
+                break;
+            }
+        }
+
+        fprintf(p_out, "    {\"vector\": \"%s\", \"op\": \"%s\", \"level\": \"%s\", \"elements\": %zu, \"total_ns\": %llu, \"ns_per_element\": %.4f, \"gb_per_sec\": %.3f, \"speedup_vs_scalar\": %.2f}%s\n",
+                p_result->p_vector_name, p_result->p_name, p_result->p_level, p_result->elements, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->elements,
+                (double)p_result->elements * (double)p_result->bytes_per_element / (double)p_result->total_ns,
+                speedup, (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,381 @@
+/**
+ * @file vector_small_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the small vector against the heap vector on many short lived small vectors.
+ *
+ * Every vector gets a random number of values in [0, --max-values], is summed through get and is then
+ * released. The heap vector is vector_double_nolock_t, the small vector is SMALL_VECTOR(double, 16), once
+ * created on the heap and once initialized on the stack. A counting allocator reports the number of
+ * allocations per vector. Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_small_bench [--vectors N] [--max-values N] [--seed N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_small.h"
+#include "vector_allocator.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of vectors per measurement. */
+#define DEFAULT_VECTORS         (2000000)
+/** definition for the default max number of values per vector. */
+#define DEFAULT_MAX_VALUES      (15)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the capacity the heap vectors start with. */
+#define INITIAL_CAPACITY        (4)
+/** definition for the number of values the small vectors hold inline. */
+#define INLINE_CAPACITY         16
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t vectors;                     /**< Number of vectors per measurement. */
+    unsigned int max_values;            /**< Max number of values per vector. */
+    unsigned int seed;                  /**< Seed for the number of values per vector. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_kind;                 /**< Name of the vector kind. */
+    size_t vectors;                     /**< Number of vectors. */
+    uint64_t allocations;               /**< Number of alloc and realloc calls. */
+    uint64_t total_ns;                  /**< Wall time of all vectors. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--vectors", "N", BENCH_OPTION_SIZE, bench_config_t, vectors),
+    BENCH_OPTION("--max-values", "N", BENCH_OPTION_UINT, bench_config_t, max_values),
+    BENCH_OPTION("--seed", "N", BENCH_OPTION_UINT, bench_config_t, seed),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+SMALL_VECTOR(double, INLINE_CAPACITY)
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+/** Number of alloc and realloc calls of the counting allocator. */
+static uint64_t s_allocations = 0;
+/** Sum of every value read, so the reads are not optimized away. */
+static volatile double s_sink = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, size_t vectors, uint64_t allocations, uint64_t total_ns);
+static void *counting_alloc(void *p_context, size_t size);
+static void *counting_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void counting_free(void *p_context, void *p_block, size_t size);
+static int bench_heap_vector(const bench_config_t *p_config, const uint8_t *p_counts);
+static int bench_small_vector_heap(const bench_config_t *p_config, const uint8_t *p_counts);
+static int bench_small_vector_stack(const bench_config_t *p_config, const uint8_t *p_counts);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/** Allocator that counts the allocations and forwards them to malloc. */
+static const vector_allocator_t s_counting_allocator = {
+    .alloc = counting_alloc,
+    .realloc = counting_realloc,
+    .free = counting_free,
+    .p_context = NULL,
+};
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_VECTORS, DEFAULT_MAX_VALUES, 1, NULL};
+    uint8_t *p_counts = NULL;
+    int status = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    /* The value counts are drawn up front so the generator stays out of the timed loops. */
+    if((p_counts = (uint8_t *)malloc(config.vectors)) == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    srand(config.seed);
+    for (size_t vector = 0; vector < config.vectors; vector++) {
+        p_counts[vector] = (uint8_t)((unsigned int)rand() % (config.max_values + 1));
+    }
+
+    status = bench_heap_vector(&config, p_counts) ||
+             bench_small_vector_heap(&config, p_counts) ||
+             bench_small_vector_stack(&config, p_counts);
+    free(p_counts);
+
+    if(status) {
+        fprintf(stderr, "vector create or push failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->vectors == 0) || (p_config->max_values > UINT8_MAX)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] vectors Number of vectors.
+ * @param[in] allocations Number of alloc and realloc calls.
+ * @param[in] total_ns Wall time of all vectors.
+ */
+static void add_result(const char *p_kind, size_t vectors, uint64_t allocations, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_kind = p_kind;
+    s_results[s_number_of_results].vectors = vectors;
+    s_results[s_number_of_results].allocations = allocations;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief alloc of the counting allocator.
+ *
+ * @param p_context Unused.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *counting_alloc(void *p_context, size_t size) {
+
+    (void)p_context;
+    s_allocations++;
+
+    return malloc(size);
+}
+
+/**
+ * @brief realloc of the counting allocator.
+ *
+ * @param p_context Unused.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Unused.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *counting_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    (void)p_context;
+    (void)old_size;
+    s_allocations++;
+
+    return realloc(p_block, new_size);
+}
+
+/**
+ * @brief free of the counting allocator.
+ *
+ * @param p_context Unused.
+ * @param p_block The block.
+ * @param size Unused.
+ */
+static void counting_free(void *p_context, void *p_block, size_t size) {
+
+    (void)p_context;
+    (void)size;
+
+    free(p_block);
+}
+
+/**
+ * @brief Time the heap vector on the workload.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_counts Number of values of every vector.
+ * @return 0 on success, -1 if a create or a push failed.
+ */
+static int bench_heap_vector(const bench_config_t *p_config, const uint8_t *p_counts) {
+
+    uint64_t start_ns = 0;
+    double sum = 0;
+    double value = 0;
+
+    s_allocations = 0;
+    start_ns = bench_now_ns();
+    for (size_t vector = 0; vector < p_config->vectors; vector++) {
+        vector_double_nolock_t *p_vector = vector_double_nolock_create_with_allocator(INITIAL_CAPACITY, &s_counting_allocator);
+
+        if(p_vector == NULL) {
+            return -1;
+        }
+        for (int index = 0; index < p_counts[vector]; index++) {
+            if(p_vector->vptr->push(p_vector, (double)index)) {
+                return -1;
+            }
+        }
+        for (int index = 0; index < p_counts[vector]; index++) {
+            p_vector->vptr->get(p_vector, index, &value);
+            sum += value;
+        }
+        vector_double_nolock_destroy(p_vector);
+    }
+    add_result("vector", p_config->vectors, s_allocations, bench_now_ns() - start_ns);
+    s_sink += sum;
+
+    return 0;
+}
+
+/**
+ * @brief Time the small vector created on the heap on the workload.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_counts Number of values of every vector.
+ * @return 0 on success, -1 if a create or a push failed.
+ */
+static int bench_small_vector_heap(const bench_config_t *p_config, const uint8_t *p_counts) {
+
+    uint64_t start_ns = 0;
+    double sum = 0;
+    double value = 0;
+
+    s_allocations = 0;
+    start_ns = bench_now_ns();
+    for (size_t vector = 0; vector < p_config->vectors; vector++) {
+        vector_double_small16_t *p_vector = vector_double_small16_create_with_allocator(&s_counting_allocator);
+
+        if(p_vector == NULL) {
+            return -1;
+        }
+        for (int index = 0; index < p_counts[vector]; index++) {
+            if(p_vector->vptr->push(p_vector, (double)index)) {
+                return -1;
+            }
+        }
+        for (int index = 0; index < p_counts[vector]; index++) {
+            p_vector->vptr->get(p_vector, index, &value);
+            sum += value;
+        }
+        vector_double_small16_destroy(p_vector);
+    }
+    add_result("small_vector_heap", p_config->vectors, s_allocations, bench_now_ns() - start_ns);
+    s_sink += sum;
+
+    return 0;
+}
+
+/**
+ * @brief Time the small vector initialized on the stack on the workload.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_counts Number of values of every vector.
+ * @return 0 on success, -1 if a push failed.
+ */
+static int bench_small_vector_stack(const bench_config_t *p_config, const uint8_t *p_counts) {
+
+    uint64_t start_ns = 0;
+    double sum = 0;
+    double value = 0;
+
+    s_allocations = 0;
+    start_ns = bench_now_ns();
+    for (size_t vector = 0; vector < p_config->vectors; vector++) {
+        vector_double_small16_t small_vector;
+
+        vector_double_small16_init(&small_vector, &s_counting_allocator);
+        for (int index = 0; index < p_counts[vector]; index++) {
+            if(small_vector.vptr->push(&small_vector, (double)index)) {
+                return -1;
+            }
+        }
+        for (int index = 0; index < p_counts[vector]; index++) {
+            small_vector.vptr->get(&small_vector, index, &value);
+            sum += value;
+        }
+        vector_double_small16_deinit(&small_vector);
+    }
+    add_result("small_vector_stack", p_config->vectors, s_allocations, bench_now_ns() - start_ns);
+    s_sink += sum;
+
+    return 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_small");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"vectors\": %zu, \"max_values\": %u, \"inline_capacity\": %d, \"seed\": %u",
+            p_config->vectors, p_config->max_values, INLINE_CAPACITY, p_config->seed);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"vectors\": %zu, \"allocations\": %llu, \"allocations_per_vector\": %.3f, \"total_ns\": %llu, \"ns_per_vector\": %.3f}%s\n",
+                p_result->p_kind, p_result->vectors, (unsigned long long)p_result->allocations,
+                (double)p_result->allocations / (double)p_result->vectors, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->vectors, (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file vector_soa_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the structure-of-arrays vector against an array-of-structs vector of the same records.
+ *
+ * The record is a 64 byte particle. The AoS vector is SMALL_VECTOR_WITH_LOCK(particle_aos, particle_t, 1, NOLOCK),
+ * the SoA vector is SOA_VECTOR_WITH_LOCK(particle_soa, particle_t, PARTICLE_FIELDS, NOLOCK). Both push --records
+ * records, read them back whole through get, sum one field and update one field from another. Results are
+ * printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_soa_bench [--records N] [--repeat N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_small.h"
+#include "vector_soa.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of records per vector. */
+#define DEFAULT_RECORDS         (1000000)
+/** definition for the default number of times every scan runs. */
+#define DEFAULT_REPEAT          (10)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the time step of the update. */
+#define TIME_STEP               (0.001)
+
+/** Fields of the particle record, 64 bytes. */
+#define PARTICLE_FIELDS(X) \
+    X(double, x) X(double, y) X(double, z) \
+    X(double, vx) X(double, vy) X(double, vz) \
+    X(double, mass) X(uint32_t, id) X(uint32_t, flags)
+
+/** Macro to generate the measurements of one layout. The layouts only differ in how they are created and a field is scanned. */
+#define BENCH_LAYOUT_FUNCS(name, CREATE, SCAN_X, UPDATE_X) \
+    static int bench_##name(const bench_config_t *p_config) { \
+        vector_##name##_t *p_vector = CREATE; \
+        uint64_t start_ns = 0; \
+        double sum = 0; \
+        particle_t record; \
+        if (p_vector == NULL) { \
+            return -1; \
+        } \
+        start_ns = bench_now_ns(); \
+        for (size_t index = 0; index < p_config->records; index++) { \
+            make_particle(index, &record); \
+            if (p_vector->vptr->push(p_vector, record)) { \
+                vector_##name##_destroy(p_vector); \
+                return -1; \
+            } \
+        } \
+        add_result(#name, "push", p_config->records, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (size_t index = 0; index < p_config->records; index++) { \
+            p_vector->vptr->get(p_vector, index, &record); \
+            sum += record.x + record.mass + (double)record.id; \
+        } \
+        add_result(#name, "get_record", p_config->records, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (unsigned int repeat = 0; repeat < p_config->repeat; repeat++) { \
+            for (size_t index = 0; index < p_config->records; index++) { \
+                sum += SCAN_X; \
+            } \
+        } \
+        add_result(#name, "scan_field", p_config->records * p_config->repeat, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (unsigned int repeat = 0; repeat < p_config->repeat; repeat++) { \
+            for (size_t index = 0; index < p_config->records; index++) { \
+                UPDATE_X; \
+            } \
+        } \
+        add_result(#name, "update_field", p_config->records * p_config->repeat, bench_now_ns() - start_ns); \
+        s_sink += sum + vector_##name##_at(p_vector, p_config->records / 2).x; \
+        vector_##name##_destroy(p_vector); \
+        return 0; \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+SOA_RECORD(particle, PARTICLE_FIELDS)
+SMALL_VECTOR_WITH_LOCK(particle_aos, particle_t, 1, NOLOCK)
+SOA_VECTOR_WITH_LOCK(particle_soa, particle_t, PARTICLE_FIELDS, NOLOCK)
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t records;                     /**< Number of records per vector. */
+    unsigned int repeat;                /**< Number of times every scan runs. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_layout;               /**< Name of the vector layout. */
+    const char *p_operation;            /**< Name of the measured operation. */
+    size_t records;                     /**< Number of records the operation touched. */
+    uint64_t total_ns;                  /**< Wall time of the operation. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--records", "N", BENCH_OPTION_SIZE, bench_config_t, records),
+    BENCH_OPTION("--repeat", "N", BENCH_OPTION_UINT, bench_config_t, repeat),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+/** Sum of every value read, so the reads are not optimized away. */
+static volatile double s_sink = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_layout, const char *p_operation, size_t records, uint64_t total_ns);
+static void make_particle(size_t index, particle_t *p_record);
+static int bench_particle_aos(const bench_config_t *p_config);
+static int bench_particle_soa(const bench_config_t *p_config);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_LAYOUT_FUNCS(particle_aos, vector_particle_aos_create(), p_vector->data[index].x, p_vector->data[index].x += p_vector->data[index].vx * TIME_STEP)
+BENCH_LAYOUT_FUNCS(particle_soa, vector_particle_soa_create(0), p_vector->x[index], p_vector->x[index] += p_vector->vx[index] * TIME_STEP)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_RECORDS, DEFAULT_REPEAT, NULL};
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    if(bench_particle_aos(&config) || bench_particle_soa(&config)) {
+        fprintf(stderr, "vector create or push failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->records == 0) || (p_config->repeat == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_layout Name of the vector layout.
+ * @param[in] p_operation Name of the measured operation.
+ * @param[in] records Number of records the operation touched.
+ * @param[in] total_ns Wall time of the operation.
+ */
+static void add_result(const char *p_layout, const char *p_operation, size_t records, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_layout = p_layout;
+    s_results[s_number_of_results].p_operation = p_operation;
+    s_results[s_number_of_results].records = records;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Fill in the particle pushed at index.
+ *
+ * @param[in] index Index of the particle.
+ * @param[out] p_record The particle.
+ */
+static void make_particle(size_t index, particle_t *p_record) {
+
+    p_record->x = (double)index;
+    p_record->y = (double)(index % 1000);
+    p_record->z = 0.0;
+    p_record->vx = 1.0;
+    p_record->vy = -1.0;
+    p_record->vz = 0.5;
+    p_record->mass = 1.0 + (double)(index % 7);
+    p_record->id = (uint32_t)index;
+    p_record->flags = 0;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_soa");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"records\": %zu, \"repeat\": %u, \"record_bytes\": %zu",
+            p_config->records, p_config->repeat, sizeof(particle_t));
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"layout\": \"%s\", \"operation\": \"%s\", \"records\": %zu, \"total_ns\": %llu, \"ns_per_record\": %.3f, \"records_per_sec\": %.0f}%s\n",
+                p_result->p_layout, p_result->p_operation, p_result->records, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->records, (double)p_result->records * 1e9 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,258 @@
+/**
+ * @file vector_sort_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the vector radix sort, sequential and parallel, and of the binary search.
+ *
+ * Fills vector_uint32_t_nolock_t, vector_uint64_t_nolock_t, vector_int_nolock_t and vector_double_nolock_t with
+ * --elements random values and times qsort as the baseline, sort, and sort_parallel on 1 up to --threads
+ * threads (doubling). Every sorted vector is checked. Then times --lookups random lower_bound calls on the
+ * sorted vector. Results are printed as JSON on stdout (or to --output).
+ *
+ * Usage: vector_sort_bench [--elements N] [--threads N] [--lookups N] [--seed N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "vector_sort.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of elements in every vector. */
+#define DEFAULT_ELEMENTS        (10000000)
+/** definition for the default number of lower_bound calls per vector. */
+#define DEFAULT_LOOKUPS         (1000000)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (128)
+
+/** Macro to generate the measurements of one vector type, value is the value made from the random r. */
+#define BENCH_SORT_FUNCS(name, data_type, value) \
+    static int compare_##name(const void *p_a, const void *p_b) { \
+        data_type a = *(const data_type *)p_a; \
+        data_type b = *(const data_type *)p_b; \
+        return (a < b) ? -1 : (a > b); \
+    } \
+    static void fill_##name(vector_##name##_t *p_vector, uint64_t seed) { \
+        uint64_t state = seed; \
+        for (size_t idx = 0; idx < p_vector->size; idx++) { \
+            uint64_t r = bench_next_random(&state); \
+            p_vector->data[idx] = (value); \
+        } \
+    } \
+    static int check_##name(const vector_##name##_t *p_vector) { \
+        for (size_t idx = 1; idx < p_vector->size; idx++) { \
+            if (p_vector->data[idx] < p_vector->data[idx - 1]) { \
+                fprintf(stderr, #name ": not sorted at %zu\n", idx); \
+                return -1; \
+            } \
+        } \
+        return 0; \
+    } \
+    static int bench_##name(const bench_config_t *p_config) { \
+        vector_##name##_t *p_vector = vector_##name##_create(1); \
+        uint64_t start_ns = 0; \
+        uint64_t state = p_config->seed; \
+        size_t hits = 0; \
+        size_t index = 0; \
+        int status = 0; \
+        if ((p_vector == NULL) || p_vector->vptr->resize(p_vector, p_config->elements)) { \
+            vector_##name##_destroy(p_vector); \
+            return -1; \
+        } \
+        fill_##name(p_vector, p_config->seed); \
+        start_ns = bench_now_ns(); \
+        qsort(p_vector->data, p_vector->size, sizeof(data_type), compare_##name); \
+        add_result(#name, "qsort", 1, p_config->elements, bench_now_ns() - start_ns); \
+        status |= check_##name(p_vector); \
+        fill_##name(p_vector, p_config->seed); \
+        start_ns = bench_now_ns(); \
+        status |= vector_##name##_sort(p_vector); \
+        add_result(#name, "sort", 1, p_config->elements, bench_now_ns() - start_ns); \
+        status |= check_##name(p_vector); \
+        for (unsigned int threads = 1; threads <= p_config->threads; threads *= 2) { \
+            fill_##name(p_vector, p_config->seed); \
+            start_ns = bench_now_ns(); \
+            status |= vector_##name##_sort_parallel(p_vector, threads); \
+            add_result(#name, "sort_parallel", threads, p_config->elements, bench_now_ns() - start_ns); \
+            status |= check_##name(p_vector); \
+        } \
+        start_ns = bench_now_ns(); \
+        for (size_t lookup = 0; lookup < p_config->lookups; lookup++) { \
+            data_type key = p_vector->data[bench_next_random(&state) % p_vector->size]; \
+            vector_##name##_lower_bound(p_vector, key, &index); \
+            hits += (p_vector->data[index] == key); \
+        } \
+        add_result(#name, "lower_bound", 1, p_config->lookups, bench_now_ns() - start_ns); \
+        if (hits != p_config->lookups) { \
+            fprintf(stderr, #name ": lower_bound missed %zu values\n", p_config->lookups - hits); \
+            status = -1; \
+        } \
+        vector_##name##_destroy(p_vector); \
+        return status; \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t elements;                    /**< Number of elements in every vector. */
+    unsigned int threads;               /**< Max number of threads of the parallel sort. */
+    size_t lookups;                     /**< Number of lower_bound calls per vector. */
+    uint64_t seed;                      /**< Seed for the generated values. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_vector_name;          /**< Name of the vector type. */
+    const char *p_operation;            /**< Name of the measured operation. */
+    unsigned int threads;               /**< Number of threads the operation ran on. */
+    size_t elements;                    /**< Number of elements sorted, or of lookups. */
+    uint64_t total_ns;                  /**< Wall time of the operation. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--elements", "N", BENCH_OPTION_SIZE, bench_config_t, elements),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--lookups", "N", BENCH_OPTION_SIZE, bench_config_t, lookups),
+    BENCH_OPTION("--seed", "N", BENCH_OPTION_UINT64, bench_config_t, seed),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_vector_name, const char *p_operation, unsigned int threads, size_t elements, uint64_t total_ns);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_SORT_FUNCS(uint32_t_nolock, uint32_t, (uint32_t)r)
+BENCH_SORT_FUNCS(uint64_t_nolock, uint64_t, r)
+BENCH_SORT_FUNCS(int_nolock, int, (int)(uint32_t)r)
+BENCH_SORT_FUNCS(double_nolock, double, (double)(int64_t)r * 1e-12)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_ELEMENTS, 0, DEFAULT_LOOKUPS, 1, NULL};
+
+    config.threads = vector_sort_default_threads();
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    if(bench_uint32_t_nolock(&config) || bench_uint64_t_nolock(&config) ||
+       bench_int_nolock(&config) || bench_double_nolock(&config)) {
+        fprintf(stderr, "vector sort failed\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->elements == 0) || (p_config->threads == 0) || (p_config->threads > VECTOR_SORT_MAX_THREADS)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_vector_name Name of the vector type.
+ * @param[in] p_operation Name of the measured operation.
+ * @param[in] threads Number of threads the operation ran on.
+ * @param[in] elements Number of elements sorted, or of lookups.
+ * @param[in] total_ns Wall time of the operation.
+ */
+static void add_result(const char *p_vector_name, const char *p_operation, unsigned int threads, size_t elements, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_vector_name = p_vector_name;
+    s_results[s_number_of_results].p_operation = p_operation;
+    s_results[s_number_of_results].threads = threads;
+    s_results[s_number_of_results].elements = elements;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_sort");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"elements\": %zu, \"threads\": %u, \"lookups\": %zu, \"seed\": %llu",
+            p_config->elements, p_config->threads, p_config->lookups, (unsigned long long)p_config->seed);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"vector\": \"%s\", \"operation\": \"%s\", \"threads\": %u, \"elements\": %zu, \"total_ns\": %llu, \"ns_per_element\": %.3f, \"elements_per_sec\": %.0f}%s\n",
+                p_result->p_vector_name, p_result->p_operation, p_result->threads, p_result->elements,
+                (unsigned long long)p_result->total_ns, (double)p_result->total_ns / (double)p_result->elements,
+                (double)p_result->elements * 1e9 / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,624 @@
+/**
+ * @file vector_std_bench.cpp
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of every generated vector type against std::vector.
+ *
+ * For int, double, char, uint8_t, uint16_t, uint32_t and uint64_t, times push (from the default capacity and
+ * after reserve), random get and pop through the virtual table of the MUTEX and NOLOCK vectors, push and get
+ * through the inlined push_fast and at of the NOLOCK vector, and the same operations on std::vector as the
+ * baseline. The growth of each is recorded as the number of reallocations, how many of them moved the values
+ * and the final capacity. Then 1 up to --threads threads (doubling) push into one shared MUTEX and SPINLOCK
+ * vector, and into a std::vector behind a std::mutex. Results are printed as JSON on stdout (or to --output),
+ * one result per line.
+ *
+ * With --baseline FILE the results are compared with those of an earlier run, and every ns_per_op more than
+ * --tolerance percent (default 10) above its baseline is reported on stderr and fails the run, so a release
+ * can be gated on it. Results and baseline rows without a counterpart are reported too, and a baseline that
+ * matches no result at all, as from a run with other --threads, fails the run.
+ *
+ * Usage: vector_std_bench [--ops N] [--threads N] [--seed N] [--output FILE] [--baseline FILE] [--tolerance N]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "bench_common.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of operations timed per measurement. */
+#define DEFAULT_OPS             (1000000)
+/** definition for the default max number of threads pushing into a shared vector. */
+#define DEFAULT_THREADS         (8)
+/** definition for the default allowed slowdown against the baseline, in percent. */
+#define DEFAULT_TOLERANCE       (10.0)
+/** definition for the max number of threads. */
+#define MAX_THREADS             (256)
+/** definition for the capacity every timed vector starts with. */
+#define INITIAL_CAPACITY        (16)
+
+/** Macro to generate the type traits of the generated vectors of one data type, for the benchmark templates. */
+#define BENCH_VECTOR_TRAITS(data_type) \
+    struct data_type##_traits { \
+        typedef data_type value_t; \
+        typedef vector_##data_type##_t mutex_t; \
+        typedef vector_##data_type##_spinlock_t spinlock_t; \
+        typedef vector_##data_type##_nolock_t nolock_t; \
+        static const char *name() { return #data_type; } \
+        static mutex_t *create(mutex_t *, size_t capacity) { return vector_##data_type##_create(capacity); } \
+        static spinlock_t *create(spinlock_t *, size_t capacity) { return vector_##data_type##_spinlock_create(capacity); } \
+        static nolock_t *create(nolock_t *, size_t capacity) { return vector_##data_type##_nolock_create(capacity); } \
+        static void destroy(mutex_t *p_vector) { vector_##data_type##_destroy(p_vector); } \
+        static void destroy(spinlock_t *p_vector) { vector_##data_type##_spinlock_destroy(p_vector); } \
+        static void destroy(nolock_t *p_vector) { vector_##data_type##_nolock_destroy(p_vector); } \
+        static int push_fast(nolock_t *p_vector, value_t value) { return vector_##data_type##_nolock_push_fast(p_vector, value); } \
+        static value_t at(const nolock_t *p_vector, size_t index) { return vector_##data_type##_nolock_at(p_vector, index); } \
+    };
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t ops;                         /**< Number of operations timed per measurement. */
+    unsigned int threads;               /**< Max number of threads pushing into a shared vector. */
+    uint64_t seed;                      /**< Seed for the random get indexes. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+    const char *p_baseline;             /**< JSON of an earlier run to compare with, NULL for none. */
+    double tolerance;                   /**< Allowed slowdown against the baseline, in percent. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    std::string kind;                   /**< Name of the vector kind. */
+    std::string type;                   /**< Name of the data type. */
+    std::string op;                     /**< Name of the operation. */
+    unsigned int threads;               /**< Number of threads doing the operation. */
+    size_t ops;                         /**< Number of timed operations, across all threads. */
+    uint64_t total_ns;                  /**< Wall time of all operations. */
+    size_t reallocs;                    /**< growth only: number of times the capacity changed. */
+    size_t moves;                       /**< growth only: number of those that moved the values. */
+    size_t capacity;                    /**< growth only: capacity after the last push. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--ops", "N", BENCH_OPTION_SIZE, bench_config_t, ops),
+    BENCH_OPTION("--threads", "N", BENCH_OPTION_UINT, bench_config_t, threads),
+    BENCH_OPTION("--seed", "N", BENCH_OPTION_UINT64, bench_config_t, seed),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output),
+    BENCH_OPTION("--baseline", "FILE", BENCH_OPTION_STRING, bench_config_t, p_baseline),
+    BENCH_OPTION("--tolerance", "N", BENCH_OPTION_DOUBLE, bench_config_t, tolerance)
+};
+
+/** Results of every measurement, in the order they ran. */
+static std::vector<bench_result_t> s_results;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_kind, const char *p_type, const char *p_op, unsigned int threads, size_t ops, uint64_t total_ns);
+static void add_growth(const char *p_kind, const char *p_type, size_t ops, uint64_t total_ns, size_t reallocs, size_t moves, size_t capacity);
+static int print_json(const bench_config_t *p_config);
+static int compare_baseline(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_VECTOR_TRAITS(int)
+BENCH_VECTOR_TRAITS(double)
+BENCH_VECTOR_TRAITS(char)
+BENCH_VECTOR_TRAITS(uint8_t)
+BENCH_VECTOR_TRAITS(uint16_t)
+BENCH_VECTOR_TRAITS(uint32_t)
+BENCH_VECTOR_TRAITS(uint64_t)
+
+/**
+ * @brief Time push, push after reserve, random get and pop through the virtual table of a generated vector.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] indexes Random indexes in [0, ops) for the gets.
+ */
+template <typename traits, typename vector_t>
+static void bench_vtable(const bench_config_t *p_config, const char *p_kind, const std::vector<size_t> &indexes) {
+
+    typedef typename traits::value_t value_t;
+    vector_t *p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    volatile value_t sink = 0;
+    value_t value = 0;
+    uint64_t start_ns = 0;
+
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        p_vector->vptr->push(p_vector, (value_t)op);
+    }
+    add_result(p_kind, traits::name(), "push", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        p_vector->vptr->get(p_vector, indexes[op], &value);
+        sink = (value_t)(sink + value);
+    }
+    add_result(p_kind, traits::name(), "get_random", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        p_vector->vptr->pop(p_vector);
+    }
+    add_result(p_kind, traits::name(), "pop", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    traits::destroy(p_vector);
+    p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    p_vector->vptr->reserve(p_vector, p_config->ops);
+    for (size_t op = 0; op < p_config->ops; op++) {
+        p_vector->vptr->push(p_vector, (value_t)op);
+    }
+    add_result(p_kind, traits::name(), "push_reserved", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    (void)sink;
+    traits::destroy(p_vector);
+}
+
+/**
+ * @brief Time push, push after reserve and random get through the inlined push_fast and at of the NOLOCK
+ * vector, the calls closest to std::vector.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] indexes Random indexes in [0, ops) for the gets.
+ */
+template <typename traits>
+static void bench_inline(const bench_config_t *p_config, const std::vector<size_t> &indexes) {
+
+    typedef typename traits::value_t value_t;
+    typedef typename traits::nolock_t vector_t;
+    vector_t *p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    volatile value_t sink = 0;
+    uint64_t start_ns = 0;
+
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        traits::push_fast(p_vector, (value_t)op);
+    }
+    add_result("nolock_inline", traits::name(), "push", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        sink = (value_t)(sink + traits::at(p_vector, indexes[op]));
+    }
+    add_result("nolock_inline", traits::name(), "get_random", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    traits::destroy(p_vector);
+    p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    p_vector->vptr->reserve(p_vector, p_config->ops);
+    for (size_t op = 0; op < p_config->ops; op++) {
+        traits::push_fast(p_vector, (value_t)op);
+    }
+    add_result("nolock_inline", traits::name(), "push_reserved", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    (void)sink;
+    traits::destroy(p_vector);
+}
+
+/**
+ * @brief Time the same operations on std::vector, the baseline.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] indexes Random indexes in [0, ops) for the gets.
+ */
+template <typename traits>
+static void bench_std(const bench_config_t *p_config, const std::vector<size_t> &indexes) {
+
+    typedef typename traits::value_t value_t;
+    std::vector<value_t> values;
+    std::vector<value_t> reserved;
+    volatile value_t sink = 0;
+    uint64_t start_ns = 0;
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        values.push_back((value_t)op);
+    }
+    add_result("std::vector", traits::name(), "push", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        sink = (value_t)(sink + values[indexes[op]]);
+    }
+    add_result("std::vector", traits::name(), "get_random", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    /* pop_back alone is a decrement the compiler drops, so take the value off the back like a caller would. */
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        sink = (value_t)(sink + values.back());
+        values.pop_back();
+    }
+    add_result("std::vector", traits::name(), "pop", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    start_ns = bench_now_ns();
+    reserved.reserve(p_config->ops);
+    for (size_t op = 0; op < p_config->ops; op++) {
+        reserved.push_back((value_t)op);
+    }
+    add_result("std::vector", traits::name(), "push_reserved", 1, p_config->ops, bench_now_ns() - start_ns);
+
+    (void)sink;
+}
+
+/**
+ * @brief Record how the MUTEX vector and std::vector grow while ops values are pushed one at a time.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ */
+template <typename traits>
+static void bench_growth(const bench_config_t *p_config) {
+
+    typedef typename traits::value_t value_t;
+    typedef typename traits::mutex_t vector_t;
+    vector_t *p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    std::vector<value_t> values;
+    size_t reallocs = 0;
+    size_t moves = 0;
+    uint64_t start_ns = 0;
+
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        size_t capacity = p_vector->capacity;
+        value_t *p_data = p_vector->data;
+
+        p_vector->vptr->push(p_vector, (value_t)op);
+        reallocs += (p_vector->capacity != capacity);
+        moves += (p_vector->data != p_data);
+    }
+    add_growth("mutex", traits::name(), p_config->ops, bench_now_ns() - start_ns, reallocs, moves, p_vector->capacity);
+    traits::destroy(p_vector);
+
+    reallocs = 0;
+    moves = 0;
+    start_ns = bench_now_ns();
+    for (size_t op = 0; op < p_config->ops; op++) {
+        size_t capacity = values.capacity();
+        value_t *p_data = values.data();
+
+        values.push_back((value_t)op);
+        reallocs += (values.capacity() != capacity);
+        moves += (values.data() != p_data);
+    }
+    add_growth("std::vector", traits::name(), p_config->ops, bench_now_ns() - start_ns, reallocs, moves, values.capacity());
+}
+
+/**
+ * @brief Time threads threads pushing ops / threads values each into one shared generated vector.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] threads Number of threads.
+ */
+template <typename traits, typename vector_t>
+static void bench_shared(const bench_config_t *p_config, const char *p_kind, unsigned int threads) {
+
+    typedef typename traits::value_t value_t;
+    vector_t *p_vector = traits::create((vector_t *)NULL, INITIAL_CAPACITY);
+    std::vector<std::thread> workers;
+    size_t ops_per_thread = p_config->ops / threads;
+    uint64_t start_ns = 0;
+
+    if(p_vector == NULL) {
+        return;
+    }
+
+    start_ns = bench_now_ns();
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        workers.push_back(std::thread([p_vector, ops_per_thread]() {
+            for (size_t op = 0; op < ops_per_thread; op++) {
+                p_vector->vptr->push(p_vector, (value_t)op);
+            }
+        }));
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    add_result(p_kind, traits::name(), "push_shared", threads, ops_per_thread * threads, bench_now_ns() - start_ns);
+
+    traits::destroy(p_vector);
+}
+
+/**
+ * @brief Time threads threads pushing ops / threads values each into one std::vector behind a std::mutex.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] threads Number of threads.
+ */
+template <typename traits>
+static void bench_shared_std(const bench_config_t *p_config, unsigned int threads) {
+
+    typedef typename traits::value_t value_t;
+    std::vector<value_t> values;
+    std::mutex lock;
+    std::vector<std::thread> workers;
+    size_t ops_per_thread = p_config->ops / threads;
+    uint64_t start_ns = 0;
+
+    start_ns = bench_now_ns();
+    for (unsigned int thread = 0; thread < threads; thread++) {
+        workers.push_back(std::thread([&values, &lock, ops_per_thread]() {
+            for (size_t op = 0; op < ops_per_thread; op++) {
+                std::lock_guard<std::mutex> guard(lock);
+                values.push_back((value_t)op);
+            }
+        }));
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    add_result("std::vector+mutex", traits::name(), "push_shared", threads, ops_per_thread * threads, bench_now_ns() - start_ns);
+}
+
+/**
+ * @brief Run every measurement of one data type.
+ *
+ * @param[in] p_config Configuration the benchmark runs with.
+ * @param[in] indexes Random indexes in [0, ops) for the gets.
+ */
+template <typename traits>
+static void bench_type(const bench_config_t *p_config, const std::vector<size_t> &indexes) {
+
+    bench_vtable<traits, typename traits::mutex_t>(p_config, "mutex", indexes);
+    bench_vtable<traits, typename traits::nolock_t>(p_config, "nolock", indexes);
+    bench_inline<traits>(p_config, indexes);
+    bench_std<traits>(p_config, indexes);
+    bench_growth<traits>(p_config);
+
+    for (unsigned int threads = 1; threads <= p_config->threads; threads *= 2) {
+        bench_shared<traits, typename traits::mutex_t>(p_config, "mutex", threads);
+        bench_shared<traits, typename traits::spinlock_t>(p_config, "spinlock", threads);
+        bench_shared_std<traits>(p_config, threads);
+    }
+}
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_OPS, DEFAULT_THREADS, 1, NULL, NULL, DEFAULT_TOLERANCE};
+    std::vector<size_t> indexes;
+    uint64_t state = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    state = config.seed;
+    indexes.resize(config.ops);
+    for (size_t op = 0; op < config.ops; op++) {
+        indexes[op] = (size_t)(bench_next_random(&state) % config.ops);
+    }
+
+    bench_type<int_traits>(&config, indexes);
+    bench_type<double_traits>(&config, indexes);
+    bench_type<char_traits>(&config, indexes);
+    bench_type<uint8_t_traits>(&config, indexes);
+    bench_type<uint16_t_traits>(&config, indexes);
+    bench_type<uint32_t_traits>(&config, indexes);
+    bench_type<uint64_t_traits>(&config, indexes);
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    if((config.p_baseline != NULL) && compare_baseline(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->ops == 0) || (p_config->threads == 0) || (p_config->threads > MAX_THREADS) ||
+       (p_config->ops < p_config->threads) || (p_config->tolerance < 0.0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a timed measurement.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] p_type Name of the data type.
+ * @param[in] p_op Name of the operation.
+ * @param[in] threads Number of threads.
+ * @param[in] ops Number of timed operations, across all threads.
+ * @param[in] total_ns Wall time of all operations.
+ */
+static void add_result(const char *p_kind, const char *p_type, const char *p_op, unsigned int threads, size_t ops, uint64_t total_ns) {
+
+    bench_result_t result = {p_kind, p_type, p_op, threads, ops, (total_ns == 0) ? 1 : total_ns, 0, 0, 0};
+
+    s_results.push_back(result);
+}
+
+/**
+ * @brief Record the growth of a vector while ops values were pushed.
+ *
+ * @param[in] p_kind Name of the vector kind.
+ * @param[in] p_type Name of the data type.
+ * @param[in] ops Number of values pushed.
+ * @param[in] total_ns Wall time of the pushes.
+ * @param[in] reallocs Number of times the capacity changed.
+ * @param[in] moves Number of those that moved the values.
+ * @param[in] capacity Capacity after the last push.
+ */
+static void add_growth(const char *p_kind, const char *p_type, size_t ops, uint64_t total_ns, size_t reallocs, size_t moves, size_t capacity) {
+
+    add_result(p_kind, p_type, "growth", 1, ops, total_ns);
+    s_results.back().reallocs = reallocs;
+    s_results.back().moves = moves;
+    s_results.back().capacity = capacity;
+}
+
+/**
+ * @brief Print every result as JSON, one result per line.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_std");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"ops\": %zu, \"threads\": %u, \"seed\": %llu", p_config->ops, p_config->threads,
+            (unsigned long long)p_config->seed);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_results.size(); result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"kind\": \"%s\", \"type\": \"%s\", \"op\": \"%s\", \"threads\": %u, \"ops\": %zu, \"total_ns\": %llu, \"ns_per_op\": %.4f",
+                p_result->kind.c_str(), p_result->type.c_str(), p_result->op.c_str(), p_result->threads, p_result->ops,
+                (unsigned long long)p_result->total_ns, (double)p_result->total_ns / (double)p_result->ops);
+        if(p_result->op == "growth") {
+            fprintf(p_out, ", \"reallocs\": %zu, \"moves\": %zu, \"capacity\": %zu", p_result->reallocs, p_result->moves, p_result->capacity);
+        }
+        fprintf(p_out, "}%s\n", (result+1 < s_results.size()) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
+
+/**
+ * @brief Compare the results with the JSON of an earlier run, matching them on kind, type, op and threads.
+ * Baseline rows without a result and results without a baseline row are reported on stderr and skipped.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 if no result is more than the tolerance slower than its baseline, -1 otherwise, if the
+ * baseline cannot be read or if no result matched it.
+ */
+static int compare_baseline(const bench_config_t *p_config) {
+
+    FILE *p_file = fopen(p_config->p_baseline, "r");
+    char line[512];
+    std::vector<char> matched(s_results.size(), 0);
+    size_t compared = 0;
+    size_t regressions = 0;
+    size_t unmatched = 0;
+
+    if(p_file == NULL) {
+        perror(p_config->p_baseline);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), p_file) != NULL) {
+        char kind[64];
+        char type[32];
+        char op[32];
+        unsigned int threads = 0;
+        double ns_per_op = 0.0;
+
+        if(sscanf(line, " {\"kind\": \"%63[^\"]\", \"type\": \"%31[^\"]\", \"op\": \"%31[^\"]\", \"threads\": %u, \"ops\": %*u, \"total_ns\": %*u, \"ns_per_op\": %lf",
+                  kind, type, op, &threads, &ns_per_op) != 5) {
+            continue;
+        }
+        size_t result = 0;
+
+        while ((result < s_results.size()) &&
+               ((s_results[result].kind != kind) || (s_results[result].type != type) || (s_results[result].op != op) ||
+                (s_results[result].threads != threads))) {
+            result++;
+        }
+        if(result == s_results.size()) {
+            fprintf(stderr, "unmatched: %s %s %s threads %u: in the baseline only\n", kind, type, op, threads);
+            unmatched++;
+            continue;
+        }
+
+        double current = (double)s_results[result].total_ns / (double)s_results[result].ops;
+
+        matched[result] = 1;
+        compared++;
+        if(current > ns_per_op * (1.0 + p_config->tolerance / 100.0)) {
+            fprintf(stderr, "regression: %s %s %s threads %u: %.3f ns/op, baseline %.3f ns/op\n",
+                    kind, type, op, threads, current, ns_per_op);
+            regressions++;
+        }
+    }
+    fclose(p_file);
+
+    for (size_t result = 0; result < s_results.size(); result++) {
+        if(!matched[result]) {
+            fprintf(stderr, "unmatched: %s %s %s threads %u: not in the baseline\n", s_results[result].kind.c_str(),
+                    s_results[result].type.c_str(), s_results[result].op.c_str(), s_results[result].threads);
+            unmatched++;
+        }
+    }
+
+    fprintf(stderr, "baseline: %zu results compared, %zu regressions over %.1f%%, %zu unmatched\n", compared, regressions,
+            p_config->tolerance, unmatched);
+    if(compared == 0) {
+        fprintf(stderr, "baseline: no result matched %s\n", p_config->p_baseline);
+        return -1;
+    }
+
+    return (regressions == 0) ? 0 : -1;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file vector_sum_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark of the virtual table against the inline direct-call vector functions.
+ *
+ * Fills vector_int_t (MUTEX) and vector_int_nolock_t (NOLOCK) with vptr->push, push_fast and one
+ * append_array, then sums them with vptr->get, get_fast and the unchecked at. Results are printed as
+ * JSON on stdout (or to --output).
+ *
+ * Usage: vector_sum_bench [--elements N] [--repeat N] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "vector_wip.h"
+#include "bench_common.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of elements in the summed vector. */
+#define DEFAULT_ELEMENTS        (1000000)
+/** definition for the default number of passes over the vector per sum measurement. */
+#define DEFAULT_REPEAT          (20)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (32)
+/** definition for the capacity every timed vector starts with. */
+#define INITIAL_CAPACITY        (16)
+
+/** Macro to generate the measurements of one vector type. */
+#define BENCH_VECTOR_FUNCS(name) \
+    static int bench_##name(const bench_config_t *p_config, const char *p_vector_name) { \
+        vector_##name##_t *p_vtable_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        vector_##name##_t *p_fast_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        vector_##name##_t *p_bulk_vector = vector_##name##_create(INITIAL_CAPACITY); \
+        int64_t sums[3] = {0}; \
+        int value = 0; \
+        uint64_t start_ns = 0; \
+        size_t size = p_config->elements; \
+        if ((p_vtable_vector == NULL) || (p_fast_vector == NULL) || (p_bulk_vector == NULL)) { \
+            vector_##name##_destroy(p_vtable_vector); \
+            vector_##name##_destroy(p_fast_vector); \
+            vector_##name##_destroy(p_bulk_vector); \
+            return -1; \
+        } \
+        /* fill */ \
+        start_ns = bench_now_ns(); \
+        for (size_t index = 0; index < size; index++) { \
+            p_vtable_vector->vptr->push(p_vtable_vector, index); \
+        } \
+        add_result(p_vector_name, "push_vtable", p_config->elements, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (size_t index = 0; index < size; index++) { \
+            vector_##name##_push_fast(p_fast_vector, index); \
+        } \
+        add_result(p_vector_name, "push_fast", p_config->elements, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        p_bulk_vector->vptr->append_array(p_bulk_vector, p_fast_vector->data, size); \
+        add_result(p_vector_name, "append_array", p_config->elements, bench_now_ns() - start_ns); \
+        /* sum */ \
+        start_ns = bench_now_ns(); \
+        for (size_t pass = 0; pass < p_config->repeat; pass++) { \
+            for (size_t index = 0; index < size; index++) { \
+                p_vtable_vector->vptr->get(p_vtable_vector, index, &value); \
+                sums[0] += value; \
+            } \
+        } \
+        add_result(p_vector_name, "sum_vtable_get", p_config->elements * p_config->repeat, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (size_t pass = 0; pass < p_config->repeat; pass++) { \
+            for (size_t index = 0; index < size; index++) { \
+                vector_##name##_get_fast(p_fast_vector, index, &value); \
+                sums[1] += value; \
+            } \
+        } \
+        add_result(p_vector_name, "sum_get_fast", p_config->elements * p_config->repeat, bench_now_ns() - start_ns); \
+        start_ns = bench_now_ns(); \
+        for (size_t pass = 0; pass < p_config->repeat; pass++) { \
+            for (size_t index = 0; index < vector_##name##_size(p_fast_vector); index++) { \
+                sums[2] += vector_##name##_at(p_fast_vector, index); \
+            } \
+        } \
+        add_result(p_vector_name, "sum_at", p_config->elements * p_config->repeat, bench_now_ns() - start_ns); \
+        vector_##name##_destroy(p_vtable_vector); \
+        vector_##name##_destroy(p_fast_vector); \
+        vector_##name##_destroy(p_bulk_vector); \
+        /* Every way of summing has to agree, otherwise the numbers mean nothing. */ \
+        return ((sums[0] == sums[1]) && (sums[1] == sums[2])) ? 0 : -1; \
+    }
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t elements;                    /**< Number of elements in the summed vector. */
+    size_t repeat;                      /**< Number of passes over the vector per sum measurement. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing result of one measurement.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_vector_name;          /**< Name of the vector type. */
+    const char *p_name;                 /**< Name of the measurement. */
+    size_t elements;                    /**< Number of elements pushed or summed. */
+    uint64_t total_ns;                  /**< Wall time of the measurement. */
+} bench_result_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Command line options of the benchmark. */
+static const bench_option_t s_options[] = {
+    BENCH_OPTION("--elements", "N", BENCH_OPTION_SIZE, bench_config_t, elements),
+    BENCH_OPTION("--repeat", "N", BENCH_OPTION_SIZE, bench_config_t, repeat),
+    BENCH_OPTION("--output", "FILE", BENCH_OPTION_STRING, bench_config_t, p_output)
+};
+
+/** Results of every measurement, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static void add_result(const char *p_vector_name, const char *p_name, size_t elements, uint64_t total_ns);
+static int print_json(const bench_config_t *p_config);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+BENCH_VECTOR_FUNCS(int)
+BENCH_VECTOR_FUNCS(int_nolock)
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_ELEMENTS, DEFAULT_REPEAT, NULL};
+
+    if(parse_arguments(argc, argv, &config)) {
+        bench_print_usage(argv[0], s_options, BENCH_NUMBER_OF_OPTIONS(s_options));
+        return EXIT_FAILURE;
+    }
+
+    if(bench_int(&config, "vector_int_t") || bench_int_nolock(&config, "vector_int_nolock_t")) {
+        fprintf(stderr, "sums differ or out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    if(print_json(&config)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse the command line into the benchmark configuration.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param[out] p_config Configuration to fill in. Options that are not given keep their value.
+ * @return 0 on success, -1 on an unknown option or a missing value.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    if(bench_parse_options(argc, argv, s_options, BENCH_NUMBER_OF_OPTIONS(s_options), p_config)) {
+        return -1;
+    }
+
+    if((p_config->elements == 0) || (p_config->elements > INT32_MAX) || (p_config->repeat == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Record the result of a measurement.
+ *
+ * @param[in] p_vector_name Name of the vector type.
+ * @param[in] p_name Name of the measurement.
+ * @param[in] elements Number of elements pushed or summed.
+ * @param[in] total_ns Wall time of the measurement.
+ */
+static void add_result(const char *p_vector_name, const char *p_name, size_t elements, uint64_t total_ns) {
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+
+    s_results[s_number_of_results].p_vector_name = p_vector_name;
+    s_results[s_number_of_results].p_name = p_name;
+    s_results[s_number_of_results].elements = elements;
+    s_results[s_number_of_results].total_ns = (total_ns == 0) ? 1 : total_ns;
+    s_number_of_results++;
+}
+
+/**
+ * @brief Print every result as JSON.
+ *
+ * @param[in] p_config Configuration the benchmark ran with.
+ * @return 0 on success, -1 if the output cannot be written.
+ */
+static int print_json(const bench_config_t *p_config) {
+
+    FILE *p_out = bench_json_open(p_config->p_output, "vector_sum");
+
+    if(p_out == NULL) {
+        return -1;
+    }
+    fprintf(p_out, "\"elements\": %zu, \"repeat\": %zu", p_config->elements, p_config->repeat);
+    bench_json_results(p_out);
+    for (size_t result = 0; result < s_number_of_results; result++) {
+        const bench_result_t *p_result = &s_results[result];
+
+        fprintf(p_out, "    {\"vector\": \"%s\", \"op\": \"%s\", \"elements\": %zu, \"total_ns\": %llu, \"ns_per_element\": %.3f, \"gb_per_sec\": %.3f}%s\n",
+                p_result->p_vector_name, p_result->p_name, p_result->elements, (unsigned long long)p_result->total_ns,
+                (double)p_result->total_ns / (double)p_result->elements,
+                (double)p_result->elements * sizeof(int) / (double)p_result->total_ns,
+                (result+1 < s_number_of_results) ? "," : "");
+    }
+
+    return bench_json_close(p_out);
+}
@@ -0,0 +1,702 @@
+/**
+* @file vector_allocator.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Allocator interface for the vectors, with a bump pointer arena, a size class pool and an mmap allocator.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+/* If Linux, mremap needs _GNU_SOURCE before any include */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+#include "vector_allocator.h" /* Used to expose the allocator API. */
+#include <stdint.h> /* Used for SIZE_MAX */
+#include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memcpy */
+
+/* If Linux */
+#ifdef __linux__
+    #include <sys/mman.h> /* Used for mmap, mremap, madvise and munmap */
+    #include <unistd.h> /* Used for sysconf */
+    #define VECTOR_MMAP_AVAILABLE (1)
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the default size of the arena chunks. */
+#define DEFAULT_CHUNK_SIZE      (64 * 1024)
+/** definition for the size of the pool slabs. */
+#define POOL_SLAB_SIZE          (64 * 1024)
+/** definition for log2 of the smallest pool size class. */
+#define POOL_MIN_CLASS_BITS     (4)
+/** definition for log2 of the biggest pool size class. */
+#define POOL_MAX_CLASS_BITS     (12)
+/** definition for the number of pool size classes, 16 bytes up to 4 KiB. */
+#define POOL_CLASSES            (POOL_MAX_CLASS_BITS - POOL_MIN_CLASS_BITS + 1)
+/** definition for the biggest block the pool keeps, bigger ones go to malloc. */
+#define POOL_MAX_BLOCK          ((size_t)1 << POOL_MAX_CLASS_BITS)
+
+/** definition for the bytes in front of every mmap block, they hold its mapped length and keep the data cache line aligned. */
+#define MMAP_HEADER_SIZE        (64)
+/** definition for the huge page size the mappings grow in when huge pages are asked for. */
+#define MMAP_HUGE_PAGE_SIZE     ((size_t)2 * 1024 * 1024)
+
+/** Round size up to the allocator alignment. The caller checks it cannot overflow. */
+#define ALIGN_UP(size) (((size) + (VECTOR_ALLOCATOR_ALIGNMENT - 1)) & ~(size_t)(VECTOR_ALLOCATOR_ALIGNMENT - 1))
+
+/** Address of the first byte of a chunk after its header. */
+#define CHUNK_DATA(p_chunk) ((unsigned char *)(p_chunk) + ALIGN_UP(sizeof(chunk_t)))
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/**
+ * @brief Chunk of memory that blocks are carved from in order. The data follows the header.
+ *
+ */
+typedef struct _chunk {
+    struct _chunk *p_next;      /**< Next chunk of the list, NULL for the last */
+    size_t size;                /**< Number of data bytes */
+} chunk_t;
+
+/**
+ * @brief List of chunks with a bump pointer into it. Rewinding keeps the chunks and starts over at the first.
+ *
+ */
+typedef struct _chunk_list {
+    chunk_t *p_first;           /**< First chunk, NULL until the first block */
+    chunk_t *p_last;            /**< Last chunk, new chunks are appended after it */
+    chunk_t *p_current;         /**< Chunk blocks are carved from */
+    size_t offset;              /**< Bytes of the current chunk carved already */
+    size_t chunk_size;          /**< Data size of new chunks, bigger blocks get a chunk of their own size */
+} chunk_list_t;
+
+/**
+ * @brief Bump pointer arena.
+ *
+ */
+struct _vector_arena {
+    vector_allocator_t allocator;   /**< Allocator interface, its context is the arena */
+    chunk_list_t chunks;            /**< Chunks the blocks are carved from */
+    unsigned char *p_last_block;    /**< Last block handed out, the only one free and realloc work in place on */
+    size_t last_block_size;         /**< Aligned size of the last block */
+    size_t used;                    /**< Bytes handed out since the arena was created or reset */
+};
+
+/**
+ * @brief Free pooled block, linked through its first bytes.
+ *
+ */
+typedef struct _pool_block {
+    struct _pool_block *p_next;     /**< Next free block of the same size class */
+} pool_block_t;
+
+/**
+ * @brief Size class pool.
+ *
+ */
+struct _vector_pool {
+    vector_allocator_t allocator;           /**< Allocator interface, its context is the pool */
+    chunk_list_t slabs;                     /**< Slabs new blocks are carved from */
+    pool_block_t *p_free[POOL_CLASSES];     /**< Free list per size class */
+};
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/** Flags of the huge page mmap allocator, its context. The plain one has a NULL context. */
+static unsigned int s_mmap_huge_pages_flags = VECTOR_MMAP_HUGE_PAGES;
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static void *default_alloc(void *p_context, size_t size);
+#ifdef VECTOR_MMAP_AVAILABLE
+static size_t mmap_granularity(const void *p_context);
+static void *mmap_alloc(void *p_context, size_t size);
+static void *mmap_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void mmap_free(void *p_context, void *p_block, size_t size);
+#endif
+static void *default_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void default_free(void *p_context, void *p_block, size_t size);
+static void *chunk_list_carve(chunk_list_t *p_list, size_t size);
+static void chunk_list_rewind(chunk_list_t *p_list);
+static void chunk_list_destroy(chunk_list_t *p_list);
+static void *arena_alloc(void *p_context, size_t size);
+static void *arena_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void arena_free(void *p_context, void *p_block, size_t size);
+static unsigned int pool_class(size_t size);
+static void *pool_alloc(void *p_context, size_t size);
+static void *pool_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void pool_free(void *p_context, void *p_block, size_t size);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/** The malloc, realloc and free allocator. */
+static const vector_allocator_t s_default_allocator = {
+    .alloc = default_alloc,
+    .realloc = default_realloc,
+    .free = default_free,
+    .p_context = NULL,
+};
+
+#ifdef VECTOR_MMAP_AVAILABLE
+/** The mmap allocator, with and without huge pages. */
+static const vector_allocator_t s_mmap_allocators[2] = {
+    {.alloc = mmap_alloc, .realloc = mmap_realloc, .free = mmap_free, .p_context = NULL},
+    {.alloc = mmap_alloc, .realloc = mmap_realloc, .free = mmap_free, .p_context = &s_mmap_huge_pages_flags},
+};
+#endif
+
+const vector_allocator_t *vector_allocator_default(void) {
+
+    return &s_default_allocator;
+}
+
+const vector_allocator_t *vector_allocator_mmap(unsigned int flags) {
+
+#ifdef VECTOR_MMAP_AVAILABLE
+    return &s_mmap_allocators[(flags & VECTOR_MMAP_HUGE_PAGES) ? 1 : 0];
+#else
+    (void)flags;
+    (void)s_mmap_huge_pages_flags;
+    return &s_default_allocator;
+#endif
+}
+
+vector_arena_t *vector_arena_create(size_t chunk_size) {
+
+    vector_arena_t *p_arena = (vector_arena_t *)calloc(1, sizeof(vector_arena_t));
+
+    if(p_arena == NULL) {
+        return NULL;
+    }
+
+    p_arena->allocator.alloc = arena_alloc;
+    p_arena->allocator.realloc = arena_realloc;
+    p_arena->allocator.free = arena_free;
+    p_arena->allocator.p_context = p_arena;
+    p_arena->chunks.chunk_size = (chunk_size == 0) ? DEFAULT_CHUNK_SIZE : ALIGN_UP(chunk_size);
+
+    return p_arena;
+}
+
+void vector_arena_reset(vector_arena_t *p_arena) {
+
+    if(p_arena == NULL) {
+        return;
+    }
+
+    chunk_list_rewind(&p_arena->chunks);
+    p_arena->p_last_block = NULL;
+    p_arena->last_block_size = 0;
+    p_arena->used = 0;
+}
+
+void vector_arena_destroy(vector_arena_t *p_arena) {
+
+    if(p_arena == NULL) {
+        return;
+    }
+
+    chunk_list_destroy(&p_arena->chunks);
+    free(p_arena);
+}
+
+const vector_allocator_t *vector_arena_allocator(vector_arena_t *p_arena) {
+
+    return (p_arena == NULL) ? NULL : &p_arena->allocator;
+}
+
+size_t vector_arena_used(const vector_arena_t *p_arena) {
+
+    return (p_arena == NULL) ? 0 : p_arena->used;
+}
+
+vector_pool_t *vector_pool_create(void) {
+
+    vector_pool_t *p_pool = (vector_pool_t *)calloc(1, sizeof(vector_pool_t));
+
+    if(p_pool == NULL) {
+        return NULL;
+    }
+
+    p_pool->allocator.alloc = pool_alloc;
+    p_pool->allocator.realloc = pool_realloc;
+    p_pool->allocator.free = pool_free;
+    p_pool->allocator.p_context = p_pool;
+    p_pool->slabs.chunk_size = POOL_SLAB_SIZE;
+
+    return p_pool;
+}
+
+void vector_pool_reset(vector_pool_t *p_pool) {
+
+    if(p_pool == NULL) {
+        return;
+    }
+
+    chunk_list_rewind(&p_pool->slabs);
+    memset(p_pool->p_free, 0, sizeof(p_pool->p_free));
+}
+
+void vector_pool_destroy(vector_pool_t *p_pool) {
+
+    if(p_pool == NULL) {
+        return;
+    }
+
+    chunk_list_destroy(&p_pool->slabs);
+    free(p_pool);
+}
+
+const vector_allocator_t *vector_pool_allocator(vector_pool_t *p_pool) {
+
+    return (p_pool == NULL) ? NULL : &p_pool->allocator;
+}
+
+/**
+ * @brief malloc for the default allocator.
+ *
+ * @param p_context Unused.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *default_alloc(void *p_context, size_t size) {
+
+    (void)p_context;
+
+    return malloc(size);
+}
+
+/**
+ * @brief realloc for the default allocator.
+ *
+ * @param p_context Unused.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Unused.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *default_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    (void)p_context;
+    (void)old_size;
+
+    return realloc(p_block, new_size);
+}
+
+/**
+ * @brief free for the default allocator.
+ *
+ * @param p_context Unused.
+ * @param p_block The block.
+ * @param size Unused.
+ */
+static void default_free(void *p_context, void *p_block, size_t size) {
+
+    (void)p_context;
+    (void)size;
+
+    free(p_block);
+}
+
+#ifdef VECTOR_MMAP_AVAILABLE
+/**
+ * @brief Helper function to get the step the mappings of an mmap allocator grow in.
+ *
+ * @param p_context Context of the allocator, its flags or NULL.
+ * @return size_t The page size, or the huge page size when huge pages are asked for.
+ */
+static size_t mmap_granularity(const void *p_context) {
+
+    long page_size = 0;
+
+    if((p_context != NULL) && (*(const unsigned int *)p_context & VECTOR_MMAP_HUGE_PAGES)) {
+        return MMAP_HUGE_PAGE_SIZE;
+    }
+    page_size = sysconf(_SC_PAGESIZE);
+
+    return (page_size > 0) ? (size_t)page_size : 4096;
+}
+
+/**
+ * @brief alloc of the mmap allocator. The block gets an anonymous mapping of its own, with the mapped length
+ * stored in front of it.
+ *
+ * @param p_context Flags of the allocator, or NULL.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *mmap_alloc(void *p_context, size_t size) {
+
+    size_t granularity = mmap_granularity(p_context);
+    size_t length = 0;
+    unsigned char *p_mapping = NULL;
+
+    if(size > SIZE_MAX - MMAP_HEADER_SIZE - granularity) {
+        return NULL;
+    }
+    length = (size + MMAP_HEADER_SIZE + granularity - 1) / granularity * granularity;
+
+    p_mapping = (unsigned char *)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(p_mapping == MAP_FAILED) {
+        return NULL;
+    }
+    if(granularity == MMAP_HUGE_PAGE_SIZE) {
+        /* Only a hint, the mapping works the same without huge pages. */
+        madvise(p_mapping, length, MADV_HUGEPAGE);
+    }
+    *(size_t *)p_mapping = length;
+
+    return p_mapping + MMAP_HEADER_SIZE;
+}
+
+/**
+ * @brief realloc of the mmap allocator. Growing past the mapping moves its pages with mremap instead of copying
+ * them, shrinking releases the pages past the new size but keeps the address space.
+ *
+ * @param p_context Flags of the allocator, or NULL.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Unused, the mapped length is stored in front of the block.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *mmap_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    size_t granularity = mmap_granularity(p_context);
+    unsigned char *p_mapping = NULL;
+    size_t mapped = 0;
+    size_t length = 0;
+
+    (void)old_size;
+
+    if(p_block == NULL) {
+        return mmap_alloc(p_context, new_size);
+    }
+    if(new_size > SIZE_MAX - MMAP_HEADER_SIZE - granularity) {
+        return NULL;
+    }
+    p_mapping = (unsigned char *)p_block - MMAP_HEADER_SIZE;
+    mapped = *(size_t *)p_mapping;
+    length = (new_size + MMAP_HEADER_SIZE + granularity - 1) / granularity * granularity;
+
+    if(length < mapped) {
+        madvise(p_mapping + length, mapped - length, MADV_DONTNEED);
+        return p_block;
+    }
+    if(length == mapped) {
+        return p_block;
+    }
+
+    p_mapping = (unsigned char *)mremap(p_mapping, mapped, length, MREMAP_MAYMOVE);
+    if(p_mapping == MAP_FAILED) {
+        return NULL;
+    }
+    if(granularity == MMAP_HUGE_PAGE_SIZE) {
+        madvise(p_mapping, length, MADV_HUGEPAGE);
+    }
+    *(size_t *)p_mapping = length;
+
+    return p_mapping + MMAP_HEADER_SIZE;
+}
+
+/**
+ * @brief free of the mmap allocator.
+ *
+ * @param p_context Unused.
+ * @param p_block The block.
+ * @param size Unused, the mapped length is stored in front of the block.
+ */
+static void mmap_free(void *p_context, void *p_block, size_t size) {
+
+    unsigned char *p_mapping = NULL;
+
+    (void)p_context;
+    (void)size;
+
+    if(p_block == NULL) {
+        return;
+    }
+    p_mapping = (unsigned char *)p_block - MMAP_HEADER_SIZE;
+    munmap(p_mapping, *(size_t *)p_mapping);
+}
+#endif
+
+/**
+ * @brief Helper function to carve a block from a chunk list. When the current chunk is full, the following
+ * chunks are tried in order before a new one is appended, so a rewound list reuses its chunks.
+ *
+ * @param p_list The chunk list.
+ * @param size Aligned number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *chunk_list_carve(chunk_list_t *p_list, size_t size) {
+
+    unsigned char *p_block = NULL;
+    chunk_t *p_chunk = NULL;
+
+    if((p_list->p_current != NULL) && (size <= p_list->p_current->size - p_list->offset)) {
+        p_block = CHUNK_DATA(p_list->p_current) + p_list->offset;
+        p_list->offset += size;
+        return p_block;
+    }
+
+    /* The rest of the current chunk is left unused until the list is rewound. */
+    for (p_chunk = (p_list->p_current != NULL) ? p_list->p_current->p_next : p_list->p_first; p_chunk != NULL; p_chunk = p_chunk->p_next) {
+        if(size <= p_chunk->size) {
+            p_list->p_current = p_chunk;
+            p_list->offset = size;
+            return CHUNK_DATA(p_chunk);
+        }
+    }
+
+    p_chunk = (chunk_t *)malloc(ALIGN_UP(sizeof(chunk_t)) + ((size > p_list->chunk_size) ? size : p_list->chunk_size));
+    if(p_chunk == NULL) {
+        return NULL;
+    }
+    p_chunk->p_next = NULL;
+    p_chunk->size = (size > p_list->chunk_size) ? size : p_list->chunk_size;
+    if(p_list->p_last == NULL) {
+        p_list->p_first = p_chunk;
+    }
+    else {
+        p_list->p_last->p_next = p_chunk;
+    }
+    p_list->p_last = p_chunk;
+    p_list->p_current = p_chunk;
+    p_list->offset = size;
+
+    return CHUNK_DATA(p_chunk);
+}
+
+/**
+ * @brief Helper function to make every chunk of a list free again, without releasing them.
+ *
+ * @param p_list The chunk list.
+ */
+static void chunk_list_rewind(chunk_list_t *p_list) {
+
+    p_list->p_current = p_list->p_first;
+    p_list->offset = 0;
+}
+
+/**
+ * @brief Helper function to release every chunk of a list.
+ *
+ * @param p_list The chunk list.
+ */
+static void chunk_list_destroy(chunk_list_t *p_list) {
+
+    chunk_t *p_chunk = p_list->p_first;
+
+    while(p_chunk != NULL) {
+        chunk_t *p_next = p_chunk->p_next;
+
+        free(p_chunk);
+        p_chunk = p_next;
+    }
+}
+
+/**
+ * @brief alloc of the arena allocator.
+ *
+ * @param p_context The arena.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *arena_alloc(void *p_context, size_t size) {
+
+    vector_arena_t *p_arena = (vector_arena_t *)p_context;
+    unsigned char *p_block = NULL;
+
+    if(size > SIZE_MAX - VECTOR_ALLOCATOR_ALIGNMENT - sizeof(chunk_t)) {
+        return NULL;
+    }
+    /* Empty blocks still take room so every block has its own address. */
+    size = (size == 0) ? VECTOR_ALLOCATOR_ALIGNMENT : ALIGN_UP(size);
+
+    if((p_block = (unsigned char *)chunk_list_carve(&p_arena->chunks, size)) == NULL) {
+        return NULL;
+    }
+    p_arena->p_last_block = p_block;
+    p_arena->last_block_size = size;
+    p_arena->used += size;
+
+    return p_block;
+}
+
+/**
+ * @brief realloc of the arena allocator. The last block grows and shrinks in place while its chunk has room,
+ * other blocks only shrink in place.
+ *
+ * @param p_context The arena.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Size the block was allocated with.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *arena_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    vector_arena_t *p_arena = (vector_arena_t *)p_context;
+    chunk_list_t *p_chunks = &p_arena->chunks;
+    unsigned char *p_new_block = NULL;
+    size_t aligned_size = 0;
+
+    if(p_block == NULL) {
+        return arena_alloc(p_context, new_size);
+    }
+    if(new_size > SIZE_MAX - VECTOR_ALLOCATOR_ALIGNMENT - sizeof(chunk_t)) {
+        return NULL;
+    }
+    aligned_size = (new_size == 0) ? VECTOR_ALLOCATOR_ALIGNMENT : ALIGN_UP(new_size);
+
+    if((unsigned char *)p_block == p_arena->p_last_block) {
+        size_t block_offset = (size_t)(p_arena->p_last_block - CHUNK_DATA(p_chunks->p_current));
+
+        if(aligned_size <= p_chunks->p_current->size - block_offset) {
+            p_chunks->offset = block_offset + aligned_size;
+            p_arena->used = p_arena->used - p_arena->last_block_size + aligned_size;
+            p_arena->last_block_size = aligned_size;
+            return p_block;
+        }
+    }
+    else if(new_size <= old_size) {
+        return p_block;
+    }
+
+    if((p_new_block = (unsigned char *)arena_alloc(p_context, new_size)) == NULL) {
+        return NULL;
+    }
+    memcpy(p_new_block, p_block, (old_size < new_size) ? old_size : new_size);
+
+    return p_new_block;
+}
+
+/**
+ * @brief free of the arena allocator. Only the last block is given back, the others wait for the reset.
+ *
+ * @param p_context The arena.
+ * @param p_block The block.
+ * @param size Unused, the arena knows the size of the last block.
+ */
+static void arena_free(void *p_context, void *p_block, size_t size) {
+
+    vector_arena_t *p_arena = (vector_arena_t *)p_context;
+
+    (void)size;
+
+    if((p_block == NULL) || ((unsigned char *)p_block != p_arena->p_last_block)) {
+        return;
+    }
+
+    p_arena->chunks.offset -= p_arena->last_block_size;
+    p_arena->used -= p_arena->last_block_size;
+    p_arena->p_last_block = NULL;
+    p_arena->last_block_size = 0;
+}
+
+/**
+ * @brief Helper function to find the size class of a pooled block.
+ *
+ * @param size Number of bytes, at most POOL_MAX_BLOCK.
+ * @return unsigned int Index of the smallest class that holds size bytes.
+ */
+static unsigned int pool_class(size_t size) {
+
+    unsigned int class_index = 0;
+
+    while(((size_t)1 << (class_index + POOL_MIN_CLASS_BITS)) < size) {
+        class_index++;
+    }
+
+    return class_index;
+}
+
+/**
+ * @brief alloc of the pool allocator.
+ *
+ * @param p_context The pool.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *pool_alloc(void *p_context, size_t size) {
+
+    vector_pool_t *p_pool = (vector_pool_t *)p_context;
+    pool_block_t *p_block = NULL;
+    unsigned int class_index = 0;
+
+    if(size > POOL_MAX_BLOCK) {
+        return malloc(size);
+    }
+
+    class_index = pool_class(size);
+    if((p_block = p_pool->p_free[class_index]) != NULL) {
+        p_pool->p_free[class_index] = p_block->p_next;
+        return p_block;
+    }
+
+    return chunk_list_carve(&p_pool->slabs, (size_t)1 << (class_index + POOL_MIN_CLASS_BITS));
+}
+
+/**
+ * @brief realloc of the pool allocator. Blocks that stay in their size class are kept.
+ *
+ * @param p_context The pool.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Size the block was allocated with.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *pool_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    void *p_new_block = NULL;
+
+    if(p_block == NULL) {
+        return pool_alloc(p_context, new_size);
+    }
+    if((old_size > POOL_MAX_BLOCK) && (new_size > POOL_MAX_BLOCK)) {
+        return realloc(p_block, new_size);
+    }
+    if((old_size <= POOL_MAX_BLOCK) && (new_size <= POOL_MAX_BLOCK) && (pool_class(old_size) == pool_class(new_size))) {
+        return p_block;
+    }
+
+    if((p_new_block = pool_alloc(p_context, new_size)) == NULL) {
+        return NULL;
+    }
+    memcpy(p_new_block, p_block, (old_size < new_size) ? old_size : new_size);
+    pool_free(p_context, p_block, old_size);
+
+    return p_new_block;
+}
+
+/**
+ * @brief free of the pool allocator. Pooled blocks go back on the free list of their size class.
+ *
+ * @param p_context The pool.
+ * @param p_block The block.
+ * @param size Size the block was allocated with.
+ */
+static void pool_free(void *p_context, void *p_block, size_t size) {
+
+    vector_pool_t *p_pool = (vector_pool_t *)p_context;
+    unsigned int class_index = 0;
+
+    if(p_block == NULL) {
+        return;
+    }
+    if(size > POOL_MAX_BLOCK) {
+        free(p_block);
+        return;
+    }
+
+    class_index = pool_class(size);
+    ((pool_block_t *)p_block)->p_next = p_pool->p_free[class_index];
+    p_pool->p_free[class_index] = (pool_block_t *)p_block;
+}
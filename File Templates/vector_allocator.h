@@ -0,0 +1,161 @@
+/**
+ * @file vector_allocator.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Allocator interface for the vectors, with a bump pointer arena, a size class pool and an mmap allocator.
+ *
+ * A vector created with an allocator gets its header and its data from it, and grows and frees through it.
+ * The arena and the pool are not thread safe, share one only between vectors used by one thread at a time.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_ALLOCATOR_H_
+#define _VECTOR_ALLOCATOR_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the alignment of every block the arena and the pool hand out. */
+#define VECTOR_ALLOCATOR_ALIGNMENT (16)
+
+/** vector_allocator_mmap flag: ask for transparent huge pages, and grow the mappings in steps of 2 MiB. */
+#define VECTOR_MMAP_HUGE_PAGES (1u << 0)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/**
+ * @brief Allocator interface. Every function gets the allocator's context, and realloc and free get the size
+ * the block was allocated or last reallocated with, so allocators do not have to store it.
+ *
+ */
+typedef struct _vector_allocator {
+    void *(*alloc)(void *p_context, size_t size);                                    /**< Allocate size bytes, NULL on fail */
+    void *(*realloc)(void *p_context, void *p_block, size_t old_size, size_t new_size); /**< Resize a block, NULL on fail and the block is kept */
+    void (*free)(void *p_context, void *p_block, size_t size);                       /**< Release a block, NULL is ignored */
+    void *p_context;                                                                 /**< Passed to every function */
+} vector_allocator_t;
+
+/** Bump pointer arena, see vector_arena_create. */
+typedef struct _vector_arena vector_arena_t;
+
+/** Size class pool, see vector_pool_create. */
+typedef struct _vector_pool vector_pool_t;
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief The allocator vectors use when they are created without one: malloc, realloc and free.
+ *
+ * @return const vector_allocator_t* The default allocator.
+ */
+const vector_allocator_t *vector_allocator_default(void);
+
+/**
+ * @brief The allocator for huge vectors. Every block is its own anonymous mapping, which grows with mremap
+ * so the values are never copied, and realloc to a smaller size gives the pages past the new size back with
+ * madvise while keeping the address space for the next growth. Pages are only committed when first written,
+ * so a reserve of billions of values only reserves address space. Falls back to the default allocator where
+ * mremap is not available.
+ *
+ * @param flags 0 or VECTOR_MMAP_HUGE_PAGES.
+ * @return const vector_allocator_t* The allocator to create vectors with.
+ */
+const vector_allocator_t *vector_allocator_mmap(unsigned int flags);
+
+/**
+ * @brief Create a bump pointer arena. Blocks are carved from chunks in order, free only gives back the last
+ * block and realloc grows the last block in place. Everything is released at once by vector_arena_reset.
+ *
+ * @param chunk_size Size of the chunks the arena allocates, 0 for the default of 64 KiB. Bigger blocks get a
+ * chunk of their own.
+ * @return vector_arena_t* Pointer to the new arena, NULL on fail.
+ */
+vector_arena_t *vector_arena_create(size_t chunk_size);
+
+/**
+ * @brief Release every block of an arena in O(1). The chunks are kept for the next blocks. Vectors in the
+ * arena must not be used afterwards, and may be dropped without destroying them when their lock policy is
+ * SPINLOCK or NOLOCK (a MUTEX may hold resources of the OS).
+ *
+ * @param p_arena The arena.
+ */
+void vector_arena_reset(vector_arena_t *p_arena);
+
+/**
+ * @brief Destroy an arena and every block in it.
+ *
+ * @param p_arena The arena, NULL is ignored.
+ */
+void vector_arena_destroy(vector_arena_t *p_arena);
+
+/**
+ * @brief Allocator interface of an arena, valid until the arena is destroyed.
+ *
+ * @param p_arena The arena.
+ * @return const vector_allocator_t* The allocator to create vectors with.
+ */
+const vector_allocator_t *vector_arena_allocator(vector_arena_t *p_arena);
+
+/**
+ * @brief Number of bytes handed out by an arena since it was created or last reset.
+ *
+ * @param p_arena The arena.
+ * @return size_t Bytes in use, including alignment padding.
+ */
+size_t vector_arena_used(const vector_arena_t *p_arena);
+
+/**
+ * @brief Create a size class pool. Blocks of up to 4 KiB are rounded up to a power of two and recycled
+ * through a free list per size, carved from 64 KiB slabs. Bigger blocks go to malloc.
+ *
+ * @return vector_pool_t* Pointer to the new pool, NULL on fail.
+ */
+vector_pool_t *vector_pool_create(void);
+
+/**
+ * @brief Release every pooled block of a pool in O(1). The slabs are kept for the next blocks. Blocks bigger
+ * than 4 KiB are not tracked and must be freed through the allocator first.
+ *
+ * @param p_pool The pool.
+ */
+void vector_pool_reset(vector_pool_t *p_pool);
+
+/**
+ * @brief Destroy a pool and every pooled block in it. Blocks bigger than 4 KiB must be freed first.
+ *
+ * @param p_pool The pool, NULL is ignored.
+ */
+void vector_pool_destroy(vector_pool_t *p_pool);
+
+/**
+ * @brief Allocator interface of a pool, valid until the pool is destroyed.
+ *
+ * @param p_pool The pool.
+ * @return const vector_allocator_t* The allocator to create vectors with.
+ */
+const vector_allocator_t *vector_pool_allocator(vector_pool_t *p_pool);
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_ALLOCATOR_H_ */
@@ -0,0 +1,85 @@
+/**
+ * @file vector_atomic.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Atomic operations shared by the lock-free containers.
+ *
+ * Loads are acquire, stores are release and read-modify-writes are sequentially consistent. Each operation
+ * is spelled per type because MSVC only has typed Interlocked functions.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_ATOMIC_H_
+#define _VECTOR_ATOMIC_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the size of a cache line, used to keep hot counters of different threads apart. */
+#ifndef VECTOR_CACHE_LINE_BYTES
+    #define VECTOR_CACHE_LINE_BYTES (64)
+#endif
+
+/* If MSVC */
+#ifdef _MSC_VER
+    #include <windows.h>
+    #define VECTOR_ATOMIC_LOAD_SIZE(p_value) ((size_t)InterlockedOr64((volatile LONG64 *)(p_value), 0))
+    #define VECTOR_ATOMIC_STORE_SIZE(p_value, value) InterlockedExchange64((volatile LONG64 *)(p_value), (LONG64)(value))
+    #define VECTOR_ATOMIC_FETCH_ADD_SIZE(p_value, amount) ((size_t)InterlockedExchangeAdd64((volatile LONG64 *)(p_value), (LONG64)(amount)))
+    #define VECTOR_ATOMIC_CAS_SIZE(p_value, expected, desired) \
+        (InterlockedCompareExchange64((volatile LONG64 *)(p_value), (LONG64)(desired), (LONG64)(expected)) == (LONG64)(expected))
+    #define VECTOR_ATOMIC_LOAD_PTR(p_pointer) InterlockedCompareExchangePointer((PVOID volatile *)(p_pointer), NULL, NULL)
+    #define VECTOR_ATOMIC_STORE_PTR(p_pointer, value) InterlockedExchangePointer((PVOID volatile *)(p_pointer), (PVOID)(value))
+    #define VECTOR_ATOMIC_EXCHANGE_PTR(p_pointer, value) InterlockedExchangePointer((PVOID volatile *)(p_pointer), (PVOID)(value))
+    #define VECTOR_ATOMIC_CAS_PTR(p_pointer, expected, desired) \
+        (InterlockedCompareExchangePointer((PVOID volatile *)(p_pointer), (PVOID)(desired), (PVOID)(expected)) == (PVOID)(expected))
+    #define VECTOR_ATOMIC_LOAD_U8(p_value) ((uint8_t)InterlockedOr8((volatile char *)(p_value), 0))
+    #define VECTOR_ATOMIC_STORE_U8(p_value, value) InterlockedExchange8((volatile char *)(p_value), (char)(value))
+    #define VECTOR_ATOMIC_FENCE() MemoryBarrier()
+#else /* If GCC or clang */
+    #define VECTOR_ATOMIC_LOAD_SIZE(p_value) __atomic_load_n((p_value), __ATOMIC_ACQUIRE)
+    #define VECTOR_ATOMIC_STORE_SIZE(p_value, value) __atomic_store_n((p_value), (value), __ATOMIC_RELEASE)
+    #define VECTOR_ATOMIC_FETCH_ADD_SIZE(p_value, amount) __atomic_fetch_add((p_value), (amount), __ATOMIC_SEQ_CST)
+    #define VECTOR_ATOMIC_CAS_SIZE(p_value, expected, desired) \
+        __extension__({ size_t vector_atomic_expected = (expected); \
+            __atomic_compare_exchange_n((p_value), &vector_atomic_expected, (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
+    #define VECTOR_ATOMIC_LOAD_PTR(p_pointer) __atomic_load_n((p_pointer), __ATOMIC_ACQUIRE)
+    #define VECTOR_ATOMIC_STORE_PTR(p_pointer, value) __atomic_store_n((p_pointer), (value), __ATOMIC_RELEASE)
+    #define VECTOR_ATOMIC_EXCHANGE_PTR(p_pointer, value) __atomic_exchange_n((p_pointer), (value), __ATOMIC_SEQ_CST)
+    #define VECTOR_ATOMIC_CAS_PTR(p_pointer, expected, desired) \
+        __extension__({ __typeof__(*(p_pointer)) vector_atomic_expected = (expected); \
+            __atomic_compare_exchange_n((p_pointer), &vector_atomic_expected, (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
+    #define VECTOR_ATOMIC_LOAD_U8(p_value) __atomic_load_n((p_value), __ATOMIC_ACQUIRE)
+    #define VECTOR_ATOMIC_STORE_U8(p_value, value) __atomic_store_n((p_value), (value), __ATOMIC_RELEASE)
+    #define VECTOR_ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_ATOMIC_H_ */
@@ -0,0 +1,653 @@
+/**
+* @file vector_bits.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Packed bit vectors with popcount, find_first_set and word-wise boolean ops.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_bits.h" /* Used to expose the bit vector API. */
+#include "vector_simd.h" /* Used for the popcount and boolean kernels. */
+#include <stdint.h> /* Used for SIZE_MAX */
+#include <string.h> /* Used for memset */
+
+/* If Windows */
+#ifdef _MSC_VER
+    #include <intrin.h> /* Used for _BitScanForward64 */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the capacity in bits an empty vector grows to on its first push. */
+#define BITS_MIN_CAPACITY       (VECTOR_BITS_PER_WORD)
+
+/** Allocate size bytes from an allocator. */
+#define BITS_ALLOC(allocator, size) ((allocator)->alloc((allocator)->p_context, (size)))
+/** Resize a block of an allocator from old_size to new_size bytes. */
+#define BITS_REALLOC(allocator, p_block, old_size, new_size) ((allocator)->realloc((allocator)->p_context, (p_block), (old_size), (new_size)))
+/** Release a block of old_size bytes to an allocator. */
+#define BITS_FREE(allocator, p_block, size) ((allocator)->free((allocator)->p_context, (p_block), (size)))
+
+/** Number of words holding bits bits. */
+#define BITS_WORDS(bits) (((bits) + VECTOR_BITS_PER_WORD - 1) / VECTOR_BITS_PER_WORD)
+/** Word holding the bit at index. */
+#define BITS_WORD(vector, index) ((vector)->words[(index) / VECTOR_BITS_PER_WORD])
+/** Mask of the bit at index within its word. */
+#define BITS_MASK(index) ((uint64_t)1 << ((index) % VECTOR_BITS_PER_WORD))
+/** Largest capacity in bits whose words still fit in a size_t of bytes. */
+#define BITS_MAX_CAPACITY ((SIZE_MAX / sizeof(uint64_t)) & ~(size_t)(VECTOR_BITS_PER_WORD - 1))
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static int vector_bits_push(vector_bits_t *vector, uint8_t value);
+static int vector_bits_pop(vector_bits_t *vector);
+static int vector_bits_get(vector_bits_t *vector, size_t index, uint8_t *out);
+static int vector_bits_set_bit(vector_bits_t *vector, size_t index);
+static int vector_bits_clear_bit(vector_bits_t *vector, size_t index);
+static int vector_bits_test_bit(vector_bits_t *vector, size_t index);
+static int vector_bits_fill(vector_bits_t *vector, size_t start, size_t count, uint8_t value);
+static int vector_bits_reserve(vector_bits_t *vector, size_t capacity);
+static int vector_bits_resize(vector_bits_t *vector, size_t size);
+static int vector_bits_clear(vector_bits_t *vector);
+static int vector_bits_popcount(vector_bits_t *vector, size_t *out);
+static int vector_bits_find_first_set(vector_bits_t *vector, size_t start, size_t *out);
+static int vector_bits_and_bits(vector_bits_t *vector, vector_bits_t *other);
+static int vector_bits_or_bits(vector_bits_t *vector, vector_bits_t *other);
+static int vector_bits_xor_bits(vector_bits_t *vector, vector_bits_t *other);
+static int vector_bits_andnot_bits(vector_bits_t *vector, vector_bits_t *other);
+static int bits_grow(vector_bits_t *vector, size_t min_capacity);
+static void bits_write_range(vector_bits_t *vector, size_t start, size_t count, uint8_t value);
+static int bits_combine(vector_bits_t *vector, vector_bits_t *other, void (*p_kernel)(uint64_t *, const uint64_t *, size_t));
+static size_t bits_lowest_set(uint64_t word);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/** Bit vector virtual table. */
+static vector_bits_vtbl_t vector_bits_vtable = {
+    .push = vector_bits_push,
+    .pop = vector_bits_pop,
+    .get = vector_bits_get,
+    .set_bit = vector_bits_set_bit,
+    .clear_bit = vector_bits_clear_bit,
+    .test_bit = vector_bits_test_bit,
+    .fill = vector_bits_fill,
+    .reserve = vector_bits_reserve,
+    .resize = vector_bits_resize,
+    .clear = vector_bits_clear,
+    .popcount = vector_bits_popcount,
+    .find_first_set = vector_bits_find_first_set,
+    .and_bits = vector_bits_and_bits,
+    .or_bits = vector_bits_or_bits,
+    .xor_bits = vector_bits_xor_bits,
+    .andnot_bits = vector_bits_andnot_bits,
+};
+
+/**
+ * @brief Create a bit vector.
+ *
+ * @param initial_capacity Number of bits to make room for.
+ * @return vector_bits_t* The vector, NULL on fail.
+ */
+vector_bits_t *vector_bits_create(size_t initial_capacity) {
+
+    return vector_bits_create_with_allocator(initial_capacity, NULL);
+}
+
+/**
+ * @brief Create a bit vector whose words come from an allocator.
+ *
+ * @param initial_capacity Number of bits to make room for.
+ * @param allocator The allocator, NULL for the default.
+ * @return vector_bits_t* The vector, NULL on fail.
+ */
+vector_bits_t *vector_bits_create_with_allocator(size_t initial_capacity, const vector_allocator_t *allocator) {
+
+    vector_bits_t *vector = NULL;
+
+    if(allocator == NULL) {
+        allocator = vector_allocator_default();
+    }
+
+    vector = (vector_bits_t *)BITS_ALLOC(allocator, sizeof(vector_bits_t));
+    if(vector == NULL) {
+        return NULL;
+    }
+    vector->vptr = &vector_bits_vtable;
+    vector->size = 0;
+    vector->capacity = 0;
+    vector->words = NULL;
+    vector->allocator = allocator;
+    if((initial_capacity > 0) && bits_grow(vector, initial_capacity)) {
+        BITS_FREE(allocator, vector, sizeof(vector_bits_t));
+        return NULL;
+    }
+    VECTOR_LOCK_INIT(MUTEX, &vector->lock);
+
+    return vector;
+}
+
+/**
+ * @brief Destroy a bit vector.
+ *
+ * @param vector The vector.
+ * @return int 0 on success, -1 on fail.
+ */
+int vector_bits_destroy(vector_bits_t *vector) {
+
+    const vector_allocator_t *allocator = NULL;
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    allocator = vector->allocator;
+    VECTOR_LOCK_DESTROY(MUTEX, &vector->lock);
+    BITS_FREE(allocator, vector->words, BITS_WORDS(vector->capacity) * sizeof(uint64_t));
+    BITS_FREE(allocator, vector, sizeof(vector_bits_t));
+
+    return 0;
+}
+
+/**
+ * @brief Push a bit to the back of the vector, doubling the capacity when it is full.
+ *
+ * @param vector The vector.
+ * @param value Nonzero pushes a 1.
+ * @return int 0 on success, -1 on fail.
+ */
+static int vector_bits_push(vector_bits_t *vector, uint8_t value) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if((vector->size >= vector->capacity) &&
+       ((vector->capacity > BITS_MAX_CAPACITY / 2) || bits_grow(vector, (vector->capacity == 0) ? BITS_MIN_CAPACITY : vector->capacity * 2))) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    if(value != 0) {
+        BITS_WORD(vector, vector->size) |= BITS_MASK(vector->size);
+    }
+    vector->size++;
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Pop the bit at the back of the vector, zeroing it so the bits past the size stay 0.
+ *
+ * @param vector The vector.
+ * @return int 0 on success, -1 if the vector is empty.
+ */
+static int vector_bits_pop(vector_bits_t *vector) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(vector->size == 0) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    vector->size--;
+    BITS_WORD(vector, vector->size) &= ~BITS_MASK(vector->size);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Get the bit at index.
+ *
+ * @param vector The vector.
+ * @param index Index of the bit.
+ * @param out Set to 0 or 1.
+ * @return int 0 on success, -1 if index is past the size.
+ */
+static int vector_bits_get(vector_bits_t *vector, size_t index, uint8_t *out) {
+
+    if((vector == NULL) || (out == NULL)) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(index >= vector->size) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    *out = vector_bits_at(vector, index);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Set the bit at index to 1.
+ *
+ * @param vector The vector.
+ * @param index Index of the bit.
+ * @return int 0 on success, -1 if index is past the size.
+ */
+static int vector_bits_set_bit(vector_bits_t *vector, size_t index) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(index >= vector->size) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    BITS_WORD(vector, index) |= BITS_MASK(index);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Set the bit at index to 0.
+ *
+ * @param vector The vector.
+ * @param index Index of the bit.
+ * @return int 0 on success, -1 if index is past the size.
+ */
+static int vector_bits_clear_bit(vector_bits_t *vector, size_t index) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(index >= vector->size) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    BITS_WORD(vector, index) &= ~BITS_MASK(index);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Test the bit at index.
+ *
+ * @param vector The vector.
+ * @param index Index of the bit.
+ * @return int 1 if the bit is set, 0 if not, -1 if index is past the size.
+ */
+static int vector_bits_test_bit(vector_bits_t *vector, size_t index) {
+
+    int rv = -1;
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(index < vector->size) {
+        rv = (int)vector_bits_at(vector, index);
+    }
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return rv;
+}
+
+/**
+ * @brief Set count bits from start to value, a word at a time between the partial first and last words.
+ *
+ * @param vector The vector.
+ * @param start Index of the first bit.
+ * @param count Number of bits.
+ * @param value Nonzero sets the bits to 1.
+ * @return int 0 on success, -1 if the range is past the size.
+ */
+static int vector_bits_fill(vector_bits_t *vector, size_t start, size_t count, uint8_t value) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if((start > vector->size) || (count > vector->size - start)) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    bits_write_range(vector, start, count, value);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Grow the capacity to at least capacity bits.
+ *
+ * @param vector The vector.
+ * @param capacity Number of bits to make room for.
+ * @return int 0 on success, -1 on fail.
+ */
+static int vector_bits_reserve(vector_bits_t *vector, size_t capacity) {
+
+    int rv = 0;
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    rv = bits_grow(vector, capacity);
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return rv;
+}
+
+/**
+ * @brief Set the size. New bits are 0, and bits cut off are zeroed so a later resize brings them back as 0.
+ *
+ * @param vector The vector.
+ * @param size Number of bits.
+ * @return int 0 on success, -1 on fail.
+ */
+static int vector_bits_resize(vector_bits_t *vector, size_t size) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(bits_grow(vector, size)) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    if(size < vector->size) {
+        bits_write_range(vector, size, vector->size - size, 0);
+    }
+    vector->size = size;
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Remove every bit, keeping the capacity.
+ *
+ * @param vector The vector.
+ * @return int 0 on success, -1 on fail.
+ */
+static int vector_bits_clear(vector_bits_t *vector) {
+
+    if(vector == NULL) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(vector->size > 0) {
+        memset(vector->words, 0, BITS_WORDS(vector->size) * sizeof(uint64_t));
+    }
+    vector->size = 0;
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Count the set bits. The bits past the size are 0, so whole words are counted.
+ *
+ * @param vector The vector.
+ * @param out Set to the number of set bits.
+ * @return int 0 on success, -1 on fail.
+ */
+static int vector_bits_popcount(vector_bits_t *vector, size_t *out) {
+
+    if((vector == NULL) || (out == NULL)) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    *out = (size_t)vector_simd_bits_popcount(vector->words, BITS_WORDS(vector->size));
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    return 0;
+}
+
+/**
+ * @brief Find the first set bit at or after start, skipping zero words.
+ *
+ * @param vector The vector.
+ * @param start Index to start at.
+ * @param out Set to the index of the bit.
+ * @return int 0 on success, -1 if no bit from start on is set.
+ */
+static int vector_bits_find_first_set(vector_bits_t *vector, size_t start, size_t *out) {
+
+    size_t words = 0;
+    size_t word = 0;
+    uint64_t bits = 0;
+
+    if((vector == NULL) || (out == NULL)) {
+        return -1;
+    }
+
+    VECTOR_LOCK(MUTEX, &vector->lock);
+    if(start >= vector->size) {
+        VECTOR_UNLOCK(MUTEX, &vector->lock);
+        return -1;
+    }
+    words = BITS_WORDS(vector->size);
+    word = start / VECTOR_BITS_PER_WORD;
+    /* Drop the bits below start from the first word. */
+    bits = vector->words[word] & (~(uint64_t)0 << (start % VECTOR_BITS_PER_WORD));
+    while((bits == 0) && (++word < words)) {
+        bits = vector->words[word];
+    }
+    VECTOR_UNLOCK(MUTEX, &vector->lock);
+
+    if(bits == 0) {
+        return -1;
+    }
+    *out = word * VECTOR_BITS_PER_WORD + bits_lowest_set(bits);
+
+    return 0;
+}
+
+/**
+ * @brief vector &= other.
+ *
+ * @param vector The vector to update.
+ * @param other The vector to combine with, of the same size.
+ * @return int 0 on success, -1 if the sizes differ.
+ */
+static int vector_bits_and_bits(vector_bits_t *vector, vector_bits_t *other) {
+
+    return bits_combine(vector, other, vector_simd_bits_and);
+}
+
+/**
+ * @brief vector |= other.
+ *
+ * @param vector The vector to update.
+ * @param other The vector to combine with, of the same size.
+ * @return int 0 on success, -1 if the sizes differ.
+ */
+static int vector_bits_or_bits(vector_bits_t *vector, vector_bits_t *other) {
+
+    return bits_combine(vector, other, vector_simd_bits_or);
+}
+
+/**
+ * @brief vector ^= other.
+ *
+ * @param vector The vector to update.
+ * @param other The vector to combine with, of the same size.
+ * @return int 0 on success, -1 if the sizes differ.
+ */
+static int vector_bits_xor_bits(vector_bits_t *vector, vector_bits_t *other) {
+
+    return bits_combine(vector, other, vector_simd_bits_xor);
+}
+
+/**
+ * @brief vector &= ~other.
+ *
+ * @param vector The vector to update.
+ * @param other The vector to combine with, of the same size.
+ * @return int 0 on success, -1 if the sizes differ.
+ */
+static int vector_bits_andnot_bits(vector_bits_t *vector, vector_bits_t *other) {
+
+    return bits_combine(vector, other, vector_simd_bits_andnot);
+}
+
+/**
+ * @brief Helper function to grow the words to hold at least min_capacity bits, zeroing the new words. The lock
+ * must be held.
+ *
+ * @param vector The vector.
+ * @param min_capacity Number of bits to make room for.
+ * @return int 0 on success, -1 on fail.
+ */
+static int bits_grow(vector_bits_t *vector, size_t min_capacity) {
+
+    size_t old_words = BITS_WORDS(vector->capacity);
+    size_t new_words = 0;
+    uint64_t *new_data = NULL;
+
+    if(min_capacity <= vector->capacity) {
+        return 0;
+    }
+    if(min_capacity > BITS_MAX_CAPACITY) {
+        return -1;
+    }
+
+    new_words = BITS_WORDS(min_capacity);
+    if(vector->words == NULL) {
+        new_data = (uint64_t *)BITS_ALLOC(vector->allocator, new_words * sizeof(uint64_t));
+    }
+    else {
+        new_data = (uint64_t *)BITS_REALLOC(vector->allocator, vector->words, old_words * sizeof(uint64_t), new_words * sizeof(uint64_t));
+    }
+    if(new_data == NULL) {
+        return -1;
+    }
+    memset(new_data + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    vector->words = new_data;
+    vector->capacity = new_words * VECTOR_BITS_PER_WORD;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to set count bits from start to value. The lock must be held and the range in the words.
+ *
+ * @param vector The vector.
+ * @param start Index of the first bit.
+ * @param count Number of bits.
+ * @param value Nonzero sets the bits to 1.
+ */
+static void bits_write_range(vector_bits_t *vector, size_t start, size_t count, uint8_t value) {
+
+    size_t end = start + count;
+    size_t first_word = start / VECTOR_BITS_PER_WORD;
+    size_t last_word = 0;
+    uint64_t first_mask = 0;
+    uint64_t last_mask = 0;
+
+    if(count == 0) {
+        return;
+    }
+
+    last_word = (end - 1) / VECTOR_BITS_PER_WORD;
+    first_mask = ~(uint64_t)0 << (start % VECTOR_BITS_PER_WORD);
+    last_mask = ~(uint64_t)0 >> ((VECTOR_BITS_PER_WORD - (end % VECTOR_BITS_PER_WORD)) % VECTOR_BITS_PER_WORD);
+    if(first_word == last_word) {
+        first_mask &= last_mask;
+    }
+
+    vector->words[first_word] = (value != 0) ? (vector->words[first_word] | first_mask) : (vector->words[first_word] & ~first_mask);
+    if(last_word > first_word) {
+        memset(&vector->words[first_word + 1], (value != 0) ? 0xff : 0, (last_word - first_word - 1) * sizeof(uint64_t));
+        vector->words[last_word] = (value != 0) ? (vector->words[last_word] | last_mask) : (vector->words[last_word] & ~last_mask);
+    }
+}
+
+/**
+ * @brief Helper function to combine the words of other into the words of vector with a boolean kernel. Both
+ * locks are taken in address order. Every kernel keeps the bits past the size 0, since they are 0 in both.
+ *
+ * @param vector The vector to update.
+ * @param other The vector to combine with, may be vector.
+ * @param p_kernel The kernel.
+ * @return int 0 on success, -1 if the sizes differ.
+ */
+static int bits_combine(vector_bits_t *vector, vector_bits_t *other, void (*p_kernel)(uint64_t *, const uint64_t *, size_t)) {
+
+    vector_bits_t *p_first = NULL;
+    vector_bits_t *p_second = NULL;
+    int rv = 0;
+
+    if((vector == NULL) || (other == NULL)) {
+        return -1;
+    }
+
+    p_first = ((uintptr_t)vector < (uintptr_t)other) ? vector : other;
+    p_second = (p_first == vector) ? other : vector;
+    VECTOR_LOCK(MUTEX, &p_first->lock);
+    if(p_second != p_first) {
+        VECTOR_LOCK(MUTEX, &p_second->lock);
+    }
+    if(vector->size != other->size) {
+        rv = -1;
+    }
+    else if(vector->size > 0) {
+        p_kernel(vector->words, other->words, BITS_WORDS(vector->size));
+    }
+    if(p_second != p_first) {
+        VECTOR_UNLOCK(MUTEX, &p_second->lock);
+    }
+    VECTOR_UNLOCK(MUTEX, &p_first->lock);
+
+    return rv;
+}
+
+/**
+ * @brief Helper function to get the index of the lowest set bit, with the bit scan instruction where there is one.
+ *
+ * @param word A nonzero word.
+ * @return size_t The index.
+ */
+static size_t bits_lowest_set(uint64_t word) {
+
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index = 0;
+
+    _BitScanForward64(&index, word);
+
+    return (size_t)index;
+#else
+    size_t index = 0;
+
+    while((word & 1u) == 0) {
+        word >>= 1;
+        index++;
+    }
+
+    return index;
+#endif
+}
@@ -0,0 +1,143 @@
+/**
+ * @file vector_bits.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Packed bit vectors, one bit per flag where vector_uint8_t_t spends a byte.
+ *
+ * vector_bits_t has the push/pop/get API of the vectors, with 0 or 1 for the values, plus set/clear/test of one
+ * bit, filling a range, popcount, find_first_set and the word-wise boolean ops AND, OR, XOR and ANDNOT of two
+ * bit vectors of the same size. The bits are kept in 64 bit words, bit i in bit i % 64 of word i / 64, and the
+ * bits of the last word past the size are always 0. popcount and the boolean ops run on the vector_simd kernels.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_BITS_H_
+#define _VECTOR_BITS_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_wip.h" /* For the lock policies */
+#include "vector_allocator.h" /* For vector_allocator_t */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the number of bits of a word. */
+#define VECTOR_BITS_PER_WORD (64)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/** Bit vector. */
+typedef struct _vector_bits vector_bits_t;
+
+/**
+ * @brief Bit vector virtual table.
+ *
+ */
+typedef struct _vector_bits_vtbl {
+    int (*const push)(vector_bits_t *vector, uint8_t value);                            /**< Push a bit to the back, 1 for any nonzero value */
+    int (*const pop)(vector_bits_t *vector);                                            /**< Pop the bit at the back */
+    int (*const get)(vector_bits_t *vector, size_t index, uint8_t *out);                /**< Get the bit at index, 0 or 1 */
+    int (*const set_bit)(vector_bits_t *vector, size_t index);                          /**< Set the bit at index to 1 */
+    int (*const clear_bit)(vector_bits_t *vector, size_t index);                        /**< Set the bit at index to 0 */
+    int (*const test_bit)(vector_bits_t *vector, size_t index);                         /**< 1 if the bit at index is set, 0 if not, -1 past the size */
+    int (*const fill)(vector_bits_t *vector, size_t start, size_t count, uint8_t value); /**< Set count bits from start to 0 or 1 */
+    int (*const reserve)(vector_bits_t *vector, size_t capacity);                       /**< Grow the capacity to at least capacity bits */
+    int (*const resize)(vector_bits_t *vector, size_t size);                            /**< Set the size, new bits are 0 */
+    int (*const clear)(vector_bits_t *vector);                                          /**< Remove every bit, keeping the capacity */
+    int (*const popcount)(vector_bits_t *vector, size_t *out);                          /**< Number of set bits */
+    int (*const find_first_set)(vector_bits_t *vector, size_t start, size_t *out);      /**< Index of the first set bit from start on, -1 if none */
+    int (*const and_bits)(vector_bits_t *vector, vector_bits_t *other);                 /**< vector &= other, same size */
+    int (*const or_bits)(vector_bits_t *vector, vector_bits_t *other);                  /**< vector |= other, same size */
+    int (*const xor_bits)(vector_bits_t *vector, vector_bits_t *other);                 /**< vector ^= other, same size */
+    int (*const andnot_bits)(vector_bits_t *vector, vector_bits_t *other);              /**< vector &= ~other, same size */
+} vector_bits_vtbl_t;
+
+/**
+ * @brief Bit vector structure.
+ *
+ */
+struct _vector_bits {
+    vector_bits_vtbl_t *vptr;               /**< Pointer to the virtual table */
+    size_t size;                            /**< Number of bits */
+    size_t capacity;                        /**< Number of bits the words have room for, a multiple of 64 */
+    uint64_t *words;                        /**< The bits */
+    const vector_allocator_t *allocator;    /**< Allocator of the vector and its words */
+    VECTOR_LOCK_TYPE(MUTEX) lock;           /**< Lock for thread safety */
+};
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Create a bit vector.
+ *
+ * @param initial_capacity Number of bits to make room for.
+ * @return vector_bits_t* The vector, NULL on fail.
+ */
+vector_bits_t *vector_bits_create(size_t initial_capacity);
+
+/**
+ * @brief Create a bit vector whose words come from an allocator.
+ *
+ * @param initial_capacity Number of bits to make room for.
+ * @param allocator The allocator, NULL for the default.
+ * @return vector_bits_t* The vector, NULL on fail.
+ */
+vector_bits_t *vector_bits_create_with_allocator(size_t initial_capacity, const vector_allocator_t *allocator);
+
+/**
+ * @brief Destroy a bit vector.
+ *
+ * @param vector The vector.
+ * @return int 0 on success, -1 on fail.
+ */
+int vector_bits_destroy(vector_bits_t *vector);
+
+/**
+ * @brief Bit at index, 0 or 1. No lock and no bounds check, index must be in [0, size).
+ *
+ * @param vector The vector.
+ * @param index Index of the bit.
+ * @return uint8_t The bit.
+ */
+static inline uint8_t vector_bits_at(const vector_bits_t *vector, size_t index) {
+    return (uint8_t)((vector->words[index / VECTOR_BITS_PER_WORD] >> (index % VECTOR_BITS_PER_WORD)) & 1u);
+}
+
+/**
+ * @brief Number of bits in the vector. No lock, so only a snapshot if other threads push or pop.
+ *
+ * @param vector The vector.
+ * @return size_t The number of bits.
+ */
+static inline size_t vector_bits_size(const vector_bits_t *vector) {
+    return vector->size;
+}
+
+/*
+The boolean ops lock both vectors, in address order, so two threads combining the same pair the other way
+around do not deadlock; a vector may be combined with itself. The words can be scanned directly through
+vector->words, (size + 63) / 64 of them, while no other thread changes the vector.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_BITS_H_ */
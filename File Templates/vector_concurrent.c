@@ -0,0 +1,233 @@
+/**
+* @file vector_concurrent.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Lock-free append-only vectors for many producer threads.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_concurrent.h" /* Used to expose the concurrent vector API. */
+#include "vector_atomic.h" /* Used for the atomic operations. */
+#include <stdlib.h> /* Used for memory allocation */
+
+/* If MSVC */
+#ifdef _MSC_VER
+    #include <intrin.h> /* Used for _BitScanReverse64 */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the number of values in the first segment. */
+#define FIRST_SEGMENT_LENGTH ((size_t)1 << VECTOR_CONCURRENT_FIRST_SEGMENT_BITS)
+
+/** Concurrent vector virtual table definition macro. */
+#define VECTOR_CONCURRENT_VTABLE_INIT(name) \
+static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .get = vector_##name##_get, \
+        .get_pointer = vector_##name##_get_pointer, \
+        .size = vector_##name##_size, \
+};
+
+/** Concurrent vector function declarations macro. */
+#define VECTOR_CONCURRENT_STATIC_FUNCTIONS_DECLARE(name, data_type) \
+    static int vector_##name##_push(vector_##name##_t *vector, data_type value, size_t *out_index); \
+    static int vector_##name##_get(vector_##name##_t *vector, size_t index, data_type *out); \
+    static data_type *vector_##name##_get_pointer(vector_##name##_t *vector, size_t index); \
+    static size_t vector_##name##_size(vector_##name##_t *vector); \
+    static data_type *vector_##name##_segment(vector_##name##_t *vector, size_t segment, int allocate);
+
+/** Macro to generate concurrent vector create function */
+#define GENERIC_VECTOR_CONCURRENT_CREATE_FUNC(name, data_type) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity) { \
+        size_t segment = 0; \
+        size_t offset = 0; \
+        vector_##name##_t *vector = (vector_##name##_t *)calloc(1, sizeof(vector_##name##_t)); \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        vector->vptr = &vector_##name##_vtable; \
+        /* Allocate up front every segment the initial capacity reaches, so the first pushes never allocate. */ \
+        if (initial_capacity > 0 && locate(initial_capacity - 1, &segment, &offset) == 0) { \
+            for (size_t idx = 0; idx <= segment; idx++) { \
+                if (vector_##name##_segment(vector, idx, 1) == NULL) { \
+                    vector_##name##_destroy(vector); \
+                    return NULL; \
+                } \
+            } \
+        } \
+        return vector; \
+    }
+
+/** Macro to generate concurrent vector destroy function */
+#define GENERIC_VECTOR_CONCURRENT_DESTROY_FUNC(name, data_type) \
+    int vector_##name##_destroy(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        for (size_t segment = 0; segment < VECTOR_CONCURRENT_MAX_SEGMENTS; segment++) { \
+            free(vector->segments[segment]); \
+        } \
+        free(vector); \
+        return 0; \
+    }
+
+/** Macro to generate the concurrent vector function that finds, and optionally allocates, a segment */
+#define GENERIC_VECTOR_CONCURRENT_SEGMENT_FUNC(name, data_type) \
+    data_type *vector_##name##_segment(vector_##name##_t *vector, size_t segment, int allocate) { \
+        size_t length = FIRST_SEGMENT_LENGTH << segment; \
+        data_type *p_segment = VECTOR_ATOMIC_LOAD_PTR(&vector->segments[segment]); \
+        data_type *p_new_segment = NULL; \
+        if (p_segment != NULL || !allocate) { \
+            return p_segment; \
+        } \
+        if (length > SIZE_MAX / (sizeof(data_type) + 1)) { \
+            return NULL; \
+        } \
+        /* The values come first and the published flags after them, zeroed so every slot starts unpublished. */ \
+        p_new_segment = (data_type *)calloc(length, sizeof(data_type) + 1); \
+        if (p_new_segment == NULL) { \
+            return NULL; \
+        } \
+        /* Threads that reach a new segment together all allocate it, the first one to install it wins. */ \
+        if (VECTOR_ATOMIC_CAS_PTR(&vector->segments[segment], NULL, p_new_segment)) { \
+            return p_new_segment; \
+        } \
+        free(p_new_segment); \
+        return VECTOR_ATOMIC_LOAD_PTR(&vector->segments[segment]); \
+    }
+
+/** Macro to generate concurrent vector push function */
+#define GENERIC_VECTOR_CONCURRENT_PUSH_FUNC(name, data_type) \
+    int vector_##name##_push(vector_##name##_t *vector, data_type value, size_t *out_index) { \
+        size_t index = 0; \
+        size_t segment = 0; \
+        size_t offset = 0; \
+        data_type *p_segment = NULL; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        index = VECTOR_ATOMIC_FETCH_ADD_SIZE(&vector->reserved, 1); \
+        if (locate(index, &segment, &offset) || (p_segment = vector_##name##_segment(vector, segment, 1)) == NULL) { \
+            return -1; \
+        } \
+        p_segment[offset] = value; \
+        VECTOR_ATOMIC_STORE_U8(&((uint8_t *)(p_segment + (FIRST_SEGMENT_LENGTH << segment)))[offset], 1); \
+        if (out_index != NULL) { \
+            *out_index = index; \
+        } \
+        return 0; \
+    }
+
+/** Macro to generate concurrent vector get pointer function */
+#define GENERIC_VECTOR_CONCURRENT_GET_POINTER_FUNC(name, data_type) \
+    data_type *vector_##name##_get_pointer(vector_##name##_t *vector, size_t index) { \
+        size_t segment = 0; \
+        size_t offset = 0; \
+        data_type *p_segment = NULL; \
+        if (vector == NULL || locate(index, &segment, &offset)) { \
+            return NULL; \
+        } \
+        p_segment = vector_##name##_segment(vector, segment, 0); \
+        if (p_segment == NULL || !VECTOR_ATOMIC_LOAD_U8(&((uint8_t *)(p_segment + (FIRST_SEGMENT_LENGTH << segment)))[offset])) { \
+            return NULL; \
+        } \
+        return &p_segment[offset]; \
+    }
+
+/** Macro to generate concurrent vector get function */
+#define GENERIC_VECTOR_CONCURRENT_GET_FUNC(name, data_type) \
+    int vector_##name##_get(vector_##name##_t *vector, size_t index, data_type *out) { \
+        data_type *p_value = NULL; \
+        if (out == NULL || (p_value = vector_##name##_get_pointer(vector, index)) == NULL) { \
+            return -1; \
+        } \
+        *out = *p_value; \
+        return 0; \
+    }
+
+/** Macro to generate concurrent vector size function */
+#define GENERIC_VECTOR_CONCURRENT_SIZE_FUNC(name, data_type) \
+    size_t vector_##name##_size(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return 0; \
+        } \
+        return VECTOR_ATOMIC_LOAD_SIZE(&vector->reserved); \
+    }
+
+/** Macro to generate the functions of vector_<data_type>_concurrent_t */
+#define GENERIC_VECTOR_CONCURRENT_FUNCTIONS(data_type) \
+    VECTOR_CONCURRENT_STATIC_FUNCTIONS_DECLARE(data_type##_concurrent, data_type) \
+    VECTOR_CONCURRENT_VTABLE_INIT(data_type##_concurrent) \
+    GENERIC_VECTOR_CONCURRENT_CREATE_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_DESTROY_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_SEGMENT_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_PUSH_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_GET_POINTER_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_GET_FUNC(data_type##_concurrent, data_type) \
+    GENERIC_VECTOR_CONCURRENT_SIZE_FUNC(data_type##_concurrent, data_type)
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static int locate(size_t index, size_t *p_segment, size_t *p_offset);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(int)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(double)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(char)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_CONCURRENT_FUNCTIONS(uint64_t)
+
+/**
+ * @brief Helper function to find the segment and the offset in it of an index.
+ *
+ * With 2^bits values in the first segment, index + 2^bits has its highest set bit at bits + segment,
+ * and the bits below that are the offset.
+ *
+ * @param index Index of the value.
+ * @param p_segment Set to the segment holding the index.
+ * @param p_offset Set to the offset of the index in its segment.
+ * @return int 0 on success, -1 if the index is beyond the last segment.
+ */
+static int locate(size_t index, size_t *p_segment, size_t *p_offset) {
+
+    uint64_t biased = (uint64_t)index + FIRST_SEGMENT_LENGTH;
+    unsigned int high_bit = 0;
+
+    if(biased < (uint64_t)index) {
+        return -1;
+    }
+
+#ifdef _MSC_VER
+    {
+        unsigned long bit = 0;
+        _BitScanReverse64(&bit, biased);
+        high_bit = (unsigned int)bit;
+    }
+#else
+    high_bit = 63u - (unsigned int)__builtin_clzll(biased);
+#endif
+
+    if(high_bit - VECTOR_CONCURRENT_FIRST_SEGMENT_BITS >= VECTOR_CONCURRENT_MAX_SEGMENTS) {
+        return -1;
+    }
+
+    *p_segment = high_bit - VECTOR_CONCURRENT_FIRST_SEGMENT_BITS;
+    *p_offset = (size_t)(biased - ((uint64_t)1 << high_bit));
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file vector_concurrent.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Lock-free append-only vectors for many producer threads.
+ *
+ * Values live in segments that double in size and are never moved, so a push never copies existing values
+ * and the address of a value stays valid until the vector is destroyed. A push reserves its slot with one
+ * atomic fetch-add and publishes the value with a per slot flag, and a get is wait-free.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_CONCURRENT_H_
+#define _VECTOR_CONCURRENT_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_atomic.h" /* For VECTOR_CACHE_LINE_BYTES */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for log2 of the number of values in the first segment. Segment k holds 2^(bits + k) values. */
+#ifndef VECTOR_CONCURRENT_FIRST_SEGMENT_BITS
+    #define VECTOR_CONCURRENT_FIRST_SEGMENT_BITS (10)
+#endif
+
+/** definition for the number of segments, enough to address every size_t index. */
+#define VECTOR_CONCURRENT_MAX_SEGMENTS (64 - VECTOR_CONCURRENT_FIRST_SEGMENT_BITS)
+
+/** Concurrent vector virtual table definition macro. */
+#define VECTOR_CONCURRENT_VTBL_T(name, data_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, data_type value, size_t *out_index);  /**< Push a value, optionally returning its index */ \
+        int (*const get)(vector_##name##_t *vector, size_t index, data_type *out);         /**< Get a published value */ \
+        data_type *(*const get_pointer)(vector_##name##_t *vector, size_t index);          /**< Stable address of a published value */ \
+        size_t (*const size)(vector_##name##_t *vector);                                   /**< Number of reserved slots */ \
+    } vector_##name##_vtbl_t;
+
+/** Concurrent vector structure definition macro. */
+#define VECTOR_CONCURRENT_T(name, data_type) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;                               /**< Pointer to the virtual table */ \
+        data_type *segments[VECTOR_CONCURRENT_MAX_SEGMENTS];        /**< Segment k holds 2^(bits + k) values followed by as many published flags, NULL until used */ \
+        char padding_before[VECTOR_CACHE_LINE_BYTES];               /**< Keeps the hot counter off the segment table's cache lines */ \
+        size_t reserved;                                            /**< Number of slots handed out, the next push gets this index */ \
+        char padding_after[VECTOR_CACHE_LINE_BYTES - sizeof(size_t)]; /**< Keeps the hot counter off whatever follows the vector */ \
+    };
+
+/** Concurrent vector public function declarations macro. */
+#define VECTOR_CONCURRENT_PUBLIC_FUNCTIONS_DECLARE(name) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity); \
+    int vector_##name##_destroy(vector_##name##_t *vector);
+
+/** Concurrent vector structure and virtual table definition macro. The type is vector_<data_type>_concurrent_t. */
+#define VECTOR_CONCURRENT_DATA_STRUCTURE(data_type) \
+    typedef struct _vector_##data_type##_concurrent vector_##data_type##_concurrent_t; \
+    VECTOR_CONCURRENT_PUBLIC_FUNCTIONS_DECLARE(data_type##_concurrent) \
+    VECTOR_CONCURRENT_VTBL_T(data_type##_concurrent, data_type) \
+    VECTOR_CONCURRENT_T(data_type##_concurrent, data_type)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+VECTOR_CONCURRENT_DATA_STRUCTURE(int)
+VECTOR_CONCURRENT_DATA_STRUCTURE(double)
+VECTOR_CONCURRENT_DATA_STRUCTURE(char)
+VECTOR_CONCURRENT_DATA_STRUCTURE(uint8_t)
+VECTOR_CONCURRENT_DATA_STRUCTURE(uint16_t)
+VECTOR_CONCURRENT_DATA_STRUCTURE(uint32_t)
+VECTOR_CONCURRENT_DATA_STRUCTURE(uint64_t)
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, e.g. with vector_uint64_t_concurrent_t *p_values = vector_uint64_t_concurrent_create(0):
+    push        - Any number of threads at once. Fails (-1) only if its segment cannot be allocated, and that
+                  slot then stays unpublished for good.
+    get         - Wait-free. Fails (-1) for an index that is not reserved yet, or reserved but not yet written.
+    get_pointer - Like get, but returns the address of the value, NULL on fail. The address stays valid until
+                  the vector is destroyed.
+    size        - Number of reserved slots. Slots that are still being written are counted, so only the values
+                  of pushes that returned before are guaranteed to be readable.
+    destroy     - Only once no other thread uses the vector.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_CONCURRENT_H_ */
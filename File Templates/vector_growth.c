@@ -0,0 +1,93 @@
+/**
+* @file vector_growth.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Growth policies of the vectors.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_growth.h" /* Used to expose the growth API. */
+#include <stddef.h> /* Used for NULL */
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/** Doubling, the policy of every new vector. */
+static const vector_growth_t s_default_growth = VECTOR_GROWTH_FACTOR(2, 1, VECTOR_GROWTH_DEFAULT_MIN_CAPACITY);
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+/**
+ * @brief Helper function to multiply a capacity by a factor without overflowing.
+ *
+ * @param capacity The capacity.
+ * @param numerator Numerator of the factor.
+ * @param denominator Denominator of the factor, not 0.
+ * @param max_capacity Value given when the product is bigger.
+ * @return size_t The product, at most max_capacity.
+ */
+static size_t growth_scale(size_t capacity, size_t numerator, size_t denominator, size_t max_capacity);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+const vector_growth_t *vector_growth_default(void) {
+
+    return &s_default_growth;
+}
+
+size_t vector_growth_next(const vector_growth_t *p_growth, size_t capacity, size_t min_capacity, size_t max_capacity) {
+
+    size_t next = 0;
+
+    if(min_capacity > max_capacity) {
+        return 0;
+    }
+    if(p_growth == NULL) {
+        p_growth = &s_default_growth;
+    }
+
+    if(p_growth->fn != NULL) {
+        next = p_growth->fn(capacity, min_capacity, p_growth->p_context);
+    }
+    else {
+        next = growth_scale(capacity, p_growth->numerator, (p_growth->denominator == 0) ? 1 : p_growth->denominator, max_capacity);
+        next = (p_growth->chunk > max_capacity - next) ? max_capacity : next + p_growth->chunk;
+    }
+
+    if(next < p_growth->min_capacity) {
+        next = p_growth->min_capacity;
+    }
+    if(next < min_capacity) {
+        next = min_capacity;
+    }
+    if(next > max_capacity) {
+        next = max_capacity;
+    }
+
+    return next;
+}
+
+static size_t growth_scale(size_t capacity, size_t numerator, size_t denominator, size_t max_capacity) {
+
+    size_t whole = capacity / denominator;
+    size_t part = capacity % denominator;
+
+    /* Split so the big part is checked before it is multiplied, the remainder times the factor stays small. */
+    if((numerator != 0) && (whole > max_capacity / numerator)) {
+        return max_capacity;
+    }
+    whole *= numerator;
+    part = part * numerator / denominator;
+
+    return (part > max_capacity - whole) ? max_capacity : whole + part;
+}
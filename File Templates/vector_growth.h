@@ -0,0 +1,119 @@
+/**
+ * @file vector_growth.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Growth policies of the vectors, which decide the capacity a full vector grows to.
+ *
+ * A policy multiplies the capacity by numerator / denominator and adds chunk, or asks a callback, and never
+ * gives less than its min_capacity or than the vector needs. Doubling reallocates log(n) times but may leave
+ * half the capacity unused, 1.5x wastes a third at most for a few more moves, and a chunk bounds the waste to
+ * the chunk for a linear number of moves, which is cheap where realloc remaps instead of copying, as for big
+ * blocks of glibc and vector_allocator_mmap. Policies are set per vector with vector_<T>_set_growth and must
+ * outlive it.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_GROWTH_H_
+#define _VECTOR_GROWTH_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include "vector_wip.h" /* For the vectors a policy is set on */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the least capacity of a growing vector under the default policy. */
+#define VECTOR_GROWTH_DEFAULT_MIN_CAPACITY (4)
+
+/** Initializer of a policy that multiplies the capacity by numerator / denominator, (3, 2) for 1.5x. */
+#define VECTOR_GROWTH_FACTOR(numerator, denominator, min_capacity) { (numerator), (denominator), 0, (min_capacity), NULL, NULL }
+
+/** Initializer of a policy that adds chunk values to the capacity. */
+#define VECTOR_GROWTH_CHUNK(chunk, min_capacity) { 1, 1, (chunk), (min_capacity), NULL, NULL }
+
+/** Initializer of a policy that asks fn for the new capacity. */
+#define VECTOR_GROWTH_CALLBACK(fn, p_context, min_capacity) { 1, 1, 0, (min_capacity), (fn), (p_context) }
+
+/**
+ * Vector growth function declarations macro. set_growth sets the policy the vector grows by from then on, NULL
+ * for vector_growth_default. The policy must outlive the vector.
+ */
+#define VECTOR_GROWTH_FUNCTIONS_DECLARE(name) \
+    int vector_##name##_set_growth(vector_##name##_t *vector, const vector_growth_t *growth);
+
+/** Vector growth function declarations macro for every lock policy of a type. */
+#define VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(data_type) \
+    VECTOR_GROWTH_FUNCTIONS_DECLARE(data_type) \
+    VECTOR_GROWTH_FUNCTIONS_DECLARE(data_type##_spinlock) \
+    VECTOR_GROWTH_FUNCTIONS_DECLARE(data_type##_nolock)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/**
+ * Function of a callback policy. Gets the capacity of the vector and the capacity it needs at least, and gives
+ * the capacity to grow to. Less than min_capacity is raised to it.
+ */
+typedef size_t (*vector_growth_fn_t)(size_t capacity, size_t min_capacity, void *p_context);
+
+/**
+ * @brief Growth policy. Without fn a full vector grows to capacity * numerator / denominator + chunk.
+ *
+ */
+typedef struct _vector_growth {
+    unsigned int numerator;             /**< Factor the capacity is multiplied by, over denominator */
+    unsigned int denominator;           /**< Divisor of the factor, 0 is taken as 1 */
+    size_t chunk;                       /**< Values added after the multiplication */
+    size_t min_capacity;                /**< Least capacity a vector grows to, so small vectors skip the first steps */
+    vector_growth_fn_t fn;              /**< Computes the new capacity instead when not NULL */
+    void *p_context;                    /**< Passed to fn */
+} vector_growth_t;
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief The policy vectors start with: doubling, from VECTOR_GROWTH_DEFAULT_MIN_CAPACITY.
+ *
+ * @return const vector_growth_t* The default policy.
+ */
+const vector_growth_t *vector_growth_default(void);
+
+/**
+ * @brief Capacity a vector grows to under a policy.
+ *
+ * @param p_growth The policy, NULL for the default.
+ * @param capacity Capacity of the vector.
+ * @param min_capacity Capacity the vector needs at least.
+ * @param max_capacity Largest capacity the vector can have.
+ * @return size_t The new capacity, in [min_capacity, max_capacity], 0 if min_capacity is above max_capacity.
+ */
+size_t vector_growth_next(const vector_growth_t *p_growth, size_t capacity, size_t min_capacity, size_t max_capacity);
+
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(int)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(double)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(char)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(uint8_t)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(uint16_t)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(uint32_t)
+VECTOR_GROWTH_FUNCTIONS_DECLARE_ALL(uint64_t)
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_GROWTH_H_ */
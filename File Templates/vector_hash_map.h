@@ -0,0 +1,529 @@
+/**
+ * @file vector_hash_map.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Open-addressing hash maps in the style of the vectors, probing a group of slots at once.
+ *
+ * HASH_MAP(key_type, value_type) generates hash_map_<key_type>_<value_type>_t, a SwissTable-style map: every slot
+ * has a control byte that is empty, deleted, or the low 7 bits of the hash of its key, and a lookup compares
+ * the control bytes of a group of HASH_MAP_GROUP_WIDTH slots with one SIMD compare (16 with SSE2, else 8 one by
+ * one), so a key is only compared where those 7 bits match. The control bytes and the key and value slots are
+ * two arrays of one allocation, so a hit reads one line of each. A map holds at most 7/8 of its capacity, which is a power of two. The *_hashed
+ * functions take the hash from the caller, who can compute it once with hash_map_<name>_hash for several calls.
+ * All functions are static inline in the header.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_HASH_MAP_H_
+#define _VECTOR_HASH_MAP_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include <string.h> /* For memcpy, memcmp and memset */
+#include "vector_wip.h" /* For the lock policies */
+#include "vector_allocator.h" /* For vector_allocator_t */
+#include "vector_atomic.h" /* For VECTOR_CACHE_LINE_BYTES */
+
+/* If SSE2 (every x86-64) */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h> /* For the SSE2 intrinsics */
+    #define HASH_MAP_SSE2 (1)
+#endif
+
+/* If Windows */
+#ifdef _MSC_VER
+    #include <intrin.h> /* For _BitScanForward */
+#endif
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the number of control bytes compared at once. */
+#ifdef HASH_MAP_SSE2
+    #define HASH_MAP_GROUP_WIDTH (16)
+#else
+    #define HASH_MAP_GROUP_WIDTH (8)
+#endif
+
+/** definition for the control byte of a slot that never held a key, it ends a probe. */
+#define HASH_MAP_CONTROL_EMPTY   ((int8_t)-128)
+/** definition for the control byte of a slot whose key was removed, a probe goes on past it. */
+#define HASH_MAP_CONTROL_DELETED ((int8_t)-2)
+
+/** Round a size in bytes up to a whole number of cache lines. */
+#define HASH_MAP_ROUND_UP(bytes) (((bytes) + VECTOR_CACHE_LINE_BYTES - 1) & ~(size_t)(VECTOR_CACHE_LINE_BYTES - 1))
+
+/** Default hash of a key up to 8 bytes, by its bits. Keys of other types pass their own hash to HASH_MAP_WITH_LOCK. */
+#define HASH_MAP_HASH_DEFAULT(key) hash_map_hash_bits(&(key), sizeof(key))
+/** Default equality of two keys, by their bits, so it agrees with HASH_MAP_HASH_DEFAULT for doubles too. */
+#define HASH_MAP_EQUAL_DEFAULT(a, b) (memcmp(&(a), &(b), sizeof(a)) == 0)
+
+/** Hash map virtual table definition macro. */
+#define HASH_MAP_VTBL_T(name, key_type, value_type) \
+    typedef struct _hash_map_##name##_vtbl { \
+        int (*const insert)(hash_map_##name##_t *map, key_type key, value_type value);          /**< Insert a key, or set its value if it is there */ \
+        int (*const get)(hash_map_##name##_t *map, key_type key, value_type *out);              /**< Get the value of a key, -1 if it is not there */ \
+        int (*const remove)(hash_map_##name##_t *map, key_type key);                            /**< Remove a key, -1 if it is not there */ \
+        int (*const contains)(hash_map_##name##_t *map, key_type key);                          /**< 1 if the key is there, else 0 */ \
+        int (*const insert_hashed)(hash_map_##name##_t *map, uint64_t hash, key_type key, value_type value); /**< insert with the hash of the key */ \
+        int (*const get_hashed)(hash_map_##name##_t *map, uint64_t hash, key_type key, value_type *out);     /**< get with the hash of the key */ \
+        int (*const reserve)(hash_map_##name##_t *map, size_t count);                           /**< Grow so count keys fit without growing again */ \
+        int (*const clear)(hash_map_##name##_t *map);                                           /**< Remove every key, keeping the capacity */ \
+    } hash_map_##name##_vtbl_t;
+
+/** Hash map slot definition macro, a key and its value side by side. */
+#define HASH_MAP_SLOT_T(name, key_type, value_type) \
+    typedef struct _hash_map_##name##_slot { \
+        key_type key;                           /**< The key */ \
+        value_type value;                       /**< Its value */ \
+    } hash_map_##name##_slot_t;
+
+/** Hash map structure definition macro. */
+#define HASH_MAP_T(name, lock_policy) \
+    struct _hash_map_##name { \
+        hash_map_##name##_vtbl_t *vptr;         /**< Pointer to the virtual table */ \
+        size_t size;                            /**< Number of keys in the map */ \
+        size_t capacity;                        /**< Number of slots, a power of two */ \
+        size_t growth_left;                     /**< Number of empty slots that can still be filled before growing */ \
+        int8_t *control;                        /**< Control byte of every slot, followed by a copy of the first group */ \
+        hash_map_##name##_slot_t *slots;        /**< Key and value of every slot */ \
+        const vector_allocator_t *allocator;    /**< Allocator of the map and its slots */ \
+        VECTOR_LOCK_TYPE(lock_policy) lock;     /**< Lock for thread safety, see the lock policies */ \
+    };
+
+/** Hash map functions macro. */
+#define HASH_MAP_FUNCS(name, key_type, value_type, hash_function, equal_function, lock_policy) \
+    /** Hash of a key, as the *_hashed functions take it. */ \
+    static inline uint64_t hash_map_##name##_hash(key_type key) { \
+        return hash_function(key); \
+    } \
+    /** Bytes of the block holding capacity slots, which start on the cache line after the control bytes. */ \
+    static inline size_t hash_map_##name##_block_bytes(size_t capacity) { \
+        return HASH_MAP_ROUND_UP(capacity + HASH_MAP_GROUP_WIDTH) + capacity * sizeof(hash_map_##name##_slot_t); \
+    } \
+    /** Set the control byte of a slot, and its copy after the end when it is in the first group. */ \
+    static inline void hash_map_##name##_set_control(hash_map_##name##_t *map, size_t index, int8_t control) { \
+        map->control[index] = control; \
+        if (index < HASH_MAP_GROUP_WIDTH) { \
+            map->control[map->capacity + index] = control; \
+        } \
+    } \
+    /** Index of the slot holding key, or capacity if it is not there. The lock must be held. */ \
+    static inline size_t hash_map_##name##_find(const hash_map_##name##_t *map, uint64_t hash, key_type key) { \
+        size_t mask = map->capacity - 1; \
+        size_t position = (size_t)(hash >> 7) & mask; \
+        int8_t tag = (int8_t)(hash & 0x7f); \
+        for (size_t step = HASH_MAP_GROUP_WIDTH; ; step += HASH_MAP_GROUP_WIDTH) { \
+            uint32_t matches = hash_map_group_match(&map->control[position], tag); \
+            while (matches != 0) { \
+                size_t index = (position + hash_map_lowest_bit(matches)) & mask; \
+                if (equal_function(map->slots[index].key, key)) { \
+                    return index; \
+                } \
+                matches &= matches - 1; \
+            } \
+            /* A key is never placed past an empty slot of its probe, so an empty slot ends the search. */ \
+            if (hash_map_group_match_empty(&map->control[position]) != 0) { \
+                return map->capacity; \
+            } \
+            position = (position + step) & mask; \
+        } \
+    } \
+    /** Index of the first empty or deleted slot on the probe of hash. There is always an empty slot. */ \
+    static inline size_t hash_map_##name##_find_free(const hash_map_##name##_t *map, uint64_t hash) { \
+        size_t mask = map->capacity - 1; \
+        size_t position = (size_t)(hash >> 7) & mask; \
+        for (size_t step = HASH_MAP_GROUP_WIDTH; ; step += HASH_MAP_GROUP_WIDTH) { \
+            uint32_t free_slots = hash_map_group_match_free(&map->control[position]); \
+            if (free_slots != 0) { \
+                return (position + hash_map_lowest_bit(free_slots)) & mask; \
+            } \
+            position = (position + step) & mask; \
+        } \
+    } \
+    /** Move every key to a new block of new_capacity slots, dropping the deleted slots. The lock must be held. */ \
+    static inline int hash_map_##name##_rehash(hash_map_##name##_t *map, size_t new_capacity) { \
+        hash_map_##name##_t old_map = *map; \
+        unsigned char *new_block = (unsigned char *)map->allocator->alloc(map->allocator->p_context, hash_map_##name##_block_bytes(new_capacity)); \
+        if (new_block == NULL) { \
+            return -1; \
+        } \
+        map->capacity = new_capacity; \
+        map->control = (int8_t *)new_block; \
+        map->slots = (hash_map_##name##_slot_t *)(void *)(new_block + HASH_MAP_ROUND_UP(new_capacity + HASH_MAP_GROUP_WIDTH)); \
+        map->growth_left = new_capacity - new_capacity / 8 - map->size; \
+        memset(map->control, HASH_MAP_CONTROL_EMPTY, new_capacity + HASH_MAP_GROUP_WIDTH); \
+        for (size_t index = 0; (old_map.control != NULL) && (index < old_map.capacity); index++) { \
+            if (old_map.control[index] >= 0) { \
+                size_t slot = hash_map_##name##_find_free(map, hash_function(old_map.slots[index].key)); \
+                hash_map_##name##_set_control(map, slot, old_map.control[index]); \
+                map->slots[slot] = old_map.slots[index]; \
+            } \
+        } \
+        if (old_map.control != NULL) { \
+            map->allocator->free(map->allocator->p_context, old_map.control, hash_map_##name##_block_bytes(old_map.capacity)); \
+        } \
+        return 0; \
+    } \
+    /** Smallest capacity that holds count keys, 0 if there is none. */ \
+    static inline size_t hash_map_##name##_capacity_for(size_t count) { \
+        size_t capacity = HASH_MAP_GROUP_WIDTH; \
+        if (count > SIZE_MAX / 4 / (sizeof(hash_map_##name##_slot_t) + 1)) { \
+            return 0; \
+        } \
+        while (capacity - capacity / 8 < count) { \
+            capacity *= 2; \
+        } \
+        return capacity; \
+    } \
+    static inline int hash_map_##name##_insert_hashed(hash_map_##name##_t *map, uint64_t hash, key_type key, value_type value) { \
+        size_t index = 0; \
+        if (map == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        index = hash_map_##name##_find(map, hash, key); \
+        if (index == map->capacity) { \
+            if (map->growth_left == 0) { \
+                /* Mostly deleted slots are cleaned up in place, else the map doubles. */ \
+                size_t new_capacity = (map->size < map->capacity / 2) ? map->capacity : hash_map_##name##_capacity_for(map->capacity); \
+                if ((new_capacity == 0) || hash_map_##name##_rehash(map, new_capacity)) { \
+                    VECTOR_UNLOCK(lock_policy, &map->lock); \
+                    return -1; \
+                } \
+            } \
+            index = hash_map_##name##_find_free(map, hash); \
+            if (map->control[index] == HASH_MAP_CONTROL_EMPTY) { \
+                map->growth_left--; \
+            } \
+            hash_map_##name##_set_control(map, index, (int8_t)(hash & 0x7f)); \
+            map->slots[index].key = key; \
+            map->size++; \
+        } \
+        map->slots[index].value = value; \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return 0; \
+    } \
+    static inline int hash_map_##name##_get_hashed(hash_map_##name##_t *map, uint64_t hash, key_type key, value_type *out) { \
+        size_t index = 0; \
+        if (map == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        index = hash_map_##name##_find(map, hash, key); \
+        if (index == map->capacity) { \
+            VECTOR_UNLOCK(lock_policy, &map->lock); \
+            return -1; \
+        } \
+        *out = map->slots[index].value; \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return 0; \
+    } \
+    static inline int hash_map_##name##_insert(hash_map_##name##_t *map, key_type key, value_type value) { \
+        return hash_map_##name##_insert_hashed(map, hash_function(key), key, value); \
+    } \
+    static inline int hash_map_##name##_get(hash_map_##name##_t *map, key_type key, value_type *out) { \
+        return hash_map_##name##_get_hashed(map, hash_function(key), key, out); \
+    } \
+    static inline int hash_map_##name##_remove(hash_map_##name##_t *map, key_type key) { \
+        size_t index = 0; \
+        if (map == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        index = hash_map_##name##_find(map, hash_function(key), key); \
+        if (index == map->capacity) { \
+            VECTOR_UNLOCK(lock_policy, &map->lock); \
+            return -1; \
+        } \
+        hash_map_##name##_set_control(map, index, HASH_MAP_CONTROL_DELETED); \
+        map->size--; \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return 0; \
+    } \
+    static inline int hash_map_##name##_contains(hash_map_##name##_t *map, key_type key) { \
+        int found = 0; \
+        if (map == NULL) { \
+            return 0; \
+        } \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        found = (hash_map_##name##_find(map, hash_function(key), key) != map->capacity); \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return found; \
+    } \
+    static inline int hash_map_##name##_reserve(hash_map_##name##_t *map, size_t count) { \
+        size_t new_capacity = 0; \
+        int rv = 0; \
+        if (map == NULL) { \
+            return -1; \
+        } \
+        new_capacity = hash_map_##name##_capacity_for(count); \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        if (new_capacity == 0) { \
+            rv = -1; \
+        } \
+        else if (new_capacity > map->capacity) { \
+            rv = hash_map_##name##_rehash(map, new_capacity); \
+        } \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return rv; \
+    } \
+    static inline int hash_map_##name##_clear(hash_map_##name##_t *map) { \
+        if (map == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        memset(map->control, HASH_MAP_CONTROL_EMPTY, map->capacity + HASH_MAP_GROUP_WIDTH); \
+        map->size = 0; \
+        map->growth_left = map->capacity - map->capacity / 8; \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return 0; \
+    } \
+    static hash_map_##name##_vtbl_t hash_map_##name##_vtable = { \
+        .insert = hash_map_##name##_insert, \
+        .get = hash_map_##name##_get, \
+        .remove = hash_map_##name##_remove, \
+        .contains = hash_map_##name##_contains, \
+        .insert_hashed = hash_map_##name##_insert_hashed, \
+        .get_hashed = hash_map_##name##_get_hashed, \
+        .reserve = hash_map_##name##_reserve, \
+        .clear = hash_map_##name##_clear, \
+    }; \
+    /** Create a map with room for initial_count keys, from allocator, NULL for the default. */ \
+    static inline hash_map_##name##_t *hash_map_##name##_create_with_allocator(size_t initial_count, const vector_allocator_t *allocator) { \
+        hash_map_##name##_t *map = NULL; \
+        size_t capacity = hash_map_##name##_capacity_for(initial_count); \
+        if (capacity == 0) { \
+            return NULL; \
+        } \
+        if (allocator == NULL) { \
+            allocator = vector_allocator_default(); \
+        } \
+        map = (hash_map_##name##_t *)allocator->alloc(allocator->p_context, sizeof(hash_map_##name##_t)); \
+        if (map == NULL) { \
+            return NULL; \
+        } \
+        map->vptr = &hash_map_##name##_vtable; \
+        map->size = 0; \
+        map->capacity = 0; \
+        map->growth_left = 0; \
+        map->control = NULL; \
+        map->slots = NULL; \
+        map->allocator = allocator; \
+        if (hash_map_##name##_rehash(map, capacity)) { \
+            allocator->free(allocator->p_context, map, sizeof(hash_map_##name##_t)); \
+            return NULL; \
+        } \
+        VECTOR_LOCK_INIT(lock_policy, &map->lock); \
+        return map; \
+    } \
+    /** Create a map with room for initial_count keys. */ \
+    static inline hash_map_##name##_t *hash_map_##name##_create(size_t initial_count) { \
+        return hash_map_##name##_create_with_allocator(initial_count, NULL); \
+    } \
+    static inline int hash_map_##name##_destroy(hash_map_##name##_t *map) { \
+        const vector_allocator_t *allocator = NULL; \
+        if (map == NULL) { \
+            return -1; \
+        } \
+        allocator = map->allocator; \
+        VECTOR_LOCK_DESTROY(lock_policy, &map->lock); \
+        allocator->free(allocator->p_context, map->control, hash_map_##name##_block_bytes(map->capacity)); \
+        allocator->free(allocator->p_context, map, sizeof(hash_map_##name##_t)); \
+        return 0; \
+    } \
+    /** Get the value of a key. Same as vptr->get without the indirect call, so the probe can be inlined. */ \
+    static inline int hash_map_##name##_get_fast(hash_map_##name##_t *map, key_type key, value_type *out) { \
+        uint64_t hash = hash_function(key); \
+        size_t index = 0; \
+        VECTOR_LOCK(lock_policy, &map->lock); \
+        index = hash_map_##name##_find(map, hash, key); \
+        if (index == map->capacity) { \
+            VECTOR_UNLOCK(lock_policy, &map->lock); \
+            return -1; \
+        } \
+        *out = map->slots[index].value; \
+        VECTOR_UNLOCK(lock_policy, &map->lock); \
+        return 0; \
+    } \
+    /** Number of keys in the map. No lock, so only a snapshot if other threads insert or remove. */ \
+    static inline size_t hash_map_##name##_size(const hash_map_##name##_t *map) { \
+        return map->size; \
+    }
+
+/**
+ * Hash map definition macro for a map named hash_map_<name>_t from key_type to value_type, guarded by lock_policy
+ * (MUTEX, SPINLOCK or NOLOCK). hash_function(key) gives the uint64_t hash of a key and equal_function(a, b) is
+ * nonzero for equal keys; both are called with lvalues, so they may be macros taking addresses.
+ */
+#define HASH_MAP_WITH_LOCK(name, key_type, value_type, hash_function, equal_function, lock_policy) \
+    typedef struct _hash_map_##name hash_map_##name##_t; \
+    HASH_MAP_VTBL_T(name, key_type, value_type) \
+    HASH_MAP_SLOT_T(name, key_type, value_type) \
+    HASH_MAP_T(name, lock_policy) \
+    HASH_MAP_FUNCS(name, key_type, value_type, hash_function, equal_function, lock_policy)
+
+/** Hash map definition macro, generates hash_map_<key_type>_<value_type>_t (MUTEX) for keys up to 8 bytes. */
+#define HASH_MAP(key_type, value_type) \
+    HASH_MAP_WITH_LOCK(key_type##_##value_type, key_type, value_type, HASH_MAP_HASH_DEFAULT, HASH_MAP_EQUAL_DEFAULT, MUTEX)
+
+/** Hash map definition macro for every lock policy of a key and value type, like VECTOR_DATA_STRUCTURES. */
+#define HASH_MAPS(key_type, value_type) \
+    HASH_MAP(key_type, value_type) \
+    HASH_MAP_WITH_LOCK(key_type##_##value_type##_spinlock, key_type, value_type, HASH_MAP_HASH_DEFAULT, HASH_MAP_EQUAL_DEFAULT, SPINLOCK) \
+    HASH_MAP_WITH_LOCK(key_type##_##value_type##_nolock, key_type, value_type, HASH_MAP_HASH_DEFAULT, HASH_MAP_EQUAL_DEFAULT, NOLOCK)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Hash of the first 8 bytes of a key, mixed so that nearby keys land far apart.
+ *
+ * @param p_key The key.
+ * @param size Size of the key in bytes.
+ * @return uint64_t The hash.
+ */
+static inline uint64_t hash_map_hash_bits(const void *p_key, size_t size) {
+    uint64_t bits = 0;
+    memcpy(&bits, p_key, (size < sizeof(bits)) ? size : sizeof(bits));
+    bits ^= bits >> 32;
+    bits *= 0xd6e8feb86659fd93ull;
+    bits ^= bits >> 32;
+    bits *= 0xd6e8feb86659fd93ull;
+    bits ^= bits >> 32;
+    return bits;
+}
+
+/**
+ * @brief Index of the lowest set bit.
+ *
+ * @param mask A nonzero mask.
+ * @return size_t The index.
+ */
+static inline size_t hash_map_lowest_bit(uint32_t mask) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (size_t)index;
+#else
+    size_t index = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+#ifdef HASH_MAP_SSE2
+
+/**
+ * @brief Slots of the group starting at p_group whose control byte is tag.
+ *
+ * @param p_group The control bytes of the group.
+ * @param tag Low 7 bits of a hash.
+ * @return uint32_t Bit i set if slot i matches.
+ */
+static inline uint32_t hash_map_group_match(const int8_t *p_group, int8_t tag) {
+    __m128i group = _mm_loadu_si128((const __m128i *)(const void *)p_group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+}
+
+/**
+ * @brief Slots of the group starting at p_group that are empty.
+ *
+ * @param p_group The control bytes of the group.
+ * @return uint32_t Bit i set if slot i is empty.
+ */
+static inline uint32_t hash_map_group_match_empty(const int8_t *p_group) {
+    return hash_map_group_match(p_group, HASH_MAP_CONTROL_EMPTY);
+}
+
+/**
+ * @brief Slots of the group starting at p_group that are empty or deleted, the control bytes with the top bit set.
+ *
+ * @param p_group The control bytes of the group.
+ * @return uint32_t Bit i set if slot i is free.
+ */
+static inline uint32_t hash_map_group_match_free(const int8_t *p_group) {
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(const void *)p_group));
+}
+
+#else
+
+/**
+ * @brief Slots of the group starting at p_group whose control byte is tag.
+ *
+ * @param p_group The control bytes of the group.
+ * @param tag Low 7 bits of a hash.
+ * @return uint32_t Bit i set if slot i matches.
+ */
+static inline uint32_t hash_map_group_match(const int8_t *p_group, int8_t tag) {
+    uint32_t matches = 0;
+    for (uint32_t slot = 0; slot < HASH_MAP_GROUP_WIDTH; slot++) {
+        matches |= (uint32_t)(p_group[slot] == tag) << slot;
+    }
+    return matches;
+}
+
+/**
+ * @brief Slots of the group starting at p_group that are empty.
+ *
+ * @param p_group The control bytes of the group.
+ * @return uint32_t Bit i set if slot i is empty.
+ */
+static inline uint32_t hash_map_group_match_empty(const int8_t *p_group) {
+    return hash_map_group_match(p_group, HASH_MAP_CONTROL_EMPTY);
+}
+
+/**
+ * @brief Slots of the group starting at p_group that are empty or deleted, the control bytes with the top bit set.
+ *
+ * @param p_group The control bytes of the group.
+ * @return uint32_t Bit i set if slot i is free.
+ */
+static inline uint32_t hash_map_group_match_free(const int8_t *p_group) {
+    uint32_t free_slots = 0;
+    for (uint32_t slot = 0; slot < HASH_MAP_GROUP_WIDTH; slot++) {
+        free_slots |= (uint32_t)(p_group[slot] < 0) << slot;
+    }
+    return free_slots;
+}
+
+#endif /* HASH_MAP_SSE2 */
+
+/*
+Usage, at file scope:
+    HASH_MAP(uint32_t, double)
+then:
+    hash_map_uint32_t_double_t *p_prices = hash_map_uint32_t_double_create(1000);
+    p_prices->vptr->insert(p_prices, 42, 9.5);
+    if (p_prices->vptr->get(p_prices, 42, &price) == 0) { use price }
+    hash_map_uint32_t_double_destroy(p_prices);
+For a struct key, HASH_MAP_WITH_LOCK(point_count, point_t, size_t, point_hash, point_equal, MUTEX).
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_HASH_MAP_H_ */
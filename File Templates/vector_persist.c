@@ -0,0 +1,514 @@
+/**
+* @file vector_persist.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Files holding the values of a vector as they are in memory, loaded back by mapping them.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_persist.h" /* Used to expose the persistence API. */
+#include "vector_atomic.h" /* Used for the block count of a mapping. */
+#include <errno.h> /* Used for errno */
+#include <stdio.h> /* Used for the file writes */
+#include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memcpy and memcmp */
+
+/* If Windows */
+#ifdef _WIN32
+    #include <io.h> /* Used for _commit */
+    #include <windows.h> /* Used for MoveFileExA */
+#else /* If POSIX-like system */
+    #include <fcntl.h> /* Used for open */
+    #include <sys/mman.h> /* Used for mmap and munmap */
+    #include <sys/stat.h> /* Used for fstat */
+    #include <unistd.h> /* Used for close and fsync */
+    #define PERSIST_MMAP_AVAILABLE (1)
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the first bytes of every file. */
+#define PERSIST_MAGIC           "VECTORv\0"
+/** definition for the version of the file layout. */
+#define PERSIST_VERSION         (1)
+/** definition for the byte order marker, it reads back the same only on a machine of the same byte order. */
+#define PERSIST_BYTE_ORDER      (0x0102030405060708ull)
+/** definition for the bytes of the header covered by its own checksum, every field before it. */
+#define PERSIST_HEADER_CHECKED  (offsetof(persist_header_t, header_checksum))
+
+/** definition for the first multiplier of the checksum, from xxHash64. */
+#define PERSIST_PRIME_1         (0x9e3779b185ebca87ull)
+/** definition for the second multiplier of the checksum, from xxHash64. */
+#define PERSIST_PRIME_2         (0xc2b2ae3d27d4eb4full)
+
+/** definition for the suffix of the file a save writes before renaming it over the old one. */
+#define PERSIST_TEMP_SUFFIX     ".tmp"
+
+/* If Windows */
+#ifdef _WIN32
+    #define PERSIST_SYNC(p_file) _commit(_fileno((p_file)))
+    #define PERSIST_RENAME(p_from, p_to) (MoveFileExA((p_from), (p_to), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 0 : -1)
+#else /* If POSIX-like system */
+    #define PERSIST_SYNC(p_file) fsync(fileno((p_file)))
+    #define PERSIST_RENAME(p_from, p_to) rename((p_from), (p_to))
+#endif
+
+/* If mmap is available */
+#ifdef PERSIST_MMAP_AVAILABLE
+    #define PERSIST_RELEASE(p_base, length) munmap((p_base), (length))
+#else /* The file was read into memory */
+    #define PERSIST_RELEASE(p_base, length) ((void)(length), free((p_base)))
+#endif
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/**
+ * @brief File header, the values follow it. Every field is in the byte order of the machine that saved it.
+ *
+ */
+typedef struct _persist_header {
+    char magic[8];                      /**< PERSIST_MAGIC */
+    uint32_t version;                   /**< PERSIST_VERSION */
+    uint32_t type;                      /**< vector_persist_type_t of the values */
+    uint64_t byte_order;                /**< PERSIST_BYTE_ORDER */
+    uint64_t value_size;                /**< Size of one value */
+    uint64_t count;                     /**< Number of values */
+    uint64_t checksum;                  /**< vector_persist_checksum of the values */
+    uint64_t header_checksum;           /**< vector_persist_checksum of the fields above */
+    uint64_t reserved;                  /**< 0, fills the header to VECTOR_PERSIST_HEADER_BYTES */
+} persist_header_t;
+
+_Static_assert(sizeof(persist_header_t) == VECTOR_PERSIST_HEADER_BYTES, "the file header must fill VECTOR_PERSIST_HEADER_BYTES");
+
+/**
+ * @brief A mapped file, the context of the allocator handed out with it.
+ *
+ */
+typedef struct _persist_mapping {
+    vector_allocator_t allocator;       /**< Allocator interface, its context is the mapping */
+    unsigned char *p_base;              /**< The file, NULL once released */
+    size_t length;                      /**< Bytes of the file */
+    size_t blocks;                      /**< Live blocks of the allocator, the mapped values count as one */
+} persist_mapping_t;
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static uint64_t persist_rotate(uint64_t value, unsigned int bits);
+static uint64_t persist_load(const unsigned char *p_bytes);
+static int persist_check_header(const persist_header_t *p_header, vector_persist_type_t type, size_t value_size, size_t *out_length);
+static unsigned char *persist_open(const char *p_path, unsigned int flags, size_t *out_length);
+static int persist_sync_directory(const char *p_path);
+static void persist_release_block(persist_mapping_t *p_mapping);
+static void *persist_alloc(void *p_context, size_t size);
+static void *persist_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size);
+static void persist_free(void *p_context, void *p_block, size_t size);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+int vector_persist_save(const char *p_path, vector_persist_type_t type, size_t value_size, const void *p_values, size_t count) {
+
+    persist_header_t header;
+    FILE *p_file = NULL;
+    char *p_temp_path = NULL;
+    size_t path_length = 0;
+    int rv = 0;
+
+    if((p_path == NULL) || (value_size == 0) || (count > SIZE_MAX / value_size) || ((p_values == NULL) && (count > 0))) {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PERSIST_MAGIC, sizeof(header.magic));
+    header.version = PERSIST_VERSION;
+    header.type = (uint32_t)type;
+    header.byte_order = PERSIST_BYTE_ORDER;
+    header.value_size = value_size;
+    header.count = count;
+    header.checksum = vector_persist_checksum(p_values, count * value_size);
+    header.header_checksum = vector_persist_checksum(&header, PERSIST_HEADER_CHECKED);
+
+    /* Write a file next to the old one and rename it over it. A crash or a failed write leaves the old file whole, */
+    /* and processes that have the old file mapped keep their pages instead of seeing it shrink under them. */
+    path_length = strlen(p_path);
+    p_temp_path = (char *)malloc(path_length + sizeof(PERSIST_TEMP_SUFFIX));
+    if(p_temp_path == NULL) {
+        return -1;
+    }
+    memcpy(p_temp_path, p_path, path_length);
+    memcpy(p_temp_path + path_length, PERSIST_TEMP_SUFFIX, sizeof(PERSIST_TEMP_SUFFIX));
+
+    p_file = fopen(p_temp_path, "wb");
+    if(p_file == NULL) {
+        free(p_temp_path);
+        return -1;
+    }
+    /* The values have to be on the disk before the rename can make them the file. */
+    if((fwrite(&header, sizeof(header), 1, p_file) != 1) ||
+       ((count > 0) && (fwrite(p_values, value_size, count, p_file) != count)) ||
+       (fflush(p_file) != 0) || (PERSIST_SYNC(p_file) != 0)) {
+        rv = -1;
+    }
+    if(fclose(p_file) != 0) {
+        rv = -1;
+    }
+    if((rv == 0) && (PERSIST_RENAME(p_temp_path, p_path) != 0)) {
+        rv = -1;
+    }
+
+    if(rv != 0) {
+        remove(p_temp_path);
+    }
+    /* Make the rename itself survive a crash. */
+    else if(persist_sync_directory(p_path) != 0) {
+        rv = -1;
+    }
+    free(p_temp_path);
+
+    return rv;
+}
+
+const vector_allocator_t *vector_persist_map(const char *p_path, vector_persist_type_t type, size_t value_size, unsigned int flags,
+                                             void **out_values, size_t *out_count) {
+
+    persist_mapping_t *p_mapping = NULL;
+    const persist_header_t *p_header = NULL;
+    unsigned char *p_base = NULL;
+    size_t length = 0;
+    size_t expected_length = 0;
+
+    if((p_path == NULL) || (out_values == NULL) || (out_count == NULL)) {
+        return NULL;
+    }
+
+    p_mapping = (persist_mapping_t *)malloc(sizeof(persist_mapping_t));
+    if(p_mapping == NULL) {
+        return NULL;
+    }
+    p_base = persist_open(p_path, flags, &length);
+    if(p_base == NULL) {
+        free(p_mapping);
+        return NULL;
+    }
+
+    p_header = (const persist_header_t *)(const void *)p_base;
+    if((persist_check_header(p_header, type, value_size, &expected_length) != 0) || (expected_length != length) ||
+       ((flags & VECTOR_MAP_VERIFY) &&
+        (vector_persist_checksum(p_base + VECTOR_PERSIST_HEADER_BYTES, length - VECTOR_PERSIST_HEADER_BYTES) != p_header->checksum))) {
+        PERSIST_RELEASE(p_base, length);
+        free(p_mapping);
+        return NULL;
+    }
+
+    p_mapping->allocator.alloc = persist_alloc;
+    p_mapping->allocator.realloc = persist_realloc;
+    p_mapping->allocator.free = persist_free;
+    p_mapping->allocator.p_context = p_mapping;
+    p_mapping->p_base = p_base;
+    p_mapping->length = length;
+    p_mapping->blocks = 1;
+
+    *out_values = p_base + VECTOR_PERSIST_HEADER_BYTES;
+    *out_count = (size_t)p_header->count;
+
+    return &p_mapping->allocator;
+}
+
+uint64_t vector_persist_checksum(const void *p_bytes, size_t length) {
+
+    const unsigned char *p_next = (const unsigned char *)p_bytes;
+    uint64_t lanes[4] = {PERSIST_PRIME_1 + PERSIST_PRIME_2, PERSIST_PRIME_2, 0, 0 - PERSIST_PRIME_1};
+    uint64_t hash = 0;
+    size_t remaining = length;
+
+    /* Four independent lanes, so the multiplies of neighboring words overlap. */
+    while(remaining >= 4 * sizeof(uint64_t)) {
+        for (unsigned int lane = 0; lane < 4; lane++) {
+            lanes[lane] = persist_rotate(lanes[lane] + persist_load(p_next + lane * sizeof(uint64_t)) * PERSIST_PRIME_2, 31) * PERSIST_PRIME_1;
+        }
+        p_next += 4 * sizeof(uint64_t);
+        remaining -= 4 * sizeof(uint64_t);
+    }
+
+    hash = persist_rotate(lanes[0], 1) + persist_rotate(lanes[1], 7) + persist_rotate(lanes[2], 12) + persist_rotate(lanes[3], 18);
+    hash ^= (uint64_t)length;
+    while(remaining > 0) {
+        hash = persist_rotate(hash ^ (*p_next * PERSIST_PRIME_1), 11) * PERSIST_PRIME_2;
+        p_next++;
+        remaining--;
+    }
+
+    /* Final mix, so every input bit reaches every output bit. */
+    hash = (hash ^ (hash >> 33)) * PERSIST_PRIME_2;
+    hash = (hash ^ (hash >> 29)) * PERSIST_PRIME_1;
+
+    return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief Helper function to rotate a value left.
+ *
+ * @param value The value.
+ * @param bits Number of bits, 1 to 63.
+ * @return uint64_t The rotated value.
+ */
+static uint64_t persist_rotate(uint64_t value, unsigned int bits) {
+
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * @brief Helper function to load a word from any address.
+ *
+ * @param p_bytes Address of the word.
+ * @return uint64_t The word, in the byte order of the machine.
+ */
+static uint64_t persist_load(const unsigned char *p_bytes) {
+
+    uint64_t word = 0;
+
+    memcpy(&word, p_bytes, sizeof(word));
+
+    return word;
+}
+
+/**
+ * @brief Helper function to check a header against the values expected.
+ *
+ * @param p_header The header.
+ * @param type Type tag the values must have.
+ * @param value_size Size the values must have.
+ * @param out_length Set to the length the file must have, may be NULL.
+ * @return int 0 if the header fits, -1 if not or if it is corrupt.
+ */
+static int persist_check_header(const persist_header_t *p_header, vector_persist_type_t type, size_t value_size, size_t *out_length) {
+
+    if((memcmp(p_header->magic, PERSIST_MAGIC, sizeof(p_header->magic)) != 0) || (p_header->version != PERSIST_VERSION) ||
+       (p_header->byte_order != PERSIST_BYTE_ORDER) || (p_header->type != (uint32_t)type) || (p_header->value_size != value_size) ||
+       (p_header->header_checksum != vector_persist_checksum(p_header, PERSIST_HEADER_CHECKED)) ||
+       (p_header->count > (SIZE_MAX - VECTOR_PERSIST_HEADER_BYTES) / value_size)) {
+        return -1;
+    }
+
+    if(out_length != NULL) {
+        *out_length = VECTOR_PERSIST_HEADER_BYTES + (size_t)p_header->count * value_size;
+    }
+
+    return 0;
+}
+
+#ifdef PERSIST_MMAP_AVAILABLE
+/**
+ * @brief Helper function to map a whole file, read-only and shared or copy-on-write.
+ *
+ * @param p_path Path of the file.
+ * @param flags VECTOR_MAP_READ_ONLY or VECTOR_MAP_COPY_ON_WRITE.
+ * @param out_length Set to the length of the file.
+ * @return unsigned char* The mapping, NULL on fail or for a file shorter than a header.
+ */
+static unsigned char *persist_open(const char *p_path, unsigned int flags, size_t *out_length) {
+
+    struct stat status;
+    void *p_base = MAP_FAILED;
+    int fd = open(p_path, O_RDONLY);
+
+    if(fd < 0) {
+        return NULL;
+    }
+    if((fstat(fd, &status) == 0) && (status.st_size >= VECTOR_PERSIST_HEADER_BYTES) && ((uint64_t)status.st_size <= SIZE_MAX)) {
+        *out_length = (size_t)status.st_size;
+        if(flags & VECTOR_MAP_COPY_ON_WRITE) {
+            p_base = mmap(NULL, *out_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        else {
+            p_base = mmap(NULL, *out_length, PROT_READ, MAP_SHARED, fd, 0);
+        }
+    }
+    /* The mapping keeps the file, the descriptor is not needed anymore. */
+    close(fd);
+
+    return (p_base == MAP_FAILED) ? NULL : (unsigned char *)p_base;
+}
+#else
+/**
+ * @brief Helper function to read a whole file into memory, where it cannot be mapped.
+ *
+ * @param p_path Path of the file.
+ * @param flags Unused, the copy is always writable.
+ * @param out_length Set to the length of the file.
+ * @return unsigned char* The file, NULL on fail, for a bad header or for a file of another length than it says.
+ */
+static unsigned char *persist_open(const char *p_path, unsigned int flags, size_t *out_length) {
+
+    persist_header_t header;
+    unsigned char *p_base = NULL;
+    FILE *p_file = fopen(p_path, "rb");
+
+    (void)flags;
+
+    if(p_file == NULL) {
+        return NULL;
+    }
+    /* The length comes from the header, the type is checked by the caller once the file is in. */
+    if((fread(&header, sizeof(header), 1, p_file) == 1) && (header.value_size != 0) &&
+       (persist_check_header(&header, (vector_persist_type_t)header.type, (size_t)header.value_size, out_length) == 0) &&
+       ((p_base = (unsigned char *)malloc(*out_length)) != NULL)) {
+        memcpy(p_base, &header, sizeof(header));
+        if((fread(p_base + sizeof(header), 1, *out_length - sizeof(header), p_file) != *out_length - sizeof(header)) ||
+           (fgetc(p_file) != EOF)) {
+            free(p_base);
+            p_base = NULL;
+        }
+    }
+    fclose(p_file);
+
+    return p_base;
+}
+#endif
+
+/**
+ * @brief Helper function to sync the directory of a file, so that a rename in it survives a crash.
+ *
+ * @param p_path Path of the file.
+ * @return int 0 on success, -1 on fail.
+ */
+static int persist_sync_directory(const char *p_path) {
+
+/* If Windows */
+#ifdef _WIN32
+    /* Directory entries can't be synced on Windows, MOVEFILE_WRITE_THROUGH covers the rename. */
+    (void)p_path;
+    return 0;
+#else /* If POSIX-like system */
+    const char *p_separator = strrchr(p_path, '/');
+    char *p_directory = NULL;
+    size_t length = 0;
+    int fd = -1;
+    int rv = 0;
+
+    /* A bare file name lives in the working directory, a file under the root in "/". */
+    if(p_separator == NULL) {
+        p_path = ".";
+        length = 1;
+    }
+    else {
+        length = (p_separator == p_path) ? 1 : (size_t)(p_separator - p_path);
+    }
+    p_directory = (char *)malloc(length + 1);
+    if(p_directory == NULL) {
+        return -1;
+    }
+    memcpy(p_directory, p_path, length);
+    p_directory[length] = '\0';
+
+    fd = open(p_directory, O_RDONLY);
+    free(p_directory);
+    if(fd < 0) {
+        return -1;
+    }
+    /* Some file systems can't sync a directory, they don't need to. */
+    if((fsync(fd) != 0) && (errno != EINVAL)) {
+        rv = -1;
+    }
+    close(fd);
+
+    return rv;
+#endif
+}
+
+/**
+ * @brief Helper function to drop a block of a mapping, and the mapping once no block is left.
+ *
+ * @param p_mapping The mapping.
+ */
+static void persist_release_block(persist_mapping_t *p_mapping) {
+
+    if(VECTOR_ATOMIC_FETCH_ADD_SIZE(&p_mapping->blocks, (size_t)-1) == 1) {
+        free(p_mapping);
+    }
+}
+
+/**
+ * @brief alloc of a mapping's allocator, an ordinary block.
+ *
+ * @param p_context The mapping.
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *persist_alloc(void *p_context, size_t size) {
+
+    persist_mapping_t *p_mapping = (persist_mapping_t *)p_context;
+    void *p_block = malloc(size);
+
+    if(p_block != NULL) {
+        VECTOR_ATOMIC_FETCH_ADD_SIZE(&p_mapping->blocks, 1);
+    }
+
+    return p_block;
+}
+
+/**
+ * @brief realloc of a mapping's allocator. The mapped values move to an ordinary block and are unmapped.
+ *
+ * @param p_context The mapping.
+ * @param p_block The block, NULL to allocate.
+ * @param old_size Size the block was allocated with.
+ * @param new_size Number of bytes.
+ * @return void* The block, NULL on fail and the block is kept.
+ */
+static void *persist_realloc(void *p_context, void *p_block, size_t old_size, size_t new_size) {
+
+    persist_mapping_t *p_mapping = (persist_mapping_t *)p_context;
+    unsigned char *p_new_block = NULL;
+
+    if(p_block == NULL) {
+        return persist_alloc(p_context, new_size);
+    }
+    if((p_mapping->p_base == NULL) || (p_block != p_mapping->p_base + VECTOR_PERSIST_HEADER_BYTES)) {
+        return realloc(p_block, new_size);
+    }
+
+    p_new_block = (unsigned char *)malloc(new_size);
+    if(p_new_block == NULL) {
+        return NULL;
+    }
+    memcpy(p_new_block, p_block, (old_size < new_size) ? old_size : new_size);
+    PERSIST_RELEASE(p_mapping->p_base, p_mapping->length);
+    p_mapping->p_base = NULL;
+
+    return p_new_block;
+}
+
+/**
+ * @brief free of a mapping's allocator. Freeing the mapped values unmaps them.
+ *
+ * @param p_context The mapping.
+ * @param p_block The block, NULL is ignored.
+ * @param size Unused.
+ */
+static void persist_free(void *p_context, void *p_block, size_t size) {
+
+    persist_mapping_t *p_mapping = (persist_mapping_t *)p_context;
+
+    (void)size;
+
+    if(p_block == NULL) {
+        return;
+    }
+    if((p_mapping->p_base != NULL) && (p_block == p_mapping->p_base + VECTOR_PERSIST_HEADER_BYTES)) {
+        PERSIST_RELEASE(p_mapping->p_base, p_mapping->length);
+        p_mapping->p_base = NULL;
+    }
+    else {
+        free(p_block);
+    }
+    persist_release_block(p_mapping);
+}
@@ -0,0 +1,142 @@
+/**
+ * @file vector_persist.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Files holding the values of a vector as they are in memory, loaded back by mapping them.
+ *
+ * A file is a VECTOR_PERSIST_HEADER_BYTES header followed by the raw values. The header names the type, the
+ * value size, the number of values and the byte order of the machine that saved them, and carries a checksum
+ * of the values. Loading maps the file and hands the mapping out as the data of a vector, so nothing is read
+ * until a value is used. The mapping is given back by the allocator of the vector once the data is freed or
+ * grown out of it.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_PERSIST_H_
+#define _VECTOR_PERSIST_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_allocator.h" /* For vector_allocator_t */
+#include "vector_wip.h" /* For the vectors saved and mapped */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the size of the file header, the values follow it on a cache line boundary. */
+#define VECTOR_PERSIST_HEADER_BYTES (64)
+
+/** map flag: the values are mapped read-only, and writing one in place faults. The default. */
+#define VECTOR_MAP_READ_ONLY        (0u)
+/** map flag: the values are mapped copy-on-write, written pages become private and the file never changes. */
+#define VECTOR_MAP_COPY_ON_WRITE    (1u << 0)
+/** map flag: check the checksum of the values before handing them out, which reads the whole file. */
+#define VECTOR_MAP_VERIFY           (1u << 1)
+
+/**
+ * Vector persistence function declarations macro. save writes the values to a file at p_path, replacing it
+ * atomically. map creates a vector whose data is the mapped values of such a file, read-only or copy-on-write by
+ * flags, with size and capacity at the number of values. A read-only vector must not be written in place (set
+ * through data, insert, remove_at, sort...), but push, reserve and the like move the values to memory of their
+ * own first. The file must not be written in place while it is mapped, a save over it leaves the mapping on the
+ * old file. NULL when the file does not hold values of data_type saved on a machine of the same byte order.
+ */
+#define VECTOR_PERSIST_FUNCTIONS_DECLARE(name) \
+    int vector_##name##_save(vector_##name##_t *vector, const char *p_path); \
+    vector_##name##_t *vector_##name##_map(const char *p_path, unsigned int flags);
+
+/** Vector persistence function declarations macro for every lock policy of a type. */
+#define VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(data_type) \
+    VECTOR_PERSIST_FUNCTIONS_DECLARE(data_type) \
+    VECTOR_PERSIST_FUNCTIONS_DECLARE(data_type##_spinlock) \
+    VECTOR_PERSIST_FUNCTIONS_DECLARE(data_type##_nolock)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/**
+ * @brief Type tags of the files, by the type of the values. The lock policy of a vector is not saved.
+ *
+ */
+typedef enum _vector_persist_type {
+    VECTOR_PERSIST_TYPE_int = 1,
+    VECTOR_PERSIST_TYPE_double,
+    VECTOR_PERSIST_TYPE_char,
+    VECTOR_PERSIST_TYPE_uint8_t,
+    VECTOR_PERSIST_TYPE_uint16_t,
+    VECTOR_PERSIST_TYPE_uint32_t,
+    VECTOR_PERSIST_TYPE_uint64_t,
+} vector_persist_type_t;
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Write count values of value_size bytes to a file, replacing it.
+ *
+ * The values are written to <p_path>.tmp, synced and renamed over p_path, so readers and mappings of the old
+ * file never see a partial one.
+ *
+ * @param p_path Path of the file.
+ * @param type Type tag of the values.
+ * @param value_size Size of one value.
+ * @param p_values The values, may be NULL when count is 0.
+ * @param count Number of values.
+ * @return int 0 on success, -1 on fail. A failed save leaves the old file as it was and removes the temp file.
+ */
+int vector_persist_save(const char *p_path, vector_persist_type_t type, size_t value_size, const void *p_values, size_t count);
+
+/**
+ * @brief Map the values of a file. The header has to match type, value_size and the byte order of this machine.
+ *
+ * Where mmap is not available the values are read into memory instead, with the same interface.
+ *
+ * @param p_path Path of the file.
+ * @param type Type tag the values must have.
+ * @param value_size Size the values must have.
+ * @param flags VECTOR_MAP_READ_ONLY or VECTOR_MAP_COPY_ON_WRITE, optionally with VECTOR_MAP_VERIFY.
+ * @param out_values Set to the mapped values.
+ * @param out_count Set to the number of values.
+ * @return const vector_allocator_t* Allocator for the vector that takes the mapped values. It hands out ordinary
+ * blocks, and unmaps the values when they are freed or reallocated, copying them for the latter. It lives as
+ * long as any block of it. NULL on fail, when nothing stays mapped.
+ */
+const vector_allocator_t *vector_persist_map(const char *p_path, vector_persist_type_t type, size_t value_size, unsigned int flags,
+                                             void **out_values, size_t *out_count);
+
+/**
+ * @brief Checksum of a file's values, as saved in its header.
+ *
+ * @param p_bytes The bytes.
+ * @param length Number of bytes.
+ * @return uint64_t The checksum.
+ */
+uint64_t vector_persist_checksum(const void *p_bytes, size_t length);
+
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(int)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(double)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(char)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(uint8_t)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(uint16_t)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(uint32_t)
+VECTOR_PERSIST_FUNCTIONS_DECLARE_ALL(uint64_t)
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_PERSIST_H_ */
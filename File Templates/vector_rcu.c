@@ -0,0 +1,364 @@
+/**
+* @file vector_rcu.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Read-mostly vectors whose readers never lock and never write a shared cache line.
+*
+* A buffer retired in epoch e may still be read by readers that announced an epoch below e. Readers announce
+* before they load the buffer pointer, with a fence in between, and writers advance the epoch after they
+* publish a new pointer, with a fence before they look at the announcements. So a reader either shows up with
+* an epoch below e, or loads the new pointer.
+*
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_rcu.h" /* Used to expose the RCU vector API. */
+#include "vector_atomic.h" /* Used for the atomic operations. */
+#include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memcpy and memset */
+
+/* If Windows */
+#ifdef _WIN32
+    #include <malloc.h> /* Used for _aligned_malloc */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the capacity an empty buffer grows to on the first push. */
+#define RCU_MIN_CAPACITY        (16)
+
+/* If Windows */
+#ifdef _WIN32
+    #define RCU_ALIGNED_ALLOC(size) _aligned_malloc((size), VECTOR_CACHE_LINE_BYTES)
+    #define RCU_ALIGNED_FREE(p_block) _aligned_free((p_block))
+#else /* If POSIX-like system */
+    #define RCU_ALIGNED_ALLOC(size) rcu_aligned_alloc((size))
+    #define RCU_ALIGNED_FREE(p_block) free((p_block))
+#endif
+
+/** RCU vector virtual table definition macro. */
+#define VECTOR_RCU_VTABLE_INIT(name) \
+static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .get = vector_##name##_get, \
+        .size = vector_##name##_size, \
+};
+
+/** RCU vector function declarations macro. */
+#define VECTOR_RCU_STATIC_FUNCTIONS_DECLARE(name, data_type) \
+    static int vector_##name##_push(vector_##name##_t *vector, data_type value); \
+    static int vector_##name##_get(vector_##name##_t *vector, size_t reader, size_t index, data_type *out); \
+    static size_t vector_##name##_size(vector_##name##_t *vector); \
+    static vector_##name##_buffer_t *vector_##name##_buffer_create(size_t capacity); \
+    static void vector_##name##_reclaim(vector_##name##_t *vector);
+
+/** Macro to generate the RCU vector function that allocates a buffer, the values right after the header */
+#define GENERIC_VECTOR_RCU_BUFFER_CREATE_FUNC(name, data_type) \
+    vector_##name##_buffer_t *vector_##name##_buffer_create(size_t capacity) { \
+        vector_##name##_buffer_t *p_buffer = NULL; \
+        if (capacity > (SIZE_MAX - sizeof(vector_##name##_buffer_t)) / sizeof(data_type)) { \
+            return NULL; \
+        } \
+        p_buffer = (vector_##name##_buffer_t *)malloc(sizeof(vector_##name##_buffer_t) + capacity * sizeof(data_type)); \
+        if (p_buffer == NULL) { \
+            return NULL; \
+        } \
+        p_buffer->size = 0; \
+        p_buffer->capacity = capacity; \
+        p_buffer->retired_epoch = 0; \
+        p_buffer->p_next_retired = NULL; \
+        p_buffer->data = (data_type *)(void *)(p_buffer + 1); \
+        return p_buffer; \
+    }
+
+/** Macro to generate RCU vector create function */
+#define GENERIC_VECTOR_RCU_CREATE_FUNC(name, data_type) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity) { \
+        vector_##name##_t *vector = (vector_##name##_t *)RCU_ALIGNED_ALLOC(sizeof(vector_##name##_t)); \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        memset(vector, 0, sizeof(vector_##name##_t)); \
+        vector->p_buffer = vector_##name##_buffer_create(initial_capacity); \
+        if (vector->p_buffer == NULL) { \
+            RCU_ALIGNED_FREE(vector); \
+            return NULL; \
+        } \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->epoch = 1; \
+        VECTOR_MUTEX_INIT(&vector->write_lock); \
+        return vector; \
+    }
+
+/** Macro to generate RCU vector destroy function */
+#define GENERIC_VECTOR_RCU_DESTROY_FUNC(name, data_type) \
+    int vector_##name##_destroy(vector_##name##_t *vector) { \
+        vector_##name##_buffer_t *p_retired = NULL; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        p_retired = vector->p_retired; \
+        while (p_retired != NULL) { \
+            vector_##name##_buffer_t *p_next = p_retired->p_next_retired; \
+            free(p_retired); \
+            p_retired = p_next; \
+        } \
+        free(vector->p_buffer); \
+        VECTOR_MUTEX_DESTROY(&vector->write_lock); \
+        RCU_ALIGNED_FREE(vector); \
+        return 0; \
+    }
+
+/** Macro to generate the RCU vector reader registration functions */
+#define GENERIC_VECTOR_RCU_REGISTER_FUNCS(name, data_type) \
+    int vector_##name##_register_reader(vector_##name##_t *vector, size_t *out_reader) { \
+        if (vector == NULL || out_reader == NULL) { \
+            return -1; \
+        } \
+        for (size_t reader = 0; reader < VECTOR_RCU_MAX_READERS; reader++) { \
+            if (VECTOR_ATOMIC_LOAD_SIZE(&vector->readers[reader].in_use) == 0 && \
+                VECTOR_ATOMIC_CAS_SIZE(&vector->readers[reader].in_use, 0, 1)) { \
+                VECTOR_ATOMIC_STORE_SIZE(&vector->readers[reader].epoch, 0); \
+                *out_reader = reader; \
+                return 0; \
+            } \
+        } \
+        return -1; \
+    } \
+    int vector_##name##_unregister_reader(vector_##name##_t *vector, size_t reader) { \
+        if (vector == NULL || reader >= VECTOR_RCU_MAX_READERS) { \
+            return -1; \
+        } \
+        VECTOR_ATOMIC_STORE_SIZE(&vector->readers[reader].epoch, 0); \
+        VECTOR_ATOMIC_STORE_SIZE(&vector->readers[reader].in_use, 0); \
+        return 0; \
+    }
+
+/** Macro to generate the RCU vector read side functions */
+#define GENERIC_VECTOR_RCU_READ_FUNCS(name, data_type) \
+    int vector_##name##_get(vector_##name##_t *vector, size_t reader, size_t index, data_type *out) { \
+        vector_##name##_buffer_t *p_buffer = NULL; \
+        int nested = 0; \
+        int rv = -1; \
+        if (vector == NULL || out == NULL || reader >= VECTOR_RCU_MAX_READERS) { \
+            return -1; \
+        } \
+        nested = rcu_reader_enter(&vector->readers[reader], &vector->epoch); \
+        p_buffer = VECTOR_ATOMIC_LOAD_PTR(&vector->p_buffer); \
+        if (index < VECTOR_ATOMIC_LOAD_SIZE(&p_buffer->size)) { \
+            *out = p_buffer->data[index]; \
+            rv = 0; \
+        } \
+        if (!nested) { \
+            rcu_reader_exit(&vector->readers[reader]); \
+        } \
+        return rv; \
+    } \
+    const data_type *vector_##name##_read_lock(vector_##name##_t *vector, size_t reader, size_t *out_size) { \
+        vector_##name##_buffer_t *p_buffer = NULL; \
+        if (vector == NULL || out_size == NULL || reader >= VECTOR_RCU_MAX_READERS) { \
+            return NULL; \
+        } \
+        rcu_reader_enter(&vector->readers[reader], &vector->epoch); \
+        p_buffer = VECTOR_ATOMIC_LOAD_PTR(&vector->p_buffer); \
+        *out_size = VECTOR_ATOMIC_LOAD_SIZE(&p_buffer->size); \
+        return p_buffer->data; \
+    } \
+    int vector_##name##_read_unlock(vector_##name##_t *vector, size_t reader) { \
+        if (vector == NULL || reader >= VECTOR_RCU_MAX_READERS) { \
+            return -1; \
+        } \
+        rcu_reader_exit(&vector->readers[reader]); \
+        return 0; \
+    } \
+    size_t vector_##name##_size(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return 0; \
+        } \
+        return VECTOR_ATOMIC_LOAD_SIZE(&vector->size); \
+    }
+
+/** Macro to generate RCU vector push function */
+#define GENERIC_VECTOR_RCU_PUSH_FUNC(name, data_type) \
+    int vector_##name##_push(vector_##name##_t *vector, data_type value) { \
+        vector_##name##_buffer_t *p_buffer = NULL; \
+        vector_##name##_buffer_t *p_new_buffer = NULL; \
+        size_t new_capacity = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_MUTEX_LOCK(&vector->write_lock); \
+        p_buffer = vector->p_buffer; \
+        /* Values below size are never written again, so an append in place is safe under readers. */ \
+        if (p_buffer->size < p_buffer->capacity) { \
+            p_buffer->data[p_buffer->size] = value; \
+            VECTOR_ATOMIC_STORE_SIZE(&p_buffer->size, p_buffer->size + 1); \
+            VECTOR_ATOMIC_STORE_SIZE(&vector->size, p_buffer->size); \
+            VECTOR_MUTEX_UNLOCK(&vector->write_lock); \
+            return 0; \
+        } \
+        new_capacity = (p_buffer->capacity < RCU_MIN_CAPACITY) ? RCU_MIN_CAPACITY : p_buffer->capacity * 2; \
+        if (p_buffer->capacity > SIZE_MAX / 2 || (p_new_buffer = vector_##name##_buffer_create(new_capacity)) == NULL) { \
+            VECTOR_MUTEX_UNLOCK(&vector->write_lock); \
+            return -1; \
+        } \
+        memcpy(p_new_buffer->data, p_buffer->data, p_buffer->size * sizeof(data_type)); \
+        p_new_buffer->data[p_buffer->size] = value; \
+        p_new_buffer->size = p_buffer->size + 1; \
+        VECTOR_ATOMIC_STORE_PTR(&vector->p_buffer, p_new_buffer); \
+        VECTOR_ATOMIC_STORE_SIZE(&vector->size, p_new_buffer->size); \
+        p_buffer->retired_epoch = VECTOR_ATOMIC_FETCH_ADD_SIZE(&vector->epoch, 1) + 1; \
+        p_buffer->p_next_retired = vector->p_retired; \
+        vector->p_retired = p_buffer; \
+        vector_##name##_reclaim(vector); \
+        VECTOR_MUTEX_UNLOCK(&vector->write_lock); \
+        return 0; \
+    }
+
+/** Macro to generate the RCU vector function that frees the retired buffers no reader can still hold. The write lock must be held. */
+#define GENERIC_VECTOR_RCU_RECLAIM_FUNC(name, data_type) \
+    void vector_##name##_reclaim(vector_##name##_t *vector) { \
+        size_t oldest = rcu_oldest_epoch(vector->readers); \
+        vector_##name##_buffer_t **p_link = &vector->p_retired; \
+        /* Newest first, so once one buffer is free of readers every older one is too. */ \
+        while (*p_link != NULL && (*p_link)->retired_epoch > oldest) { \
+            p_link = &(*p_link)->p_next_retired; \
+        } \
+        while (*p_link != NULL) { \
+            vector_##name##_buffer_t *p_free = *p_link; \
+            *p_link = p_free->p_next_retired; \
+            free(p_free); \
+        } \
+    }
+
+/** Macro to generate RCU vector synchronize function */
+#define GENERIC_VECTOR_RCU_SYNCHRONIZE_FUNC(name, data_type) \
+    int vector_##name##_synchronize(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_MUTEX_LOCK(&vector->write_lock); \
+        vector_##name##_reclaim(vector); \
+        while (vector->p_retired != NULL) { \
+            VECTOR_CPU_RELAX(); \
+            vector_##name##_reclaim(vector); \
+        } \
+        VECTOR_MUTEX_UNLOCK(&vector->write_lock); \
+        return 0; \
+    }
+
+/** Macro to generate the functions of vector_<data_type>_rcu_t */
+#define GENERIC_VECTOR_RCU_FUNCTIONS(data_type) \
+    VECTOR_RCU_STATIC_FUNCTIONS_DECLARE(data_type##_rcu, data_type) \
+    VECTOR_RCU_VTABLE_INIT(data_type##_rcu) \
+    GENERIC_VECTOR_RCU_BUFFER_CREATE_FUNC(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_CREATE_FUNC(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_DESTROY_FUNC(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_REGISTER_FUNCS(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_READ_FUNCS(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_PUSH_FUNC(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_RECLAIM_FUNC(data_type##_rcu, data_type) \
+    GENERIC_VECTOR_RCU_SYNCHRONIZE_FUNC(data_type##_rcu, data_type)
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static int rcu_reader_enter(vector_rcu_reader_slot_t *p_slot, size_t *p_epoch);
+static void rcu_reader_exit(vector_rcu_reader_slot_t *p_slot);
+static size_t rcu_oldest_epoch(vector_rcu_reader_slot_t *p_slots);
+#ifndef _WIN32
+static void *rcu_aligned_alloc(size_t size);
+#endif
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+GENERIC_VECTOR_RCU_FUNCTIONS(int)
+GENERIC_VECTOR_RCU_FUNCTIONS(double)
+GENERIC_VECTOR_RCU_FUNCTIONS(char)
+GENERIC_VECTOR_RCU_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_RCU_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_RCU_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_RCU_FUNCTIONS(uint64_t)
+
+/**
+ * @brief Helper function to announce a reader, unless it is inside a read_lock already.
+ *
+ * Only the reader's own slot is written. The fence orders the announcement before the buffer pointer load.
+ *
+ * @param p_slot Slot of the reader.
+ * @param p_epoch The vector's global epoch.
+ * @return int 1 if the reader was announced already, 0 if it is now.
+ */
+static int rcu_reader_enter(vector_rcu_reader_slot_t *p_slot, size_t *p_epoch) {
+
+    if(VECTOR_ATOMIC_LOAD_SIZE(&p_slot->epoch) != 0) {
+        return 1;
+    }
+
+    VECTOR_ATOMIC_STORE_SIZE(&p_slot->epoch, VECTOR_ATOMIC_LOAD_SIZE(p_epoch));
+    VECTOR_ATOMIC_FENCE();
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to clear the announcement of a reader, after its last read of the buffer.
+ *
+ * @param p_slot Slot of the reader.
+ */
+static void rcu_reader_exit(vector_rcu_reader_slot_t *p_slot) {
+
+    VECTOR_ATOMIC_STORE_SIZE(&p_slot->epoch, 0);
+}
+
+/**
+ * @brief Helper function to find the oldest epoch a reader is reading in.
+ *
+ * @param p_slots The VECTOR_RCU_MAX_READERS reader slots.
+ * @return size_t The oldest announced epoch, SIZE_MAX if no reader is reading.
+ */
+static size_t rcu_oldest_epoch(vector_rcu_reader_slot_t *p_slots) {
+
+    size_t oldest = SIZE_MAX;
+
+    /* Pairs with the fence of rcu_reader_enter, after the new buffer and epoch were published. */
+    VECTOR_ATOMIC_FENCE();
+    for (size_t reader = 0; reader < VECTOR_RCU_MAX_READERS; reader++) {
+        size_t epoch = VECTOR_ATOMIC_LOAD_SIZE(&p_slots[reader].epoch);
+
+        if((epoch != 0) && (epoch < oldest)) {
+            oldest = epoch;
+        }
+    }
+
+    return oldest;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Helper function to allocate on a cache line boundary, so every reader slot has a line of its own.
+ *
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *rcu_aligned_alloc(size_t size) {
+
+    void *p_block = NULL;
+
+    if(posix_memalign(&p_block, VECTOR_CACHE_LINE_BYTES, size)) {
+        return NULL;
+    }
+
+    return p_block;
+}
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file vector_rcu.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Read-mostly vectors whose readers never lock and never write a shared cache line.
+ *
+ * The values live in a buffer that readers reach through one pointer. A reader announces the epoch it reads in
+ * on a cache line of its own, reads the buffer and clears its announcement, so gets from any number of threads
+ * never touch a line another thread writes except when a push lands. Writers take a mutex, append in place while
+ * the buffer has room, and on growth publish a copy in a new buffer. The old buffer is retired and freed once
+ * every reader has announced a later epoch or left, which the writers check without waiting.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_RCU_H_
+#define _VECTOR_RCU_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_wip.h" /* For VECTOR_MUTEX_TYPE */
+#include "vector_atomic.h" /* For VECTOR_CACHE_LINE_BYTES */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the number of reader slots of a vector, the max number of registered readers at once. */
+#ifndef VECTOR_RCU_MAX_READERS
+    #define VECTOR_RCU_MAX_READERS (64)
+#endif
+
+/** RCU vector virtual table definition macro. */
+#define VECTOR_RCU_VTBL_T(name, data_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, data_type value);                         /**< Push a value to the back of the vector */ \
+        int (*const get)(vector_##name##_t *vector, size_t reader, size_t index, data_type *out); /**< Get a value as a registered reader */ \
+        size_t (*const size)(vector_##name##_t *vector);                                       /**< Number of published values */ \
+    } vector_##name##_vtbl_t;
+
+/** RCU vector buffer definition macro. A buffer is one allocation, the values follow the header. */
+#define VECTOR_RCU_BUFFER_T(name, data_type) \
+    typedef struct _vector_##name##_buffer { \
+        size_t size;                                    /**< Number of published values */ \
+        size_t capacity;                                /**< Number of values the buffer has room for */ \
+        size_t retired_epoch;                           /**< Epoch the buffer was replaced in, 0 while current */ \
+        struct _vector_##name##_buffer *p_next_retired; /**< Next retired buffer, newest first */ \
+        data_type *data;                                /**< The values */ \
+    } vector_##name##_buffer_t;
+
+/** RCU vector structure definition macro. */
+#define VECTOR_RCU_T(name, data_type) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;                               /**< Pointer to the virtual table */ \
+        vector_##name##_buffer_t *p_buffer;                         /**< The current buffer, read by every reader */ \
+        size_t epoch;                                               /**< Global epoch, advanced on every retire, starts at 1 */ \
+        char padding_before[VECTOR_CACHE_LINE_BYTES];               /**< Keeps the writer state off the line readers read */ \
+        VECTOR_MUTEX_TYPE write_lock;                               /**< Serializes the writers */ \
+        vector_##name##_buffer_t *p_retired;                        /**< Retired buffers not freed yet, newest first */ \
+        size_t size;                                                /**< Number of published values, read by size without pinning a buffer */ \
+        char padding_after[VECTOR_CACHE_LINE_BYTES];                /**< Keeps the writer state off the reader slots */ \
+        vector_rcu_reader_slot_t readers[VECTOR_RCU_MAX_READERS];   /**< One slot per registered reader */ \
+    };
+
+/** RCU vector public function declarations macro. */
+#define VECTOR_RCU_PUBLIC_FUNCTIONS_DECLARE(name, data_type) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity); \
+    int vector_##name##_destroy(vector_##name##_t *vector); \
+    int vector_##name##_register_reader(vector_##name##_t *vector, size_t *out_reader); \
+    int vector_##name##_unregister_reader(vector_##name##_t *vector, size_t reader); \
+    const data_type *vector_##name##_read_lock(vector_##name##_t *vector, size_t reader, size_t *out_size); \
+    int vector_##name##_read_unlock(vector_##name##_t *vector, size_t reader); \
+    int vector_##name##_synchronize(vector_##name##_t *vector);
+
+/** RCU vector structure and virtual table definition macro. The type is vector_<data_type>_rcu_t. */
+#define VECTOR_RCU_DATA_STRUCTURE(data_type) \
+    typedef struct _vector_##data_type##_rcu vector_##data_type##_rcu_t; \
+    VECTOR_RCU_PUBLIC_FUNCTIONS_DECLARE(data_type##_rcu, data_type) \
+    VECTOR_RCU_VTBL_T(data_type##_rcu, data_type) \
+    VECTOR_RCU_BUFFER_T(data_type##_rcu, data_type) \
+    VECTOR_RCU_T(data_type##_rcu, data_type)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/**
+ * @brief Announcement of one reader, alone on its cache line.
+ *
+ */
+typedef struct _vector_rcu_reader_slot {
+    size_t epoch;                                               /**< Epoch the reader entered in, 0 while it is not reading */
+    size_t in_use;                                              /**< 1 while the slot belongs to a registered reader */
+    char padding[VECTOR_CACHE_LINE_BYTES - 2 * sizeof(size_t)]; /**< Fills the cache line */
+} vector_rcu_reader_slot_t;
+
+VECTOR_RCU_DATA_STRUCTURE(int)
+VECTOR_RCU_DATA_STRUCTURE(double)
+VECTOR_RCU_DATA_STRUCTURE(char)
+VECTOR_RCU_DATA_STRUCTURE(uint8_t)
+VECTOR_RCU_DATA_STRUCTURE(uint16_t)
+VECTOR_RCU_DATA_STRUCTURE(uint32_t)
+VECTOR_RCU_DATA_STRUCTURE(uint64_t)
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, e.g. with vector_uint64_t_rcu_t *p_values = vector_uint64_t_rcu_create(0):
+    register_reader   - Once per reading thread, gives the reader number the reads take. Fails (-1) when all
+                        VECTOR_RCU_MAX_READERS slots are taken. unregister_reader gives the slot back.
+    get               - Any number of registered readers at once, never blocks. Fails (-1) for an index past size.
+                        A reader number is used by one thread at a time.
+    read_lock/unlock  - Pin the current buffer for a scan, read_lock returns the values and their number. The
+                        pointer stays valid until read_unlock, which should come soon since it holds back freeing.
+                        get may be called in between.
+    push              - Any number of threads, they take turns. Never waits for readers.
+    size              - Number of published values.
+    synchronize       - Wait until every reader is out of the buffers retired so far and free them.
+    destroy           - Only once no other thread uses the vector.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_RCU_H_ */
@@ -0,0 +1,371 @@
+/**
+ * @file vector_ring.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Bounded lock-free ring buffers for handing values between threads.
+ *
+ * RING_BUFFER(data_type) generates two queues of data_type values with a power of two capacity:
+ * ring_<data_type>_spsc_t for one producer and one consumer, where both sides are wait-free, and
+ * ring_<data_type>_mpmc_t for any number of producers and consumers (Dmitry Vyukov's bounded queue), where
+ * every value slot carries a sequence number that tells producers and consumers whose turn it is. The indices
+ * the producers and the consumers advance sit on cache lines of their own, and the SPSC sides each keep a
+ * private copy of the other side's index so they only read the shared one when the copy says full or empty.
+ * All functions are static inline in the header.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_RING_H_
+#define _VECTOR_RING_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include <string.h> /* For memcpy */
+#include "vector_allocator.h" /* For vector_allocator_t */
+#include "vector_atomic.h" /* For the atomic operations and VECTOR_CACHE_LINE_BYTES */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the smallest capacity of a ring buffer, the MPMC sequence numbers need two slots. */
+#define RING_BUFFER_MIN_CAPACITY (2)
+
+/** Ring buffer virtual table definition macro, shared by both kinds. */
+#define RING_BUFFER_VTBL_T(name, data_type) \
+    typedef struct _ring_##name##_vtbl { \
+        int (*const enqueue)(ring_##name##_t *ring, data_type value);                             /**< Add a value, -1 when full */ \
+        int (*const dequeue)(ring_##name##_t *ring, data_type *out);                              /**< Take the oldest value, -1 when empty */ \
+        size_t (*const enqueue_batch)(ring_##name##_t *ring, const data_type *values, size_t count); /**< Add up to count values, gives the number added */ \
+        size_t (*const dequeue_batch)(ring_##name##_t *ring, data_type *out, size_t count);       /**< Take up to count values, gives the number taken */ \
+        size_t (*const size)(ring_##name##_t *ring);                                              /**< Number of values queued, a snapshot */ \
+    } ring_##name##_vtbl_t;
+
+/** SPSC ring buffer structure definition macro. Each index has a cache line, shared with the other side's copy. */
+#define RING_BUFFER_SPSC_T(name, data_type) \
+    struct _ring_##name { \
+        ring_##name##_vtbl_t *vptr;                                     /**< Pointer to the virtual table */ \
+        data_type *data;                                                /**< The value slots */ \
+        size_t mask;                                                    /**< Capacity - 1 */ \
+        const vector_allocator_t *allocator;                            /**< Allocator of the ring and its slots */ \
+        char padding_before[VECTOR_CACHE_LINE_BYTES];                   /**< Keeps the indices off the read-only fields */ \
+        size_t head;                                                    /**< Next slot the consumer takes */ \
+        size_t cached_tail;                                             /**< The consumer's copy of tail */ \
+        char padding_middle[VECTOR_CACHE_LINE_BYTES - 2 * sizeof(size_t)]; /**< Keeps the sides apart */ \
+        size_t tail;                                                    /**< Next slot the producer fills */ \
+        size_t cached_head;                                             /**< The producer's copy of head */ \
+        char padding_after[VECTOR_CACHE_LINE_BYTES - 2 * sizeof(size_t)]; /**< Keeps the producer off whatever follows */ \
+    };
+
+/** MPMC ring buffer slot definition macro, a value and the sequence number of its turn. */
+#define RING_BUFFER_MPMC_SLOT_T(name, data_type) \
+    typedef struct _ring_##name##_slot { \
+        size_t sequence;                                                /**< Position of the next enqueue, or + 1 of the next dequeue */ \
+        data_type value;                                                /**< The value */ \
+    } ring_##name##_slot_t;
+
+/** MPMC ring buffer structure definition macro. */
+#define RING_BUFFER_MPMC_T(name, data_type) \
+    struct _ring_##name { \
+        ring_##name##_vtbl_t *vptr;                                     /**< Pointer to the virtual table */ \
+        ring_##name##_slot_t *slots;                                    /**< The value slots */ \
+        size_t mask;                                                    /**< Capacity - 1 */ \
+        const vector_allocator_t *allocator;                            /**< Allocator of the ring and its slots */ \
+        char padding_before[VECTOR_CACHE_LINE_BYTES];                   /**< Keeps the positions off the read-only fields */ \
+        size_t enqueue_position;                                        /**< Position the producers claim next */ \
+        char padding_middle[VECTOR_CACHE_LINE_BYTES - sizeof(size_t)];  /**< Keeps the producers and consumers apart */ \
+        size_t dequeue_position;                                        /**< Position the consumers claim next */ \
+        char padding_after[VECTOR_CACHE_LINE_BYTES - sizeof(size_t)];   /**< Keeps the consumers off whatever follows */ \
+    };
+
+/** Ring buffer create and destroy macro, shared by both kinds. slots_field is the slot array, of slot_type. */
+#define RING_BUFFER_LIFETIME_FUNCS(name, slot_type, slots_field) \
+    /** Create a ring with room for capacity values rounded up to a power of two, from allocator, NULL for the default. */ \
+    static inline ring_##name##_t *ring_##name##_create_with_allocator(size_t capacity, const vector_allocator_t *allocator) { \
+        ring_##name##_t *ring = NULL; \
+        size_t rounded = RING_BUFFER_MIN_CAPACITY; \
+        if (capacity > (SIZE_MAX / 2) / sizeof(slot_type)) { \
+            return NULL; \
+        } \
+        while (rounded < capacity) { \
+            rounded *= 2; \
+        } \
+        if (allocator == NULL) { \
+            allocator = vector_allocator_default(); \
+        } \
+        ring = (ring_##name##_t *)allocator->alloc(allocator->p_context, sizeof(ring_##name##_t)); \
+        if (ring == NULL) { \
+            return NULL; \
+        } \
+        memset(ring, 0, sizeof(ring_##name##_t)); \
+        ring->vptr = &ring_##name##_vtable; \
+        ring->mask = rounded - 1; \
+        ring->allocator = allocator; \
+        ring->slots_field = (slot_type *)allocator->alloc(allocator->p_context, rounded * sizeof(slot_type)); \
+        if (ring->slots_field == NULL) { \
+            allocator->free(allocator->p_context, ring, sizeof(ring_##name##_t)); \
+            return NULL; \
+        } \
+        ring_##name##_init_slots(ring, rounded); \
+        return ring; \
+    } \
+    /** Create a ring with room for capacity values rounded up to a power of two. */ \
+    static inline ring_##name##_t *ring_##name##_create(size_t capacity) { \
+        return ring_##name##_create_with_allocator(capacity, NULL); \
+    } \
+    /** Destroy a ring, once no other thread uses it. */ \
+    static inline int ring_##name##_destroy(ring_##name##_t *ring) { \
+        const vector_allocator_t *allocator = NULL; \
+        if (ring == NULL) { \
+            return -1; \
+        } \
+        allocator = ring->allocator; \
+        allocator->free(allocator->p_context, ring->slots_field, (ring->mask + 1) * sizeof(slot_type)); \
+        allocator->free(allocator->p_context, ring, sizeof(ring_##name##_t)); \
+        return 0; \
+    } \
+    /** Number of values the ring holds when full. */ \
+    static inline size_t ring_##name##_capacity(const ring_##name##_t *ring) { \
+        return ring->mask + 1; \
+    }
+
+/** SPSC ring buffer functions macro. */
+#define RING_BUFFER_SPSC_FUNCS(name, data_type) \
+    /** Copy count values into the slots from index on, wrapping around the end. */ \
+    static inline void ring_##name##_copy_in(ring_##name##_t *ring, size_t index, const data_type *values, size_t count) { \
+        size_t first = ring->mask + 1 - (index & ring->mask); \
+        if (first > count) { \
+            first = count; \
+        } \
+        memcpy(&ring->data[index & ring->mask], values, first * sizeof(data_type)); \
+        memcpy(ring->data, values + first, (count - first) * sizeof(data_type)); \
+    } \
+    /** Copy count values out of the slots from index on, wrapping around the end. */ \
+    static inline void ring_##name##_copy_out(ring_##name##_t *ring, size_t index, data_type *out, size_t count) { \
+        size_t first = ring->mask + 1 - (index & ring->mask); \
+        if (first > count) { \
+            first = count; \
+        } \
+        memcpy(out, &ring->data[index & ring->mask], first * sizeof(data_type)); \
+        memcpy(out + first, ring->data, (count - first) * sizeof(data_type)); \
+    } \
+    /** Add up to count values, only from the one producer thread. The shared head is read only when the copy says full. */ \
+    static inline size_t ring_##name##_enqueue_batch(ring_##name##_t *ring, const data_type *values, size_t count) { \
+        size_t tail = ring->tail; \
+        size_t room = ring->mask + 1 - (tail - ring->cached_head); \
+        if (room < count) { \
+            ring->cached_head = VECTOR_ATOMIC_LOAD_SIZE(&ring->head); \
+            room = ring->mask + 1 - (tail - ring->cached_head); \
+            count = (room < count) ? room : count; \
+        } \
+        if (count > 0) { \
+            ring_##name##_copy_in(ring, tail, values, count); \
+            VECTOR_ATOMIC_STORE_SIZE(&ring->tail, tail + count); \
+        } \
+        return count; \
+    } \
+    /** Take up to count values, only from the one consumer thread. The shared tail is read only when the copy says empty. */ \
+    static inline size_t ring_##name##_dequeue_batch(ring_##name##_t *ring, data_type *out, size_t count) { \
+        size_t head = ring->head; \
+        size_t queued = ring->cached_tail - head; \
+        if (queued < count) { \
+            ring->cached_tail = VECTOR_ATOMIC_LOAD_SIZE(&ring->tail); \
+            queued = ring->cached_tail - head; \
+            count = (queued < count) ? queued : count; \
+        } \
+        if (count > 0) { \
+            ring_##name##_copy_out(ring, head, out, count); \
+            VECTOR_ATOMIC_STORE_SIZE(&ring->head, head + count); \
+        } \
+        return count; \
+    } \
+    static inline int ring_##name##_enqueue(ring_##name##_t *ring, data_type value) { \
+        size_t tail = ring->tail; \
+        if (tail - ring->cached_head > ring->mask) { \
+            ring->cached_head = VECTOR_ATOMIC_LOAD_SIZE(&ring->head); \
+            if (tail - ring->cached_head > ring->mask) { \
+                return -1; \
+            } \
+        } \
+        ring->data[tail & ring->mask] = value; \
+        VECTOR_ATOMIC_STORE_SIZE(&ring->tail, tail + 1); \
+        return 0; \
+    } \
+    static inline int ring_##name##_dequeue(ring_##name##_t *ring, data_type *out) { \
+        size_t head = ring->head; \
+        if (head == ring->cached_tail) { \
+            ring->cached_tail = VECTOR_ATOMIC_LOAD_SIZE(&ring->tail); \
+            if (head == ring->cached_tail) { \
+                return -1; \
+            } \
+        } \
+        *out = ring->data[head & ring->mask]; \
+        VECTOR_ATOMIC_STORE_SIZE(&ring->head, head + 1); \
+        return 0; \
+    } \
+    static inline size_t ring_##name##_size(ring_##name##_t *ring) { \
+        size_t head = VECTOR_ATOMIC_LOAD_SIZE(&ring->head); \
+        return VECTOR_ATOMIC_LOAD_SIZE(&ring->tail) - head; \
+    } \
+    static inline int ring_##name##_init_slots(ring_##name##_t *ring, size_t capacity) { \
+        (void)ring; \
+        (void)capacity; \
+        return 0; \
+    }
+
+/** MPMC ring buffer functions macro. */
+#define RING_BUFFER_MPMC_FUNCS(name, data_type) \
+    /** Add up to count values from any thread. Claims the run of free slots at the enqueue position with one CAS. */ \
+    static inline size_t ring_##name##_enqueue_batch(ring_##name##_t *ring, const data_type *values, size_t count) { \
+        size_t position = VECTOR_ATOMIC_LOAD_SIZE(&ring->enqueue_position); \
+        size_t claimed = 0; \
+        for (;;) { \
+            claimed = 0; \
+            while (claimed < count && \
+                   VECTOR_ATOMIC_LOAD_SIZE(&ring->slots[(position + claimed) & ring->mask].sequence) == position + claimed) { \
+                claimed++; \
+            } \
+            if (claimed == 0) { \
+                /* The slot of the position is not free: full if it still holds the previous lap, else it moved on. */ \
+                size_t sequence = VECTOR_ATOMIC_LOAD_SIZE(&ring->slots[position & ring->mask].sequence); \
+                if ((intptr_t)(sequence - position) < 0) { \
+                    return 0; \
+                } \
+            } \
+            else if (VECTOR_ATOMIC_CAS_SIZE(&ring->enqueue_position, position, position + claimed)) { \
+                break; \
+            } \
+            position = VECTOR_ATOMIC_LOAD_SIZE(&ring->enqueue_position); \
+        } \
+        for (size_t index = 0; index < claimed; index++) { \
+            ring_##name##_slot_t *p_slot = &ring->slots[(position + index) & ring->mask]; \
+            p_slot->value = values[index]; \
+            VECTOR_ATOMIC_STORE_SIZE(&p_slot->sequence, position + index + 1); \
+        } \
+        return claimed; \
+    } \
+    /** Take up to count values from any thread. Claims the run of full slots at the dequeue position with one CAS. */ \
+    static inline size_t ring_##name##_dequeue_batch(ring_##name##_t *ring, data_type *out, size_t count) { \
+        size_t position = VECTOR_ATOMIC_LOAD_SIZE(&ring->dequeue_position); \
+        size_t claimed = 0; \
+        for (;;) { \
+            claimed = 0; \
+            while (claimed < count && \
+                   VECTOR_ATOMIC_LOAD_SIZE(&ring->slots[(position + claimed) & ring->mask].sequence) == position + claimed + 1) { \
+                claimed++; \
+            } \
+            if (claimed == 0) { \
+                /* The slot of the position is not full: empty if it is still waiting for this lap, else it moved on. */ \
+                size_t sequence = VECTOR_ATOMIC_LOAD_SIZE(&ring->slots[position & ring->mask].sequence); \
+                if ((intptr_t)(sequence - (position + 1)) < 0) { \
+                    return 0; \
+                } \
+            } \
+            else if (VECTOR_ATOMIC_CAS_SIZE(&ring->dequeue_position, position, position + claimed)) { \
+                break; \
+            } \
+            position = VECTOR_ATOMIC_LOAD_SIZE(&ring->dequeue_position); \
+        } \
+        for (size_t index = 0; index < claimed; index++) { \
+            ring_##name##_slot_t *p_slot = &ring->slots[(position + index) & ring->mask]; \
+            out[index] = p_slot->value; \
+            /* Hands the slot to the producer of the next lap. */ \
+            VECTOR_ATOMIC_STORE_SIZE(&p_slot->sequence, position + index + ring->mask + 1); \
+        } \
+        return claimed; \
+    } \
+    static inline int ring_##name##_enqueue(ring_##name##_t *ring, data_type value) { \
+        return (ring_##name##_enqueue_batch(ring, &value, 1) == 1) ? 0 : -1; \
+    } \
+    static inline int ring_##name##_dequeue(ring_##name##_t *ring, data_type *out) { \
+        return (ring_##name##_dequeue_batch(ring, out, 1) == 1) ? 0 : -1; \
+    } \
+    static inline size_t ring_##name##_size(ring_##name##_t *ring) { \
+        size_t dequeue_position = VECTOR_ATOMIC_LOAD_SIZE(&ring->dequeue_position); \
+        size_t enqueue_position = VECTOR_ATOMIC_LOAD_SIZE(&ring->enqueue_position); \
+        return ((intptr_t)(enqueue_position - dequeue_position) > 0) ? enqueue_position - dequeue_position : 0; \
+    } \
+    /** Give every slot the sequence number of its first enqueue. */ \
+    static inline int ring_##name##_init_slots(ring_##name##_t *ring, size_t capacity) { \
+        for (size_t index = 0; index < capacity; index++) { \
+            ring->slots[index].sequence = index; \
+        } \
+        return 0; \
+    }
+
+/** Ring buffer virtual table initialization macro, shared by both kinds. */
+#define RING_BUFFER_VTABLE_INIT(name) \
+    static ring_##name##_vtbl_t ring_##name##_vtable = { \
+        .enqueue = ring_##name##_enqueue, \
+        .dequeue = ring_##name##_dequeue, \
+        .enqueue_batch = ring_##name##_enqueue_batch, \
+        .dequeue_batch = ring_##name##_dequeue_batch, \
+        .size = ring_##name##_size, \
+    };
+
+/** SPSC ring buffer definition macro for a ring named ring_<name>_t holding data_type values. */
+#define RING_BUFFER_SPSC(name, data_type) \
+    typedef struct _ring_##name ring_##name##_t; \
+    RING_BUFFER_VTBL_T(name, data_type) \
+    RING_BUFFER_SPSC_T(name, data_type) \
+    RING_BUFFER_SPSC_FUNCS(name, data_type) \
+    RING_BUFFER_VTABLE_INIT(name) \
+    RING_BUFFER_LIFETIME_FUNCS(name, data_type, data)
+
+/** MPMC ring buffer definition macro for a ring named ring_<name>_t holding data_type values. */
+#define RING_BUFFER_MPMC(name, data_type) \
+    typedef struct _ring_##name ring_##name##_t; \
+    RING_BUFFER_VTBL_T(name, data_type) \
+    RING_BUFFER_MPMC_SLOT_T(name, data_type) \
+    RING_BUFFER_MPMC_T(name, data_type) \
+    RING_BUFFER_MPMC_FUNCS(name, data_type) \
+    RING_BUFFER_VTABLE_INIT(name) \
+    RING_BUFFER_LIFETIME_FUNCS(name, ring_##name##_slot_t, slots)
+
+/**
+ * Ring buffer definition macro for both kinds of a named type, ring_<name>_spsc_t and ring_<name>_mpmc_t. Use it
+ * for struct types or types whose name is not a single identifier.
+ */
+#define RING_BUFFER_WITH_NAME(name, data_type) \
+    RING_BUFFER_SPSC(name##_spsc, data_type) \
+    RING_BUFFER_MPMC(name##_mpmc, data_type)
+
+/** Ring buffer definition macro, generates ring_<data_type>_spsc_t and ring_<data_type>_mpmc_t. */
+#define RING_BUFFER(data_type) \
+    RING_BUFFER_WITH_NAME(data_type, data_type)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, at file scope:
+    RING_BUFFER(uint64_t)
+then:
+    ring_uint64_t_spsc_t *p_samples = ring_uint64_t_spsc_create(1024);
+    producer: while (p_samples->vptr->enqueue(p_samples, sample)) { wait or drop }
+    consumer: if (p_samples->vptr->dequeue(p_samples, &sample) == 0) { use sample }
+    ring_uint64_t_spsc_destroy(p_samples);
+    The SPSC ring takes one producer thread and one consumer thread at a time, the MPMC ring any number of each.
+    The batch functions move as many values as fit or are queued, from 0 to count, and give that number.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_RING_H_ */
@@ -0,0 +1,362 @@
+/**
+* @file vector_sharded.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Sharded vectors that many threads push into without locking, merged into one vector on demand.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_sharded.h" /* Used to expose the sharded vector API. */
+#include "vector_atomic.h" /* Used for the shard ownership and the shard sizes. */
+#include "vector_sort.h" /* Used for VECTOR_SORT_MAX_THREADS */
+#include "vector_thread_pool.h" /* Used to run the collect copy on the shared thread pool and for the number of CPUs. */
+#include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memcpy and memset */
+
+/* If Windows */
+#ifdef _WIN32
+    #include <malloc.h> /* Used for _aligned_malloc */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the capacity an empty shard grows to on its first push. */
+#define SHARDED_MIN_CAPACITY    (16)
+/** definition for the least number of bytes worth a copy thread of their own. */
+#define SHARDED_MIN_COPY_BYTES  ((size_t)1 << 20)
+/** definition for the max number of threads collect copies on, more are clamped. */
+#define SHARDED_MAX_THREADS     (VECTOR_SORT_MAX_THREADS)
+
+/** Allocate size bytes from an allocator. */
+#define SHARDED_ALLOC(allocator, size) ((allocator)->alloc((allocator)->p_context, (size)))
+/** Resize a block of an allocator from old_size to new_size bytes. */
+#define SHARDED_REALLOC(allocator, p_block, old_size, new_size) ((allocator)->realloc((allocator)->p_context, (p_block), (old_size), (new_size)))
+/** Release a block of old_size bytes to an allocator. */
+#define SHARDED_FREE(allocator, p_block, size) ((allocator)->free((allocator)->p_context, (p_block), (size)))
+
+/* If Windows */
+#ifdef _WIN32
+    #define SHARDED_ALIGNED_ALLOC(size) _aligned_malloc((size), VECTOR_CACHE_LINE_BYTES)
+    #define SHARDED_ALIGNED_FREE(p_block) _aligned_free((p_block))
+#else /* If POSIX-like system */
+    #define SHARDED_ALIGNED_ALLOC(size) sharded_aligned_alloc((size))
+    #define SHARDED_ALIGNED_FREE(p_block) free((p_block))
+#endif
+
+/** Sharded vector virtual table definition macro. */
+#define VECTOR_SHARDED_VTABLE_INIT(name) \
+static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .size = vector_##name##_size, \
+        .clear = vector_##name##_clear, \
+};
+
+/** Sharded vector function declarations macro. */
+#define VECTOR_SHARDED_STATIC_FUNCTIONS_DECLARE(name, data_type) \
+    static int vector_##name##_push(vector_##name##_t *vector, size_t shard, data_type value); \
+    static size_t vector_##name##_size(vector_##name##_t *vector); \
+    static int vector_##name##_clear(vector_##name##_t *vector);
+
+/** Macro to generate sharded vector create functions */
+#define GENERIC_VECTOR_SHARDED_CREATE_FUNCS(name, data_type) \
+    vector_##name##_t *vector_##name##_create_with_allocator(const vector_allocator_t *allocator) { \
+        vector_##name##_t *vector = (vector_##name##_t *)SHARDED_ALIGNED_ALLOC(sizeof(vector_##name##_t)); \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        memset(vector, 0, sizeof(vector_##name##_t)); \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->allocator = (allocator != NULL) ? allocator : vector_allocator_default(); \
+        return vector; \
+    } \
+    vector_##name##_t *vector_##name##_create(void) { \
+        return vector_##name##_create_with_allocator(NULL); \
+    }
+
+/** Macro to generate sharded vector destroy function */
+#define GENERIC_VECTOR_SHARDED_DESTROY_FUNC(name, data_type) \
+    int vector_##name##_destroy(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            if (vector->shards[shard].data != NULL) { \
+                SHARDED_FREE(vector->allocator, vector->shards[shard].data, vector->shards[shard].capacity * sizeof(data_type)); \
+            } \
+        } \
+        SHARDED_ALIGNED_FREE(vector); \
+        return 0; \
+    }
+
+/** Macro to generate the sharded vector shard ownership functions */
+#define GENERIC_VECTOR_SHARDED_SHARD_FUNCS(name, data_type) \
+    int vector_##name##_acquire_shard(vector_##name##_t *vector, size_t *out_shard) { \
+        if (vector == NULL || out_shard == NULL) { \
+            return -1; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            if (VECTOR_ATOMIC_LOAD_SIZE(&vector->shards[shard].in_use) == 0 && \
+                VECTOR_ATOMIC_CAS_SIZE(&vector->shards[shard].in_use, 0, 1)) { \
+                *out_shard = shard; \
+                return 0; \
+            } \
+        } \
+        return -1; \
+    } \
+    int vector_##name##_release_shard(vector_##name##_t *vector, size_t shard) { \
+        if (vector == NULL || shard >= VECTOR_SHARDED_MAX_SHARDS) { \
+            return -1; \
+        } \
+        VECTOR_ATOMIC_STORE_SIZE(&vector->shards[shard].in_use, 0); \
+        return 0; \
+    }
+
+/** Macro to generate sharded vector push function */
+#define GENERIC_VECTOR_SHARDED_PUSH_FUNC(name, data_type) \
+    int vector_##name##_push(vector_##name##_t *vector, size_t shard, data_type value) { \
+        vector_##name##_shard_t *p_shard = NULL; \
+        if (vector == NULL || shard >= VECTOR_SHARDED_MAX_SHARDS) { \
+            return -1; \
+        } \
+        p_shard = &vector->shards[shard]; \
+        if (p_shard->size >= p_shard->capacity) { \
+            size_t new_capacity = (p_shard->capacity < SHARDED_MIN_CAPACITY) ? SHARDED_MIN_CAPACITY : p_shard->capacity * 2; \
+            data_type *new_data = NULL; \
+            if (p_shard->capacity > (SIZE_MAX / sizeof(data_type)) / 2) { \
+                return -1; \
+            } \
+            new_data = (data_type *)((p_shard->data == NULL) ? \
+                SHARDED_ALLOC(vector->allocator, new_capacity * sizeof(data_type)) : \
+                SHARDED_REALLOC(vector->allocator, p_shard->data, p_shard->capacity * sizeof(data_type), new_capacity * sizeof(data_type))); \
+            if (new_data == NULL) { \
+                return -1; \
+            } \
+            p_shard->data = new_data; \
+            p_shard->capacity = new_capacity; \
+        } \
+        p_shard->data[p_shard->size] = value; \
+        /* A release store is a plain store on x86, and lets size read the shards of other threads. */ \
+        VECTOR_ATOMIC_STORE_SIZE(&p_shard->size, p_shard->size + 1); \
+        return 0; \
+    }
+
+/** Macro to generate sharded vector size and clear functions */
+#define GENERIC_VECTOR_SHARDED_SIZE_FUNCS(name, data_type) \
+    size_t vector_##name##_size(vector_##name##_t *vector) { \
+        size_t size = 0; \
+        if (vector == NULL) { \
+            return 0; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            size += VECTOR_ATOMIC_LOAD_SIZE(&vector->shards[shard].size); \
+        } \
+        return size; \
+    } \
+    int vector_##name##_clear(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            VECTOR_ATOMIC_STORE_SIZE(&vector->shards[shard].size, 0); \
+        } \
+        return 0; \
+    }
+
+/** Macro to generate sharded vector collect function */
+#define GENERIC_VECTOR_SHARDED_COLLECT_FUNC(name, data_type) \
+    vector_##data_type##_t *vector_##name##_collect(vector_##name##_t *vector, unsigned int threads) { \
+        sharded_copy_t copy; \
+        vector_##data_type##_t *p_collected = NULL; \
+        size_t total = 0; \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            copy.p_sources[shard] = vector->shards[shard].data; \
+            copy.bytes[shard] = vector->shards[shard].size * sizeof(data_type); \
+            total += vector->shards[shard].size; \
+        } \
+        p_collected = vector_##data_type##_create_with_allocator(total, vector->allocator); \
+        if (p_collected == NULL) { \
+            return NULL; \
+        } \
+        copy.p_destination = (unsigned char *)p_collected->data; \
+        copy.total = total * sizeof(data_type); \
+        copy.threads = sharded_threads(threads, copy.total); \
+        sharded_run_copy(&copy); \
+        p_collected->size = total; \
+        return p_collected; \
+    }
+
+/** Macro to generate sharded vector for each function */
+#define GENERIC_VECTOR_SHARDED_FOR_EACH_FUNC(name, data_type) \
+    int vector_##name##_for_each(vector_##name##_t *vector, vector_##name##_visit_t visit, void *p_context) { \
+        if (vector == NULL || visit == NULL) { \
+            return -1; \
+        } \
+        for (size_t shard = 0; shard < VECTOR_SHARDED_MAX_SHARDS; shard++) { \
+            int rv = 0; \
+            if (vector->shards[shard].size == 0) { \
+                continue; \
+            } \
+            rv = visit(vector->shards[shard].data, vector->shards[shard].size, shard, p_context); \
+            if (rv != 0) { \
+                return rv; \
+            } \
+        } \
+        return 0; \
+    }
+
+/** Macro to generate the functions of vector_<data_type>_sharded_t */
+#define GENERIC_VECTOR_SHARDED_FUNCTIONS(data_type) \
+    VECTOR_SHARDED_STATIC_FUNCTIONS_DECLARE(data_type##_sharded, data_type) \
+    VECTOR_SHARDED_VTABLE_INIT(data_type##_sharded) \
+    GENERIC_VECTOR_SHARDED_CREATE_FUNCS(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_DESTROY_FUNC(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_SHARD_FUNCS(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_PUSH_FUNC(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_SIZE_FUNCS(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_COLLECT_FUNC(data_type##_sharded, data_type) \
+    GENERIC_VECTOR_SHARDED_FOR_EACH_FUNC(data_type##_sharded, data_type)
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/**
+ * @brief A collect copy. The shards are laid end to end in the destination, and every thread copies an
+ * equal slice of the destination bytes from whichever shards it spans.
+ *
+ */
+typedef struct _sharded_copy {
+    const void *p_sources[VECTOR_SHARDED_MAX_SHARDS];   /**< Values of every shard */
+    size_t bytes[VECTOR_SHARDED_MAX_SHARDS];            /**< Bytes of every shard */
+    unsigned char *p_destination;                       /**< Where the shards go */
+    size_t total;                                       /**< Bytes of all shards */
+    unsigned int threads;                               /**< Number of slices */
+} sharded_copy_t;
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static unsigned int sharded_threads(unsigned int threads, size_t bytes);
+static void sharded_copy_slice(const sharded_copy_t *p_copy, unsigned int thread);
+static void sharded_copy_task(size_t begin, size_t end, void *p_arg);
+static void sharded_run_copy(const sharded_copy_t *p_copy);
+#ifndef _WIN32
+static void *sharded_aligned_alloc(size_t size);
+#endif
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+GENERIC_VECTOR_SHARDED_FUNCTIONS(int)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(double)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(char)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_SHARDED_FUNCTIONS(uint64_t)
+
+/**
+ * @brief Number of threads a collect of bytes bytes copies on.
+ *
+ * @param threads Requested number of threads, 0 for one per CPU.
+ * @param bytes Number of bytes to copy.
+ * @return unsigned int threads, clamped so every thread copies at least SHARDED_MIN_COPY_BYTES. At least 1.
+ */
+static unsigned int sharded_threads(unsigned int threads, size_t bytes) {
+
+    size_t useful = bytes / SHARDED_MIN_COPY_BYTES;
+
+    if(threads == 0) {
+        threads = vector_thread_pool_cpu_count();
+    }
+    if(threads > SHARDED_MAX_THREADS) {
+        threads = SHARDED_MAX_THREADS;
+    }
+    if(useful < threads) {
+        threads = (useful > 0) ? (unsigned int)useful : 1u;
+    }
+
+    return threads;
+}
+
+/**
+ * @brief Copy one slice of the destination, slices differ in size by at most one byte.
+ *
+ * @param p_copy The copy.
+ * @param thread The slice.
+ */
+static void sharded_copy_slice(const sharded_copy_t *p_copy, unsigned int thread) {
+
+    size_t remainder = p_copy->total % p_copy->threads;
+    size_t begin = (p_copy->total / p_copy->threads) * thread + ((thread < remainder) ? thread : remainder);
+    size_t end = begin + (p_copy->total / p_copy->threads) + ((thread < remainder) ? 1 : 0);
+    size_t shard_begin = 0;
+
+    for (size_t shard = 0; (shard < VECTOR_SHARDED_MAX_SHARDS) && (shard_begin < end); shard++) {
+        size_t shard_end = shard_begin + p_copy->bytes[shard];
+
+        if((shard_end > begin) && (p_copy->bytes[shard] != 0)) {
+            size_t from = (begin > shard_begin) ? begin : shard_begin;
+            size_t to = (end < shard_end) ? end : shard_end;
+
+            memcpy(p_copy->p_destination + from, (const unsigned char *)p_copy->p_sources[shard] + (from - shard_begin), to - from);
+        }
+        shard_begin = shard_end;
+    }
+}
+
+/**
+ * @brief Helper function to copy the slices [begin, end), a task of the thread pool.
+ *
+ * @param begin First slice.
+ * @param end Slice after the last one.
+ * @param p_arg The sharded_copy_t of the copy.
+ */
+static void sharded_copy_task(size_t begin, size_t end, void *p_arg) {
+
+    const sharded_copy_t *p_copy = (const sharded_copy_t *)p_arg;
+
+    for (size_t thread = begin; thread < end; thread++) {
+        sharded_copy_slice(p_copy, (unsigned int)thread);
+    }
+}
+
+/**
+ * @brief Copy every slice on the shared thread pool, and wait for all of them.
+ *
+ * The calling thread copies slices too. Without a pool, or when every pool thread is busy, the slices are
+ * copied on the calling thread, so the copy always completes, just with less parallelism.
+ *
+ * @param p_copy The copy.
+ */
+static void sharded_run_copy(const sharded_copy_t *p_copy) {
+
+    (void)vector_thread_pool_for(p_copy->threads, 1, sharded_copy_task, (void *)p_copy);
+}
+
+#ifndef _WIN32
+/**
+ * @brief Helper function to allocate on a cache line boundary, so every shard has a line of its own.
+ *
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *sharded_aligned_alloc(size_t size) {
+
+    void *p_block = NULL;
+
+    if(posix_memalign(&p_block, VECTOR_CACHE_LINE_BYTES, size)) {
+        return NULL;
+    }
+
+    return p_block;
+}
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file vector_sharded.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Sharded vectors that many threads push into without locking, merged into one vector on demand.
+ *
+ * Every thread takes a shard of its own and pushes into it like into an unlocked vector. The shards sit on
+ * separate cache lines, so pushes of different threads never touch the same line. Once the threads are done,
+ * collect concatenates the shards into a regular vector with the copy split across threads, and for_each
+ * visits the values of every shard where they are.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_SHARDED_H_
+#define _VECTOR_SHARDED_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_wip.h" /* For the vectors collect creates */
+#include "vector_atomic.h" /* For VECTOR_CACHE_LINE_BYTES */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the number of shards of a vector, the max number of pushing threads at once. */
+#ifndef VECTOR_SHARDED_MAX_SHARDS
+    #define VECTOR_SHARDED_MAX_SHARDS (64)
+#endif
+
+/** Sharded vector virtual table definition macro. */
+#define VECTOR_SHARDED_VTBL_T(name, data_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, size_t shard, data_type value); /**< Push a value to the back of a shard the caller acquired */ \
+        size_t (*const size)(vector_##name##_t *vector);                             /**< Number of values in all shards */ \
+        int (*const clear)(vector_##name##_t *vector);                               /**< Remove every value, keeping the capacity */ \
+    } vector_##name##_vtbl_t;
+
+/** Sharded vector shard definition macro. A shard fills one cache line. */
+#define VECTOR_SHARDED_SHARD_T(name, data_type) \
+    typedef struct _vector_##name##_shard { \
+        data_type *data;                                                        /**< The values of the shard */ \
+        size_t size;                                                            /**< Number of values in the shard */ \
+        size_t capacity;                                                        /**< Number of values the shard has room for */ \
+        size_t in_use;                                                          /**< 1 while a thread owns the shard */ \
+        char padding[VECTOR_CACHE_LINE_BYTES - sizeof(void *) - 3 * sizeof(size_t)]; /**< Fills the cache line */ \
+    } vector_##name##_shard_t;
+
+/** Sharded vector structure definition macro. The vector is allocated on a cache line so the shards start on one. */
+#define VECTOR_SHARDED_T(name, data_type) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;                                       /**< Pointer to the virtual table */ \
+        const vector_allocator_t *allocator;                                /**< Allocator of the shard data and the collected vectors, not of this aligned struct */ \
+        char padding[VECTOR_CACHE_LINE_BYTES - 2 * sizeof(void *)];         /**< Fills the first cache line */ \
+        vector_##name##_shard_t shards[VECTOR_SHARDED_MAX_SHARDS];          /**< The shards */ \
+    };
+
+/**
+ * Sharded vector public function declarations macro. The visit function of for_each gets the values of one
+ * shard and returns 0 to go on with the next shard, anything else stops for_each with that value.
+ */
+#define VECTOR_SHARDED_PUBLIC_FUNCTIONS_DECLARE(name, data_type) \
+    typedef int (*vector_##name##_visit_t)(const data_type *values, size_t count, size_t shard, void *p_context); \
+    vector_##name##_t *vector_##name##_create(void); \
+    vector_##name##_t *vector_##name##_create_with_allocator(const vector_allocator_t *allocator); \
+    int vector_##name##_destroy(vector_##name##_t *vector); \
+    int vector_##name##_acquire_shard(vector_##name##_t *vector, size_t *out_shard); \
+    int vector_##name##_release_shard(vector_##name##_t *vector, size_t shard); \
+    vector_##data_type##_t *vector_##name##_collect(vector_##name##_t *vector, unsigned int threads); \
+    int vector_##name##_for_each(vector_##name##_t *vector, vector_##name##_visit_t visit, void *p_context);
+
+/** Sharded vector structure and virtual table definition macro. The type is vector_<data_type>_sharded_t. */
+#define VECTOR_SHARDED_DATA_STRUCTURE(data_type) \
+    typedef struct _vector_##data_type##_sharded vector_##data_type##_sharded_t; \
+    VECTOR_SHARDED_PUBLIC_FUNCTIONS_DECLARE(data_type##_sharded, data_type) \
+    VECTOR_SHARDED_VTBL_T(data_type##_sharded, data_type) \
+    VECTOR_SHARDED_SHARD_T(data_type##_sharded, data_type) \
+    VECTOR_SHARDED_T(data_type##_sharded, data_type)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+VECTOR_SHARDED_DATA_STRUCTURE(int)
+VECTOR_SHARDED_DATA_STRUCTURE(double)
+VECTOR_SHARDED_DATA_STRUCTURE(char)
+VECTOR_SHARDED_DATA_STRUCTURE(uint8_t)
+VECTOR_SHARDED_DATA_STRUCTURE(uint16_t)
+VECTOR_SHARDED_DATA_STRUCTURE(uint32_t)
+VECTOR_SHARDED_DATA_STRUCTURE(uint64_t)
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, e.g. with vector_uint64_t_sharded_t *p_results = vector_uint64_t_sharded_create():
+    acquire_shard     - Once per pushing thread, gives the shard the pushes take. Fails (-1) when all
+                        VECTOR_SHARDED_MAX_SHARDS shards are owned. release_shard gives the shard back, its values
+                        stay and the next owner pushes after them.
+    push              - Any number of threads at once, each into its own shard. Never locks.
+    size              - Number of values in all shards, a snapshot while threads push.
+    collect           - A new vector_<data_type>_t (MUTEX) holding the values of shard 0, then shard 1 and so on,
+                        copied in threads slices (0 for one per CPU) on the shared thread pool. The shards
+                        keep their values.
+    for_each          - Visit the values of every non-empty shard in shard order, without copying.
+    clear             - Empty every shard.
+    collect, for_each, clear and destroy must not run while a thread pushes.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_SHARDED_H_ */
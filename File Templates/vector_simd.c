@@ -0,0 +1,617 @@
+/**
+* @file vector_simd.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Numeric kernels over plain arrays, dispatched at runtime to the widest SIMD instruction set the CPU has.
+*
+* Every kernel is written once as a blocked loop over SIMD_LANES independent accumulators, which compilers
+* turn into packed instructions without reordering floating point math. The blocked kernels are compiled once
+* per x86 instruction set with a target attribute and picked through a table indexed by the level in use.
+* The scalar level uses plain one value at a time loops and is the only level on other CPUs and compilers.
+*
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_simd.h" /* Used to expose the kernel API. */
+#include <stddef.h> /* Used for NULL */
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the number of independent accumulators of the blocked kernels. */
+#define SIMD_LANES          (16)
+/** definition for the number of values find compares before checking for a hit. */
+#define SIMD_SEARCH_BLOCK   (64)
+/** definition for the number of values count takes in 32 bit lanes before adding them up, a multiple of SIMD_LANES. */
+#define SIMD_COUNT_FLUSH    ((size_t)SIMD_LANES << 30)
+
+/* If GCC or clang on x86 */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define SIMD_X86 (1)
+    #define SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+    #define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+    #define SIMD_TARGET_AVX2_POPCNT __attribute__((target("avx2,popcnt")))
+    #ifdef __clang__
+        #define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq"), min_vector_width(512)))
+        #define SIMD_TARGET_AVX512_POPCNT __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,popcnt"), min_vector_width(512)))
+    #else
+        #define SIMD_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,prefer-vector-width=512")))
+        #define SIMD_TARGET_AVX512_POPCNT __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,popcnt,prefer-vector-width=512")))
+    #endif
+#endif
+
+/* If GCC or clang */
+#ifdef __GNUC__
+    #define SIMD_LEVEL_LOAD(p_level) __atomic_load_n((p_level), __ATOMIC_ACQUIRE)
+    #define SIMD_LEVEL_STORE(p_level, level) __atomic_store_n((p_level), (level), __ATOMIC_RELEASE)
+#else
+    #define SIMD_LEVEL_LOAD(p_level) (*(p_level))
+    #define SIMD_LEVEL_STORE(p_level, level) (*(p_level) = (level))
+#endif
+
+/** Kernel table type macro. One table per level. */
+#define SIMD_KERNEL_TABLE_T(data_type, sum_type) \
+    typedef struct _simd_##data_type##_kernels { \
+        sum_type (*sum)(const data_type *p_data, size_t count);                              /**< Sum of the values */ \
+        data_type (*min)(const data_type *p_data, size_t count);                             /**< Smallest value */ \
+        data_type (*max)(const data_type *p_data, size_t count);                             /**< Largest value */ \
+        sum_type (*dot)(const data_type *p_x, const data_type *p_y, size_t count);           /**< Sum of the products */ \
+        void (*axpy)(data_type *p_y, data_type a, const data_type *p_x, size_t count);       /**< y = a * x + y */ \
+        void (*scale)(data_type *p_data, data_type a, size_t count);                         /**< x = a * x */ \
+        size_t (*find)(const data_type *p_data, size_t count, data_type value);                 /**< Index of the first equal value */ \
+        size_t (*count)(const data_type *p_data, size_t count, data_type value);                /**< Number of equal values */ \
+    } simd_##data_type##_kernels_t;
+
+/** Scalar kernels macro. arith_type is the type products are computed in, unsigned for integers so they wrap. */
+#define SIMD_SCALAR_KERNELS(data_type, sum_type, arith_type) \
+    static sum_type simd_##data_type##_sum_scalar(const data_type *p_data, size_t count) { \
+        sum_type total = 0; \
+        for (size_t idx = 0; idx < count; idx++) { \
+            total += (sum_type)p_data[idx]; \
+        } \
+        return total; \
+    } \
+    static data_type simd_##data_type##_min_scalar(const data_type *p_data, size_t count) { \
+        data_type result = p_data[0]; \
+        for (size_t idx = 1; idx < count; idx++) { \
+            result = (p_data[idx] < result) ? p_data[idx] : result; \
+        } \
+        return result; \
+    } \
+    static data_type simd_##data_type##_max_scalar(const data_type *p_data, size_t count) { \
+        data_type result = p_data[0]; \
+        for (size_t idx = 1; idx < count; idx++) { \
+            result = (p_data[idx] > result) ? p_data[idx] : result; \
+        } \
+        return result; \
+    } \
+    static sum_type simd_##data_type##_dot_scalar(const data_type *p_x, const data_type *p_y, size_t count) { \
+        sum_type total = 0; \
+        for (size_t idx = 0; idx < count; idx++) { \
+            total += (sum_type)p_x[idx] * (sum_type)p_y[idx]; \
+        } \
+        return total; \
+    } \
+    static void simd_##data_type##_axpy_scalar(data_type *p_y, data_type a, const data_type *p_x, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_y[idx] = (data_type)((arith_type)a * (arith_type)p_x[idx] + (arith_type)p_y[idx]); \
+        } \
+    } \
+    static void simd_##data_type##_scale_scalar(data_type *p_data, data_type a, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_data[idx] = (data_type)((arith_type)a * (arith_type)p_data[idx]); \
+        } \
+    } \
+    static size_t simd_##data_type##_find_scalar(const data_type *p_data, size_t count, data_type value) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            if (p_data[idx] == value) { \
+                return idx; \
+            } \
+        } \
+        return VECTOR_SIMD_NPOS; \
+    } \
+    static size_t simd_##data_type##_count_scalar(const data_type *p_data, size_t count, data_type value) { \
+        size_t matches = 0; \
+        for (size_t idx = 0; idx < count; idx++) { \
+            matches += (p_data[idx] == value); \
+        } \
+        return matches; \
+    }
+
+/** Blocked kernels macro, compiled for the instruction set given by target (a target attribute) and named by isa. */
+#define SIMD_BLOCKED_KERNELS(data_type, sum_type, arith_type, isa, target) \
+    target static sum_type simd_##data_type##_sum_##isa(const data_type *p_data, size_t count) { \
+        sum_type lanes[SIMD_LANES] = {0}; \
+        sum_type total = 0; \
+        size_t idx = 0; \
+        for (; idx + SIMD_LANES <= count; idx += SIMD_LANES) { \
+            for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                lanes[lane] += (sum_type)p_data[idx + lane]; \
+            } \
+        } \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            total += lanes[lane]; \
+        } \
+        for (; idx < count; idx++) { \
+            total += (sum_type)p_data[idx]; \
+        } \
+        return total; \
+    } \
+    target static data_type simd_##data_type##_min_##isa(const data_type *p_data, size_t count) { \
+        data_type lanes[SIMD_LANES]; \
+        data_type result = p_data[0]; \
+        size_t idx = 0; \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            lanes[lane] = p_data[0]; \
+        } \
+        for (; idx + SIMD_LANES <= count; idx += SIMD_LANES) { \
+            for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                lanes[lane] = (p_data[idx + lane] < lanes[lane]) ? p_data[idx + lane] : lanes[lane]; \
+            } \
+        } \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            result = (lanes[lane] < result) ? lanes[lane] : result; \
+        } \
+        for (; idx < count; idx++) { \
+            result = (p_data[idx] < result) ? p_data[idx] : result; \
+        } \
+        return result; \
+    } \
+    target static data_type simd_##data_type##_max_##isa(const data_type *p_data, size_t count) { \
+        data_type lanes[SIMD_LANES]; \
+        data_type result = p_data[0]; \
+        size_t idx = 0; \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            lanes[lane] = p_data[0]; \
+        } \
+        for (; idx + SIMD_LANES <= count; idx += SIMD_LANES) { \
+            for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                lanes[lane] = (p_data[idx + lane] > lanes[lane]) ? p_data[idx + lane] : lanes[lane]; \
+            } \
+        } \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            result = (lanes[lane] > result) ? lanes[lane] : result; \
+        } \
+        for (; idx < count; idx++) { \
+            result = (p_data[idx] > result) ? p_data[idx] : result; \
+        } \
+        return result; \
+    } \
+    target static sum_type simd_##data_type##_dot_##isa(const data_type *p_x, const data_type *p_y, size_t count) { \
+        sum_type lanes[SIMD_LANES] = {0}; \
+        sum_type total = 0; \
+        size_t idx = 0; \
+        for (; idx + SIMD_LANES <= count; idx += SIMD_LANES) { \
+            for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                lanes[lane] += (sum_type)p_x[idx + lane] * (sum_type)p_y[idx + lane]; \
+            } \
+        } \
+        for (int lane = 0; lane < SIMD_LANES; lane++) { \
+            total += lanes[lane]; \
+        } \
+        for (; idx < count; idx++) { \
+            total += (sum_type)p_x[idx] * (sum_type)p_y[idx]; \
+        } \
+        return total; \
+    } \
+    target static void simd_##data_type##_axpy_##isa(data_type *p_y, data_type a, const data_type *p_x, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_y[idx] = (data_type)((arith_type)a * (arith_type)p_x[idx] + (arith_type)p_y[idx]); \
+        } \
+    } \
+    target static void simd_##data_type##_scale_##isa(data_type *p_data, data_type a, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_data[idx] = (data_type)((arith_type)a * (arith_type)p_data[idx]); \
+        } \
+    } \
+    target static size_t simd_##data_type##_find_##isa(const data_type *p_data, size_t count, data_type value) { \
+        size_t idx = 0; \
+        /* Compare a whole block without branching, and only look for the exact index in a block that hit. */ \
+        for (; idx + SIMD_SEARCH_BLOCK <= count; idx += SIMD_SEARCH_BLOCK) { \
+            int hit = 0; \
+            for (int lane = 0; lane < SIMD_SEARCH_BLOCK; lane++) { \
+                hit |= (p_data[idx + lane] == value); \
+            } \
+            if (hit) { \
+                break; \
+            } \
+        } \
+        for (; idx < count; idx++) { \
+            if (p_data[idx] == value) { \
+                return idx; \
+            } \
+        } \
+        return VECTOR_SIMD_NPOS; \
+    } \
+    target static size_t simd_##data_type##_count_##isa(const data_type *p_data, size_t count, data_type value) { \
+        size_t matches = 0; \
+        size_t idx = 0; \
+        while (idx + SIMD_LANES <= count) { \
+            /* The lanes stay 32 bit so they pack as tightly as narrow data, and are flushed before they can overflow. */ \
+            uint32_t lanes[SIMD_LANES] = {0}; \
+            size_t end = (count - idx > SIMD_COUNT_FLUSH) ? idx + SIMD_COUNT_FLUSH : count; \
+            for (; idx + SIMD_LANES <= end; idx += SIMD_LANES) { \
+                for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                    lanes[lane] += (p_data[idx + lane] == value); \
+                } \
+            } \
+            for (int lane = 0; lane < SIMD_LANES; lane++) { \
+                matches += lanes[lane]; \
+            } \
+        } \
+        for (; idx < count; idx++) { \
+            matches += (p_data[idx] == value); \
+        } \
+        return matches; \
+    }
+
+/** Kernel table entry macro for one level. */
+#define SIMD_KERNEL_TABLE_ENTRY(data_type, isa) \
+    { \
+        simd_##data_type##_sum_##isa, \
+        simd_##data_type##_min_##isa, \
+        simd_##data_type##_max_##isa, \
+        simd_##data_type##_dot_##isa, \
+        simd_##data_type##_axpy_##isa, \
+        simd_##data_type##_scale_##isa, \
+        simd_##data_type##_find_##isa, \
+        simd_##data_type##_count_##isa, \
+    }
+
+#ifdef SIMD_X86
+/** Kernels and per level table macro. */
+#define SIMD_KERNELS(data_type, sum_type, arith_type) \
+    SIMD_KERNEL_TABLE_T(data_type, sum_type) \
+    SIMD_SCALAR_KERNELS(data_type, sum_type, arith_type) \
+    SIMD_BLOCKED_KERNELS(data_type, sum_type, arith_type, sse2, SIMD_TARGET_SSE2) \
+    SIMD_BLOCKED_KERNELS(data_type, sum_type, arith_type, avx2, SIMD_TARGET_AVX2) \
+    SIMD_BLOCKED_KERNELS(data_type, sum_type, arith_type, avx512, SIMD_TARGET_AVX512) \
+    static const simd_##data_type##_kernels_t s_##data_type##_kernels[VECTOR_SIMD_LEVEL_COUNT] = { \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, scalar), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, sse2), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, avx2), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, avx512), \
+    };
+#else
+/** Kernels and per level table macro. Only the scalar level exists, so every entry points to it. */
+#define SIMD_KERNELS(data_type, sum_type, arith_type) \
+    SIMD_KERNEL_TABLE_T(data_type, sum_type) \
+    SIMD_SCALAR_KERNELS(data_type, sum_type, arith_type) \
+    static const simd_##data_type##_kernels_t s_##data_type##_kernels[VECTOR_SIMD_LEVEL_COUNT] = { \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, scalar), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, scalar), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, scalar), \
+        SIMD_KERNEL_TABLE_ENTRY(data_type, scalar), \
+    };
+#endif
+
+/** Public kernel functions macro. Every call goes through the table of the level in use. */
+#define SIMD_PUBLIC_KERNELS(data_type, sum_type) \
+    sum_type vector_simd_##data_type##_sum(const data_type *p_data, size_t count) { \
+        return s_##data_type##_kernels[simd_level()].sum(p_data, count); \
+    } \
+    data_type vector_simd_##data_type##_min(const data_type *p_data, size_t count) { \
+        return s_##data_type##_kernels[simd_level()].min(p_data, count); \
+    } \
+    data_type vector_simd_##data_type##_max(const data_type *p_data, size_t count) { \
+        return s_##data_type##_kernels[simd_level()].max(p_data, count); \
+    } \
+    size_t vector_simd_##data_type##_argmin(const data_type *p_data, size_t count) { \
+        /* Two streaming passes beat one pass that has to carry an index per lane. */ \
+        return (count > 0) ? vector_simd_##data_type##_find(p_data, count, vector_simd_##data_type##_min(p_data, count)) : VECTOR_SIMD_NPOS; \
+    } \
+    size_t vector_simd_##data_type##_argmax(const data_type *p_data, size_t count) { \
+        return (count > 0) ? vector_simd_##data_type##_find(p_data, count, vector_simd_##data_type##_max(p_data, count)) : VECTOR_SIMD_NPOS; \
+    } \
+    sum_type vector_simd_##data_type##_dot(const data_type *p_x, const data_type *p_y, size_t count) { \
+        return s_##data_type##_kernels[simd_level()].dot(p_x, p_y, count); \
+    } \
+    void vector_simd_##data_type##_axpy(data_type *p_y, data_type a, const data_type *p_x, size_t count) { \
+        s_##data_type##_kernels[simd_level()].axpy(p_y, a, p_x, count); \
+    } \
+    void vector_simd_##data_type##_scale(data_type *p_data, data_type a, size_t count) { \
+        s_##data_type##_kernels[simd_level()].scale(p_data, a, count); \
+    } \
+    size_t vector_simd_##data_type##_find(const data_type *p_data, size_t count, data_type value) { \
+        return s_##data_type##_kernels[simd_level()].find(p_data, count, value); \
+    } \
+    size_t vector_simd_##data_type##_count(const data_type *p_data, size_t count, data_type value) { \
+        return s_##data_type##_kernels[simd_level()].count(p_data, count, value); \
+    }
+
+/** Bit kernels macro for arrays of 64 bit words, compiled for target, named by isa and counting bits with popcount. */
+#define SIMD_BITS_KERNELS(isa, target, popcount) \
+    target static uint64_t simd_bits_popcount_##isa(const uint64_t *p_words, size_t count) { \
+        uint64_t lanes[4] = {0}; \
+        size_t idx = 0; \
+        /* Independent sums so the popcounts of four words run at once. */ \
+        for (; idx + 4 <= count; idx += 4) { \
+            for (int lane = 0; lane < 4; lane++) { \
+                lanes[lane] += (uint64_t)popcount(p_words[idx + lane]); \
+            } \
+        } \
+        for (; idx < count; idx++) { \
+            lanes[0] += (uint64_t)popcount(p_words[idx]); \
+        } \
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3]; \
+    } \
+    target static void simd_bits_and_##isa(uint64_t *p_dst, const uint64_t *p_src, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_dst[idx] &= p_src[idx]; \
+        } \
+    } \
+    target static void simd_bits_or_##isa(uint64_t *p_dst, const uint64_t *p_src, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_dst[idx] |= p_src[idx]; \
+        } \
+    } \
+    target static void simd_bits_xor_##isa(uint64_t *p_dst, const uint64_t *p_src, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_dst[idx] ^= p_src[idx]; \
+        } \
+    } \
+    target static void simd_bits_andnot_##isa(uint64_t *p_dst, const uint64_t *p_src, size_t count) { \
+        for (size_t idx = 0; idx < count; idx++) { \
+            p_dst[idx] &= ~p_src[idx]; \
+        } \
+    }
+
+/** Bit kernel table entry macro for one level. */
+#define SIMD_BITS_TABLE_ENTRY(isa) \
+    { \
+        simd_bits_popcount_##isa, \
+        simd_bits_and_##isa, \
+        simd_bits_or_##isa, \
+        simd_bits_xor_##isa, \
+        simd_bits_andnot_##isa, \
+    }
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/**
+ * @brief Bit kernel table, one per level.
+ *
+ */
+typedef struct _simd_bits_kernels {
+    uint64_t (*popcount)(const uint64_t *p_words, size_t count);                /**< Number of set bits */
+    void (*and_words)(uint64_t *p_dst, const uint64_t *p_src, size_t count);    /**< dst &= src */
+    void (*or_words)(uint64_t *p_dst, const uint64_t *p_src, size_t count);     /**< dst |= src */
+    void (*xor_words)(uint64_t *p_dst, const uint64_t *p_src, size_t count);    /**< dst ^= src */
+    void (*andnot_words)(uint64_t *p_dst, const uint64_t *p_src, size_t count); /**< dst &= ~src */
+} simd_bits_kernels_t;
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/** Level in use, -1 until the first kernel call detects it. */
+static int s_simd_level = -1;
+
+/** Names of the levels. */
+static const char *const s_simd_level_names[VECTOR_SIMD_LEVEL_COUNT] = {"scalar", "sse2", "avx2", "avx512"};
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static int simd_level(void);
+static vector_simd_level_t simd_detect_level(void);
+static unsigned int simd_popcount_word(uint64_t word);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+SIMD_KERNELS(int, int64_t, uint32_t)
+SIMD_KERNELS(double, double, double)
+SIMD_KERNELS(uint8_t, uint64_t, uint32_t)
+SIMD_KERNELS(uint16_t, uint64_t, uint32_t)
+SIMD_KERNELS(uint32_t, uint64_t, uint32_t)
+SIMD_KERNELS(uint64_t, uint64_t, uint64_t)
+
+SIMD_PUBLIC_KERNELS(int, int64_t)
+SIMD_PUBLIC_KERNELS(double, double)
+SIMD_PUBLIC_KERNELS(uint8_t, uint64_t)
+SIMD_PUBLIC_KERNELS(uint16_t, uint64_t)
+SIMD_PUBLIC_KERNELS(uint32_t, uint64_t)
+SIMD_PUBLIC_KERNELS(uint64_t, uint64_t)
+
+SIMD_BITS_KERNELS(scalar, , simd_popcount_word)
+#ifdef SIMD_X86
+/* SSE2 has no popcnt, so that level only gets the wider boolean ops. */
+SIMD_BITS_KERNELS(sse2, SIMD_TARGET_SSE2, simd_popcount_word)
+SIMD_BITS_KERNELS(avx2, SIMD_TARGET_AVX2_POPCNT, __builtin_popcountll)
+SIMD_BITS_KERNELS(avx512, SIMD_TARGET_AVX512_POPCNT, __builtin_popcountll)
+
+/** Bit kernels of every level. */
+static const simd_bits_kernels_t s_bits_kernels[VECTOR_SIMD_LEVEL_COUNT] = {
+    SIMD_BITS_TABLE_ENTRY(scalar),
+    SIMD_BITS_TABLE_ENTRY(sse2),
+    SIMD_BITS_TABLE_ENTRY(avx2),
+    SIMD_BITS_TABLE_ENTRY(avx512),
+};
+#else
+/** Bit kernels of every level, only the scalar level exists. */
+static const simd_bits_kernels_t s_bits_kernels[VECTOR_SIMD_LEVEL_COUNT] = {
+    SIMD_BITS_TABLE_ENTRY(scalar),
+    SIMD_BITS_TABLE_ENTRY(scalar),
+    SIMD_BITS_TABLE_ENTRY(scalar),
+    SIMD_BITS_TABLE_ENTRY(scalar),
+};
+#endif
+
+/**
+ * @brief Count the set bits of count 64 bit words.
+ *
+ * @param p_words The words.
+ * @param count Number of words.
+ * @return uint64_t Number of set bits.
+ */
+uint64_t vector_simd_bits_popcount(const uint64_t *p_words, size_t count) {
+
+    return s_bits_kernels[simd_level()].popcount(p_words, count);
+}
+
+/**
+ * @brief dst &= src, word by word.
+ *
+ * @param p_dst Words to update.
+ * @param p_src Words to combine with, may be p_dst.
+ * @param count Number of words.
+ */
+void vector_simd_bits_and(uint64_t *p_dst, const uint64_t *p_src, size_t count) {
+
+    s_bits_kernels[simd_level()].and_words(p_dst, p_src, count);
+}
+
+/**
+ * @brief dst |= src, word by word.
+ *
+ * @param p_dst Words to update.
+ * @param p_src Words to combine with, may be p_dst.
+ * @param count Number of words.
+ */
+void vector_simd_bits_or(uint64_t *p_dst, const uint64_t *p_src, size_t count) {
+
+    s_bits_kernels[simd_level()].or_words(p_dst, p_src, count);
+}
+
+/**
+ * @brief dst ^= src, word by word.
+ *
+ * @param p_dst Words to update.
+ * @param p_src Words to combine with, may be p_dst.
+ * @param count Number of words.
+ */
+void vector_simd_bits_xor(uint64_t *p_dst, const uint64_t *p_src, size_t count) {
+
+    s_bits_kernels[simd_level()].xor_words(p_dst, p_src, count);
+}
+
+/**
+ * @brief dst &= ~src, word by word.
+ *
+ * @param p_dst Words to update.
+ * @param p_src Words to combine with, may be p_dst.
+ * @param count Number of words.
+ */
+void vector_simd_bits_andnot(uint64_t *p_dst, const uint64_t *p_src, size_t count) {
+
+    s_bits_kernels[simd_level()].andnot_words(p_dst, p_src, count);
+}
+
+/**
+ * @brief Get the instruction set the kernels run with.
+ *
+ * @return vector_simd_level_t The level in use.
+ */
+vector_simd_level_t vector_simd_get_level(void) {
+
+    return (vector_simd_level_t)simd_level();
+}
+
+/**
+ * @brief Force the kernels to an instruction set.
+ *
+ * @param level Level to use.
+ * @return int 0 on success, -1 if the CPU or the build does not support the level.
+ */
+int vector_simd_set_level(vector_simd_level_t level) {
+
+    if(!vector_simd_is_supported(level)) {
+        return -1;
+    }
+
+    SIMD_LEVEL_STORE(&s_simd_level, (int)level);
+
+    return 0;
+}
+
+/**
+ * @brief Check whether the CPU and the build support an instruction set.
+ *
+ * @param level Level to check.
+ * @return int 1 if supported, 0 if not.
+ */
+int vector_simd_is_supported(vector_simd_level_t level) {
+
+    if((level < VECTOR_SIMD_LEVEL_SCALAR) || (level >= VECTOR_SIMD_LEVEL_COUNT)) {
+        return 0;
+    }
+
+    return (level <= simd_detect_level());
+}
+
+/**
+ * @brief Name of an instruction set.
+ *
+ * @param level Level to name.
+ * @return const char* The name, "unknown" for an invalid level.
+ */
+const char *vector_simd_level_name(vector_simd_level_t level) {
+
+    if((level < VECTOR_SIMD_LEVEL_SCALAR) || (level >= VECTOR_SIMD_LEVEL_COUNT)) {
+        return "unknown";
+    }
+
+    return s_simd_level_names[level];
+}
+
+/**
+ * @brief Helper function to get the level in use, detecting it on first use.
+ *
+ * Racing first calls all detect the same level, so the last store wins harmlessly.
+ *
+ * @return int The level in use.
+ */
+static int simd_level(void) {
+
+    int level = SIMD_LEVEL_LOAD(&s_simd_level);
+
+    if(level < 0) {
+        level = (int)simd_detect_level();
+        SIMD_LEVEL_STORE(&s_simd_level, level);
+    }
+
+    return level;
+}
+
+/**
+ * @brief Helper function to find the widest instruction set the CPU and the OS support.
+ *
+ * @return vector_simd_level_t The widest supported level.
+ */
+static vector_simd_level_t simd_detect_level(void) {
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+       && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq")) {
+        return VECTOR_SIMD_LEVEL_AVX512;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        return VECTOR_SIMD_LEVEL_AVX2;
+    }
+    if(__builtin_cpu_supports("sse2")) {
+        return VECTOR_SIMD_LEVEL_SSE2;
+    }
+#endif
+
+    return VECTOR_SIMD_LEVEL_SCALAR;
+}
+
+/**
+ * @brief Helper function to count the set bits of a word without a popcount instruction.
+ *
+ * @param word The word.
+ * @return unsigned int Number of set bits.
+ */
+static unsigned int simd_popcount_word(uint64_t word) {
+
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+
+    return (unsigned int)((word * 0x0101010101010101ull) >> 56);
+}
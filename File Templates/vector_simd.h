@@ -0,0 +1,136 @@
+/**
+ * @file vector_simd.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Numeric kernels over plain arrays, dispatched at runtime to the widest SIMD instruction set the CPU has.
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_SIMD_H_
+#define _VECTOR_SIMD_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the index find, argmin and argmax return when there is none. */
+#define VECTOR_SIMD_NPOS ((size_t)-1)
+
+/**
+ * Kernel declarations macro for arrays of data_type. Sums and dot products are accumulated in sum_type.
+ * Integer arithmetic wraps. Kernels that return one value (min, max) need count > 0.
+ */
+#define VECTOR_SIMD_KERNELS_DECLARE(data_type, sum_type) \
+    sum_type vector_simd_##data_type##_sum(const data_type *p_data, size_t count); \
+    data_type vector_simd_##data_type##_min(const data_type *p_data, size_t count); \
+    data_type vector_simd_##data_type##_max(const data_type *p_data, size_t count); \
+    size_t vector_simd_##data_type##_argmin(const data_type *p_data, size_t count); \
+    size_t vector_simd_##data_type##_argmax(const data_type *p_data, size_t count); \
+    sum_type vector_simd_##data_type##_dot(const data_type *p_x, const data_type *p_y, size_t count); \
+    void vector_simd_##data_type##_axpy(data_type *p_y, data_type a, const data_type *p_x, size_t count); \
+    void vector_simd_##data_type##_scale(data_type *p_data, data_type a, size_t count); \
+    size_t vector_simd_##data_type##_find(const data_type *p_data, size_t count, data_type value); \
+    size_t vector_simd_##data_type##_count(const data_type *p_data, size_t count, data_type value);
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/**
+ * @brief Instruction set the kernels run with.
+ *
+ */
+typedef enum _vector_simd_level {
+    VECTOR_SIMD_LEVEL_SCALAR = 0,   /**< Plain C loops, the fallback for every CPU. */
+    VECTOR_SIMD_LEVEL_SSE2,         /**< x86 SSE2, 128 bit vectors. */
+    VECTOR_SIMD_LEVEL_AVX2,         /**< x86 AVX2, 256 bit vectors. */
+    VECTOR_SIMD_LEVEL_AVX512,       /**< x86 AVX-512 F/BW/VL/DQ, 512 bit vectors. */
+    VECTOR_SIMD_LEVEL_COUNT         /**< Number of levels. */
+} vector_simd_level_t;
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+VECTOR_SIMD_KERNELS_DECLARE(int, int64_t)
+VECTOR_SIMD_KERNELS_DECLARE(double, double)
+VECTOR_SIMD_KERNELS_DECLARE(uint8_t, uint64_t)
+VECTOR_SIMD_KERNELS_DECLARE(uint16_t, uint64_t)
+VECTOR_SIMD_KERNELS_DECLARE(uint32_t, uint64_t)
+VECTOR_SIMD_KERNELS_DECLARE(uint64_t, uint64_t)
+
+/**
+ * @brief Count the set bits of count 64 bit words, with popcnt from the AVX2 level up.
+ *
+ * @param p_words The words.
+ * @param count Number of words.
+ * @return uint64_t Number of set bits.
+ */
+uint64_t vector_simd_bits_popcount(const uint64_t *p_words, size_t count);
+
+/**
+ * @brief Word-wise boolean ops on count 64 bit words: dst &= src, dst |= src, dst ^= src and dst &= ~src.
+ * p_src may be p_dst.
+ *
+ * @param p_dst Words to update.
+ * @param p_src Words to combine with.
+ * @param count Number of words.
+ */
+void vector_simd_bits_and(uint64_t *p_dst, const uint64_t *p_src, size_t count);
+void vector_simd_bits_or(uint64_t *p_dst, const uint64_t *p_src, size_t count);
+void vector_simd_bits_xor(uint64_t *p_dst, const uint64_t *p_src, size_t count);
+void vector_simd_bits_andnot(uint64_t *p_dst, const uint64_t *p_src, size_t count);
+
+/**
+ * @brief Get the instruction set the kernels run with. The first call picks the widest one the CPU supports.
+ *
+ * @return vector_simd_level_t The level in use.
+ */
+vector_simd_level_t vector_simd_get_level(void);
+
+/**
+ * @brief Force the kernels to an instruction set, e.g. to compare levels. Not safe while kernels are running.
+ *
+ * The SIMD levels sum and dot double values in a different order than the scalar level, so their results can
+ * differ in the last bits. NaN values give unspecified results for min, max, argmin and argmax.
+ *
+ * @param level Level to use.
+ * @return int 0 on success, -1 if the CPU or the build does not support the level.
+ */
+int vector_simd_set_level(vector_simd_level_t level);
+
+/**
+ * @brief Check whether the CPU and the build support an instruction set.
+ *
+ * @param level Level to check.
+ * @return int 1 if supported, 0 if not.
+ */
+int vector_simd_is_supported(vector_simd_level_t level);
+
+/**
+ * @brief Name of an instruction set, e.g. "avx2".
+ *
+ * @param level Level to name.
+ * @return const char* The name.
+ */
+const char *vector_simd_level_name(vector_simd_level_t level);
+
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_SIMD_H_ */
@@ -0,0 +1,266 @@
+/**
+ * @file vector_small.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Vectors that keep their first N values inside the struct and only use the heap past that.
+ *
+ * SMALL_VECTOR(data_type, N) generates vector_<data_type>_small<N>_t with the push, pop and get of the other
+ * vectors. All of its functions are static inline in the header, so any type and any N can be generated
+ * where it is needed. A small vector created in place with init costs no allocation until it holds more
+ * than N values, and one created with create costs a single allocation.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_SMALL_H_
+#define _VECTOR_SMALL_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include <string.h> /* For memcpy */
+#include "vector_wip.h" /* For the lock policies */
+#include "vector_allocator.h" /* For vector_allocator_t */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** Small vector virtual table definition macro. */
+#define SMALL_VECTOR_VTBL_T(name, data_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, data_type value);                 /**< Push a value to the back of the vector */ \
+        int (*const pop)(vector_##name##_t *vector);                                   /**< Pop a value from the back of the vector */ \
+        int (*const get)(vector_##name##_t *vector, size_t index, data_type *out);     /**< Get a value from the vector at index */ \
+        int (*const reserve)(vector_##name##_t *vector, size_t capacity);              /**< Grow the capacity to at least capacity */ \
+        int (*const clear)(vector_##name##_t *vector);                                 /**< Remove every value, keeping the capacity */ \
+    } vector_##name##_vtbl_t;
+
+/**
+ * Small vector structure definition macro. data points at inline_data until the vector spills, so the struct
+ * must not be copied by value.
+ */
+#define SMALL_VECTOR_T(name, data_type, inline_capacity, lock_policy) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;           /**< Pointer to the virtual table */ \
+        size_t size;                            /**< Size of the vector */ \
+        size_t capacity;                        /**< Capacity of the vector, inline_capacity until it spills */ \
+        data_type *data;                        /**< Pointer to the data array, inline_data or the heap */ \
+        const vector_allocator_t *allocator;    /**< Allocator of the spilled data, and of the vector if created */ \
+        VECTOR_LOCK_TYPE(lock_policy) lock;     /**< Lock for thread safety, see the lock policies */ \
+        data_type inline_data[inline_capacity]; /**< Storage of the first inline_capacity values */ \
+    };
+
+/** Small vector functions macro. */
+#define SMALL_VECTOR_FUNCS(name, data_type, inline_capacity, lock_policy) \
+    /** Grow the capacity to at least min_capacity, moving the values to the heap on the first spill. The lock must be held. */ \
+    static inline int vector_##name##_grow(vector_##name##_t *vector, size_t min_capacity) { \
+        size_t new_capacity = vector->capacity; \
+        data_type *new_data = NULL; \
+        if (min_capacity <= vector->capacity) { \
+            return 0; \
+        } \
+        if (min_capacity > SIZE_MAX / sizeof(data_type)) { \
+            return -1; \
+        } \
+        while (new_capacity < min_capacity) { \
+            new_capacity = (new_capacity > SIZE_MAX / sizeof(data_type) / 2) ? min_capacity : new_capacity * 2; \
+        } \
+        if (vector->data == vector->inline_data) { \
+            new_data = (data_type *)vector->allocator->alloc(vector->allocator->p_context, new_capacity * sizeof(data_type)); \
+            if (new_data != NULL) { \
+                memcpy(new_data, vector->inline_data, vector->size * sizeof(data_type)); \
+            } \
+        } \
+        else { \
+            new_data = (data_type *)vector->allocator->realloc(vector->allocator->p_context, vector->data, \
+                vector->capacity * sizeof(data_type), new_capacity * sizeof(data_type)); \
+        } \
+        if (new_data == NULL) { \
+            return -1; \
+        } \
+        vector->data = new_data; \
+        vector->capacity = new_capacity; \
+        return 0; \
+    } \
+    static inline int vector_##name##_push(vector_##name##_t *vector, data_type value) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (vector->size >= vector->capacity && (vector->size == SIZE_MAX || vector_##name##_grow(vector, vector->size + 1))) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        vector->data[vector->size] = value; \
+        vector->size++; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_pop(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (vector->size == 0) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        vector->size--; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_get(vector_##name##_t *vector, size_t index, data_type *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        *out = vector->data[index]; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_reserve(vector_##name##_t *vector, size_t capacity) { \
+        int rv = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        rv = vector_##name##_grow(vector, capacity); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    } \
+    static inline int vector_##name##_clear(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        vector->size = 0; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .pop = vector_##name##_pop, \
+        .get = vector_##name##_get, \
+        .reserve = vector_##name##_reserve, \
+        .clear = vector_##name##_clear, \
+    }; \
+    /** Initialize a small vector in place, e.g. on the stack. allocator is used once it spills, NULL for the default. */ \
+    static inline int vector_##name##_init(vector_##name##_t *vector, const vector_allocator_t *allocator) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->size = 0; \
+        vector->capacity = (inline_capacity); \
+        vector->data = vector->inline_data; \
+        vector->allocator = (allocator != NULL) ? allocator : vector_allocator_default(); \
+        VECTOR_LOCK_INIT(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    /** Release the spilled data of a small vector initialized with init. */ \
+    static inline int vector_##name##_deinit(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_DESTROY(lock_policy, &vector->lock); \
+        if (vector->data != vector->inline_data) { \
+            vector->allocator->free(vector->allocator->p_context, vector->data, vector->capacity * sizeof(data_type)); \
+        } \
+        vector->data = vector->inline_data; \
+        vector->size = 0; \
+        vector->capacity = (inline_capacity); \
+        return 0; \
+    } \
+    /** Create a small vector with one allocation from allocator, NULL for the default. */ \
+    static inline vector_##name##_t *vector_##name##_create_with_allocator(const vector_allocator_t *allocator) { \
+        vector_##name##_t *vector = NULL; \
+        if (allocator == NULL) { \
+            allocator = vector_allocator_default(); \
+        } \
+        vector = (vector_##name##_t *)allocator->alloc(allocator->p_context, sizeof(vector_##name##_t)); \
+        if (vector != NULL) { \
+            vector_##name##_init(vector, allocator); \
+        } \
+        return vector; \
+    } \
+    /** Create a small vector with one allocation. */ \
+    static inline vector_##name##_t *vector_##name##_create(void) { \
+        return vector_##name##_create_with_allocator(NULL); \
+    } \
+    /** Destroy a small vector made by create. */ \
+    static inline int vector_##name##_destroy(vector_##name##_t *vector) { \
+        const vector_allocator_t *allocator = NULL; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        allocator = vector->allocator; \
+        vector_##name##_deinit(vector); \
+        allocator->free(allocator->p_context, vector, sizeof(vector_##name##_t)); \
+        return 0; \
+    } \
+    /** Value at index. No lock and no bounds check, index must be in [0, size). */ \
+    static inline data_type vector_##name##_at(const vector_##name##_t *vector, size_t index) { \
+        return vector->data[index]; \
+    } \
+    /** Number of values in the vector. No lock, so only a snapshot if other threads push or pop. */ \
+    static inline size_t vector_##name##_size(const vector_##name##_t *vector) { \
+        return vector->size; \
+    }
+
+/**
+ * Small vector structure, virtual table and functions definition macro for a vector named vector_<name>_t that
+ * holds its first inline_capacity data_type values inline and is guarded by lock_policy (MUTEX, SPINLOCK or NOLOCK).
+ */
+#define SMALL_VECTOR_WITH_LOCK(name, data_type, inline_capacity, lock_policy) \
+    typedef struct _vector_##name vector_##name##_t; \
+    SMALL_VECTOR_VTBL_T(name, data_type) \
+    SMALL_VECTOR_T(name, data_type, inline_capacity, lock_policy) \
+    SMALL_VECTOR_FUNCS(name, data_type, inline_capacity, lock_policy)
+
+/**
+ * Small vector definition macro, generates vector_<data_type>_small<inline_capacity>_t. Small vectors are mostly
+ * members and locals owned by one thread, so this one is NOLOCK, use SMALL_VECTOR_WITH_LOCK to share one.
+ */
+#define SMALL_VECTOR(data_type, inline_capacity) \
+    SMALL_VECTOR_NAMED(data_type, inline_capacity)
+
+/** Helper of SMALL_VECTOR, so an inline_capacity given as a macro is expanded before it is pasted into the name. */
+#define SMALL_VECTOR_NAMED(data_type, inline_capacity) \
+    SMALL_VECTOR_WITH_LOCK(data_type##_small##inline_capacity, data_type, inline_capacity, NOLOCK)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, e.g. SMALL_VECTOR(double, 16) at file scope, then:
+    vector_double_small16_t values;
+    vector_double_small16_init(&values, NULL);
+    values.vptr->push(&values, 1.0);
+    vector_double_small16_deinit(&values);
+or vector_double_small16_create() / vector_double_small16_destroy() for one on the heap.
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_SMALL_H_ */
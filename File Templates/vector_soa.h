@@ -0,0 +1,309 @@
+/**
+ * @file vector_soa.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Structure-of-arrays vectors of records, one contiguous array per field.
+ *
+ * The fields of a record are listed once in an X-macro, e.g.
+ *     #define PARTICLE_FIELDS(X) X(double, x) X(double, y) X(uint32_t, id)
+ * and SOA_VECTOR(particle, PARTICLE_FIELDS) generates the record particle_t and vector_particle_t. The vector
+ * pushes and gets whole records, but keeps every field in its own column, so a scan of one field only reads
+ * that field. The columns are the members of the vector named after the fields (vector->x, vector->y, ...),
+ * they share one allocation and each starts on a cache line. All functions are static inline in the header.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_SOA_H_
+#define _VECTOR_SOA_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include <string.h> /* For memcpy */
+#include "vector_wip.h" /* For the lock policies */
+#include "vector_allocator.h" /* For vector_allocator_t */
+#include "vector_atomic.h" /* For VECTOR_CACHE_LINE_BYTES */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the capacity a vector created with capacity 0 gets on its first push. */
+#define SOA_VECTOR_MIN_CAPACITY (8)
+
+/** Round a column size in bytes up to a whole number of cache lines. */
+#define SOA_VECTOR_ROUND_UP(bytes) (((bytes) + VECTOR_CACHE_LINE_BYTES - 1) & ~(size_t)(VECTOR_CACHE_LINE_BYTES - 1))
+
+/** X-macro callback declaring a field of the record. */
+#define SOA_VECTOR_RECORD_MEMBER(data_type, field) data_type field;
+/** X-macro callback declaring the column of a field. */
+#define SOA_VECTOR_COLUMN_MEMBER(data_type, field) data_type *field; /**< Column of the field */
+/** X-macro callback adding the bytes of a column of capacity values to bytes. */
+#define SOA_VECTOR_COLUMN_BYTES(data_type, field) bytes += SOA_VECTOR_ROUND_UP(capacity * sizeof(data_type));
+/** X-macro callback copying a column into the new block at offset and pointing the vector at the copy. */
+#define SOA_VECTOR_MOVE_COLUMN(data_type, field) \
+    if (vector->size > 0) { \
+        memcpy(new_base + offset, vector->field, vector->size * sizeof(data_type)); \
+    } \
+    vector->field = (data_type *)(void *)(new_base + offset); \
+    offset += SOA_VECTOR_ROUND_UP(new_capacity * sizeof(data_type));
+/** X-macro callback storing a field of value at index. */
+#define SOA_VECTOR_STORE_FIELD(data_type, field) vector->field[index] = value.field;
+/** X-macro callback loading a field at index into out. */
+#define SOA_VECTOR_LOAD_FIELD(data_type, field) out->field = vector->field[index];
+/** X-macro callback clearing the column of a field. */
+#define SOA_VECTOR_CLEAR_COLUMN(data_type, field) vector->field = NULL;
+
+/** Record structure definition macro, a struct named record_t with the fields of FIELDS. */
+#define SOA_RECORD(record, FIELDS) \
+    typedef struct _##record { \
+        FIELDS(SOA_VECTOR_RECORD_MEMBER) \
+    } record##_t;
+
+/** Structure-of-arrays vector virtual table definition macro. */
+#define SOA_VECTOR_VTBL_T(name, record_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, record_type value);               /**< Push a record to the back of the vector */ \
+        int (*const pop)(vector_##name##_t *vector);                                   /**< Pop a record from the back of the vector */ \
+        int (*const get)(vector_##name##_t *vector, size_t index, record_type *out);   /**< Get the record at index */ \
+        int (*const set)(vector_##name##_t *vector, size_t index, record_type value);  /**< Set the record at index */ \
+        int (*const reserve)(vector_##name##_t *vector, size_t capacity);              /**< Grow the capacity to at least capacity */ \
+        int (*const clear)(vector_##name##_t *vector);                                 /**< Remove every record, keeping the capacity */ \
+    } vector_##name##_vtbl_t;
+
+/**
+ * Structure-of-arrays vector structure definition macro. The columns are valid until the next push, reserve or
+ * destroy, and are only safe to scan without the lock while no other thread changes the vector.
+ */
+#define SOA_VECTOR_T(name, FIELDS, lock_policy) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;           /**< Pointer to the virtual table */ \
+        size_t size;                            /**< Size of the vector */ \
+        size_t capacity;                        /**< Capacity of every column */ \
+        FIELDS(SOA_VECTOR_COLUMN_MEMBER) \
+        void *block;                            /**< The allocation all columns live in */ \
+        const vector_allocator_t *allocator;    /**< Allocator of the vector and its columns */ \
+        VECTOR_LOCK_TYPE(lock_policy) lock;     /**< Lock for thread safety, see the lock policies */ \
+    };
+
+/** Structure-of-arrays vector functions macro. */
+#define SOA_VECTOR_FUNCS(name, record_type, FIELDS, lock_policy) \
+    /** Bytes of the block holding every column at capacity, with room to align the first column. */ \
+    static inline size_t vector_##name##_block_bytes(size_t capacity) { \
+        size_t bytes = VECTOR_CACHE_LINE_BYTES - 1; \
+        FIELDS(SOA_VECTOR_COLUMN_BYTES) \
+        return bytes; \
+    } \
+    /** Grow the capacity to at least min_capacity, moving every column to one new block. The lock must be held. */ \
+    static inline int vector_##name##_grow(vector_##name##_t *vector, size_t min_capacity) { \
+        size_t new_capacity = (vector->capacity < SOA_VECTOR_MIN_CAPACITY) ? SOA_VECTOR_MIN_CAPACITY : vector->capacity; \
+        size_t offset = 0; \
+        void *new_block = NULL; \
+        unsigned char *new_base = NULL; \
+        if (min_capacity <= vector->capacity) { \
+            return 0; \
+        } \
+        /* Every column is at most a record wide, so half the address space bounds the block with its padding. */ \
+        if (min_capacity > SIZE_MAX / 2 / sizeof(record_type)) { \
+            return -1; \
+        } \
+        while (new_capacity < min_capacity) { \
+            new_capacity = (new_capacity > SIZE_MAX / 4 / sizeof(record_type)) ? min_capacity : new_capacity * 2; \
+        } \
+        new_block = vector->allocator->alloc(vector->allocator->p_context, vector_##name##_block_bytes(new_capacity)); \
+        if (new_block == NULL) { \
+            return -1; \
+        } \
+        new_base = (unsigned char *)new_block + (SOA_VECTOR_ROUND_UP((uintptr_t)new_block) - (uintptr_t)new_block); \
+        FIELDS(SOA_VECTOR_MOVE_COLUMN) \
+        if (vector->block != NULL) { \
+            vector->allocator->free(vector->allocator->p_context, vector->block, vector_##name##_block_bytes(vector->capacity)); \
+        } \
+        vector->block = new_block; \
+        vector->capacity = new_capacity; \
+        return 0; \
+    } \
+    static inline int vector_##name##_push(vector_##name##_t *vector, record_type value) { \
+        size_t index = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (vector->size >= vector->capacity && (vector->size == SIZE_MAX || vector_##name##_grow(vector, vector->size + 1))) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        index = vector->size; \
+        FIELDS(SOA_VECTOR_STORE_FIELD) \
+        vector->size++; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_pop(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (vector->size == 0) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        vector->size--; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_get(vector_##name##_t *vector, size_t index, record_type *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        FIELDS(SOA_VECTOR_LOAD_FIELD) \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_set(vector_##name##_t *vector, size_t index, record_type value) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        FIELDS(SOA_VECTOR_STORE_FIELD) \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static inline int vector_##name##_reserve(vector_##name##_t *vector, size_t capacity) { \
+        int rv = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        rv = vector_##name##_grow(vector, capacity); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    } \
+    static inline int vector_##name##_clear(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK(lock_policy, &vector->lock); \
+        vector->size = 0; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .pop = vector_##name##_pop, \
+        .get = vector_##name##_get, \
+        .set = vector_##name##_set, \
+        .reserve = vector_##name##_reserve, \
+        .clear = vector_##name##_clear, \
+    }; \
+    /** Create a vector with room for initial_capacity records, from allocator, NULL for the default. */ \
+    static inline vector_##name##_t *vector_##name##_create_with_allocator(size_t initial_capacity, const vector_allocator_t *allocator) { \
+        vector_##name##_t *vector = NULL; \
+        if (allocator == NULL) { \
+            allocator = vector_allocator_default(); \
+        } \
+        vector = (vector_##name##_t *)allocator->alloc(allocator->p_context, sizeof(vector_##name##_t)); \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->size = 0; \
+        vector->capacity = 0; \
+        FIELDS(SOA_VECTOR_CLEAR_COLUMN) \
+        vector->block = NULL; \
+        vector->allocator = allocator; \
+        if (vector_##name##_grow(vector, initial_capacity)) { \
+            allocator->free(allocator->p_context, vector, sizeof(vector_##name##_t)); \
+            return NULL; \
+        } \
+        VECTOR_LOCK_INIT(lock_policy, &vector->lock); \
+        return vector; \
+    } \
+    /** Create a vector with room for initial_capacity records. */ \
+    static inline vector_##name##_t *vector_##name##_create(size_t initial_capacity) { \
+        return vector_##name##_create_with_allocator(initial_capacity, NULL); \
+    } \
+    static inline int vector_##name##_destroy(vector_##name##_t *vector) { \
+        const vector_allocator_t *allocator = NULL; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        allocator = vector->allocator; \
+        VECTOR_LOCK_DESTROY(lock_policy, &vector->lock); \
+        if (vector->block != NULL) { \
+            allocator->free(allocator->p_context, vector->block, vector_##name##_block_bytes(vector->capacity)); \
+        } \
+        allocator->free(allocator->p_context, vector, sizeof(vector_##name##_t)); \
+        return 0; \
+    } \
+    /** Record at index, gathered from the columns. No lock and no bounds check, index must be in [0, size). */ \
+    static inline record_type vector_##name##_at(const vector_##name##_t *vector, size_t index) { \
+        record_type record; \
+        record_type *out = &record; \
+        FIELDS(SOA_VECTOR_LOAD_FIELD) \
+        return record; \
+    } \
+    /** Number of records in the vector. No lock, so only a snapshot if other threads push or pop. */ \
+    static inline size_t vector_##name##_size(const vector_##name##_t *vector) { \
+        return vector->size; \
+    }
+
+/**
+ * Structure-of-arrays vector definition macro for a vector named vector_<name>_t of record_type records, which
+ * must have a member for every field of FIELDS, and guarded by lock_policy (MUTEX, SPINLOCK or NOLOCK). Use it
+ * directly to store an existing struct type, or for a second lock policy of one record.
+ */
+#define SOA_VECTOR_WITH_LOCK(name, record_type, FIELDS, lock_policy) \
+    typedef struct _vector_##name vector_##name##_t; \
+    SOA_VECTOR_VTBL_T(name, record_type) \
+    SOA_VECTOR_T(name, FIELDS, lock_policy) \
+    SOA_VECTOR_FUNCS(name, record_type, FIELDS, lock_policy)
+
+/** Structure-of-arrays vector definition macro, generates the record <name>_t and vector_<name>_t (MUTEX). */
+#define SOA_VECTOR(name, FIELDS) \
+    SOA_RECORD(name, FIELDS) \
+    SOA_VECTOR_WITH_LOCK(name, name##_t, FIELDS, MUTEX)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/*
+Usage, at file scope:
+    #define PARTICLE_FIELDS(X) X(double, x) X(double, y) X(uint32_t, id)
+    SOA_VECTOR(particle, PARTICLE_FIELDS)
+then:
+    vector_particle_t *particles = vector_particle_create(0);
+    particles->vptr->push(particles, (particle_t){1.0, 2.0, 7});
+    double sum_x = vector_simd_double_sum(particles->x, vector_particle_size(particles));
+    vector_particle_destroy(particles);
+*/
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_SOA_H_ */
@@ -0,0 +1,411 @@
+/**
+* @file vector_sort.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Radix sort and binary search kernels over plain arrays, sequential or on several threads.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_sort.h" /* Used to expose the sort API. */
+#include "vector_atomic.h" /* Used for the shared bucket counter. */
+#include "vector_thread_pool.h" /* Used to run the phases on the shared thread pool and for the number of CPUs. */
+#include <limits.h> /* Used for CHAR_MIN and INT_MAX */
+#include <string.h> /* Used for memcpy and memset */
+
+/* If MSVC */
+#ifdef _MSC_VER
+    #include <intrin.h> /* Used for _BitScanReverse64 */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the number of key bits sorted per pass. */
+#define SORT_RADIX_BITS         (8)
+/** definition for the number of buckets per pass. */
+#define SORT_BUCKETS            (1 << SORT_RADIX_BITS)
+/** definition for the mask of one digit. */
+#define SORT_DIGIT_MASK         (SORT_BUCKETS - 1)
+/** definition for the max count sorted by insertion instead of by radix. */
+#define SORT_INSERTION_MAX      (32)
+/** definition for the least number of values worth a thread of their own. */
+#define SORT_MIN_PER_THREAD     ((size_t)1 << 16)
+/** definition for the max bytes sorted by LSD passes over the whole array, bigger arrays are first split into buckets. */
+#define SORT_CACHE_BYTES        ((size_t)512 * 1024)
+
+/* If GCC or clang */
+#ifdef __GNUC__
+    #define SORT_PREFETCH(p_address) __builtin_prefetch((p_address))
+#else
+    #define SORT_PREFETCH(p_address) ((void)(p_address))
+#endif
+
+/** Macro to generate the sort kernels of data_type, ordered by the key_type keys of sort_<data_type>_key. */
+#define SORT_KERNELS(data_type, key_type) \
+    typedef struct _sort_##data_type##_context { \
+        data_type *p_data;                                  /**< The values to sort */ \
+        data_type *p_buffer;                                /**< Scratch array of count values */ \
+        size_t count;                                       /**< Number of values */ \
+        unsigned int threads;                               /**< Number of slices, one per thread */ \
+        unsigned int shift;                                 /**< Lowest key bit of the digit the values are scattered on */ \
+        key_type first_key;                                 /**< Key of the first value */ \
+        key_type masks[VECTOR_SORT_MAX_THREADS];            /**< Per slice, the key bits that differ from first_key */ \
+        size_t (*p_counts)[SORT_BUCKETS];                   /**< Per slice, the count and then the next index of every bucket */ \
+        size_t bucket_starts[SORT_BUCKETS + 1];             /**< Index of the first value of every bucket */ \
+        size_t next_bucket;                                 /**< Next bucket a thread sorts, taken atomically */ \
+    } sort_##data_type##_context_t; \
+    static void sort_##data_type##_insertion(data_type *p_data, size_t count) { \
+        for (size_t idx = 1; idx < count; idx++) { \
+            data_type value = p_data[idx]; \
+            key_type key = sort_##data_type##_key(value); \
+            size_t hole = idx; \
+            while (hole > 0 && sort_##data_type##_key(p_data[hole - 1]) > key) { \
+                p_data[hole] = p_data[hole - 1]; \
+                hole--; \
+            } \
+            p_data[hole] = value; \
+        } \
+    } \
+    /** Sort on the lowest bits of the keys, leaving the result in p_scratch if into_scratch or else in p_data. Both are clobbered. */ \
+    static void sort_##data_type##_radix(data_type *p_data, data_type *p_scratch, size_t count, unsigned int bits, int into_scratch) { \
+        size_t counts[sizeof(key_type)][SORT_BUCKETS]; \
+        unsigned int digits = (bits + SORT_RADIX_BITS - 1) / SORT_RADIX_BITS; \
+        data_type *p_from = p_data; \
+        data_type *p_to = p_scratch; \
+        data_type *p_target = into_scratch ? p_scratch : p_data; \
+        if (count <= SORT_INSERTION_MAX) { \
+            if (into_scratch) { \
+                memcpy(p_scratch, p_data, count * sizeof(data_type)); \
+            } \
+            sort_##data_type##_insertion(p_target, count); \
+            return; \
+        } \
+        if (digits > sizeof(key_type)) { \
+            digits = sizeof(key_type); \
+        } \
+        /* One pass counts every digit. */ \
+        memset(counts, 0, sizeof(counts)); \
+        for (size_t idx = 0; idx < count; idx++) { \
+            key_type key = sort_##data_type##_key(p_data[idx]); \
+            for (unsigned int digit = 0; digit < digits; digit++) { \
+                counts[digit][(key >> (digit * SORT_RADIX_BITS)) & SORT_DIGIT_MASK]++; \
+            } \
+        } \
+        for (unsigned int digit = 0; digit < digits; digit++) { \
+            unsigned int shift = digit * SORT_RADIX_BITS; \
+            size_t *p_offsets = counts[digit]; \
+            size_t offset = 0; \
+            data_type *p_swap = NULL; \
+            /* A digit every key shares would only copy the values. */ \
+            if (p_offsets[(sort_##data_type##_key(p_from[0]) >> shift) & SORT_DIGIT_MASK] == count) { \
+                continue; \
+            } \
+            for (unsigned int bucket = 0; bucket < SORT_BUCKETS; bucket++) { \
+                size_t bucket_count = p_offsets[bucket]; \
+                p_offsets[bucket] = offset; \
+                offset += bucket_count; \
+            } \
+            for (size_t idx = 0; idx < count; idx++) { \
+                data_type value = p_from[idx]; \
+                p_to[p_offsets[(sort_##data_type##_key(value) >> shift) & SORT_DIGIT_MASK]++] = value; \
+            } \
+            p_swap = p_from; \
+            p_from = p_to; \
+            p_to = p_swap; \
+        } \
+        if (p_from != p_target) { \
+            memcpy(p_target, p_from, count * sizeof(data_type)); \
+        } \
+    } \
+    static void sort_##data_type##_phase_mask(void *p_arg, unsigned int thread) { \
+        sort_##data_type##_context_t *p_context = (sort_##data_type##_context_t *)p_arg; \
+        size_t end = sort_slice_begin(p_context->count, p_context->threads, thread + 1); \
+        key_type mask = 0; \
+        for (size_t idx = sort_slice_begin(p_context->count, p_context->threads, thread); idx < end; idx++) { \
+            mask |= (key_type)(sort_##data_type##_key(p_context->p_data[idx]) ^ p_context->first_key); \
+        } \
+        p_context->masks[thread] = mask; \
+    } \
+    static void sort_##data_type##_phase_count(void *p_arg, unsigned int thread) { \
+        sort_##data_type##_context_t *p_context = (sort_##data_type##_context_t *)p_arg; \
+        size_t *p_counts = p_context->p_counts[thread]; \
+        size_t end = sort_slice_begin(p_context->count, p_context->threads, thread + 1); \
+        memset(p_counts, 0, SORT_BUCKETS * sizeof(size_t)); \
+        for (size_t idx = sort_slice_begin(p_context->count, p_context->threads, thread); idx < end; idx++) { \
+            p_counts[(sort_##data_type##_key(p_context->p_data[idx]) >> p_context->shift) & SORT_DIGIT_MASK]++; \
+        } \
+    } \
+    static void sort_##data_type##_phase_scatter(void *p_arg, unsigned int thread) { \
+        sort_##data_type##_context_t *p_context = (sort_##data_type##_context_t *)p_arg; \
+        size_t *p_offsets = p_context->p_counts[thread]; \
+        size_t end = sort_slice_begin(p_context->count, p_context->threads, thread + 1); \
+        for (size_t idx = sort_slice_begin(p_context->count, p_context->threads, thread); idx < end; idx++) { \
+            data_type value = p_context->p_data[idx]; \
+            p_context->p_buffer[p_offsets[(sort_##data_type##_key(value) >> p_context->shift) & SORT_DIGIT_MASK]++] = value; \
+        } \
+    } \
+    static void sort_##data_type##_phase_buckets(void *p_arg, unsigned int thread) { \
+        sort_##data_type##_context_t *p_context = (sort_##data_type##_context_t *)p_arg; \
+        size_t bucket = 0; \
+        (void)thread; \
+        while ((bucket = VECTOR_ATOMIC_FETCH_ADD_SIZE(&p_context->next_bucket, 1)) < SORT_BUCKETS) { \
+            size_t start = p_context->bucket_starts[bucket]; \
+            sort_##data_type##_radix(p_context->p_buffer + start, p_context->p_data + start, \
+                p_context->bucket_starts[bucket + 1] - start, p_context->shift, 1); \
+        } \
+    } \
+    int vector_sort_##data_type(data_type *p_data, size_t count, unsigned int threads, const vector_allocator_t *p_allocator) { \
+        const vector_allocator_t *p_counts_allocator = vector_allocator_default(); \
+        sort_##data_type##_context_t context; \
+        key_type mask = 0; \
+        size_t offset = 0; \
+        if (p_data == NULL && count > 0) { \
+            return -1; \
+        } \
+        if (count <= SORT_INSERTION_MAX) { \
+            sort_##data_type##_insertion(p_data, count); \
+            return 0; \
+        } \
+        if (p_allocator == NULL) { \
+            p_allocator = vector_allocator_default(); \
+        } \
+        memset(&context, 0, sizeof(context)); \
+        context.p_data = p_data; \
+        context.count = count; \
+        context.threads = sort_threads(threads, count); \
+        context.p_buffer = (data_type *)p_allocator->alloc(p_allocator->p_context, count * sizeof(data_type)); \
+        if (context.p_buffer == NULL) { \
+            return -1; \
+        } \
+        if (context.threads == 1 && count * sizeof(data_type) <= SORT_CACHE_BYTES) { \
+            sort_##data_type##_radix(p_data, context.p_buffer, count, (unsigned int)(sizeof(key_type) * CHAR_BIT), 0); \
+            p_allocator->free(p_allocator->p_context, context.p_buffer, count * sizeof(data_type)); \
+            return 0; \
+        } \
+        /* The counts are small and come from the heap, so the scratch stays the last block of p_allocator and an */ \
+        /* arena, which only gives back its last block, gets it back when it is freed. */ \
+        context.p_counts = (size_t (*)[SORT_BUCKETS])p_counts_allocator->alloc(p_counts_allocator->p_context, context.threads * sizeof(*context.p_counts)); \
+        if (context.p_counts == NULL) { \
+            p_allocator->free(p_allocator->p_context, context.p_buffer, count * sizeof(data_type)); \
+            return -1; \
+        } \
+        /* Scatter on the highest digit any two keys differ in, so skewed keys still spread over the buckets. The */ \
+        /* buckets are then small enough for their LSD passes to stay in cache, which pays off even on one thread. */ \
+        context.first_key = sort_##data_type##_key(p_data[0]); \
+        sort_run_phase(sort_##data_type##_phase_mask, &context, context.threads); \
+        for (unsigned int thread = 0; thread < context.threads; thread++) { \
+            mask |= context.masks[thread]; \
+        } \
+        if (mask != 0) { \
+            unsigned int high_bit = sort_high_bit((uint64_t)mask); \
+            context.shift = (high_bit >= SORT_RADIX_BITS) ? high_bit - (SORT_RADIX_BITS - 1) : 0; \
+            sort_run_phase(sort_##data_type##_phase_count, &context, context.threads); \
+            for (unsigned int bucket = 0; bucket < SORT_BUCKETS; bucket++) { \
+                context.bucket_starts[bucket] = offset; \
+                for (unsigned int thread = 0; thread < context.threads; thread++) { \
+                    size_t bucket_count = context.p_counts[thread][bucket]; \
+                    context.p_counts[thread][bucket] = offset; \
+                    offset += bucket_count; \
+                } \
+            } \
+            context.bucket_starts[SORT_BUCKETS] = count; \
+            sort_run_phase(sort_##data_type##_phase_scatter, &context, context.threads); \
+            sort_run_phase(sort_##data_type##_phase_buckets, &context, context.threads); \
+        } \
+        p_counts_allocator->free(p_counts_allocator->p_context, context.p_counts, context.threads * sizeof(*context.p_counts)); \
+        p_allocator->free(p_allocator->p_context, context.p_buffer, count * sizeof(data_type)); \
+        return 0; \
+    } \
+    size_t vector_sort_##data_type##_lower_bound(const data_type *p_data, size_t count, data_type value) { \
+        const data_type *p_base = p_data; \
+        if (count == 0) { \
+            return 0; \
+        } \
+        /* Halve the range without a branch on the comparison, which is unpredictable by design, and fetch */ \
+        /* both values the next step may compare so the cache misses overlap. */ \
+        while (count > 1) { \
+            size_t half = count / 2; \
+            SORT_PREFETCH(&p_base[half / 2]); \
+            SORT_PREFETCH(&p_base[half + half / 2]); \
+            p_base = (p_base[half - 1] < value) ? p_base + half : p_base; \
+            count -= half; \
+        } \
+        return (size_t)(p_base - p_data) + (size_t)(*p_base < value); \
+    }
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/** Work of one slice of a parallel phase. */
+typedef void (*sort_phase_t)(void *p_context, unsigned int thread);
+
+/**
+ * @brief A phase handed to the thread pool, which runs it on a range of slices.
+ *
+ */
+typedef struct _sort_phase_run {
+    sort_phase_t phase;                 /**< The phase to run. */
+    void *p_context;                    /**< Context of the sort. */
+} sort_phase_run_t;
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static unsigned int sort_threads(unsigned int threads, size_t count);
+static size_t sort_slice_begin(size_t count, unsigned int threads, unsigned int thread);
+static unsigned int sort_high_bit(uint64_t mask);
+static void sort_phase_task(size_t begin, size_t end, void *p_arg);
+static void sort_run_phase(sort_phase_t phase, void *p_context, unsigned int threads);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/** The key of a signed int, its bits with the sign bit flipped. */
+static inline unsigned int sort_int_key(int value) {
+    return (unsigned int)value ^ ((unsigned int)INT_MAX + 1u);
+}
+
+/** The key of a char, its bits with the sign bit flipped where char is signed. */
+static inline unsigned char sort_char_key(char value) {
+    return (unsigned char)((unsigned char)value ^ ((CHAR_MIN < 0) ? 0x80u : 0u));
+}
+
+/** The key of a double. Positive values set the sign bit, negative ones flip every bit, NaN is the largest. */
+static inline uint64_t sort_double_key(double value) {
+    uint64_t bits = 0;
+
+    if(value != value) {
+        return UINT64_MAX;
+    }
+    memcpy(&bits, &value, sizeof(bits));
+
+    return (bits >> 63) ? ~bits : (bits | ((uint64_t)1 << 63));
+}
+
+/** The key of an unsigned value, the value itself. */
+static inline uint8_t sort_uint8_t_key(uint8_t value) {
+    return value;
+}
+
+/** The key of an unsigned value, the value itself. */
+static inline uint16_t sort_uint16_t_key(uint16_t value) {
+    return value;
+}
+
+/** The key of an unsigned value, the value itself. */
+static inline uint32_t sort_uint32_t_key(uint32_t value) {
+    return value;
+}
+
+/** The key of an unsigned value, the value itself. */
+static inline uint64_t sort_uint64_t_key(uint64_t value) {
+    return value;
+}
+
+SORT_KERNELS(int, unsigned int)
+SORT_KERNELS(double, uint64_t)
+SORT_KERNELS(char, unsigned char)
+SORT_KERNELS(uint8_t, uint8_t)
+SORT_KERNELS(uint16_t, uint16_t)
+SORT_KERNELS(uint32_t, uint32_t)
+SORT_KERNELS(uint64_t, uint64_t)
+
+/**
+ * @brief Number of threads a sort with threads 0 runs on, one per online CPU, see vector_thread_pool_cpu_count.
+ *
+ * @return unsigned int The number of CPUs, at least 1.
+ */
+unsigned int vector_sort_default_threads(void) {
+
+    return vector_thread_pool_cpu_count();
+}
+
+/**
+ * @brief Number of threads a sort of count values runs on.
+ *
+ * @param threads Requested number of threads, 0 for one per CPU.
+ * @param count Number of values.
+ * @return unsigned int threads, clamped so every thread gets at least SORT_MIN_PER_THREAD values. At least 1.
+ */
+static unsigned int sort_threads(unsigned int threads, size_t count) {
+
+    size_t useful = count / SORT_MIN_PER_THREAD;
+
+    if(threads == 0) {
+        threads = vector_sort_default_threads();
+    }
+    if(threads > VECTOR_SORT_MAX_THREADS) {
+        threads = VECTOR_SORT_MAX_THREADS;
+    }
+    if(useful < threads) {
+        threads = (useful > 0) ? (unsigned int)useful : 1u;
+    }
+
+    return threads;
+}
+
+/**
+ * @brief Index of the first value of a slice, slices differ in size by at most one value.
+ *
+ * @param count Number of values.
+ * @param threads Number of slices.
+ * @param thread The slice, threads for the end of the last one.
+ * @return size_t The index.
+ */
+static size_t sort_slice_begin(size_t count, unsigned int threads, unsigned int thread) {
+
+    size_t remainder = count % threads;
+
+    return (count / threads) * thread + ((thread < remainder) ? thread : remainder);
+}
+
+/**
+ * @brief Index of the highest set bit.
+ *
+ * @param mask The bits, not 0.
+ * @return unsigned int The index, 0 for the lowest bit.
+ */
+static unsigned int sort_high_bit(uint64_t mask) {
+
+#ifdef _MSC_VER
+    unsigned long bit = 0;
+
+    _BitScanReverse64(&bit, mask);
+
+    return (unsigned int)bit;
+#else
+    return 63u - (unsigned int)__builtin_clzll(mask);
+#endif
+}
+
+/**
+ * @brief Helper function to run a phase on the slices [begin, end), a task of the thread pool.
+ *
+ * @param begin First slice.
+ * @param end Slice after the last one.
+ * @param p_arg The sort_phase_run_t of the phase.
+ */
+static void sort_phase_task(size_t begin, size_t end, void *p_arg) {
+
+    const sort_phase_run_t *p_run = (const sort_phase_run_t *)p_arg;
+
+    for (size_t thread = begin; thread < end; thread++) {
+        p_run->phase(p_run->p_context, (unsigned int)thread);
+    }
+}
+
+/**
+ * @brief Run a phase on every slice on the shared thread pool, and wait for all of them.
+ *
+ * The calling thread runs slices too. Without a pool, or when every pool thread is busy, the slices run on the
+ * calling thread, so the phase always completes, just with less parallelism.
+ *
+ * @param phase The phase.
+ * @param p_context Context of the sort.
+ * @param threads Number of slices.
+ */
+static void sort_run_phase(sort_phase_t phase, void *p_context, unsigned int threads) {
+
+    sort_phase_run_t run = {phase, p_context};
+
+    (void)vector_thread_pool_for(threads, 1, sort_phase_task, &run);
+}
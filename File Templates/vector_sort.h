@@ -0,0 +1,77 @@
+/**
+ * @file vector_sort.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Radix sort and binary search kernels over plain arrays, sequential or on several threads.
+ *
+ * Every type is sorted by an LSD radix sort on an unsigned key with the same order as the values: signed
+ * integers flip their sign bit and doubles flip their sign bit or, when negative, every bit. Passes over a
+ * digit that is the same in every key are skipped. The parallel sort first scatters the values on their
+ * highest varying digit with one thread per slice, then sorts the buckets on the remaining digits with the
+ * threads taking buckets in turn. The slices run on the shared thread pool of vector_thread_pool.h.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_SORT_H_
+#define _VECTOR_SORT_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include "vector_allocator.h" /* For vector_allocator_t */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the max number of threads a parallel sort runs on, more are clamped. */
+#define VECTOR_SORT_MAX_THREADS (256)
+
+/**
+ * Kernel declarations macro for arrays of data_type. sort orders ascending on threads threads, 0 for one per
+ * CPU, with a scratch copy of the array from p_allocator, NULL for the default. The scratch is the only block
+ * taken from p_allocator and is freed before returning, so an arena gets it back. Doubles sort -0.0 before 0.0
+ * and every NaN last. lower_bound gives the first index whose value is not less than value, count if none.
+ */
+#define VECTOR_SORT_KERNELS_DECLARE(data_type) \
+    int vector_sort_##data_type(data_type *p_data, size_t count, unsigned int threads, const vector_allocator_t *p_allocator); \
+    size_t vector_sort_##data_type##_lower_bound(const data_type *p_data, size_t count, data_type value);
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+VECTOR_SORT_KERNELS_DECLARE(int)
+VECTOR_SORT_KERNELS_DECLARE(double)
+VECTOR_SORT_KERNELS_DECLARE(char)
+VECTOR_SORT_KERNELS_DECLARE(uint8_t)
+VECTOR_SORT_KERNELS_DECLARE(uint16_t)
+VECTOR_SORT_KERNELS_DECLARE(uint32_t)
+VECTOR_SORT_KERNELS_DECLARE(uint64_t)
+
+/**
+ * @brief Number of threads a sort with threads 0 runs on, one per online CPU, see vector_thread_pool_cpu_count.
+ *
+ * @return unsigned int The number of CPUs, at least 1.
+ */
+unsigned int vector_sort_default_threads(void);
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_SORT_H_ */
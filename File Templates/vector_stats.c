@@ -0,0 +1,170 @@
+/**
+* @file vector_stats.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Registry of the live vectors and the clock of the vector lock counters.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_stats.h" /* Used to expose the stats API. */
+#include <stdio.h> /* Used for fprintf */
+#include <inttypes.h> /* Used for PRIu64 */
+
+/* If Windows */
+#ifdef _WIN32
+    #include <windows.h> /* Used for the registry lock and the clock */
+#else /* If POSIX-like system */
+    #include <pthread.h> /* Used for the registry lock */
+    #include <sched.h> /* Used for sched_yield */
+    #include <time.h> /* Used for clock_gettime */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the number of times the registry tries the lock of a vector before it reports it busy. */
+#define STATS_READ_ROUNDS       (1000)
+
+/* If Windows */
+#ifdef _WIN32
+    /* A critical section cannot be initialized statically, an SRW lock can. */
+    #define STATS_LOCK_TYPE SRWLOCK
+    #define STATS_LOCK_INITIALIZER SRWLOCK_INIT
+    #define STATS_LOCK(p_lock) AcquireSRWLockExclusive((p_lock))
+    #define STATS_UNLOCK(p_lock) ReleaseSRWLockExclusive((p_lock))
+    #define STATS_YIELD() SwitchToThread()
+#else /* If POSIX-like system */
+    #define STATS_LOCK_TYPE pthread_mutex_t
+    #define STATS_LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+    #define STATS_LOCK(p_lock) pthread_mutex_lock((p_lock))
+    #define STATS_UNLOCK(p_lock) pthread_mutex_unlock((p_lock))
+    #define STATS_YIELD() sched_yield()
+#endif
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/** Guards the list of live vectors. */
+static STATS_LOCK_TYPE s_registry_lock = STATS_LOCK_INITIALIZER;
+
+/** Sentinel of the circular list of live vectors, oldest after it. */
+static vector_stats_entry_t s_registry = { &s_registry, &s_registry, NULL, NULL, NULL };
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+/**
+ * @brief Helper function to write the stats of one vector as a line of JSON.
+ *
+ * @param p_name Name of the vector type.
+ * @param p_vector The vector.
+ * @param p_stats Its stats, NULL if it was busy.
+ * @param p_context The FILE to write to.
+ */
+static void stats_dump_one(const char *p_name, const void *p_vector, const vector_stats_t *p_stats, void *p_context);
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+uint64_t vector_stats_now_ns(void) {
+/* If Windows */
+#ifdef _WIN32
+    static LARGE_INTEGER s_frequency = {0};
+    LARGE_INTEGER counter;
+    if (s_frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&s_frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((counter.QuadPart / s_frequency.QuadPart) * 1000000000ull +
+                      (counter.QuadPart % s_frequency.QuadPart) * 1000000000ull / s_frequency.QuadPart);
+#else /* If POSIX-like system */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+void vector_stats_register(vector_stats_entry_t *p_entry, const char *p_name, void *p_vector, vector_stats_read_t read) {
+    if (p_entry == NULL) {
+        return;
+    }
+    p_entry->p_name = p_name;
+    p_entry->p_vector = p_vector;
+    p_entry->read = read;
+    STATS_LOCK(&s_registry_lock);
+    p_entry->p_next = &s_registry;
+    p_entry->p_prev = s_registry.p_prev;
+    s_registry.p_prev->p_next = p_entry;
+    s_registry.p_prev = p_entry;
+    STATS_UNLOCK(&s_registry_lock);
+}
+
+void vector_stats_unregister(vector_stats_entry_t *p_entry) {
+    if (p_entry == NULL || p_entry->p_next == NULL) {
+        return;
+    }
+    STATS_LOCK(&s_registry_lock);
+    p_entry->p_prev->p_next = p_entry->p_next;
+    p_entry->p_next->p_prev = p_entry->p_prev;
+    STATS_UNLOCK(&s_registry_lock);
+    p_entry->p_prev = NULL;
+    p_entry->p_next = NULL;
+}
+
+int vector_stats_foreach(vector_stats_visit_t visit, void *p_context) {
+    vector_stats_entry_t *p_entry = NULL;
+    vector_stats_t stats;
+    int count = 0;
+    if (visit == NULL) {
+        return -1;
+    }
+    STATS_LOCK(&s_registry_lock);
+    for (p_entry = s_registry.p_next; p_entry != &s_registry; p_entry = p_entry->p_next) {
+        /* Only try the lock: its holder may be waiting for the registry, to create a vector in a parallel_for. */
+        int read = -1;
+        for (int round = 0; (read != 0) && (round < STATS_READ_ROUNDS); round++) {
+            read = p_entry->read(p_entry->p_vector, &stats);
+            if (read != 0) {
+                STATS_YIELD();
+            }
+        }
+        visit(p_entry->p_name, p_entry->p_vector, (read == 0) ? &stats : NULL, p_context);
+        count++;
+    }
+    STATS_UNLOCK(&s_registry_lock);
+    return count;
+}
+
+int vector_stats_dump(FILE *p_file) {
+    int count = 0;
+    if (p_file == NULL) {
+        return -1;
+    }
+    count = vector_stats_foreach(stats_dump_one, p_file);
+    if (count < 0 || fflush(p_file) != 0 || ferror(p_file)) {
+        return -1;
+    }
+    return count;
+}
+
+static void stats_dump_one(const char *p_name, const void *p_vector, const vector_stats_t *p_stats, void *p_context) {
+    FILE *p_file = (FILE *)p_context;
+    if (p_stats == NULL) {
+        fprintf(p_file, "{\"vector\": \"%s\", \"address\": \"%p\", \"busy\": true}\n", p_name, p_vector);
+        return;
+    }
+    fprintf(p_file,
+            "{\"vector\": \"%s\", \"address\": \"%p\", \"element_size\": %zu, \"size\": %zu, \"capacity\": %zu, "
+            "\"peak_capacity\": %zu, \"bytes\": %zu, \"unused_bytes\": %zu, \"pushes\": %" PRIu64 ", \"gets\": %" PRIu64 ", "
+            "\"reallocs\": %" PRIu64 ", \"bytes_moved\": %" PRIu64 ", \"lock_acquires\": %" PRIu64 ", "
+            "\"lock_contended\": %" PRIu64 ", \"lock_wait_ns\": %" PRIu64 "}\n",
+            p_name, p_vector, p_stats->element_size, p_stats->size, p_stats->capacity, p_stats->peak_capacity,
+            p_stats->capacity * p_stats->element_size, (p_stats->capacity - p_stats->size) * p_stats->element_size,
+            p_stats->pushes, p_stats->gets, p_stats->reallocs, p_stats->bytes_moved, p_stats->lock_acquires,
+            p_stats->lock_contended, p_stats->lock_wait_ns);
+}
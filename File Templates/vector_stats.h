@@ -0,0 +1,159 @@
+/**
+ * @file vector_stats.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Optional growth and lock counters of the vectors, and a registry of the live vectors to dump them from.
+ *
+ * The counters are only compiled in when VECTOR_STATS is defined, by the CMake option of the same name, for the
+ * library and every file that includes vector_wip.h alike. Every vector then carries a vector_stats_t, updated
+ * under its lock, and is added to the registry by create and map and removed by destroy. vector_<T>_stats reads
+ * the counters of one vector and vector_stats_dump writes those of every live vector, to find the vectors that
+ * hold far more capacity than values or wait on their lock the most. Without VECTOR_STATS the vectors are
+ * unchanged, vector_<T>_stats fails and the registry stays empty.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_STATS_H_
+#define _VECTOR_STATS_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+#include <stdio.h> /* For FILE */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/**
+ * Vector stats function declarations macro. stats reads the counters of the vector with its size and capacity,
+ * and fails when VECTOR_STATS is not defined. The vector is named by its struct tag, since vector_wip.h includes
+ * this header for the counters before it defines vector_<name>_t.
+ */
+#define VECTOR_STATS_FUNCTIONS_DECLARE(name) \
+    struct _vector_##name; \
+    int vector_##name##_stats(struct _vector_##name *vector, vector_stats_t *out);
+
+/** Vector stats function declarations macro for every lock policy of a type. */
+#define VECTOR_STATS_FUNCTIONS_DECLARE_ALL(data_type) \
+    VECTOR_STATS_FUNCTIONS_DECLARE(data_type) \
+    VECTOR_STATS_FUNCTIONS_DECLARE(data_type##_spinlock) \
+    VECTOR_STATS_FUNCTIONS_DECLARE(data_type##_nolock)
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/**
+ * @brief Counters of a vector. The vector keeps the counters, size, capacity and element_size are filled in when
+ * the stats are read.
+ *
+ */
+typedef struct _vector_stats {
+    uint64_t pushes;                    /**< Values pushed by push, push_fast and append_array */
+    uint64_t gets;                      /**< Values read by get, get_fast and get_range, not by at */
+    uint64_t reallocs;                  /**< Resizes of the data, by growth, reserve and shrink_to_fit */
+    uint64_t bytes_moved;               /**< Bytes copied by the resizes that could not resize the data in place */
+    uint64_t lock_acquires;             /**< Times the lock was taken */
+    uint64_t lock_contended;            /**< Times the lock was held by another thread and had to be waited for */
+    uint64_t lock_wait_ns;              /**< Nanoseconds spent waiting for the lock */
+    size_t peak_capacity;               /**< Largest capacity the vector had */
+    size_t size;                        /**< Number of values when the stats were read */
+    size_t capacity;                    /**< Capacity when the stats were read */
+    size_t element_size;                /**< Bytes of a value */
+} vector_stats_t;
+
+/** Read the stats of the vector at p_vector, without waiting for its lock. 0 on success, -1 if it is held. */
+typedef int (*vector_stats_read_t)(void *p_vector, vector_stats_t *out);
+
+/**
+ * @brief Node of a vector in the registry. Lives in the vector and is only touched by the registry.
+ *
+ */
+typedef struct _vector_stats_entry {
+    struct _vector_stats_entry *p_prev; /**< Previous live vector */
+    struct _vector_stats_entry *p_next; /**< Next live vector */
+    const char *p_name;                 /**< Name of the vector type, as in vector_<name>_t */
+    void *p_vector;                     /**< The vector */
+    vector_stats_read_t read;           /**< Reads its stats */
+} vector_stats_entry_t;
+
+/**
+ * Function vector_stats_foreach calls on every live vector. p_stats is NULL for a vector whose lock stayed held
+ * while the registry tried to read it.
+ */
+typedef void (*vector_stats_visit_t)(const char *p_name, const void *p_vector, const vector_stats_t *p_stats, void *p_context);
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Monotonic time the lock waits are measured with.
+ *
+ * @return uint64_t Nanoseconds since an arbitrary point.
+ */
+uint64_t vector_stats_now_ns(void);
+
+/**
+ * @brief Add a vector to the registry. Called by the vector functions.
+ *
+ * @param p_entry Node of the vector.
+ * @param p_name Name of the vector type, must outlive the vector.
+ * @param p_vector The vector.
+ * @param read Reads its stats.
+ */
+void vector_stats_register(vector_stats_entry_t *p_entry, const char *p_name, void *p_vector, vector_stats_read_t read);
+
+/**
+ * @brief Remove a vector from the registry before it is destroyed. Called by the vector functions.
+ *
+ * @param p_entry Node the vector was registered with.
+ */
+void vector_stats_unregister(vector_stats_entry_t *p_entry);
+
+/**
+ * @brief Call visit on every live vector, oldest first. The registry stays locked throughout, so visit must not
+ * create or destroy vectors. A vector whose lock is held is retried for a while, so a dump never waits on a
+ * thread that holds one for long, and is visited with NULL stats if it stays held.
+ *
+ * The counters of a NOLOCK vector are read without a lock, so they are only a snapshot if its thread uses it.
+ *
+ * @param visit The function.
+ * @param p_context Passed to visit.
+ * @return int Number of vectors visited, -1 on fail.
+ */
+int vector_stats_foreach(vector_stats_visit_t visit, void *p_context);
+
+/**
+ * @brief Write one JSON object per live vector, one per line, with its type, address, size, capacity, bytes
+ * and unused bytes of capacity, and its counters. A vector whose lock stayed held has "busy": true instead.
+ *
+ * @param p_file Where to write.
+ * @return int Number of vectors written, -1 on fail.
+ */
+int vector_stats_dump(FILE *p_file);
+
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(int)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(double)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(char)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(uint8_t)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(uint16_t)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(uint32_t)
+VECTOR_STATS_FUNCTIONS_DECLARE_ALL(uint64_t)
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_STATS_H_ */
@@ -0,0 +1,623 @@
+/**
+* @file vector_thread_pool.c
+* @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+* @brief Shared work-stealing thread pool that runs a function over the chunks of an index range.
+* @version 0.1
+* @date 2025-04-03
+*
+* @copyright Microchip Technology Inc. Copyright (c) 2025
+*
+*/
+/* -------------------- Private Includes ------------------------------------------- */
+#include "vector_thread_pool.h" /* Used to expose the pool API. */
+#include "vector_wip.h" /* Used for the mutex and VECTOR_CPU_RELAX */
+#include "vector_atomic.h" /* Used for the deques and the job counters. */
+#include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memset */
+
+/* If Windows */
+#ifdef _WIN32
+    #include <windows.h> /* Used for threads and the number of CPUs */
+    #include <malloc.h> /* Used for _aligned_malloc */
+#else /* If POSIX-like system */
+    #include <pthread.h> /* Used for threads */
+    #include <sched.h> /* Used for sched_yield */
+    #include <unistd.h> /* Used for sysconf */
+#endif
+
+/* -------------------- Private Macros/Defines ------------------------------------- */
+
+/** definition for the number of tasks a deque holds. A range that does not fit is run by its owner instead. */
+#define POOL_DEQUE_CAPACITY     (128)
+/** definition for the number of failed rounds an idle thread spins before it yields, or sleeps if no job runs. */
+#define POOL_SPIN_ROUNDS        (64)
+/** definition for the number of chunks per thread the default grain aims for. */
+#define POOL_CHUNKS_PER_THREAD  (8)
+/** definition for the least default grain, so a chunk is worth the task. */
+#define POOL_MIN_DEFAULT_GRAIN  (1024)
+
+/** definition for the pool state without threads. */
+#define POOL_STOPPED            (0)
+/** definition for the pool state while start or stop runs. */
+#define POOL_CHANGING           (1)
+/** definition for the pool state with its threads waiting for work. */
+#define POOL_RUNNING            (2)
+
+/* If Windows */
+#ifdef _WIN32
+    #define POOL_ALIGNED_ALLOC(size) _aligned_malloc((size), VECTOR_CACHE_LINE_BYTES)
+    #define POOL_ALIGNED_FREE(p_block) _aligned_free((p_block))
+    #define POOL_THREAD_TYPE HANDLE
+    #define POOL_THREAD_FUNC(function, p_arg) static DWORD WINAPI function(LPVOID p_arg)
+    #define POOL_THREAD_RETURN (0)
+    #define POOL_THREAD_START(p_thread, function, p_arg) ((*(p_thread) = CreateThread(NULL, 0, (function), (p_arg), 0, NULL)) == NULL ? -1 : 0)
+    #define POOL_THREAD_JOIN(thread) (WaitForSingleObject((thread), INFINITE), CloseHandle((thread)))
+    #define POOL_THREAD_LOCAL __declspec(thread)
+    #define POOL_YIELD() SwitchToThread()
+    #define POOL_COND_TYPE CONDITION_VARIABLE
+    #define POOL_COND_INIT(p_cond) InitializeConditionVariable((p_cond))
+    #define POOL_COND_DESTROY(p_cond) ((void)(p_cond))
+    #define POOL_COND_WAIT(p_cond, p_mutex) SleepConditionVariableCS((p_cond), (p_mutex), INFINITE)
+    #define POOL_COND_BROADCAST(p_cond) WakeAllConditionVariable((p_cond))
+#else /* If POSIX-like system */
+    #define POOL_ALIGNED_ALLOC(size) pool_aligned_alloc((size))
+    #define POOL_ALIGNED_FREE(p_block) free((p_block))
+    #define POOL_THREAD_TYPE pthread_t
+    #define POOL_THREAD_FUNC(function, p_arg) static void *function(void *p_arg)
+    #define POOL_THREAD_RETURN (NULL)
+    #define POOL_THREAD_START(p_thread, function, p_arg) pthread_create((p_thread), NULL, (function), (p_arg))
+    #define POOL_THREAD_JOIN(thread) pthread_join((thread), NULL)
+    #define POOL_THREAD_LOCAL _Thread_local
+    #define POOL_YIELD() sched_yield()
+    #define POOL_COND_TYPE pthread_cond_t
+    #define POOL_COND_INIT(p_cond) pthread_cond_init((p_cond), NULL)
+    #define POOL_COND_DESTROY(p_cond) pthread_cond_destroy((p_cond))
+    #define POOL_COND_WAIT(p_cond, p_mutex) pthread_cond_wait((p_cond), (p_mutex))
+    #define POOL_COND_BROADCAST(p_cond) pthread_cond_broadcast((p_cond))
+#endif
+
+/* -------------------- Private Enums ---------------------------------------------- */
+
+/* -------------------- Private Structs -------------------------------------------- */
+
+/**
+ * @brief One vector_thread_pool_for call. Lives on the stack of the caller, which waits until remaining is 0.
+ *
+ */
+typedef struct _pool_job {
+    vector_thread_pool_task_t task;            /**< Function run on every chunk */
+    void *p_context;                    /**< Passed to task */
+    size_t grain;                       /**< Number of indexes of a chunk */
+    size_t remaining;                   /**< Number of indexes not run yet */
+} pool_job_t;
+
+/**
+ * @brief A range of a job in a deque. The fields are read by thieves while the owner may write the slot, so
+ * they are only accessed atomically.
+ *
+ */
+typedef struct _pool_task {
+    pool_job_t *p_job;                  /**< The job */
+    size_t begin;                       /**< First index of the range, a multiple of the grain */
+    size_t end;                         /**< Index past the range */
+} pool_task_t;
+
+/**
+ * @brief Chase-Lev deque of one thread. The owner pushes and pops at the bottom, thieves take from the top.
+ * top and bottom only grow, the slot of index i is tasks[i % POOL_DEQUE_CAPACITY].
+ *
+ */
+typedef struct _pool_deque {
+    size_t top;                                                     /**< Index of the oldest task */
+    char padding_top[VECTOR_CACHE_LINE_BYTES - sizeof(size_t)];     /**< Keeps the thieves off the owner's line */
+    size_t bottom;                                                  /**< Index past the newest task */
+    size_t in_use;                                                  /**< 1 while a guest owns the deque */
+    uint64_t seed;                                                  /**< Random state of the owner, picks victims */
+    char padding_bottom[VECTOR_CACHE_LINE_BYTES - 2 * sizeof(size_t) - sizeof(uint64_t)]; /**< Fills the line */
+    pool_task_t tasks[POOL_DEQUE_CAPACITY];                         /**< The tasks */
+} pool_deque_t;
+
+/**
+ * @brief The pool. Its deques are those of the threads, then VECTOR_THREAD_POOL_MAX_GUESTS for guests.
+ *
+ */
+typedef struct _pool {
+    size_t state;                                   /**< POOL_STOPPED, POOL_CHANGING or POOL_RUNNING */
+    size_t running;                                 /**< 1 until stop tells the threads to exit */
+    size_t active_jobs;                             /**< Number of jobs not done, threads never sleep while > 0 */
+    unsigned int workers;                           /**< Number of thread deques, the guest deques follow them */
+    unsigned int started;                           /**< Number of threads of the pool, the callers not counted */
+    pool_deque_t *p_deques;                         /**< The deques */
+    VECTOR_MUTEX_TYPE mutex;                        /**< Guards the sleep of idle threads */
+    POOL_COND_TYPE wake;                            /**< Wakes the idle threads when a job starts */
+    POOL_THREAD_TYPE threads[VECTOR_THREAD_POOL_MAX_THREADS]; /**< The threads */
+} pool_t;
+
+/* -------------------- Private (static) Vars -------------------------------------- */
+
+/** The pool shared by every parallel call. */
+static pool_t s_pool = {0};
+/** Deque of the calling thread, NULL outside the pool and outside a parallel call. */
+static POOL_THREAD_LOCAL pool_deque_t *s_p_deque = NULL;
+
+/* -------------------- Private (static) Function Declarations --------------------- */
+
+static unsigned int pool_clamp_threads(unsigned int threads);
+static int pool_start_threads(unsigned int threads);
+static int pool_ensure_started(void);
+static pool_deque_t *pool_claim_guest(void);
+static int pool_push(pool_deque_t *p_deque, const pool_task_t *p_task);
+static int pool_pop(pool_deque_t *p_deque, pool_task_t *p_task);
+static int pool_steal(pool_deque_t *p_victim, pool_task_t *p_task);
+static int pool_find_task(pool_deque_t *p_deque, pool_task_t *p_task);
+static void pool_run(pool_deque_t *p_deque, const pool_task_t *p_task);
+static void pool_idle(unsigned int *p_rounds, int may_sleep);
+static void pool_wake(void);
+POOL_THREAD_FUNC(pool_thread_main, p_arg);
+#ifndef _WIN32
+static void *pool_aligned_alloc(size_t size);
+#endif
+
+/* -------------------- Public (global) Vars --------------------------------------- */
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+int vector_thread_pool_start(unsigned int threads) {
+
+    int rv = 0;
+
+    if(!VECTOR_ATOMIC_CAS_SIZE(&s_pool.state, POOL_STOPPED, POOL_CHANGING)) {
+        return -1;
+    }
+
+    rv = pool_start_threads(threads);
+    VECTOR_ATOMIC_STORE_SIZE(&s_pool.state, (rv == 0) ? POOL_RUNNING : POOL_STOPPED);
+
+    return rv;
+}
+
+int vector_thread_pool_stop(void) {
+
+    if(!VECTOR_ATOMIC_CAS_SIZE(&s_pool.state, POOL_RUNNING, POOL_CHANGING)) {
+        return -1;
+    }
+
+    VECTOR_ATOMIC_STORE_SIZE(&s_pool.running, 0);
+    pool_wake();
+    for (unsigned int worker = 0; worker < s_pool.started; worker++) {
+        POOL_THREAD_JOIN(s_pool.threads[worker]);
+    }
+
+    POOL_COND_DESTROY(&s_pool.wake);
+    VECTOR_MUTEX_DESTROY(&s_pool.mutex);
+    POOL_ALIGNED_FREE(s_pool.p_deques);
+    s_pool.p_deques = NULL;
+    s_pool.workers = 0;
+    s_pool.started = 0;
+    VECTOR_ATOMIC_STORE_SIZE(&s_pool.state, POOL_STOPPED);
+
+    return 0;
+}
+
+unsigned int vector_thread_pool_cpu_count(void) {
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return (info.dwNumberOfProcessors > 0) ? (unsigned int)info.dwNumberOfProcessors : 1u;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (cpus > 0) ? (unsigned int)cpus : 1u;
+#endif
+}
+
+unsigned int vector_thread_pool_threads(void) {
+
+    if(VECTOR_ATOMIC_LOAD_SIZE(&s_pool.state) == POOL_RUNNING) {
+        return s_pool.started + 1;
+    }
+
+    return pool_clamp_threads(0);
+}
+
+size_t vector_thread_pool_default_grain(size_t count) {
+
+    size_t grain = count / ((size_t)vector_thread_pool_threads() * POOL_CHUNKS_PER_THREAD);
+
+    return (grain < POOL_MIN_DEFAULT_GRAIN) ? POOL_MIN_DEFAULT_GRAIN : grain;
+}
+
+int vector_thread_pool_for(size_t count, size_t grain, vector_thread_pool_task_t task, void *p_context) {
+
+    pool_deque_t *p_deque = s_p_deque;
+    pool_job_t job;
+    pool_task_t next;
+    unsigned int rounds = 0;
+    int guest = 0;
+
+    if(task == NULL) {
+        return -1;
+    }
+    if(grain == 0) {
+        grain = vector_thread_pool_default_grain(count);
+    }
+
+    /* Run on the calling thread alone when one chunk is all there is or no other thread can help. */
+    if((count > grain) && (p_deque == NULL) && (pool_ensure_started() == 0) && (s_pool.started > 0)) {
+        p_deque = pool_claim_guest();
+        guest = (p_deque != NULL);
+        s_p_deque = p_deque;
+    }
+    if((count <= grain) || (p_deque == NULL)) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            task(begin, (count - begin > grain) ? begin + grain : count, p_context);
+        }
+        return 0;
+    }
+
+    job.task = task;
+    job.p_context = p_context;
+    job.grain = grain;
+    job.remaining = count;
+    VECTOR_ATOMIC_FETCH_ADD_SIZE(&s_pool.active_jobs, 1);
+    pool_wake();
+
+    next.p_job = &job;
+    next.begin = 0;
+    next.end = count;
+    pool_run(p_deque, &next);
+
+    /* Help with whatever is left, the own deque first, until every chunk of the job has run. */
+    while (VECTOR_ATOMIC_LOAD_SIZE(&job.remaining) != 0) {
+        if(pool_find_task(p_deque, &next) == 0) {
+            pool_run(p_deque, &next);
+            rounds = 0;
+        }
+        else {
+            pool_idle(&rounds, 0);
+        }
+    }
+    VECTOR_ATOMIC_FETCH_ADD_SIZE(&s_pool.active_jobs, (size_t)0 - 1);
+
+    if(guest) {
+        /* Ranges of other jobs this thread stole and split are still in its deque, run them before leaving. */
+        while (pool_pop(p_deque, &next) == 0) {
+            pool_run(p_deque, &next);
+        }
+        s_p_deque = NULL;
+        VECTOR_ATOMIC_STORE_SIZE(&p_deque->in_use, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Number of threads a pool started with threads threads has.
+ *
+ * @param threads Requested number of threads, 0 for one per CPU.
+ * @return unsigned int threads, clamped to [1, VECTOR_THREAD_POOL_MAX_THREADS].
+ */
+static unsigned int pool_clamp_threads(unsigned int threads) {
+
+    if(threads == 0) {
+        threads = vector_thread_pool_cpu_count();
+    }
+    if(threads > VECTOR_THREAD_POOL_MAX_THREADS) {
+        threads = VECTOR_THREAD_POOL_MAX_THREADS;
+    }
+
+    return (threads > 0) ? threads : 1u;
+}
+
+/**
+ * @brief Helper function to allocate the deques and start the threads of the pool. A thread that cannot be
+ * started leaves the pool with fewer threads, its deque stays empty.
+ *
+ * @param threads Requested number of threads, the calling thread included, 0 for one per CPU.
+ * @return int 0 on success, -1 if the deques cannot be allocated.
+ */
+static int pool_start_threads(unsigned int threads) {
+
+    unsigned int workers = pool_clamp_threads(threads) - 1;
+    size_t deques = (size_t)workers + VECTOR_THREAD_POOL_MAX_GUESTS;
+
+    s_pool.p_deques = (pool_deque_t *)POOL_ALIGNED_ALLOC(deques * sizeof(pool_deque_t));
+    if(s_pool.p_deques == NULL) {
+        return -1;
+    }
+    memset(s_pool.p_deques, 0, deques * sizeof(pool_deque_t));
+    for (size_t deque = 0; deque < deques; deque++) {
+        s_pool.p_deques[deque].seed = 0x9e3779b97f4a7c15ull * (deque + 1);
+    }
+
+    s_pool.workers = workers;
+    VECTOR_MUTEX_INIT(&s_pool.mutex);
+    POOL_COND_INIT(&s_pool.wake);
+    VECTOR_ATOMIC_STORE_SIZE(&s_pool.running, 1);
+
+    for (s_pool.started = 0; s_pool.started < workers; s_pool.started++) {
+        if(POOL_THREAD_START(&s_pool.threads[s_pool.started], pool_thread_main, &s_pool.p_deques[s_pool.started]) != 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to start the pool if no other thread has.
+ *
+ * @return int 0 once the pool runs, -1 if it cannot be started.
+ */
+static int pool_ensure_started(void) {
+
+    size_t state = 0;
+
+    while ((state = VECTOR_ATOMIC_LOAD_SIZE(&s_pool.state)) != POOL_RUNNING) {
+        if(state == POOL_STOPPED) {
+            if((vector_thread_pool_start(0) != 0) && (VECTOR_ATOMIC_LOAD_SIZE(&s_pool.state) == POOL_STOPPED)) {
+                return -1;
+            }
+        }
+        else {
+            POOL_YIELD();
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to take a guest deque for a thread outside the pool.
+ *
+ * @return pool_deque_t* The deque, NULL if every guest deque is taken.
+ */
+static pool_deque_t *pool_claim_guest(void) {
+
+    for (unsigned int guest = 0; guest < VECTOR_THREAD_POOL_MAX_GUESTS; guest++) {
+        pool_deque_t *p_deque = &s_pool.p_deques[s_pool.workers + guest];
+
+        if((VECTOR_ATOMIC_LOAD_SIZE(&p_deque->in_use) == 0) && VECTOR_ATOMIC_CAS_SIZE(&p_deque->in_use, 0, 1)) {
+            return p_deque;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Push a task to the bottom of the own deque.
+ *
+ * @param p_deque The deque of the calling thread.
+ * @param p_task The task.
+ * @return int 0 on success, -1 if the deque is full.
+ */
+static int pool_push(pool_deque_t *p_deque, const pool_task_t *p_task) {
+
+    size_t bottom = VECTOR_ATOMIC_LOAD_SIZE(&p_deque->bottom);
+    pool_task_t *p_slot = &p_deque->tasks[bottom % POOL_DEQUE_CAPACITY];
+
+    if(bottom - VECTOR_ATOMIC_LOAD_SIZE(&p_deque->top) >= POOL_DEQUE_CAPACITY) {
+        return -1;
+    }
+
+    VECTOR_ATOMIC_STORE_PTR(&p_slot->p_job, p_task->p_job);
+    VECTOR_ATOMIC_STORE_SIZE(&p_slot->begin, p_task->begin);
+    VECTOR_ATOMIC_STORE_SIZE(&p_slot->end, p_task->end);
+    /* The release store publishes the slot to the thieves that read bottom. */
+    VECTOR_ATOMIC_STORE_SIZE(&p_deque->bottom, bottom + 1);
+
+    return 0;
+}
+
+/**
+ * @brief Pop the newest task from the bottom of the own deque.
+ *
+ * @param p_deque The deque of the calling thread.
+ * @param p_task Set to the task.
+ * @return int 0 on success, -1 if the deque is empty or a thief took the last task.
+ */
+static int pool_pop(pool_deque_t *p_deque, pool_task_t *p_task) {
+
+    size_t bottom = VECTOR_ATOMIC_LOAD_SIZE(&p_deque->bottom) - 1;
+    size_t top = 0;
+    pool_task_t *p_slot = &p_deque->tasks[bottom % POOL_DEQUE_CAPACITY];
+    int taken = 1;
+
+    /* Claim the slot before looking at top, the fence orders the two against the thieves' top then bottom. */
+    VECTOR_ATOMIC_STORE_SIZE(&p_deque->bottom, bottom);
+    VECTOR_ATOMIC_FENCE();
+    top = VECTOR_ATOMIC_LOAD_SIZE(&p_deque->top);
+
+    if((ptrdiff_t)(bottom - top) < 0) {
+        VECTOR_ATOMIC_STORE_SIZE(&p_deque->bottom, bottom + 1);
+        return -1;
+    }
+
+    p_task->p_job = (pool_job_t *)VECTOR_ATOMIC_LOAD_PTR(&p_slot->p_job);
+    p_task->begin = VECTOR_ATOMIC_LOAD_SIZE(&p_slot->begin);
+    p_task->end = VECTOR_ATOMIC_LOAD_SIZE(&p_slot->end);
+
+    if(bottom == top) {
+        /* The last task, a thief may be taking it too. */
+        taken = VECTOR_ATOMIC_CAS_SIZE(&p_deque->top, top, top + 1);
+        VECTOR_ATOMIC_STORE_SIZE(&p_deque->bottom, bottom + 1);
+    }
+
+    return taken ? 0 : -1;
+}
+
+/**
+ * @brief Steal the oldest task from the top of the deque of another thread.
+ *
+ * @param p_victim The deque.
+ * @param p_task Set to the task.
+ * @return int 0 on success, -1 if the deque is empty or another thread took the task first.
+ */
+static int pool_steal(pool_deque_t *p_victim, pool_task_t *p_task) {
+
+    size_t top = VECTOR_ATOMIC_LOAD_SIZE(&p_victim->top);
+    size_t bottom = 0;
+    pool_task_t *p_slot = &p_victim->tasks[top % POOL_DEQUE_CAPACITY];
+
+    VECTOR_ATOMIC_FENCE();
+    bottom = VECTOR_ATOMIC_LOAD_SIZE(&p_victim->bottom);
+    if((ptrdiff_t)(bottom - top) <= 0) {
+        return -1;
+    }
+
+    /* The slot cannot be reused before top moves past it, so a torn read only happens when the CAS fails. */
+    p_task->p_job = (pool_job_t *)VECTOR_ATOMIC_LOAD_PTR(&p_slot->p_job);
+    p_task->begin = VECTOR_ATOMIC_LOAD_SIZE(&p_slot->begin);
+    p_task->end = VECTOR_ATOMIC_LOAD_SIZE(&p_slot->end);
+
+    return VECTOR_ATOMIC_CAS_SIZE(&p_victim->top, top, top + 1) ? 0 : -1;
+}
+
+/**
+ * @brief Find a task, from the own deque first, then from the others starting at a random one.
+ *
+ * @param p_deque The deque of the calling thread.
+ * @param p_task Set to the task.
+ * @return int 0 on success, -1 if no deque had a task.
+ */
+static int pool_find_task(pool_deque_t *p_deque, pool_task_t *p_task) {
+
+    size_t deques = (size_t)s_pool.workers + VECTOR_THREAD_POOL_MAX_GUESTS;
+    size_t victim = 0;
+
+    if(pool_pop(p_deque, p_task) == 0) {
+        return 0;
+    }
+
+    p_deque->seed ^= p_deque->seed << 13;
+    p_deque->seed ^= p_deque->seed >> 7;
+    p_deque->seed ^= p_deque->seed << 17;
+    victim = (size_t)(p_deque->seed % deques);
+
+    for (size_t tried = 0; tried < deques; tried++) {
+        pool_deque_t *p_victim = &s_pool.p_deques[victim];
+
+        if((p_victim != p_deque) && (pool_steal(p_victim, p_task) == 0)) {
+            return 0;
+        }
+        victim = (victim + 1 < deques) ? victim + 1 : 0;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Run a task. The range is halved on a multiple of the grain until one chunk is left, and every upper
+ * half goes to the own deque for this or another thread to run.
+ *
+ * @param p_deque The deque of the calling thread.
+ * @param p_task The task.
+ */
+static void pool_run(pool_deque_t *p_deque, const pool_task_t *p_task) {
+
+    pool_job_t *p_job = p_task->p_job;
+    size_t begin = p_task->begin;
+    size_t end = p_task->end;
+
+    while (end - begin > p_job->grain) {
+        size_t chunks = (end - begin - 1) / p_job->grain + 1;
+        pool_task_t upper;
+
+        upper.p_job = p_job;
+        upper.begin = begin + (chunks / 2) * p_job->grain;
+        upper.end = end;
+        if(pool_push(p_deque, &upper) != 0) {
+            pool_run(p_deque, &upper);
+        }
+        end = upper.begin;
+    }
+
+    p_job->task(begin, end, p_job->p_context);
+
+    /* The last access to the job, its caller may return once remaining reaches 0. */
+    VECTOR_ATOMIC_FETCH_ADD_SIZE(&p_job->remaining, (size_t)0 - (end - begin));
+}
+
+/**
+ * @brief Wait a little after failing to find a task: spin, then yield, then sleep until a job starts.
+ *
+ * @param p_rounds Number of rounds failed in a row, updated.
+ * @param may_sleep 1 if the thread may sleep, 0 for a caller waiting for its job.
+ */
+static void pool_idle(unsigned int *p_rounds, int may_sleep) {
+
+    if(++(*p_rounds) < POOL_SPIN_ROUNDS) {
+        VECTOR_CPU_RELAX();
+        return;
+    }
+    if(!may_sleep || (VECTOR_ATOMIC_LOAD_SIZE(&s_pool.active_jobs) != 0)) {
+        POOL_YIELD();
+        return;
+    }
+
+    VECTOR_MUTEX_LOCK(&s_pool.mutex);
+    while (VECTOR_ATOMIC_LOAD_SIZE(&s_pool.running) && (VECTOR_ATOMIC_LOAD_SIZE(&s_pool.active_jobs) == 0)) {
+        POOL_COND_WAIT(&s_pool.wake, &s_pool.mutex);
+    }
+    VECTOR_MUTEX_UNLOCK(&s_pool.mutex);
+    *p_rounds = 0;
+}
+
+/**
+ * @brief Wake the sleeping threads. Taking the mutex orders the wake after the check of a thread going to sleep.
+ *
+ */
+static void pool_wake(void) {
+
+    VECTOR_MUTEX_LOCK(&s_pool.mutex);
+    POOL_COND_BROADCAST(&s_pool.wake);
+    VECTOR_MUTEX_UNLOCK(&s_pool.mutex);
+}
+
+/**
+ * @brief Entry point of the pool threads.
+ *
+ * @param p_arg The pool_deque_t of the thread.
+ */
+POOL_THREAD_FUNC(pool_thread_main, p_arg) {
+
+    pool_deque_t *p_deque = (pool_deque_t *)p_arg;
+    pool_task_t task;
+    unsigned int rounds = 0;
+
+    s_p_deque = p_deque;
+    while (VECTOR_ATOMIC_LOAD_SIZE(&s_pool.running)) {
+        if(pool_find_task(p_deque, &task) == 0) {
+            pool_run(p_deque, &task);
+            rounds = 0;
+        }
+        else {
+            pool_idle(&rounds, 1);
+        }
+    }
+
+    return POOL_THREAD_RETURN;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Helper function to allocate on a cache line boundary, so every deque has its lines to itself.
+ *
+ * @param size Number of bytes.
+ * @return void* The block, NULL on fail.
+ */
+static void *pool_aligned_alloc(size_t size) {
+
+    void *p_block = NULL;
+
+    if(posix_memalign(&p_block, VECTOR_CACHE_LINE_BYTES, size)) {
+        return NULL;
+    }
+
+    return p_block;
+}
+#endif
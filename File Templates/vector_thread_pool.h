@@ -0,0 +1,118 @@
+/**
+ * @file vector_thread_pool.h
+ * @author Zachary Hoagland - C63928 (zachary.hoagland@microchip.com)
+ * @brief Shared work-stealing thread pool that runs a function over the chunks of an index range.
+ *
+ * The pool is started once, on the first parallel call or by vector_thread_pool_start, and every later call
+ * reuses its threads. Each thread owns a Chase-Lev deque: a thread splits the range it runs in halves, pushes
+ * the upper half to the bottom of its deque and goes on with the lower one, and idle threads steal the oldest,
+ * largest halves from the top of the others' deques. Ranges are split on multiples of the grain, so every
+ * chunk the function gets is [k * grain, min((k + 1) * grain, count)). The calling thread takes part in the
+ * work until the whole range is done. The parallel vector functions, the sort kernels and the collect of the
+ * sharded vectors all run on this one pool. It is not the size class pool of vector_allocator.h.
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Microchip Technology Inc. Copyright (c) 2025
+ *
+ */
+#ifndef _VECTOR_THREAD_POOL_H_
+#define _VECTOR_THREAD_POOL_H_
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes --------------------------------- */
+
+#include <stddef.h> /* For size_t */
+#include <stdint.h> /* For int types */
+
+/* -------------------- Public Macros/Defines --------------------------- */
+
+/** definition for the max number of threads of the pool, the calling thread included. More are clamped. */
+#ifndef VECTOR_THREAD_POOL_MAX_THREADS
+    #define VECTOR_THREAD_POOL_MAX_THREADS (64)
+#endif
+
+/**
+ * definition for the max number of threads outside the pool that run parallel calls at once with the pool's
+ * help. A call made while all of them are taken runs on the calling thread alone.
+ */
+#ifndef VECTOR_THREAD_POOL_MAX_GUESTS
+    #define VECTOR_THREAD_POOL_MAX_GUESTS (16)
+#endif
+
+/* -------------------- Public Enums ------------------------------------ */
+
+/* -------------------- Public Structs ---------------------------------- */
+
+/** Function the pool runs on the chunk [begin, end) of a range. */
+typedef void (*vector_thread_pool_task_t)(size_t begin, size_t end, void *p_context);
+
+/* -------------------- Public (global) Vars ---------------------------- */
+
+
+/* -------------------- Public Function Declarations -------------------- */
+
+/**
+ * @brief Start the pool. Parallel calls start it on their own with threads 0, so this is only needed to pick
+ * another number of threads.
+ *
+ * @param threads Number of threads the work runs on, the calling thread included, 0 for one per CPU.
+ * @return int 0 on success, -1 if the pool is already running.
+ */
+int vector_thread_pool_start(unsigned int threads);
+
+/**
+ * @brief Stop the pool and join its threads. Must not run while a parallel call does. The next parallel call
+ * starts it again.
+ *
+ * @return int 0 on success, -1 if the pool is not running.
+ */
+int vector_thread_pool_stop(void);
+
+/**
+ * @brief Number of online CPUs, the number of threads a pool started with threads 0 runs on.
+ *
+ * @return unsigned int The number of CPUs, at least 1.
+ */
+unsigned int vector_thread_pool_cpu_count(void);
+
+/**
+ * @brief Number of threads parallel calls run on, the calling thread included.
+ *
+ * @return unsigned int The threads of the running pool, or those it would start with if it is not running.
+ */
+unsigned int vector_thread_pool_threads(void);
+
+/**
+ * @brief Grain a parallel call with grain 0 uses, a few chunks per thread but not too small to be worth a task.
+ *
+ * @param count Number of indexes.
+ * @return size_t The grain, at least 1.
+ */
+size_t vector_thread_pool_default_grain(size_t count);
+
+/**
+ * @brief Run task over every grain sized chunk of [0, count) on the pool, and wait for all of them.
+ *
+ * May be called from inside a task, the calling thread then keeps running tasks while it waits.
+ *
+ * @param count Number of indexes.
+ * @param grain Number of indexes of a chunk, 0 for vector_thread_pool_default_grain(count).
+ * @param task The function.
+ * @param p_context Passed to task.
+ * @return int 0 on success, -1 on fail.
+ */
+int vector_thread_pool_for(size_t count, size_t grain, vector_thread_pool_task_t task, void *p_context);
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* _VECTOR_THREAD_POOL_H_ */
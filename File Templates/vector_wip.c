@@ -9,123 +9,770 @@
 *
 */
 /* -------------------- Private Includes ------------------------------------------- */
-#include "vector.h" /* Used to expose the vector API. */
+#include "vector_wip.h" /* Used to expose the vector API. */
+#include "vector_simd.h" /* Used for the numeric kernels. */
+#include "vector_sort.h" /* Used for the sort kernels. */
+#include "vector_persist.h" /* Used for the file format and the mappings. */
+#include "vector_thread_pool.h" /* Used for the parallel functions. */
+#include "vector_stats.h" /* Used for the counters and the registry of live vectors. */
+#include "vector_growth.h" /* Used for the growth policies. */
 #include <stdio.h> /* Used for io */
+#include <stdint.h> /* Used for SIZE_MAX */
 #include <stdlib.h> /* Used for memory allocation */
+#include <string.h> /* Used for memcpy and memmove */
 
 /* -------------------- Private Macros/Defines ------------------------------------- */
 
+/** Allocate size bytes from an allocator. */
+#define VECTOR_ALLOC(allocator, size) ((allocator)->alloc((allocator)->p_context, (size)))
+/** Resize a block of an allocator from old_size to new_size bytes. */
+#define VECTOR_REALLOC(allocator, p_block, old_size, new_size) ((allocator)->realloc((allocator)->p_context, (p_block), (old_size), (new_size)))
+/** Release a block of old_size bytes to an allocator. */
+#define VECTOR_FREE(allocator, p_block, size) ((allocator)->free((allocator)->p_context, (p_block), (size)))
+/* If the counters of vector_stats.h are compiled in */
+#ifdef VECTOR_STATS
+    /** Resize the data of a vector to new_capacity values, counting the resize. */
+    #define VECTOR_REALLOC_DATA(vector, data_type, new_capacity) \
+        ((data_type *)vector_realloc_counted((vector)->allocator, &(vector)->stats, (vector)->data, \
+                                             (vector)->capacity * sizeof(data_type), (new_capacity) * sizeof(data_type), (new_capacity)))
+    /** Zero the counters of a new vector and add it to the registry of live vectors. */
+    #define VECTOR_STATS_START(name, vector) \
+        do { \
+            memset(&(vector)->stats, 0, sizeof((vector)->stats)); \
+            (vector)->stats.peak_capacity = (vector)->capacity; \
+            vector_stats_register(&(vector)->stats_entry, #name, (vector), vector_##name##_stats_read); \
+        } while (0)
+    /** Remove a vector from the registry of live vectors. */
+    #define VECTOR_STATS_STOP(vector) vector_stats_unregister(&(vector)->stats_entry)
+    /** Declaration of the function the registry reads the stats of a vector with. */
+    #define VECTOR_STATS_READ_DECLARE(name) \
+        static int vector_##name##_stats_read(void *p_vector, vector_stats_t *out);
+#else
+    /** Resize the data of a vector to new_capacity values. */
+    #define VECTOR_REALLOC_DATA(vector, data_type, new_capacity) \
+        ((data_type *)VECTOR_REALLOC((vector)->allocator, (vector)->data, (vector)->capacity * sizeof(data_type), (new_capacity) * sizeof(data_type)))
+    #define VECTOR_STATS_START(name, vector) ((void)0)
+    #define VECTOR_STATS_STOP(vector) ((void)0)
+    #define VECTOR_STATS_READ_DECLARE(name)
+#endif
+/** Largest capacity of a vector of data_type whose size in bytes still fits in a size_t. */
+#define VECTOR_MAX_CAPACITY(data_type) (SIZE_MAX / sizeof(data_type))
+
 /** Vector virtual table definition macro. */
-#define VECTOR_VTABLE_INIT(data_type) \
-static vector_##data_type##_vtbl_t vector_##data_type##_vtable = { \
-        .push = vector_##data_type##_push, \
-        .pop = vector_##data_type##_pop, \
-        .get = vector_##data_type##_get, \
+#define VECTOR_VTABLE_INIT(name) \
+static vector_##name##_vtbl_t vector_##name##_vtable = { \
+        .push = vector_##name##_push, \
+        .pop = vector_##name##_pop, \
+        .get = vector_##name##_get, \
+        .reserve = vector_##name##_reserve, \
+        .resize = vector_##name##_resize, \
+        .append_array = vector_##name##_append_array, \
+        .get_range = vector_##name##_get_range, \
+        .insert = vector_##name##_insert, \
+        .remove_at = vector_##name##_remove_at, \
+        .clear = vector_##name##_clear, \
+        .copy = vector_##name##_copy, \
+        .shrink_to_fit = vector_##name##_shrink_to_fit, \
 };
 
 /** Vector function declarations macro. */
-#define VECTOR_STATIC_FUNCTIONS_DECLARE(data_type) \
-    static int vector_##data_type##_push(vector_##data_type##_t *vector, data_type value); \
-    static int vector_##data_type##_pop(vector_##data_type##_t *vector); \
-    static int vector_##data_type##_get(vector_##data_type##_t *vector, int index, data_type *out);
+#define VECTOR_STATIC_FUNCTIONS_DECLARE(name, data_type) \
+    static int vector_##name##_push(vector_##name##_t *vector, data_type value); \
+    static int vector_##name##_pop(vector_##name##_t *vector); \
+    static int vector_##name##_get(vector_##name##_t *vector, size_t index, data_type *out); \
+    static int vector_##name##_grow(vector_##name##_t *vector, size_t min_capacity); \
+    static int vector_##name##_reserve(vector_##name##_t *vector, size_t capacity); \
+    static int vector_##name##_resize(vector_##name##_t *vector, size_t size); \
+    static int vector_##name##_append_array(vector_##name##_t *vector, const data_type *values, size_t count); \
+    static int vector_##name##_get_range(vector_##name##_t *vector, size_t start, size_t count, data_type *out); \
+    static int vector_##name##_insert(vector_##name##_t *vector, size_t index, data_type value); \
+    static int vector_##name##_remove_at(vector_##name##_t *vector, size_t index); \
+    static int vector_##name##_clear(vector_##name##_t *vector); \
+    static vector_##name##_t *vector_##name##_copy(vector_##name##_t *vector); \
+    static int vector_##name##_shrink_to_fit(vector_##name##_t *vector); \
+    VECTOR_STATS_READ_DECLARE(name)
 
 
 
-/** Macro to generate vector create function */
-#define GENERIC_VECTOR_CREATE_FUNC(data_type) \
-    vector_##data_type##_t *vector_##data_type##_create(int initial_capacity) { \
-        vector_##data_type##_t *vector = (vector_##data_type##_t *)malloc(sizeof(vector_##data_type##_t)); \
+/** Macro to generate vector create functions */
+#define GENERIC_VECTOR_CREATE_FUNC(name, data_type, lock_policy) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity) { \
+        return vector_##name##_create_with_allocator(initial_capacity, NULL); \
+    } \
+    vector_##name##_t *vector_##name##_create_with_allocator(size_t initial_capacity, const vector_allocator_t *allocator) { \
+        vector_##name##_t *vector = NULL; \
+        if (initial_capacity > VECTOR_MAX_CAPACITY(data_type)) { \
+            return NULL; \
+        } \
+        if (allocator == NULL) { \
+            allocator = vector_allocator_default(); \
+        } \
+        vector = (vector_##name##_t *)VECTOR_ALLOC(allocator, sizeof(vector_##name##_t)); \
         if (vector == NULL) { \
             return NULL; \
         } \
         vector->size = 0; \
         vector->capacity = initial_capacity; \
-        vector->vptr = &vector_##data_type##_vtable; \
-        vector->data = (data_type *)malloc(initial_capacity * sizeof(data_type)); \
-        if (vector->data == NULL) { \
-            free(vector); \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->allocator = allocator; \
+        vector->growth = vector_growth_default(); \
+        /* The data comes last so an arena can grow it in place. An empty vector has none, the first push allocates it. */ \
+        vector->data = (initial_capacity == 0) ? NULL : (data_type *)VECTOR_ALLOC(allocator, initial_capacity * sizeof(data_type)); \
+        if (vector->data == NULL && initial_capacity != 0) { \
+            VECTOR_FREE(allocator, vector, sizeof(vector_##name##_t)); \
             return NULL; \
         } \
-        VECTOR_MUTEX_INIT(&vector->lock); /* Initialize lock */ \
+        VECTOR_LOCK_INIT(lock_policy, &vector->lock); /* Initialize lock */ \
+        VECTOR_STATS_START(name, vector); \
         return vector; \
     }
 
 /** Macro to generate vector destroy function */
-#define GENERIC_VECTOR_DESTROY_FUNC(data_type) \
-    int vector_##data_type##_destroy(vector_##data_type##_t *vector) { \
+#define GENERIC_VECTOR_DESTROY_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_destroy(vector_##name##_t *vector) { \
         if (vector == NULL) { \
             return -1; \
         } \
-        VECTOR_MUTEX_DESTROY(&vector->lock); /* Delete lock */ \
-        free(vector->data); \
-        free(vector); \
+        VECTOR_STATS_STOP(vector); \
+        VECTOR_LOCK_DESTROY(lock_policy, &vector->lock); /* Delete lock */ \
+        VECTOR_FREE(vector->allocator, vector->data, vector->capacity * sizeof(data_type)); \
+        VECTOR_FREE(vector->allocator, vector, sizeof(vector_##name##_t)); \
         return 0; \
     }
 
 /** Macro to generate vector push function */
-#define GENERIC_VECTOR_PUSH_FUNC(data_type) \
-    int vector_##data_type##_push(vector_##data_type##_t *vector, data_type value) { \
+#define GENERIC_VECTOR_PUSH_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_push(vector_##name##_t *vector, data_type value) { \
         if (vector == NULL) { \
             return -1; \
         } \
-        VECTOR_MUTEX_LOCK(&vector->lock); \
-        if (vector->size >= vector->capacity) { \
-            int new_capacity = vector->capacity * 2; \
-            data_type *new_data = (data_type *)realloc(vector->data, new_capacity * sizeof(data_type)); \
-            if (new_data == NULL) { \
-                VECTOR_MUTEX_UNLOCK(&vector->lock); \
-                return -1; \
-            } \
-            vector->data = new_data; \
-            vector->capacity = new_capacity; \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (vector->size >= vector->capacity && (vector->size == SIZE_MAX || vector_##name##_grow(vector, vector->size + 1))) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
         } \
         vector->data[vector->size] = value; \
         vector->size++; \
-        VECTOR_MUTEX_UNLOCK(&vector->lock); \
+        VECTOR_STATS_ADD(vector, pushes, 1); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
         return 0; \
     }
 
 /** Macro to generate vector pop function */
-#define GENERIC_VECTOR_POP_FUNC(data_type) \
-    int vector_##data_type##_pop(vector_##data_type##_t *vector) { \
+#define GENERIC_VECTOR_POP_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_pop(vector_##name##_t *vector) { \
         if (vector == NULL) { \
             return -1; \
         } \
-        VECTOR_MUTEX_LOCK(&vector->lock); \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
         if (vector->size == 0) { \
-            VECTOR_MUTEX_UNLOCK(&vector->lock); \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
             return -1; \
         } \
         vector->size--; \
-        VECTOR_MUTEX_UNLOCK(&vector->lock); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
         return 0; \
     }
 
 /** Macro to generate vector get function */
-#define GENERIC_VECTOR_GET_FUNC(data_type) \
-    int vector_##data_type##_get(vector_##data_type##_t *vector, int index, data_type *out) { \
+#define GENERIC_VECTOR_GET_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_get(vector_##name##_t *vector, size_t index, data_type *out) { \
         if (!vector || !out) \
             return -1; \
-        VECTOR_MUTEX_LOCK(&vector->lock); \
-        if (index < 0 || index >= vector->size) { \
-            VECTOR_MUTEX_UNLOCK(&vector->lock); \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
             return -1; \
         } \
         *out = vector->data[index]; \
-        VECTOR_MUTEX_UNLOCK(&vector->lock); \
+        VECTOR_STATS_ADD(vector, gets, 1); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate the vector grow function. The lock must be held. */
+#define GENERIC_VECTOR_GROW_FUNC(name, data_type, lock_policy) \
+    static int vector_##name##_grow(vector_##name##_t *vector, size_t min_capacity) { \
+        size_t new_capacity = 0; \
+        data_type *new_data = NULL; \
+        if (min_capacity <= vector->capacity) { \
+            return 0; \
+        } \
+        new_capacity = vector_growth_next(vector->growth, vector->capacity, min_capacity, VECTOR_MAX_CAPACITY(data_type)); \
+        if (new_capacity == 0) { \
+            return -1; \
+        } \
+        new_data = VECTOR_REALLOC_DATA(vector, data_type, new_capacity); \
+        if (new_data == NULL) { \
+            return -1; \
+        } \
+        vector->data = new_data; \
+        vector->capacity = new_capacity; \
+        return 0; \
+    }
+
+/** Macro to generate vector reserve function */
+#define GENERIC_VECTOR_RESERVE_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_reserve(vector_##name##_t *vector, size_t capacity) { \
+        int rv = 0; \
+        if (vector == NULL || capacity > VECTOR_MAX_CAPACITY(data_type)) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (capacity > vector->capacity) { \
+            data_type *new_data = VECTOR_REALLOC_DATA(vector, data_type, capacity); \
+            if (new_data == NULL) { \
+                rv = -1; \
+            } \
+            else { \
+                vector->data = new_data; \
+                vector->capacity = capacity; \
+            } \
+        } \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    }
+
+/** Macro to generate vector resize function */
+#define GENERIC_VECTOR_RESIZE_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_resize(vector_##name##_t *vector, size_t size) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (vector_##name##_grow(vector, size)) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        if (size > vector->size) { \
+            memset(&vector->data[vector->size], 0, (size - vector->size) * sizeof(data_type)); \
+        } \
+        vector->size = size; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector append array function */
+#define GENERIC_VECTOR_APPEND_ARRAY_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_append_array(vector_##name##_t *vector, const data_type *values, size_t count) { \
+        if (vector == NULL || (values == NULL && count != 0)) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (count > SIZE_MAX - vector->size || vector_##name##_grow(vector, vector->size + count)) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        if (count != 0) { \
+            memcpy(&vector->data[vector->size], values, count * sizeof(data_type)); \
+        } \
+        vector->size += count; \
+        VECTOR_STATS_ADD(vector, pushes, count); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector get range function */
+#define GENERIC_VECTOR_GET_RANGE_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_get_range(vector_##name##_t *vector, size_t start, size_t count, data_type *out) { \
+        if (vector == NULL || (out == NULL && count != 0)) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (start > vector->size || count > vector->size - start) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        if (count != 0) { \
+            memcpy(out, &vector->data[start], count * sizeof(data_type)); \
+        } \
+        VECTOR_STATS_ADD(vector, gets, count); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector insert function */
+#define GENERIC_VECTOR_INSERT_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_insert(vector_##name##_t *vector, size_t index, data_type value) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (index > vector->size || vector->size == SIZE_MAX || vector_##name##_grow(vector, vector->size + 1)) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        memmove(&vector->data[index + 1], &vector->data[index], (vector->size - index) * sizeof(data_type)); \
+        vector->data[index] = value; \
+        vector->size++; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector remove at function */
+#define GENERIC_VECTOR_REMOVE_AT_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_remove_at(vector_##name##_t *vector, size_t index) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        memmove(&vector->data[index], &vector->data[index + 1], (vector->size - index - 1) * sizeof(data_type)); \
+        vector->size--; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector clear function */
+#define GENERIC_VECTOR_CLEAR_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_clear(vector_##name##_t *vector) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        vector->size = 0; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector copy function */
+#define GENERIC_VECTOR_COPY_FUNC(name, data_type, lock_policy) \
+    vector_##name##_t *vector_##name##_copy(vector_##name##_t *vector) { \
+        vector_##name##_t *new_vector = NULL; \
+        if (vector == NULL) { \
+            return NULL; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        /* The copy gets the capacity of the size so copies of mostly empty vectors stay small, but never 0 so push can grow it. */ \
+        new_vector = vector_##name##_create_with_allocator(vector->size > 0 ? vector->size : 1, vector->allocator); \
+        if (new_vector != NULL && vector->size != 0) { \
+            memcpy(new_vector->data, vector->data, vector->size * sizeof(data_type)); \
+            new_vector->size = vector->size; \
+        } \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return new_vector; \
+    }
+
+/** Macro to generate vector shrink to fit function */
+#define GENERIC_VECTOR_SHRINK_TO_FIT_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_shrink_to_fit(vector_##name##_t *vector) { \
+        size_t new_capacity = 0; \
+        data_type *new_data = NULL; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        /* Keep room for one value, a block of 0 bytes is freed by realloc on some systems. */ \
+        new_capacity = vector->size > 0 ? vector->size : 1; \
+        if (new_capacity < vector->capacity) { \
+            new_data = VECTOR_REALLOC_DATA(vector, data_type, new_capacity); \
+            if (new_data == NULL) { \
+                VECTOR_UNLOCK(lock_policy, &vector->lock); \
+                return -1; \
+            } \
+            vector->data = new_data; \
+            vector->capacity = new_capacity; \
+        } \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate vector stats functions */
+#ifdef VECTOR_STATS
+    #define GENERIC_VECTOR_STATS_FUNC(name, data_type, lock_policy) \
+        int vector_##name##_stats(vector_##name##_t *vector, vector_stats_t *out) { \
+            if (vector == NULL || out == NULL) { \
+                return -1; \
+            } \
+            /* Not counted, so reading the stats does not change them. */ \
+            VECTOR_LOCK(lock_policy, &vector->lock); \
+            *out = vector->stats; \
+            out->size = vector->size; \
+            out->capacity = vector->capacity; \
+            out->element_size = sizeof(data_type); \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return 0; \
+        } \
+        static int vector_##name##_stats_read(void *p_vector, vector_stats_t *out) { \
+            vector_##name##_t *vector = (vector_##name##_t *)p_vector; \
+            if (!VECTOR_LOCK_TRY(lock_policy, &vector->lock)) { \
+                return -1; \
+            } \
+            *out = vector->stats; \
+            out->size = vector->size; \
+            out->capacity = vector->capacity; \
+            out->element_size = sizeof(data_type); \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return 0; \
+        }
+#else
+    #define GENERIC_VECTOR_STATS_FUNC(name, data_type, lock_policy) \
+        int vector_##name##_stats(vector_##name##_t *vector, vector_stats_t *out) { \
+            (void)vector; \
+            (void)out; \
+            return -1; \
+        }
+#endif
+
+/** Macro to generate vector set growth function */
+#define GENERIC_VECTOR_SET_GROWTH_FUNC(name, data_type, lock_policy) \
+    int vector_##name##_set_growth(vector_##name##_t *vector, const vector_growth_t *growth) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        vector->growth = (growth == NULL) ? vector_growth_default() : growth; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Take the locks of two vectors, lowest address first so two threads locking the same pair cannot deadlock. */
+#define VECTOR_LOCK_PAIR(lock_policy, vector_a, vector_b) \
+    do { \
+        if ((vector_a) == (vector_b)) { \
+            VECTOR_LOCK_COUNTED(lock_policy, (vector_a)); \
+        } \
+        else if ((uintptr_t)(vector_a) < (uintptr_t)(vector_b)) { \
+            VECTOR_LOCK_COUNTED(lock_policy, (vector_a)); \
+            VECTOR_LOCK_COUNTED(lock_policy, (vector_b)); \
+        } \
+        else { \
+            VECTOR_LOCK_COUNTED(lock_policy, (vector_b)); \
+            VECTOR_LOCK_COUNTED(lock_policy, (vector_a)); \
+        } \
+    } while (0)
+
+/** Release the locks taken by VECTOR_LOCK_PAIR. */
+#define VECTOR_UNLOCK_PAIR(lock_policy, vector_a, vector_b) \
+    do { \
+        VECTOR_UNLOCK(lock_policy, &(vector_a)->lock); \
+        if ((vector_a) != (vector_b)) { \
+            VECTOR_UNLOCK(lock_policy, &(vector_b)->lock); \
+        } \
+    } while (0)
+
+/** Macro to generate a numeric function that reduces a non empty vector to one value with the kernel of the same name */
+#define GENERIC_VECTOR_REDUCE_FUNC(name, data_type, out_type, function, lock_policy) \
+    int vector_##name##_##function(vector_##name##_t *vector, out_type *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (vector->size == 0) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        *out = vector_simd_##data_type##_##function(vector->data, vector->size); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate the numeric functions of a vector */
+#define GENERIC_VECTOR_NUMERIC_FUNCTIONS_WITH_LOCK(name, data_type, sum_type, lock_policy) \
+    int vector_##name##_sum(vector_##name##_t *vector, sum_type *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        *out = vector_simd_##data_type##_sum(vector->data, vector->size); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    GENERIC_VECTOR_REDUCE_FUNC(name, data_type, data_type, min, lock_policy) \
+    GENERIC_VECTOR_REDUCE_FUNC(name, data_type, data_type, max, lock_policy) \
+    GENERIC_VECTOR_REDUCE_FUNC(name, data_type, size_t, argmin, lock_policy) \
+    GENERIC_VECTOR_REDUCE_FUNC(name, data_type, size_t, argmax, lock_policy) \
+    int vector_##name##_dot(vector_##name##_t *vector, vector_##name##_t *other, sum_type *out) { \
+        int rv = 0; \
+        if (vector == NULL || other == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_PAIR(lock_policy, vector, other); \
+        if (vector->size != other->size) { \
+            rv = -1; \
+        } \
+        else { \
+            *out = vector_simd_##data_type##_dot(vector->data, other->data, vector->size); \
+        } \
+        VECTOR_UNLOCK_PAIR(lock_policy, vector, other); \
+        return rv; \
+    } \
+    int vector_##name##_axpy(vector_##name##_t *vector, data_type a, vector_##name##_t *x) { \
+        int rv = 0; \
+        if (vector == NULL || x == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_PAIR(lock_policy, vector, x); \
+        if (vector->size != x->size) { \
+            rv = -1; \
+        } \
+        else { \
+            vector_simd_##data_type##_axpy(vector->data, a, x->data, vector->size); \
+        } \
+        VECTOR_UNLOCK_PAIR(lock_policy, vector, x); \
+        return rv; \
+    } \
+    int vector_##name##_scale(vector_##name##_t *vector, data_type a) { \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        vector_simd_##data_type##_scale(vector->data, a, vector->size); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    int vector_##name##_find(vector_##name##_t *vector, data_type value, size_t *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        *out = vector_simd_##data_type##_find(vector->data, vector->size, value); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    int vector_##name##_count(vector_##name##_t *vector, data_type value, size_t *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        *out = vector_simd_##data_type##_count(vector->data, vector->size, value); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
         return 0; \
     }
 
+/** Macro to generate the numeric functions of every lock policy of a type */
+#define GENERIC_VECTOR_NUMERIC_FUNCTIONS(data_type, sum_type) \
+    GENERIC_VECTOR_NUMERIC_FUNCTIONS_WITH_LOCK(data_type, data_type, sum_type, MUTEX) \
+    GENERIC_VECTOR_NUMERIC_FUNCTIONS_WITH_LOCK(data_type##_spinlock, data_type, sum_type, SPINLOCK) \
+    GENERIC_VECTOR_NUMERIC_FUNCTIONS_WITH_LOCK(data_type##_nolock, data_type, sum_type, NOLOCK)
+
+/** Macro to generate the sort and binary search functions of a vector */
+#define GENERIC_VECTOR_SORT_FUNCTIONS_WITH_LOCK(name, data_type, lock_policy) \
+    int vector_##name##_sort_parallel(vector_##name##_t *vector, unsigned int threads) { \
+        int rv = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        rv = vector_sort_##data_type(vector->data, vector->size, threads, vector->allocator); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    } \
+    int vector_##name##_sort(vector_##name##_t *vector) { \
+        return vector_##name##_sort_parallel(vector, 1); \
+    } \
+    int vector_##name##_lower_bound(vector_##name##_t *vector, data_type value, size_t *out) { \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        *out = vector_sort_##data_type##_lower_bound(vector->data, vector->size, value); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    int vector_##name##_binary_search(vector_##name##_t *vector, data_type value, size_t *out) { \
+        size_t index = 0; \
+        if (vector == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        index = vector_sort_##data_type##_lower_bound(vector->data, vector->size, value); \
+        *out = (index < vector->size && vector->data[index] == value) ? index : VECTOR_NPOS; \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    }
+
+/** Macro to generate the sort functions of every lock policy of a type */
+#define GENERIC_VECTOR_SORT_FUNCTIONS(data_type) \
+    GENERIC_VECTOR_SORT_FUNCTIONS_WITH_LOCK(data_type, data_type, MUTEX) \
+    GENERIC_VECTOR_SORT_FUNCTIONS_WITH_LOCK(data_type##_spinlock, data_type, SPINLOCK) \
+    GENERIC_VECTOR_SORT_FUNCTIONS_WITH_LOCK(data_type##_nolock, data_type, NOLOCK)
+
+/** Macro to generate the save and map functions of a vector */
+#define GENERIC_VECTOR_PERSIST_FUNCTIONS_WITH_LOCK(name, data_type, lock_policy) \
+    int vector_##name##_save(vector_##name##_t *vector, const char *p_path) { \
+        int rv = 0; \
+        if (vector == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        rv = vector_persist_save(p_path, VECTOR_PERSIST_TYPE_##data_type, sizeof(data_type), vector->data, vector->size); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    } \
+    vector_##name##_t *vector_##name##_map(const char *p_path, unsigned int flags) { \
+        vector_##name##_t *vector = NULL; \
+        void *p_values = NULL; \
+        size_t count = 0; \
+        const vector_allocator_t *allocator = vector_persist_map(p_path, VECTOR_PERSIST_TYPE_##data_type, sizeof(data_type), flags, &p_values, &count); \
+        if (allocator == NULL) { \
+            return NULL; \
+        } \
+        vector = (vector_##name##_t *)VECTOR_ALLOC(allocator, sizeof(vector_##name##_t)); \
+        if (vector == NULL) { \
+            VECTOR_FREE(allocator, p_values, count * sizeof(data_type)); \
+            return NULL; \
+        } \
+        vector->size = count; \
+        vector->capacity = count; \
+        vector->vptr = &vector_##name##_vtable; \
+        vector->allocator = allocator; \
+        vector->growth = vector_growth_default(); \
+        vector->data = (data_type *)p_values; \
+        VECTOR_LOCK_INIT(lock_policy, &vector->lock); \
+        VECTOR_STATS_START(name, vector); \
+        return vector; \
+    }
+
+/** Macro to generate the save and map functions of every lock policy of a type */
+#define GENERIC_VECTOR_PERSIST_FUNCTIONS(data_type) \
+    GENERIC_VECTOR_PERSIST_FUNCTIONS_WITH_LOCK(data_type, data_type, MUTEX) \
+    GENERIC_VECTOR_PERSIST_FUNCTIONS_WITH_LOCK(data_type##_spinlock, data_type, SPINLOCK) \
+    GENERIC_VECTOR_PERSIST_FUNCTIONS_WITH_LOCK(data_type##_nolock, data_type, NOLOCK)
+
+/** Macro to generate the parallel for and reduce functions of a vector */
+#define GENERIC_VECTOR_PARALLEL_FUNCTIONS_WITH_LOCK(name, data_type, lock_policy) \
+    typedef struct _vector_##name##_parallel { \
+        data_type *data;                            /**< The values */ \
+        vector_##name##_for_t for_fn;               /**< Function of parallel_for */ \
+        vector_##name##_reduce_t reduce_fn;         /**< Function of parallel_reduce */ \
+        data_type identity;                         /**< Value every chunk of parallel_reduce starts from */ \
+        data_type *partials;                        /**< Result of every chunk of parallel_reduce */ \
+        size_t grain;                               /**< Number of values of a chunk */ \
+        void *p_context;                            /**< Passed to the function */ \
+    } vector_##name##_parallel_t; \
+    static void vector_##name##_parallel_for_chunk(size_t begin, size_t end, void *p_arg) { \
+        vector_##name##_parallel_t *p_parallel = (vector_##name##_parallel_t *)p_arg; \
+        p_parallel->for_fn(p_parallel->data + begin, end - begin, begin, p_parallel->p_context); \
+    } \
+    static void vector_##name##_parallel_reduce_chunk(size_t begin, size_t end, void *p_arg) { \
+        vector_##name##_parallel_t *p_parallel = (vector_##name##_parallel_t *)p_arg; \
+        data_type accumulator = p_parallel->identity; \
+        for (size_t index = begin; index < end; index++) { \
+            accumulator = p_parallel->reduce_fn(accumulator, p_parallel->data[index], p_parallel->p_context); \
+        } \
+        p_parallel->partials[begin / p_parallel->grain] = accumulator; \
+    } \
+    int vector_##name##_parallel_for(vector_##name##_t *vector, vector_##name##_for_t fn, void *p_context, size_t grain) { \
+        vector_##name##_parallel_t parallel = {0}; \
+        int rv = 0; \
+        if (vector == NULL || fn == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        parallel.data = vector->data; \
+        parallel.for_fn = fn; \
+        parallel.p_context = p_context; \
+        rv = vector_thread_pool_for(vector->size, grain, vector_##name##_parallel_for_chunk, &parallel); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return rv; \
+    } \
+    int vector_##name##_parallel_reduce(vector_##name##_t *vector, vector_##name##_reduce_t fn, data_type identity, void *p_context, \
+                                        size_t grain, data_type *out) { \
+        vector_##name##_parallel_t parallel = {0}; \
+        data_type accumulator = identity; \
+        size_t chunks = 0; \
+        int rv = 0; \
+        if (vector == NULL || fn == NULL || out == NULL) { \
+            return -1; \
+        } \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        parallel.grain = (grain == 0) ? vector_thread_pool_default_grain(vector->size) : grain; \
+        chunks = (vector->size == 0) ? 0 : (vector->size - 1) / parallel.grain + 1; \
+        if (chunks > 0) { \
+            parallel.partials = (data_type *)VECTOR_ALLOC(vector->allocator, chunks * sizeof(data_type)); \
+            if (parallel.partials == NULL) { \
+                VECTOR_UNLOCK(lock_policy, &vector->lock); \
+                return -1; \
+            } \
+        } \
+        parallel.data = vector->data; \
+        parallel.reduce_fn = fn; \
+        parallel.identity = identity; \
+        parallel.p_context = p_context; \
+        rv = vector_thread_pool_for(vector->size, parallel.grain, vector_##name##_parallel_reduce_chunk, &parallel); \
+        for (size_t chunk = 0; (rv == 0) && (chunk < chunks); chunk++) { \
+            accumulator = fn(accumulator, parallel.partials[chunk], p_context); \
+        } \
+        if (chunks > 0) { \
+            VECTOR_FREE(vector->allocator, parallel.partials, chunks * sizeof(data_type)); \
+        } \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        if (rv == 0) { \
+            *out = accumulator; \
+        } \
+        return rv; \
+    }
+
+/** Macro to generate the parallel functions of every lock policy of a type */
+#define GENERIC_VECTOR_PARALLEL_FUNCTIONS(data_type) \
+    GENERIC_VECTOR_PARALLEL_FUNCTIONS_WITH_LOCK(data_type, data_type, MUTEX) \
+    GENERIC_VECTOR_PARALLEL_FUNCTIONS_WITH_LOCK(data_type##_spinlock, data_type, SPINLOCK) \
+    GENERIC_VECTOR_PARALLEL_FUNCTIONS_WITH_LOCK(data_type##_nolock, data_type, NOLOCK)
+
+/** Macro to generate the functions of a vector named vector_<name>_t holding data_type values guarded by lock_policy */
+#define GENERIC_VECTOR_FUNCTIONS_WITH_LOCK(name, data_type, lock_policy) \
+    VECTOR_STATIC_FUNCTIONS_DECLARE(name, data_type) \
+    VECTOR_VTABLE_INIT(name) \
+    GENERIC_VECTOR_CREATE_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_DESTROY_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_PUSH_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_POP_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_GET_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_GROW_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_RESERVE_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_RESIZE_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_APPEND_ARRAY_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_GET_RANGE_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_INSERT_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_REMOVE_AT_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_CLEAR_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_COPY_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_SHRINK_TO_FIT_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_STATS_FUNC(name, data_type, lock_policy) \
+    GENERIC_VECTOR_SET_GROWTH_FUNC(name, data_type, lock_policy)
+
 /** Macro to generate vector function declarations */
 #define GENERIC_VECTOR_FUNCTIONS(data_type) \
-    VECTOR_STATIC_FUNCTIONS_DECLARE(data_type) \
-    VECTOR_VTABLE_INIT(data_type) \
-    GENERIC_VECTOR_CREATE_FUNC(data_type) \
-    GENERIC_VECTOR_DESTROY_FUNC(data_type) \
-    GENERIC_VECTOR_PUSH_FUNC(data_type) \
-    GENERIC_VECTOR_POP_FUNC(data_type) \
-    GENERIC_VECTOR_GET_FUNC(data_type)
+    GENERIC_VECTOR_FUNCTIONS_WITH_LOCK(data_type, data_type, MUTEX) \
+    GENERIC_VECTOR_FUNCTIONS_WITH_LOCK(data_type##_spinlock, data_type, SPINLOCK) \
+    GENERIC_VECTOR_FUNCTIONS_WITH_LOCK(data_type##_nolock, data_type, NOLOCK)
+
+/* -------------------- Private and Public Function Definitions -------------------- */
 
+#ifdef VECTOR_STATS
+/**
+ * @brief Helper function to resize the data of a vector and count it. realloc copies the old block, up to the
+ * new size, only when it cannot resize it in place.
+ *
+ * @param allocator Allocator of the vector.
+ * @param p_stats Counters of the vector.
+ * @param p_data The data.
+ * @param old_size Bytes of the data.
+ * @param new_size Bytes of the resized data.
+ * @param new_capacity Capacity of the resized data.
+ * @return void* The resized data, NULL on fail with the data unchanged.
+ */
+static void *vector_realloc_counted(const vector_allocator_t *allocator, vector_stats_t *p_stats, void *p_data, size_t old_size,
+                                    size_t new_size, size_t new_capacity) {
+    uintptr_t old_address = (uintptr_t)p_data;
+    void *p_new_data = VECTOR_REALLOC(allocator, p_data, old_size, new_size);
+    if (p_new_data == NULL) {
+        return NULL;
+    }
+    p_stats->reallocs++;
+    if ((uintptr_t)p_new_data != old_address) {
+        p_stats->bytes_moved += (old_size < new_size) ? old_size : new_size;
+    }
+    if (new_capacity > p_stats->peak_capacity) {
+        p_stats->peak_capacity = new_capacity;
+    }
+    return p_new_data;
+}
+#endif
 
 GENERIC_VECTOR_FUNCTIONS(int)
 GENERIC_VECTOR_FUNCTIONS(double)
@@ -135,3 +782,33 @@ GENERIC_VECTOR_FUNCTIONS(uint16_t)
 GENERIC_VECTOR_FUNCTIONS(uint32_t)
 GENERIC_VECTOR_FUNCTIONS(uint64_t)
 
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(int, int64_t)
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(double, double)
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(uint8_t, uint64_t)
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(uint16_t, uint64_t)
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(uint32_t, uint64_t)
+GENERIC_VECTOR_NUMERIC_FUNCTIONS(uint64_t, uint64_t)
+
+GENERIC_VECTOR_SORT_FUNCTIONS(int)
+GENERIC_VECTOR_SORT_FUNCTIONS(double)
+GENERIC_VECTOR_SORT_FUNCTIONS(char)
+GENERIC_VECTOR_SORT_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_SORT_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_SORT_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_SORT_FUNCTIONS(uint64_t)
+
+GENERIC_VECTOR_PERSIST_FUNCTIONS(int)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(double)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(char)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_PERSIST_FUNCTIONS(uint64_t)
+
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(int)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(double)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(char)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(uint8_t)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(uint16_t)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(uint32_t)
+GENERIC_VECTOR_PARALLEL_FUNCTIONS(uint64_t)
@@ -19,22 +19,22 @@
 
 /* -------------------- Public Includes --------------------------------- */
 
+#include <stddef.h> /* For size_t */
 #include <stdint.h> /* For int types */
+#include "vector_allocator.h" /* For vector_allocator_t */
+#ifdef VECTOR_STATS
+    #include "vector_stats.h" /* For the counters every vector carries */
+#endif
 
 /* -------------------- Public Macros/Defines --------------------------- */
 
 /*
-TODO Functions to add
-insert
-remove_at
-clear
-find
-copy
-shrink_to_fit
-
 TODO Make error system a lot more robust.
 */
 
+/** definition for the index find returns when no value matches. */
+#define VECTOR_NPOS ((size_t)-1)
+
 /* If Windows */
 #ifdef _WIN32
     #include <windows.h>
@@ -42,65 +42,314 @@ TODO Make error system a lot more robust.
     #define VECTOR_MUTEX_INIT(p_mutex_address) InitializeCriticalSection((p_mutex_address))
     #define VECTOR_MUTEX_DESTROY(p_mutex_address) DeleteCriticalSection((p_mutex_address))
     #define VECTOR_MUTEX_LOCK(p_mutex_address) EnterCriticalSection((p_mutex_address))
+    #define VECTOR_MUTEX_TRY_LOCK(p_mutex_address) (TryEnterCriticalSection((p_mutex_address)) != 0)
     #define VECTOR_MUTEX_UNLOCK(p_mutex_address) LeaveCriticalSection((p_mutex_address))
+    #define VECTOR_SPINLOCK_TYPE volatile LONG
+    #define VECTOR_SPINLOCK_INIT(p_spinlock_address) (*(p_spinlock_address) = 0)
+    #define VECTOR_SPINLOCK_DESTROY(p_spinlock_address) ((void)(p_spinlock_address))
+    #define VECTOR_SPINLOCK_TRY_LOCK(p_spinlock_address) (InterlockedExchange((p_spinlock_address), 1) == 0)
+    #define VECTOR_SPINLOCK_IS_LOCKED(p_spinlock_address) (*(p_spinlock_address) != 0)
+    #define VECTOR_SPINLOCK_UNLOCK(p_spinlock_address) InterlockedExchange((p_spinlock_address), 0)
+    #define VECTOR_CPU_RELAX() YieldProcessor()
 #else /* If POSIX-like system */
     #include <pthread.h>
     #define VECTOR_MUTEX_TYPE pthread_mutex_t
     #define VECTOR_MUTEX_INIT(p_mutex_address) pthread_mutex_init((p_mutex_address), NULL)
     #define VECTOR_MUTEX_DESTROY(p_mutex_address) pthread_mutex_destroy((p_mutex_address))
     #define VECTOR_MUTEX_LOCK(p_mutex_address) pthread_mutex_lock((p_mutex_address))
+    #define VECTOR_MUTEX_TRY_LOCK(p_mutex_address) (pthread_mutex_trylock((p_mutex_address)) == 0)
     #define VECTOR_MUTEX_UNLOCK(p_mutex_address) pthread_mutex_unlock((p_mutex_address))
+    #define VECTOR_SPINLOCK_TYPE int
+    #define VECTOR_SPINLOCK_INIT(p_spinlock_address) __atomic_store_n((p_spinlock_address), 0, __ATOMIC_RELAXED)
+    #define VECTOR_SPINLOCK_DESTROY(p_spinlock_address) ((void)(p_spinlock_address))
+    #define VECTOR_SPINLOCK_TRY_LOCK(p_spinlock_address) (__atomic_exchange_n((p_spinlock_address), 1, __ATOMIC_ACQUIRE) == 0)
+    #define VECTOR_SPINLOCK_IS_LOCKED(p_spinlock_address) (__atomic_load_n((p_spinlock_address), __ATOMIC_RELAXED) != 0)
+    #define VECTOR_SPINLOCK_UNLOCK(p_spinlock_address) __atomic_store_n((p_spinlock_address), 0, __ATOMIC_RELEASE)
+    #if defined(__x86_64__) || defined(__i386__)
+        #define VECTOR_CPU_RELAX() __builtin_ia32_pause()
+    #elif defined(__aarch64__)
+        #define VECTOR_CPU_RELAX() __asm__ __volatile__("yield")
+    #else
+        #define VECTOR_CPU_RELAX() ((void)0)
+    #endif
+#endif
+
+/** Take a spinlock. Waiters spin on a plain load so the lock's cache line is only written when it looks free. */
+#define VECTOR_SPINLOCK_LOCK(p_spinlock_address) \
+    do { \
+        while (!VECTOR_SPINLOCK_TRY_LOCK((p_spinlock_address))) { \
+            while (VECTOR_SPINLOCK_IS_LOCKED((p_spinlock_address))) { \
+                VECTOR_CPU_RELAX(); \
+            } \
+        } \
+    } while (0)
+
+/*
+Lock policies. A vector is generated with one of these, which decides what its lock member is and what
+every operation on it does to that lock.
+    MUTEX    - VECTOR_MUTEX_TYPE. Safe to share between threads, sleeps under contention. The default.
+    SPINLOCK - VECTOR_SPINLOCK_TYPE. Safe to share between threads, busy waits. For short critical sections.
+    NOLOCK   - No locking at all. Only for vectors that are never used by more than one thread at a time.
+*/
+#define VECTOR_LOCK_MUTEX_TYPE VECTOR_MUTEX_TYPE
+#define VECTOR_LOCK_MUTEX_INIT(p_lock_address) VECTOR_MUTEX_INIT((p_lock_address))
+#define VECTOR_LOCK_MUTEX_DESTROY(p_lock_address) VECTOR_MUTEX_DESTROY((p_lock_address))
+#define VECTOR_LOCK_MUTEX_LOCK(p_lock_address) VECTOR_MUTEX_LOCK((p_lock_address))
+#define VECTOR_LOCK_MUTEX_TRY_LOCK(p_lock_address) VECTOR_MUTEX_TRY_LOCK((p_lock_address))
+#define VECTOR_LOCK_MUTEX_UNLOCK(p_lock_address) VECTOR_MUTEX_UNLOCK((p_lock_address))
+
+#define VECTOR_LOCK_SPINLOCK_TYPE VECTOR_SPINLOCK_TYPE
+#define VECTOR_LOCK_SPINLOCK_INIT(p_lock_address) VECTOR_SPINLOCK_INIT((p_lock_address))
+#define VECTOR_LOCK_SPINLOCK_DESTROY(p_lock_address) VECTOR_SPINLOCK_DESTROY((p_lock_address))
+#define VECTOR_LOCK_SPINLOCK_LOCK(p_lock_address) VECTOR_SPINLOCK_LOCK((p_lock_address))
+#define VECTOR_LOCK_SPINLOCK_TRY_LOCK(p_lock_address) VECTOR_SPINLOCK_TRY_LOCK((p_lock_address))
+#define VECTOR_LOCK_SPINLOCK_UNLOCK(p_lock_address) VECTOR_SPINLOCK_UNLOCK((p_lock_address))
+
+#define VECTOR_LOCK_NOLOCK_TYPE char
+#define VECTOR_LOCK_NOLOCK_INIT(p_lock_address) ((void)(p_lock_address))
+#define VECTOR_LOCK_NOLOCK_DESTROY(p_lock_address) ((void)(p_lock_address))
+#define VECTOR_LOCK_NOLOCK_LOCK(p_lock_address) ((void)(p_lock_address))
+#define VECTOR_LOCK_NOLOCK_TRY_LOCK(p_lock_address) ((void)(p_lock_address), 1)
+#define VECTOR_LOCK_NOLOCK_UNLOCK(p_lock_address) ((void)(p_lock_address))
+
+/** Lock type of a lock policy. */
+#define VECTOR_LOCK_TYPE(lock_policy) VECTOR_LOCK_##lock_policy##_TYPE
+/** Initialize a lock of a lock policy. */
+#define VECTOR_LOCK_INIT(lock_policy, p_lock_address) VECTOR_LOCK_##lock_policy##_INIT(p_lock_address)
+/** Destroy a lock of a lock policy. */
+#define VECTOR_LOCK_DESTROY(lock_policy, p_lock_address) VECTOR_LOCK_##lock_policy##_DESTROY(p_lock_address)
+/** Take a lock of a lock policy. */
+#define VECTOR_LOCK(lock_policy, p_lock_address) VECTOR_LOCK_##lock_policy##_LOCK(p_lock_address)
+/** Release a lock of a lock policy. */
+#define VECTOR_UNLOCK(lock_policy, p_lock_address) VECTOR_LOCK_##lock_policy##_UNLOCK(p_lock_address)
+/** Take a lock of a lock policy if it is free, without waiting. Non-zero when it was taken. */
+#define VECTOR_LOCK_TRY(lock_policy, p_lock_address) VECTOR_LOCK_##lock_policy##_TRY_LOCK(p_lock_address)
+
+/* If the counters of vector_stats.h are compiled in */
+#ifdef VECTOR_STATS
+    /** Members a vector gets for its counters. */
+    #define VECTOR_STATS_MEMBERS \
+        vector_stats_t stats;                   /**< Counters, see vector_stats.h */ \
+        vector_stats_entry_t stats_entry;       /**< Node of the vector in the registry of live vectors */
+    /** Add amount to a counter of a vector. The lock must be held. */
+    #define VECTOR_STATS_ADD(vector, counter, amount) ((vector)->stats.counter += (amount))
+    /**
+     * Take the lock of a vector and count it. The lock is tried first so the clock is only read when it has to
+     * be waited for.
+     */
+    #define VECTOR_LOCK_COUNTED(lock_policy, vector) \
+        do { \
+            if (!VECTOR_LOCK_TRY(lock_policy, &(vector)->lock)) { \
+                uint64_t wait_start_ns = vector_stats_now_ns(); \
+                VECTOR_LOCK(lock_policy, &(vector)->lock); \
+                (vector)->stats.lock_wait_ns += vector_stats_now_ns() - wait_start_ns; \
+                (vector)->stats.lock_contended++; \
+            } \
+            (vector)->stats.lock_acquires++; \
+        } while (0)
+#else
+    #define VECTOR_STATS_MEMBERS
+    #define VECTOR_STATS_ADD(vector, counter, amount) ((void)0)
+    #define VECTOR_LOCK_COUNTED(lock_policy, vector) VECTOR_LOCK(lock_policy, &(vector)->lock)
 #endif
 
 /** Vector virtual table definition macro. */
-#define VECTOR_VTBL_T(data_type) \
-	typedef struct _vector_##data_type##_vtbl { \
-	    int (*const push)(vector_##data_type##_t *vector, data_type value); 		        /**< Push a value to the back of the vector */ \
-	    int (*const pop)(vector_##data_type##_t *vector);                    		        /**< Pop a value from the back of the vector */ \
-	    int (*const get)(vector_##data_type##_t *vector, int index, data_type *out);        /**< Get a value from the vector at index */ \
-	} vector_##data_type##_vtbl_t;
+#define VECTOR_VTBL_T(name, data_type) \
+    typedef struct _vector_##name##_vtbl { \
+        int (*const push)(vector_##name##_t *vector, data_type value);                 /**< Push a value to the back of the vector */ \
+        int (*const pop)(vector_##name##_t *vector);                                   /**< Pop a value from the back of the vector */ \
+        int (*const get)(vector_##name##_t *vector, size_t index, data_type *out);     /**< Get a value from the vector at index */ \
+        int (*const reserve)(vector_##name##_t *vector, size_t capacity);              /**< Grow the capacity to at least capacity */ \
+        int (*const resize)(vector_##name##_t *vector, size_t size);                   /**< Set the size, new values are zeroed */ \
+        int (*const append_array)(vector_##name##_t *vector, const data_type *values, size_t count); /**< Push count values to the back of the vector */ \
+        int (*const get_range)(vector_##name##_t *vector, size_t start, size_t count, data_type *out); /**< Get count values starting at start */ \
+        int (*const insert)(vector_##name##_t *vector, size_t index, data_type value); /**< Insert a value before index, index == size appends */ \
+        int (*const remove_at)(vector_##name##_t *vector, size_t index);               /**< Remove the value at index */ \
+        int (*const clear)(vector_##name##_t *vector);                                 /**< Remove every value, keeping the capacity */ \
+        vector_##name##_t *(*const copy)(vector_##name##_t *vector);                   /**< Create a new vector holding the same values */ \
+        int (*const shrink_to_fit)(vector_##name##_t *vector);                         /**< Release the capacity beyond the size */ \
+    } vector_##name##_vtbl_t;
 
 /** Vector structure definition macro. */
-#define VECTOR_T(data_type) \
-	struct _vector_##data_type { \
-	    vector_##data_type##_vtbl_t *vptr;  /**< Pointer to the virtual table */ \
-	    int size;                           /**< Size of the vector */ \
-	    int capacity;                       /**< Capacity of the vector */ \
-	    data_type *data;                    /**< Pointer to the data array */ \
-	    VECTOR_MUTEX_TYPE lock; 			/** Mutex for thread safety */ \
-	};
+#define VECTOR_T(name, data_type, lock_policy) \
+    struct _vector_##name { \
+        vector_##name##_vtbl_t *vptr;           /**< Pointer to the virtual table */ \
+        size_t size;                            /**< Size of the vector */ \
+        size_t capacity;                        /**< Capacity of the vector */ \
+        data_type *data;                        /**< Pointer to the data array */ \
+        const vector_allocator_t *allocator;    /**< Allocator of the vector and its data */ \
+        const struct _vector_growth *growth;    /**< Growth policy, see vector_growth.h */ \
+        VECTOR_LOCK_TYPE(lock_policy) lock;     /**< Lock for thread safety, see the lock policies */ \
+        VECTOR_STATS_MEMBERS \
+    };
+
+/** Vector inline direct-call functions macro. These skip the virtual table so the compiler can inline them. */
+#define VECTOR_INLINE_FUNCS(name, data_type, lock_policy) \
+    /** Push a value to the back of the vector. Same as vptr->push, but only leaves the inlined fast path to grow. */ \
+    static inline int vector_##name##_push_fast(vector_##name##_t *vector, data_type value) { \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (vector->size < vector->capacity) { \
+            vector->data[vector->size] = value; \
+            vector->size++; \
+            VECTOR_STATS_ADD(vector, pushes, 1); \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return 0; \
+        } \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return vector->vptr->push(vector, value); \
+    } \
+    /** Get a value from the vector at index. Same as vptr->get without the indirect call. */ \
+    static inline int vector_##name##_get_fast(vector_##name##_t *vector, size_t index, data_type *out) { \
+        VECTOR_LOCK_COUNTED(lock_policy, vector); \
+        if (index >= vector->size) { \
+            VECTOR_UNLOCK(lock_policy, &vector->lock); \
+            return -1; \
+        } \
+        *out = vector->data[index]; \
+        VECTOR_STATS_ADD(vector, gets, 1); \
+        VECTOR_UNLOCK(lock_policy, &vector->lock); \
+        return 0; \
+    } \
+    /** Value at index. No lock and no bounds check, index must be in [0, size). */ \
+    static inline data_type vector_##name##_at(const vector_##name##_t *vector, size_t index) { \
+        return vector->data[index]; \
+    } \
+    /** Number of values in the vector. No lock, so only a snapshot if other threads push or pop. */ \
+    static inline size_t vector_##name##_size(const vector_##name##_t *vector) { \
+        return vector->size; \
+    }
 
 /** Vector create function */
-#define VECTOR_CREATE_FUNC(data_type) \
-    vector_##data_type##_t *vector_##data_type##_create(int initial_capacity);
+#define VECTOR_CREATE_FUNC(name) \
+    vector_##name##_t *vector_##name##_create(size_t initial_capacity); \
+    vector_##name##_t *vector_##name##_create_with_allocator(size_t initial_capacity, const vector_allocator_t *allocator);
 
 /** Vector destroy function */
-#define VECTOR_DESTROY_FUNC(data_type) \
-    int vector_##data_type##_destroy(vector_##data_type##_t *vector);
+#define VECTOR_DESTROY_FUNC(name) \
+    int vector_##name##_destroy(vector_##name##_t *vector);
 
 /** Vector public function declarations macro. */
-#define VECTOR_PUBLIC_FUNCTIONS_DECLARE(data_type) \
-    VECTOR_CREATE_FUNC(data_type) \
-    VECTOR_DESTROY_FUNC(data_type)
+#define VECTOR_PUBLIC_FUNCTIONS_DECLARE(name) \
+    VECTOR_CREATE_FUNC(name) \
+    VECTOR_DESTROY_FUNC(name)
+
+/**
+ * Vector structure and virtual table definition macro for a vector named vector_<name>_t that holds
+ * data_type values and is guarded by lock_policy (MUTEX, SPINLOCK or NOLOCK).
+ */
+#define VECTOR_DATA_STRUCTURE_WITH_LOCK(name, data_type, lock_policy) \
+    typedef struct _vector_##name vector_##name##_t; \
+    VECTOR_PUBLIC_FUNCTIONS_DECLARE(name) \
+    VECTOR_VTBL_T(name, data_type) \
+    VECTOR_T(name, data_type, lock_policy) \
+    VECTOR_INLINE_FUNCS(name, data_type, lock_policy)
 
 /** Vector structure and virtual table definition macro. */
 #define VECTOR_DATA_STRUCTURE(data_type) \
-	typedef struct _vector_##data_type vector_##data_type##_t; \
-	VECTOR_PUBLIC_FUNCTIONS_DECLARE(data_type)\
-    VECTOR_VTBL_T(data_type) \
-    VECTOR_T(data_type)
+    VECTOR_DATA_STRUCTURE_WITH_LOCK(data_type, data_type, MUTEX)
+
+/** Vector structure and virtual table definition macro for every lock policy of a type. */
+#define VECTOR_DATA_STRUCTURES(data_type) \
+    VECTOR_DATA_STRUCTURE(data_type) \
+    VECTOR_DATA_STRUCTURE_WITH_LOCK(data_type##_spinlock, data_type, SPINLOCK) \
+    VECTOR_DATA_STRUCTURE_WITH_LOCK(data_type##_nolock, data_type, NOLOCK)
+
+/**
+ * Vector numeric function declarations macro, for vectors of numbers. Sums and dot products are accumulated in
+ * sum_type, integer arithmetic wraps. The work is done by the vector_simd kernels under one lock acquisition.
+ * find gives VECTOR_NPOS when no value matches.
+ */
+#define VECTOR_NUMERIC_FUNCTIONS_DECLARE(name, data_type, sum_type) \
+    int vector_##name##_sum(vector_##name##_t *vector, sum_type *out); \
+    int vector_##name##_min(vector_##name##_t *vector, data_type *out); \
+    int vector_##name##_max(vector_##name##_t *vector, data_type *out); \
+    int vector_##name##_argmin(vector_##name##_t *vector, size_t *out); \
+    int vector_##name##_argmax(vector_##name##_t *vector, size_t *out); \
+    int vector_##name##_dot(vector_##name##_t *vector, vector_##name##_t *other, sum_type *out); \
+    int vector_##name##_axpy(vector_##name##_t *vector, data_type a, vector_##name##_t *x); \
+    int vector_##name##_scale(vector_##name##_t *vector, data_type a); \
+    int vector_##name##_find(vector_##name##_t *vector, data_type value, size_t *out); \
+    int vector_##name##_count(vector_##name##_t *vector, data_type value, size_t *out);
+
+/** Vector numeric function declarations macro for every lock policy of a type. */
+#define VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(data_type, sum_type) \
+    VECTOR_NUMERIC_FUNCTIONS_DECLARE(data_type, data_type, sum_type) \
+    VECTOR_NUMERIC_FUNCTIONS_DECLARE(data_type##_spinlock, data_type, sum_type) \
+    VECTOR_NUMERIC_FUNCTIONS_DECLARE(data_type##_nolock, data_type, sum_type)
+
+/**
+ * Vector sort function declarations macro. sort orders the values ascending with the vector_sort radix sort,
+ * sort_parallel does the same on threads threads, 0 for one per CPU. lower_bound gives the index of the first
+ * value not less than value, size if none, and binary_search the index of an equal value or VECTOR_NPOS.
+ * Both need a sorted vector.
+ */
+#define VECTOR_SORT_FUNCTIONS_DECLARE(name, data_type) \
+    int vector_##name##_sort(vector_##name##_t *vector); \
+    int vector_##name##_sort_parallel(vector_##name##_t *vector, unsigned int threads); \
+    int vector_##name##_lower_bound(vector_##name##_t *vector, data_type value, size_t *out); \
+    int vector_##name##_binary_search(vector_##name##_t *vector, data_type value, size_t *out);
+
+/** Vector sort function declarations macro for every lock policy of a type. */
+#define VECTOR_SORT_FUNCTIONS_DECLARE_ALL(data_type) \
+    VECTOR_SORT_FUNCTIONS_DECLARE(data_type, data_type) \
+    VECTOR_SORT_FUNCTIONS_DECLARE(data_type##_spinlock, data_type) \
+    VECTOR_SORT_FUNCTIONS_DECLARE(data_type##_nolock, data_type)
+
+/**
+ * Vector parallel function declarations macro. parallel_for runs fn on every grain sized chunk of the values on
+ * the shared vector_thread_pool threads, start being the index of the chunk's first value, and fn may change the
+ * values in place. parallel_reduce folds every chunk with fn starting from identity, then the chunk results in
+ * index order, so fn has to be associative with identity neutral, and the result of a given grain does not
+ * depend on the threads. grain 0 picks vector_thread_pool_default_grain. The vector stays locked throughout, so fn
+ * must not call the functions of the same vector.
+ */
+#define VECTOR_PARALLEL_FUNCTIONS_DECLARE(name, data_type) \
+    typedef void (*vector_##name##_for_t)(data_type *values, size_t count, size_t start, void *p_context); \
+    typedef data_type (*vector_##name##_reduce_t)(data_type accumulator, data_type value, void *p_context); \
+    int vector_##name##_parallel_for(vector_##name##_t *vector, vector_##name##_for_t fn, void *p_context, size_t grain); \
+    int vector_##name##_parallel_reduce(vector_##name##_t *vector, vector_##name##_reduce_t fn, data_type identity, void *p_context, \
+                                        size_t grain, data_type *out);
+
+/** Vector parallel function declarations macro for every lock policy of a type. */
+#define VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(data_type) \
+    VECTOR_PARALLEL_FUNCTIONS_DECLARE(data_type, data_type) \
+    VECTOR_PARALLEL_FUNCTIONS_DECLARE(data_type##_spinlock, data_type) \
+    VECTOR_PARALLEL_FUNCTIONS_DECLARE(data_type##_nolock, data_type)
 
 /* -------------------- Public Enums ------------------------------------ */
 
 /* -------------------- Public Structs ---------------------------------- */
 
-VECTOR_DATA_STRUCTURE(int)
-VECTOR_DATA_STRUCTURE(double)
-VECTOR_DATA_STRUCTURE(char)
-VECTOR_DATA_STRUCTURE(uint8_t)
-VECTOR_DATA_STRUCTURE(uint16_t)
-VECTOR_DATA_STRUCTURE(uint32_t)
-VECTOR_DATA_STRUCTURE(uint64_t)
+VECTOR_DATA_STRUCTURES(int)
+VECTOR_DATA_STRUCTURES(double)
+VECTOR_DATA_STRUCTURES(char)
+VECTOR_DATA_STRUCTURES(uint8_t)
+VECTOR_DATA_STRUCTURES(uint16_t)
+VECTOR_DATA_STRUCTURES(uint32_t)
+VECTOR_DATA_STRUCTURES(uint64_t)
+
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(int, int64_t)
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(double, double)
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(uint8_t, uint64_t)
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(uint16_t, uint64_t)
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(uint32_t, uint64_t)
+VECTOR_NUMERIC_FUNCTIONS_DECLARE_ALL(uint64_t, uint64_t)
+
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(int)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(double)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(char)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(uint8_t)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(uint16_t)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(uint32_t)
+VECTOR_SORT_FUNCTIONS_DECLARE_ALL(uint64_t)
+
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(int)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(double)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(char)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(uint8_t)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(uint16_t)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(uint32_t)
+VECTOR_PARALLEL_FUNCTIONS_DECLARE_ALL(uint64_t)
 
 /* -------------------- Public (global) Vars ---------------------------- */
 
@@ -108,7 +357,8 @@ VECTOR_DATA_STRUCTURE(uint64_t)
 /* -------------------- Public Function Declarations -------------------- */
 
 /**
- * @brief Create a new vector. Supports int, double, char, uint8_t, uint16_t, uint32_t, and uint64_t.
+ * @brief Create a new vector. Supports int, double, char, uint8_t, uint16_t, uint32_t, and uint64_t, each also
+ * as <type>_spinlock and <type>_nolock (e.g. double_nolock) for the other lock policies.
  *
  * @param data_type The c type of the vector.
  * @param variable_name Name of the variable to create.
@@ -118,6 +368,19 @@ VECTOR_DATA_STRUCTURE(uint64_t)
 #define vector_create(data_type, variable_name, initial_capacity) \
     vector_##data_type##_t *variable_name = vector_##data_type##_create((initial_capacity))
 
+/**
+ * @brief Create a new vector that gets its memory from an allocator, e.g. vector_arena_allocator(p_arena).
+ * Copies of the vector use the same allocator.
+ *
+ * @param data_type The c type of the vector.
+ * @param variable_name Name of the variable to create.
+ * @param initial_capacity Initial capacity of the vector.
+ * @param allocator The allocator, NULL for vector_allocator_default(). Must outlive the vector.
+ * @return vector_<data_type>_t* Pointer to the newly created vector.
+ */
+#define vector_create_with_allocator(data_type, variable_name, initial_capacity, allocator) \
+    vector_##data_type##_t *variable_name = vector_##data_type##_create_with_allocator((initial_capacity), (allocator))
+
 /**
  * @brief Destroy a vector. Supports int, double, char, uint8_t, uint16_t, uint32_t, and uint64_t.
  *
@@ -128,6 +391,28 @@ VECTOR_DATA_STRUCTURE(uint64_t)
 #define vector_destroy(data_type, vector) \
     vector_##data_type##_destroy(vector)
 
+/**
+ * @brief Push a value to the back of a vector without the virtual table call. The vector must not be NULL.
+ *
+ * @param data_type The c type of the vector.
+ * @param vector The vector to push to.
+ * @param value Value to push.
+ * @return int 0 on success, -1 on failure.
+ */
+#define vector_push_fast(data_type, vector, value) \
+    vector_##data_type##_push_fast((vector), (value))
+
+/**
+ * @brief Get the value at index of a vector without locking or bounds checking. The vector must not be NULL.
+ *
+ * @param data_type The c type of the vector.
+ * @param vector The vector to read.
+ * @param index Index of the value, in [0, size).
+ * @return data_type The value.
+ */
+#define vector_at(data_type, vector, index) \
+    vector_##data_type##_at((vector), (index))
+
 
 
 #ifdef __cplusplus
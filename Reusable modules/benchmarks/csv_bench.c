@@ -0,0 +1,548 @@
+/**
+ * @file csv_bench.c
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Benchmark for the CSV storage module.
+ *
+ * Generates a synthetic csv file of rows x columns x field width, then times every public operation
+ * of the module against it and prints the results as JSON on stdout (or to --output).
+ *
+ * Throughput (MB/s) is counted in csv payload bytes: the file size for open, the cell bytes returned
+ * for reads, and the bytes of the row or cell written or removed for the mutating operations.
+ *
+ * Usage: csv_bench [--rows N] [--columns N] [--width N] [--read-ops N] [--write-ops N]
+ *                  [--seed N] [--dir PATH] [--output FILE]
+ *
+ * @version 0.1
+ * @date 2025-04-03
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+/* -------------------- Private Includes -------------------- */
+#include "csv.h"
+#include "file_io.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------- Private Macros/Defines -------------------- */
+
+/** definition for the default number of rows in the generated file. */
+#define DEFAULT_ROWS            (1000)
+/** definition for the default number of columns in the generated file. */
+#define DEFAULT_COLUMNS         (8)
+/** definition for the default number of chars in every generated field. */
+#define DEFAULT_FIELD_WIDTH     (8)
+/** definition for the default number of timed read operations. */
+#define DEFAULT_READ_OPS        (10000)
+/** definition for the default number of timed operations that rewrite the file. */
+#define DEFAULT_WRITE_OPS       (100)
+/** definition for the max number of results the benchmark reports. */
+#define MAX_RESULTS             (16)
+/** definition for the name of the generated file. */
+#define BENCH_FILE_NAME         "csv_bench.csv"
+
+/* -------------------- Private Structs -------------------- */
+
+/**
+ * @brief Benchmark configuration taken from the command line.
+ *
+ */
+typedef struct _bench_config {
+    size_t rows;                        /**< Number of rows in the generated file. */
+    size_t columns;                     /**< Number of columns in the generated file. */
+    size_t field_width;                 /**< Number of chars in every generated field. */
+    size_t read_ops;                    /**< Number of timed read operations. */
+    size_t write_ops;                   /**< Number of timed operations that rewrite the file. */
+    unsigned int seed;                  /**< Seed for the random row and column choices. */
+    const char *p_dir;                  /**< Directory to generate the file in. */
+    const char *p_output;               /**< File to write the JSON to, NULL for stdout. */
+} bench_config_t;
+
+/**
+ * @brief Timing results of one benchmarked operation.
+ *
+ */
+typedef struct _bench_result {
+    const char *p_name;                 /**< Name of the operation. */
+    size_t ops;                         /**< Number of timed operations. */
+    uint64_t total_ns;                  /**< Sum of the operation latencies. */
+    uint64_t total_bytes;               /**< Payload bytes moved by all operations. */
+    uint64_t p50_ns;                    /**< Median latency. */
+    uint64_t p90_ns;                    /**< 90th percentile latency. */
+    uint64_t p99_ns;                    /**< 99th percentile latency. */
+    uint64_t max_ns;                    /**< Worst latency. */
+} bench_result_t;
+
+/**
+ * @brief Running state of the operation being timed.
+ *
+ */
+typedef struct _bench_run {
+    uint64_t *p_latencies;              /**< Latency of every timed operation. */
+    size_t ops;                         /**< Number of latencies recorded. */
+    uint64_t bytes;                     /**< Payload bytes moved so far. */
+    uint64_t start_ns;                  /**< Start of the operation currently timed. */
+} bench_run_t;
+
+/* -------------------- Private (static) Vars -------------------- */
+
+/** Results of every benchmarked operation, in the order they ran. */
+static bench_result_t s_results[MAX_RESULTS];
+/** Number of entries used in s_results. */
+static size_t s_number_of_results = 0;
+
+/* -------------------- Private (static) Function Declarations */
+
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config);
+static uint64_t now_ns(void);
+static void fill_field(char *p_field, size_t width);
+static long generate_csv_file(const bench_config_t *p_config, const char *p_path);
+static int run_begin(bench_run_t *p_run, size_t ops);
+static void op_begin(bench_run_t *p_run);
+static void op_end(bench_run_t *p_run, uint64_t bytes);
+static void run_end(bench_run_t *p_run, const char *p_name);
+static int compare_u64(const void *p_a, const void *p_b);
+static void print_json(FILE *p_out, const bench_config_t *p_config, long file_bytes, const char *p_stats_json);
+
+/* -------------------- Private and Public Function Definitions -------------------- */
+
+/**
+ * @brief Entry point of the benchmark.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @return exit status
+ */
+int main(int argc, char *argv[]) {
+
+    bench_config_t config = {DEFAULT_ROWS, DEFAULT_COLUMNS, DEFAULT_FIELD_WIDTH, DEFAULT_READ_OPS, DEFAULT_WRITE_OPS, 1, ".", NULL};
+    char path[FILE_PATH_LENGTH] = {0};
+    char *p_row = NULL;
+    char *p_cell = NULL;
+    FILE *p_out = stdout;
+    bench_run_t run = {0};
+    csv_stats_t *p_stats = NULL;
+    char *p_stats_json = NULL;
+    int stats_json_length = 0;
+    long file_bytes = 0;
+    int handle = 0;
+
+    if(parse_arguments(argc, argv, &config)) {
+        fprintf(stderr, "usage: %s [--rows N] [--columns N] [--width N] [--read-ops N] [--write-ops N] [--seed N] [--dir PATH] [--output FILE]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    srand(config.seed);
+    snprintf(path, sizeof(path), "%s/%s", config.p_dir, BENCH_FILE_NAME);
+
+    /* The row buffer holds one field per column, each field_width+1 apart as insert_row() expects. */
+    p_row = (char *)calloc(config.columns, config.field_width+1);
+    p_cell = (char *)calloc(config.field_width+1, 1);
+    if((p_row == NULL) || (p_cell == NULL)) {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t column = 0; column < config.columns; column++) {
+        fill_field(p_row+(column*(config.field_width+1)), config.field_width);
+    }
+
+    if((file_bytes = generate_csv_file(&config, path)) < 0) {
+        fprintf(stderr, "failed to generate %s: %s\n", path, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    /* Open: counts rows and columns by scanning the whole file. */
+    if(run_begin(&run, 1)) {
+        return EXIT_FAILURE;
+    }
+    op_begin(&run);
+    handle = open_csv_file(path);
+    op_end(&run, (uint64_t)file_bytes);
+    run_end(&run, "open");
+
+    if(get_row_count(handle) != (int)config.rows) {
+        fprintf(stderr, "open counted %d rows, expected %zu\n", get_row_count(handle), config.rows);
+        return EXIT_FAILURE;
+    }
+
+    /* Row count. */
+    if(run_begin(&run, config.read_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.read_ops; op++) {
+        op_begin(&run);
+        (void)get_row_count(handle);
+        op_end(&run, 0);
+    }
+    run_end(&run, "row_count");
+
+    /* Random cell reads, first with the row cache disabled, then with the default cache. */
+    csv_set_cache_bytes(handle, 0);
+    if(run_begin(&run, config.read_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.read_ops; op++) {
+        cell_t cell = {(size_t)rand() % config.rows, (size_t)rand() % config.columns};
+        p_cell[0] = '\0';
+        op_begin(&run);
+        get_cell_contents(handle, p_cell, cell);
+        op_end(&run, strlen(p_cell));
+    }
+    run_end(&run, "random_read_uncached");
+
+    csv_set_cache_bytes(handle, CSV_DEFAULT_ROW_CACHE_BYTES);
+    if(run_begin(&run, config.read_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.read_ops; op++) {
+        cell_t cell = {(size_t)rand() % config.rows, (size_t)rand() % config.columns};
+        p_cell[0] = '\0';
+        op_begin(&run);
+        get_cell_contents(handle, p_cell, cell);
+        op_end(&run, strlen(p_cell));
+    }
+    run_end(&run, "random_read");
+
+    /* Sequential scan of every cell, timed per cell. */
+    if(run_begin(&run, config.rows*config.columns)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t row = 0; row < config.rows; row++) {
+        for (size_t column = 0; column < config.columns; column++) {
+            cell_t cell = {row, column};
+            p_cell[0] = '\0';
+            op_begin(&run);
+            get_cell_contents(handle, p_cell, cell);
+            op_end(&run, strlen(p_cell));
+        }
+    }
+    run_end(&run, "sequential_scan");
+
+    /* Append. */
+    if(run_begin(&run, config.write_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.write_ops; op++) {
+        op_begin(&run);
+        append_row(handle, (int)config.field_width+1, p_row);
+        op_end(&run, config.columns*(config.field_width+1));
+    }
+    run_end(&run, "append_row");
+
+    /* Update a random cell. */
+    if(run_begin(&run, config.write_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.write_ops; op++) {
+        cell_t cell = {(size_t)rand() % config.rows, (size_t)rand() % config.columns};
+        op_begin(&run);
+        update_cell(handle, p_row, cell);
+        op_end(&run, config.field_width);
+    }
+    run_end(&run, "update_cell");
+
+    /* Insert before a random row. */
+    if(run_begin(&run, config.write_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.write_ops; op++) {
+        op_begin(&run);
+        insert_row(handle, rand() % (int)config.rows, (int)config.field_width+1, p_row);
+        op_end(&run, config.columns*(config.field_width+1));
+    }
+    run_end(&run, "insert_row");
+
+    /* Delete a random row. */
+    if(run_begin(&run, config.write_ops)) {
+        return EXIT_FAILURE;
+    }
+    for (size_t op = 0; op < config.write_ops; op++) {
+        op_begin(&run);
+        delete_row(handle, rand() % (int)config.rows);
+        op_end(&run, config.columns*(config.field_width+1));
+    }
+    run_end(&run, "delete_row");
+
+    /* Module instrumentation, only available when built with CSV_ENABLE_STATS. */
+    if(((p_stats = (csv_stats_t *)malloc(sizeof(csv_stats_t))) != NULL) && (csv_get_stats(handle, p_stats) == 0)) {
+        stats_json_length = csv_stats_to_json(p_stats, NULL, 0);
+        if((stats_json_length > 0) && ((p_stats_json = (char *)malloc((size_t)stats_json_length+1)) != NULL)) {
+            csv_stats_to_json(p_stats, p_stats_json, (size_t)stats_json_length+1);
+        }
+    }
+    free(p_stats);
+
+    close_csv_file(handle);
+    remove(path);
+    free(p_row);
+    free(p_cell);
+    free(run.p_latencies);
+
+    if((config.p_output != NULL) && ((p_out = fopen(config.p_output, "w")) == NULL)) {
+        fprintf(stderr, "failed to open %s: %s\n", config.p_output, strerror(errno));
+        return EXIT_FAILURE;
+    }
+    print_json(p_out, &config, file_bytes, p_stats_json);
+    if(p_out != stdout) {
+        fclose(p_out);
+    }
+    free(p_stats_json);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Helper function to fill the benchmark configuration from the command line.
+ *
+ * @param[in] argc Number of command line arguments.
+ * @param[in] argv Array of pointers to the command line argument strings.
+ * @param p_config Configuration to update.
+ * @return 0 on success, -1 on an unknown or incomplete argument.
+ */
+static int parse_arguments(int argc, char *argv[], bench_config_t *p_config) {
+
+    for (int arg = 1; arg < argc; arg++) {
+        /* Every option takes a value. */
+        if(arg+1 >= argc) {
+            return -1;
+        }
+        if(strcmp(argv[arg], "--rows") == 0) {
+            p_config->rows = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--columns") == 0) {
+            p_config->columns = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--width") == 0) {
+            p_config->field_width = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--read-ops") == 0) {
+            p_config->read_ops = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--write-ops") == 0) {
+            p_config->write_ops = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--seed") == 0) {
+            p_config->seed = (unsigned int)strtoul(argv[++arg], NULL, 10);
+        }
+        else if(strcmp(argv[arg], "--dir") == 0) {
+            p_config->p_dir = argv[++arg];
+        }
+        else if(strcmp(argv[arg], "--output") == 0) {
+            p_config->p_output = argv[++arg];
+        }
+        else {
+            return -1;
+        }
+    }
+
+    /* Random row choices need at least one row, and a row needs at least one column. */
+    if((p_config->rows == 0) || (p_config->columns == 0)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to read the monotonic clock.
+ *
+ * @return Current time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec*1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Helper function to fill a field with random alphanumeric chars.
+ *
+ * @param p_field Field to fill. Must have room for width+1 chars.
+ * @param width Number of chars to write before the null terminator.
+ */
+static void fill_field(char *p_field, size_t width) {
+
+    static const char s_alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+    for (size_t idx = 0; idx < width; idx++) {
+        p_field[idx] = s_alphabet[rand() % (int)(sizeof(s_alphabet)-1)];
+    }
+    p_field[width] = '\0';
+}
+
+/**
+ * @brief Helper function to write the synthetic csv file in the module's format.
+ *
+ * @param p_config Benchmark configuration.
+ * @param p_path Path of the file to create.
+ * @return Size of the file in bytes, -1 on fail.
+ */
+static long generate_csv_file(const bench_config_t *p_config, const char *p_path) {
+
+    FILE *p_file = NULL;
+    char *p_field = NULL;
+    long file_bytes = 0;
+
+    if((p_file = fopen(p_path, "w")) == NULL) {
+        return -1;
+    }
+    if((p_field = (char *)malloc(p_config->field_width+1)) == NULL) {
+        fclose(p_file);
+        return -1;
+    }
+
+    /* Every field is followed by a ',' and every row by a new line, as append_row() writes them. */
+    for (size_t row = 0; row < p_config->rows; row++) {
+        for (size_t column = 0; column < p_config->columns; column++) {
+            fill_field(p_field, p_config->field_width);
+            fputs(p_field, p_file);
+            fputc(',', p_file);
+        }
+        fputc('\n', p_file);
+    }
+
+    file_bytes = ftell(p_file);
+    free(p_field);
+
+    if(fclose(p_file)) {
+        return -1;
+    }
+
+    return file_bytes;
+}
+
+/**
+ * @brief Helper function to start timing a new operation.
+ *
+ * @param p_run Run state to reset.
+ * @param ops Max number of operations that will be timed.
+ * @return 0 on success, -1 on fail.
+ */
+static int run_begin(bench_run_t *p_run, size_t ops) {
+
+    free(p_run->p_latencies);
+    memset(p_run, 0, sizeof(bench_run_t));
+
+    if((p_run->p_latencies = (uint64_t *)malloc((ops+1)*sizeof(uint64_t))) == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to mark the start of one timed operation.
+ *
+ * @param p_run Run state.
+ */
+static inline void op_begin(bench_run_t *p_run) {
+    p_run->start_ns = now_ns();
+}
+
+/**
+ * @brief Helper function to record the latency of one timed operation.
+ *
+ * @param p_run Run state.
+ * @param bytes Payload bytes the operation moved.
+ */
+static inline void op_end(bench_run_t *p_run, uint64_t bytes) {
+    p_run->p_latencies[p_run->ops++] = now_ns() - p_run->start_ns;
+    p_run->bytes += bytes;
+}
+
+/**
+ * @brief Helper function to turn the recorded latencies into a result.
+ *
+ * @param p_run Run state.
+ * @param p_name Name of the operation.
+ */
+static void run_end(bench_run_t *p_run, const char *p_name) {
+
+    bench_result_t *p_result = &s_results[s_number_of_results];
+
+    if(s_number_of_results >= MAX_RESULTS) {
+        return;
+    }
+    s_number_of_results++;
+
+    memset(p_result, 0, sizeof(bench_result_t));
+    p_result->p_name = p_name;
+    p_result->ops = p_run->ops;
+    p_result->total_bytes = p_run->bytes;
+
+    if(p_run->ops == 0) {
+        return;
+    }
+
+    for (size_t op = 0; op < p_run->ops; op++) {
+        p_result->total_ns += p_run->p_latencies[op];
+    }
+
+    /* Percentiles by nearest rank over the sorted latencies. */
+    qsort(p_run->p_latencies, p_run->ops, sizeof(uint64_t), compare_u64);
+    p_result->p50_ns = p_run->p_latencies[((p_run->ops-1)*50)/100];
+    p_result->p90_ns = p_run->p_latencies[((p_run->ops-1)*90)/100];
+    p_result->p99_ns = p_run->p_latencies[((p_run->ops-1)*99)/100];
+    p_result->max_ns = p_run->p_latencies[p_run->ops-1];
+}
+
+/**
+ * @brief qsort() comparison for uint64_t values.
+ *
+ * @param p_a Pointer to the first value.
+ * @param p_b Pointer to the second value.
+ * @return <0, 0 or >0 as a is less than, equal to or greater than b.
+ */
+static int compare_u64(const void *p_a, const void *p_b) {
+
+    uint64_t a = *(const uint64_t *)p_a;
+    uint64_t b = *(const uint64_t *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Helper function to print every result as a JSON document.
+ *
+ * @param p_out Stream to print to.
+ * @param p_config Benchmark configuration.
+ * @param file_bytes Size of the generated file in bytes.
+ * @param p_stats_json Module instrumentation as JSON, NULL if it was not compiled in.
+ */
+static void print_json(FILE *p_out, const bench_config_t *p_config, long file_bytes, const char *p_stats_json) {
+
+    fprintf(p_out, "{\n");
+    fprintf(p_out, "  \"benchmark\": \"csv\",\n");
+    fprintf(p_out, "  \"config\": {\"rows\": %zu, \"columns\": %zu, \"field_width\": %zu, \"read_ops\": %zu, \"write_ops\": %zu, \"seed\": %u},\n",
+            p_config->rows, p_config->columns, p_config->field_width, p_config->read_ops, p_config->write_ops, p_config->seed);
+    fprintf(p_out, "  \"file_bytes\": %ld,\n", file_bytes);
+    fprintf(p_out, "  \"results\": [\n");
+
+    for (size_t idx = 0; idx < s_number_of_results; idx++) {
+        const bench_result_t *p_result = &s_results[idx];
+        double seconds = (double)p_result->total_ns / 1e9;
+        double ops_per_sec = (seconds > 0.0) ? ((double)p_result->ops / seconds) : 0.0;
+        double mb_per_sec = (seconds > 0.0) ? (((double)p_result->total_bytes / 1e6) / seconds) : 0.0;
+
+        fprintf(p_out, "    {\"name\": \"%s\", \"ops\": %zu, \"ops_per_sec\": %.1f, \"mb_per_sec\": %.3f, "
+                "\"latency_ns\": {\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu}}%s\n",
+                p_result->p_name, p_result->ops, ops_per_sec, mb_per_sec,
+                (unsigned long long)p_result->p50_ns, (unsigned long long)p_result->p90_ns,
+                (unsigned long long)p_result->p99_ns, (unsigned long long)p_result->max_ns,
+                (idx+1 < s_number_of_results) ? "," : "");
+    }
+
+    fprintf(p_out, "  ]%s\n", (p_stats_json != NULL) ? "," : "");
+    if(p_stats_json != NULL) {
+        fprintf(p_out, "  \"module_stats\": %s\n", p_stats_json);
+    }
+    fprintf(p_out, "}\n");
+}
@@ -12,23 +12,159 @@
 #include "csv.h"
 #include "file_io.h"
 #include <assert.h>
+#include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <time.h>
 
 /* -------------------- Private Macros/Defines -------------------- */
 
+/* If Windows */
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+    #define CSV_FILENO(p_stream) _fileno((p_stream))
+    #define CSV_FSYNC(file_descriptor) _commit((file_descriptor))
+    #define CSV_FDATASYNC(file_descriptor) _commit((file_descriptor))
+    #define CSV_THREAD_TYPE HANDLE
+    #define CSV_THREAD_RETURN_TYPE DWORD WINAPI
+    #define CSV_THREAD_CREATE(p_thread, function, p_arg) ((*(p_thread) = CreateThread(NULL, 0, (function), (p_arg), 0, NULL)) == NULL)
+    #define CSV_THREAD_JOIN(thread) (WaitForSingleObject((thread), INFINITE), CloseHandle((thread)))
+#else /* If POSIX-like system */
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <unistd.h>
+    #define CSV_THREAD_TYPE pthread_t
+    #define CSV_THREAD_RETURN_TYPE void *
+    #define CSV_THREAD_CREATE(p_thread, function, p_arg) pthread_create((p_thread), NULL, (function), (p_arg))
+    #define CSV_THREAD_JOIN(thread) pthread_join((thread), NULL)
+    #define CSV_FILENO(p_stream) fileno((p_stream))
+    #define CSV_FSYNC(file_descriptor) fsync((file_descriptor))
+    #if defined(__linux__)
+        #define CSV_FDATASYNC(file_descriptor) fdatasync((file_descriptor))
+    #else
+        #define CSV_FDATASYNC(file_descriptor) fsync((file_descriptor))
+    #endif
+#endif
+
 /** definition for the length of a csv file extension including the period. */
 #define EXTENSION_LENGTH            (4)
 /** definition for the max number of current csv files that can be open. */
 #define MAX_CONCURRENT_CSV_FILES    (1)
 /** definition of a macro for the csv file extension string. */
 #define CSV_EXTENSION_STRING        ".csv"
+/** definition for the number of hash buckets a row cache starts with. Must be a power of 2. */
+#define ROW_CACHE_INITIAL_BUCKETS   (64)
+/** definition for the initial size of the buffer a row is read into. */
+#define ROW_READ_BUFFER_LENGTH      (128)
+/** definition for the size of the buffer the partitioner streams the source through. */
+#define PARTITION_READ_BUFFER_BYTES (64 * 1024)
+/** definition for the size of the write buffer of every partition. */
+#define PARTITION_WRITE_BUFFER_BYTES (8 * 1024)
+/** definition for the smallest source chunk worth a thread of its own. */
+#define PARTITION_MIN_CHUNK_BYTES   (1024 * 1024)
+/** definition for the number of hash buckets a partition table starts with. Must be a power of 2. */
+#define PARTITION_INITIAL_BUCKETS   (64)
+
+#ifdef CSV_ENABLE_STATS
+/** Add to an instrumentation counter of a csv file handle. */
+#define STATS_ADD(csv_file_handle, counter, amount) (s_csv_files[convert_handle_to_index(csv_file_handle)].stats.counter += (amount))
+#else
+/** Instrumentation is compiled out. */
+#define STATS_ADD(csv_file_handle, counter, amount) ((void)0)
+#endif
 
 /* -------------------- Private Enums -------------------- */
 
 /* -------------------- Private Structs -------------------- */
 
+/**
+ * @brief Location of one field inside the text of a cached row.
+ * 
+ */
+typedef struct _csv_field_span {
+    size_t offset;                           /**< Offset of the first char of the field from the start of the row text. */
+    size_t length;                           /**< Number of chars in the field. */
+} csv_field_span_t;
+
+/**
+ * @brief A parsed row of a csv file held in memory.
+ * 
+ */
+typedef struct _csv_cached_row {
+    struct _csv_cached_row *p_lru_prev;      /**< Next more recently used row. */
+    struct _csv_cached_row *p_lru_next;      /**< Next less recently used row. */
+    struct _csv_cached_row *p_hash_next;     /**< Next row in the same hash bucket. */
+    size_t row;                              /**< Row number in the file (0 based index). */
+    size_t footprint;                        /**< Bytes charged to the cache for this row. */
+    size_t number_of_fields;                 /**< Number of fields in the row. */
+    int is_complete;                         /**< 1 if the row was terminated by a new line, 0 if it ran into EOF. */
+    csv_field_span_t *p_fields;              /**< Span of each field within p_text. */
+    char *p_text;                            /**< Row text with every ',' replaced by a null terminator. */
+} csv_cached_row_t;
+
+/**
+ * @brief Bounded memory LRU cache of parsed rows for a csv file.
+ * 
+ */
+typedef struct _csv_row_cache {
+    csv_cached_row_t **pp_buckets;           /**< Hash table of the cached rows keyed by row number. */
+    size_t number_of_buckets;                /**< Number of buckets in the hash table (power of 2). */
+    csv_cached_row_t *p_lru_head;            /**< Most recently used row. */
+    csv_cached_row_t *p_lru_tail;            /**< Least recently used row. */
+    size_t number_of_rows;                   /**< Number of rows currently cached. */
+    size_t used_bytes;                       /**< Sum of the footprints of the cached rows. */
+    size_t capacity_bytes;                   /**< Memory budget of the cache. */
+    uint64_t hits;                           /**< Lookups served from memory. */
+    uint64_t misses;                         /**< Lookups that had to read the file. */
+    uint64_t evictions;                      /**< Rows dropped to stay within the budget. */
+    uint64_t invalidations;                  /**< Rows dropped because the file changed. */
+} csv_row_cache_t;
+
+/**
+ * @brief One output file of a partitioning run.
+ * 
+ */
+typedef struct _csv_partition {
+    struct _csv_partition *p_hash_next;      /**< Next partition in the same hash bucket. */
+    struct _csv_partition *p_all_next;       /**< Next partition in creation order. */
+    struct _csv_partition *p_lru_prev;       /**< Next more recently written open partition. */
+    struct _csv_partition *p_lru_next;       /**< Next less recently written open partition. */
+    FILE *p_file;                            /**< Output file, NULL while it is closed. */
+    int has_been_created;                    /**< 1 once the output file was created (truncated) by this run. */
+    uint64_t name_hash;                      /**< Hash of file_name. */
+    char *p_buffer;                          /**< Rows not yet written to the file. Only allocated while the file is open. */
+    size_t buffer_length;                    /**< Number of bytes in p_buffer. */
+    char file_name[FILE_PATH_LENGTH];        /**< Name of the output file inside the output directory. */
+} csv_partition_t;
+
+/**
+ * @brief State of one thread of a partitioning run, streaming one chunk of the source.
+ * 
+ */
+typedef struct _csv_partition_writer {
+    const csv_partition_options_t *p_options;   /**< Options of the run. */
+    const char *p_source_path;               /**< Path of the csv file being partitioned. */
+    long start_offset;                       /**< First byte of the chunk, always the start of a row. */
+    long end_offset;                         /**< One past the last byte of the chunk. */
+    unsigned int chunk;                      /**< Index of the chunk. */
+    int is_chunked;                          /**< 1 to write per chunk files that get stitched together afterwards. */
+    size_t max_open_files;                   /**< Max number of files this writer keeps open. */
+    csv_partition_t **pp_buckets;            /**< Hash table of the partitions keyed by file name. */
+    size_t number_of_buckets;                /**< Number of buckets in the hash table (power of 2). */
+    size_t number_of_partitions;             /**< Number of partitions in the table. */
+    csv_partition_t *p_first;                /**< First partition in creation order. */
+    csv_partition_t *p_last;                 /**< Last partition in creation order. */
+    csv_partition_t *p_lru_head;             /**< Most recently written open partition. */
+    csv_partition_t *p_lru_tail;             /**< Least recently written open partition. */
+    size_t number_of_open_files;             /**< Number of partitions with an open file. */
+    uint64_t bytes_read;                     /**< Bytes read from the source. */
+    uint64_t bytes_written;                  /**< Bytes written to the partition files. */
+    int rv;                                  /**< 0 on success, errno on fail. */
+} csv_partition_writer_t;
+
 /**
  * @brief Collection of data for a csv file.
  * 
@@ -38,6 +174,15 @@ typedef struct _csv_file {
     size_t number_of_rows;                   /**< Current number of rows in the csv file. */
     size_t number_of_columns;                /**< Number of columns to make the csv file. */
     char absolute_path[FILE_PATH_LENGTH];    /**< Copy of the absolute file path */
+    csv_row_cache_t row_cache;               /**< Cache of recently read rows. */
+    csv_durability_t durability;             /**< When writes are synced to the disk. */
+    uint64_t group_sync_age_ns;              /**< Age of the oldest unsynced append at which the next append syncs in group commit mode, 0 for none. */
+    size_t group_window_bytes;               /**< Max number of unsynced appended bytes in group commit mode, 0 for no limit. */
+    size_t pending_bytes;                    /**< Bytes appended since the last sync. */
+    uint64_t pending_since_ns;               /**< Time of the first append since the last sync. */
+#ifdef CSV_ENABLE_STATS
+    csv_stats_t stats;                       /**< Instrumentation counters. */
+#endif
 } csv_file_t;
 
 /* -------------------- Private (static) Vars -------------------- */
@@ -55,8 +200,55 @@ static int check_for_extension(const char* filename);
 static int calculate_row_count(int csv_file_handle);
 static int calculate_column_count(int csv_file_handle);
 static int convert_handle_to_index(int csv_file_handle);
+static int create_csv_file_(const char *absolute_path_to_file, int number_of_columns, int *p_csv_file_handle);
+static int open_csv_file_(const char *absolute_path_to_file, int *p_csv_file_handle);
+static int update_cell_(int csv_file_handle, const char *data_to_insert, cell_t cell);
+static int update_row_(int csv_file_handle, int row, int width_of_string, const char *data_array_to_insert);
+static int insert_row_(int csv_file_handle, int row_to_insert_before, int memory_spacing, const char *data_array_to_insert);
+static int append_row_(int csv_file_handle, int memory_spacing, const char *data_array_to_insert);
+static int delete_row_(int csv_file_handle, int row_to_delete);
+static int get_cell_contents_(int csv_file_handle, char *content_string, cell_t cell);
+static int tracked_fgetc(int csv_file_handle, FILE *p_stream);
+static int tracked_fprintf(int csv_file_handle, FILE *p_stream, const char *p_format, ...);
+static int tracked_fseek(int csv_file_handle, FILE *p_stream, long offset, int origin);
+static void tracked_rewind(int csv_file_handle, FILE *p_stream);
+static CSV_THREAD_RETURN_TYPE partition_worker(void *p_arg);
+static int partition_run(csv_partition_writer_t *p_writer);
+static int partition_route_row(csv_partition_writer_t *p_writer, const char *p_row, size_t row_length);
+static csv_partition_t *partition_lookup(csv_partition_writer_t *p_writer, const char *p_file_name);
+static int partition_write(csv_partition_writer_t *p_writer, csv_partition_t *p_partition, const char *p_data, size_t length);
+static int partition_flush(csv_partition_writer_t *p_writer, csv_partition_t *p_partition);
+static int partition_open(csv_partition_writer_t *p_writer, csv_partition_t *p_partition);
+static int partition_path(const csv_partition_writer_t *p_writer, const csv_partition_t *p_partition, char *p_path);
+static int partition_merge(csv_partition_writer_t *p_writers, unsigned int number_of_writers);
+static int partition_append_file(const char *p_from_path, const char *p_to_path);
+static void partition_writer_free(csv_partition_writer_t *p_writer, int remove_outputs);
+static uint64_t hash_bytes(const char *p_data, size_t length);
+static uint64_t clock_ns(void);
+static int sync_file(int csv_file_handle);
+static int sync_appended_bytes(int csv_file_handle, size_t appended_bytes);
+static int sync_directory(const char *p_path);
+static void directory_of(const char *p_path, char *p_directory);
+static int partition_check_out_dir(const char *p_out_dir, const char *p_source_path);
+static int replace_with_temp_file(int csv_file_handle, FILE *p_temp_file, const char *p_temp_file_name);
+static uint64_t stats_clock_ns(void);
+static void stats_record_latency(int csv_file_handle, csv_op_t op, uint64_t start_ns);
+#ifdef CSV_ENABLE_STATS
+static size_t histogram_bucket_index(uint64_t latency_ns);
+#endif
+static uint64_t histogram_bucket_upper_ns(size_t bucket);
+static void json_append(char *p_buffer, size_t buffer_length, size_t *p_length, const char *p_format, ...);
 static void go_to_row(int csv_file_handle, int row);
 static void go_to_column(int csv_file_handle, int column);
+static int load_row(int csv_file_handle, size_t row, csv_cached_row_t **pp_row);
+static csv_cached_row_t *row_cache_find(csv_row_cache_t *p_cache, size_t row);
+static int row_cache_insert(csv_row_cache_t *p_cache, csv_cached_row_t *p_row);
+static void row_cache_unlink(csv_row_cache_t *p_cache, csv_cached_row_t *p_row);
+static void row_cache_evict(csv_row_cache_t *p_cache, size_t budget_bytes);
+static int row_cache_rehash(csv_row_cache_t *p_cache, size_t number_of_buckets);
+static void row_cache_invalidate_row(csv_row_cache_t *p_cache, size_t row);
+static void row_cache_shift_rows(csv_row_cache_t *p_cache, size_t first_row, int delta);
+static void row_cache_clear(csv_row_cache_t *p_cache);
 
 /* -------------------- Public (global) Vars -------------------- */
 
@@ -69,10 +261,31 @@ extern int errno;
  * 
  * @param absolute_path_to_file Absolute path to the csv file to be created
  * @param number_of_columns Number of columns for the csv file
- * @return 0 on success, errno on fail.
+ * @return The handle of the file on success, errno on fail.
  */
 int create_csv_file(const char *absolute_path_to_file, int number_of_columns) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int file_handle = 0;
+    int rv = create_csv_file_(absolute_path_to_file, number_of_columns, &file_handle);
+
+    /* Only a created file has a handle to record the latency in, a failed create returns the errno. */
+    if(rv != 0) {
+        return rv;
+    }
+    stats_record_latency(file_handle, CSV_OP_CREATE_CSV_FILE, start_ns);
+
+    return file_handle;
+}
+
+/**
+ * @brief Body of create_csv_file(), called without recording its latency.
+ * 
+ * @param p_csv_file_handle Set to the handle of the new file on success.
+ * @return 0 on success, errno on fail.
+ */
+static int create_csv_file_(const char *absolute_path_to_file, int number_of_columns, int *p_csv_file_handle) {
+
     int file_handle = 0;
 
     /* 
@@ -80,7 +293,7 @@ int create_csv_file(const char *absolute_path_to_file, int number_of_columns) {
         Also checking to make sure it open the file correctly and a handle was assigned. If not return
         an "error code".
     */
-    if((file_handle = open_csv_file(absolute_path_to_file)) <= 0) {
+    if(open_csv_file_(absolute_path_to_file, &file_handle)) {
         return errno;
     }
 
@@ -90,17 +303,39 @@ int create_csv_file(const char *absolute_path_to_file, int number_of_columns) {
     set_row_count(file_handle, 0);
 
     /* Return the file handle for the user. */
-    return file_handle;
+    *p_csv_file_handle = file_handle;
+    return 0;
 }
 
 /**
  * @brief Opens an already existing csv file
  * 
  * @param absolute_path_to_file Absolute path of the file to be opened.
- * @return 0 on success, errno on fail.
+ * @return The handle of the file on success, errno on fail.
  */
 int open_csv_file(const char *absolute_path_to_file) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int file_handle = 0;
+    int rv = open_csv_file_(absolute_path_to_file, &file_handle);
+
+    /* Only an opened file has a handle to record the latency in, a failed open returns the errno. */
+    if(rv != 0) {
+        return rv;
+    }
+    stats_record_latency(file_handle, CSV_OP_OPEN_CSV_FILE, start_ns);
+
+    return file_handle;
+}
+
+/**
+ * @brief Body of open_csv_file(), called without recording its latency.
+ * 
+ * @param p_csv_file_handle Set to the handle of the opened file on success.
+ * @return 0 on success, errno on fail.
+ */
+static int open_csv_file_(const char *absolute_path_to_file, int *p_csv_file_handle) {
+
     int next_free_index = 0;
 
     /* Check to see if we have room to open any more csv files. If not return an invalid handle. */
@@ -123,35 +358,51 @@ int open_csv_file(const char *absolute_path_to_file) {
 
     /* Open the csv file and check it opened successfully. */
     if((s_csv_files[next_free_index].p_file = fopen(absolute_path_to_file, "a+")) == NULL) {
+        /* Give the index back, it holds no file. */
+        s_free_indexes[next_free_index] = 0;
         return errno;
     }
 
 	/* Update number of files open */
 	s_number_of_open_files++;	
+#ifdef CSV_ENABLE_STATS
+    /* Start counting from zero, including the scans below. */
+    memset(&s_csv_files[next_free_index].stats, 0, sizeof(csv_stats_t));
+#endif
     /* store the column count for later use. */
     s_csv_files[next_free_index].number_of_rows = calculate_row_count(next_free_index+1);
     /* store the current row count for later use. */
     s_csv_files[next_free_index].number_of_columns = calculate_column_count(next_free_index+1);
     /* store the file path. */
     strcpy(s_csv_files[next_free_index].absolute_path, absolute_path_to_file);
+    /* Start with an empty row cache of the default size. */
+    memset(&s_csv_files[next_free_index].row_cache, 0, sizeof(csv_row_cache_t));
+    s_csv_files[next_free_index].row_cache.capacity_bytes = CSV_DEFAULT_ROW_CACHE_BYTES;
+    /* Leave syncing to the OS until asked otherwise. */
+    s_csv_files[next_free_index].durability = CSV_DURABILITY_NONE;
+    s_csv_files[next_free_index].group_sync_age_ns = 0;
+    s_csv_files[next_free_index].group_window_bytes = 0;
+    s_csv_files[next_free_index].pending_bytes = 0;
 
     /* Return the handle. (Array index plus 1. a handle of 0 is invalid. )*/
-    return (next_free_index+1);
+    *p_csv_file_handle = next_free_index+1;
+    return 0;
 }
 
 /**
  * @brief Closes a csv file from reading and writing.
  * 
  * @param csv_file_handle Handle of the csv file to operate on.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail. The file is closed even when syncing an open group commit window fails.
  */
 int close_csv_file(int csv_file_handle) {
 
     /* Realign the csv handle to the actual index into the csv files array. */
     int csv_file_index = convert_handle_to_index(csv_file_handle);    
+    int sync_error = 0;
 
-    /* Check that we have a valid handle and that we have files that are open. */
-    if ( (csv_file_index < 0) || (s_number_of_open_files-1 < 0)) {
+    /* Check that we have a valid handle to a file that is open. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
         errno = ENOENT;
         return errno;
     }
@@ -161,6 +412,14 @@ int close_csv_file(int csv_file_handle) {
     /* Mark the index as free. */
     s_free_indexes[csv_file_index] = 0;
 
+    /* Release every cached row. */
+    row_cache_clear(&s_csv_files[csv_file_index].row_cache);
+
+    /* Don't let a group commit window end unsynced. A failed sync is reported once the file is closed. */
+    if(s_csv_files[csv_file_index].pending_bytes != 0) {
+        sync_error = sync_file(csv_file_handle);
+    }
+
     /* Close the csv file and check it closed successfully. */
     if(fclose(s_csv_files[csv_file_index].p_file)){
         return errno;
@@ -170,9 +429,9 @@ int close_csv_file(int csv_file_handle) {
     s_csv_files[csv_file_index].p_file = NULL;
     s_csv_files[csv_file_index].number_of_columns = 0;
     s_csv_files[csv_file_index].number_of_rows = 0;
-    sprintf(s_csv_files[csv_file_index].absolute_path, "");
+    s_csv_files[csv_file_index].absolute_path[0] = '\0';
 
-    return 0;
+    return sync_error;
 }
 
 /**
@@ -181,18 +440,38 @@ int close_csv_file(int csv_file_handle) {
  * @param csv_file_handle Handle of the csv file to operate on.
  * @param data_to_insert Pointer to the string of data to insert.
  * @param cell Cell struct that specifies the location to update.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail, EINVAL if the column is not below the column count.
  */
 int update_cell(int csv_file_handle, const char *data_to_insert, cell_t cell) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int rv = update_cell_(csv_file_handle, data_to_insert, cell);
+
+    stats_record_latency(csv_file_handle, CSV_OP_UPDATE_CELL, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of update_cell(), called without recording its latency.
+ * 
+ */
+static int update_cell_(int csv_file_handle, const char *data_to_insert, cell_t cell) {
+
     long splice_offset = 0;
     FILE *p_temp_file = NULL;
     char read_char = 0;
     char temp_file_name[FILE_PATH_LENGTH] = {0};
+
+    /* A column past the end of the row would be written into the next row, behind the row cache's back. */
+    if(cell.column >= s_csv_files[convert_handle_to_index(csv_file_handle)].number_of_columns) {
+        errno = EINVAL;
+        return errno;
+    }
 	
 	/* If row doesn't exist, append empty rows until the row count is correct */
 	for ( size_t row = get_row_count(csv_file_handle); row < cell.row; row++) {
-		append_row(csv_file_handle, 0, NULL);
+		append_row_(csv_file_handle, 0, NULL);
 	}
 	
     /* Move cursor in file to where the insertion should be. */    
@@ -208,50 +487,39 @@ int update_cell(int csv_file_handle, const char *data_to_insert, cell_t cell) {
     if((p_temp_file = fopen(temp_file_name, "w+")) == NULL) {
         return errno;
     }
+    STATS_ADD(csv_file_handle, temp_files, 1);
 
     /* Reset cursor position to start of file. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 
     /* Copy the old data into the new file until the splice mark is hit or EOF is reached. */
-    while ((ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset) && ((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF)) {
-        fprintf(p_temp_file, "%c", read_char);
+    while ((ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset) && ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF)) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
 
 
     /* Insert new cell data. */
-    fprintf(p_temp_file, "%s,", data_to_insert);
+    tracked_fprintf(csv_file_handle, p_temp_file, "%s,", data_to_insert);
 
 
     /* Fast forward in the file until we reach the end of the cell */
-    while (((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != ',') && read_char != EOF) {
+    while (((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != ',') && read_char != EOF) {
         continue;
     }
 
     /* Write out the rest of the data into the new file. */
-    while ((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
-        fprintf(p_temp_file, "%c", read_char);
+    while ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
     
-    /* Close the files and assign the pointers null */
-    fclose(p_temp_file);
-    p_temp_file = NULL;
-    fclose(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
-    s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = NULL;
-
-    /* Remove old file. */
-	if(remove(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
+    /* Swap the temp file in for the old file to "save" the changes. */
+    if(replace_with_temp_file(csv_file_handle, p_temp_file, temp_file_name)) {
         return errno;
     }
-    
-    /* Rename temp file to the old file to "save" the changes. */
-    if(rename(temp_file_name, s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
-        return errno;   
-    }
+    p_temp_file = NULL;
 
-    /* Reopen the file so that the user can still interact with it. */
-    if((s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = fopen(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path, "a+")) == NULL) {
-        return errno;
-    }
+    /* Only the updated row changed. */
+    row_cache_invalidate_row(&s_csv_files[convert_handle_to_index(csv_file_handle)].row_cache, cell.row);
     
     return 0;
 }
@@ -261,10 +529,16 @@ int update_cell(int csv_file_handle, const char *data_to_insert, cell_t cell) {
  * 
  * @param csv_file_handle Handle of the csv file to operate on.
  * @param cell Cell struct that specifies the location to clear.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail, EINVAL if the column is not below the column count.
  */
-inline int clear_cell(int csv_file_handle, cell_t cell) {
-    return update_cell(csv_file_handle, "", cell);
+int clear_cell(int csv_file_handle, cell_t cell) {
+
+    uint64_t start_ns = stats_clock_ns();
+    int rv = update_cell_(csv_file_handle, "", cell);
+
+    stats_record_latency(csv_file_handle, CSV_OP_CLEAR_CELL, start_ns);
+
+    return rv;
 }
 
 /**
@@ -278,15 +552,29 @@ inline int clear_cell(int csv_file_handle, cell_t cell) {
  */
 int update_row(int csv_file_handle, int row, int width_of_string, const char *data_array_to_insert) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int rv = update_row_(csv_file_handle, row, width_of_string, data_array_to_insert);
+
+    stats_record_latency(csv_file_handle, CSV_OP_UPDATE_ROW, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of update_row(), called without recording its latency.
+ * 
+ */
+static int update_row_(int csv_file_handle, int row, int width_of_string, const char *data_array_to_insert) {
+
     int rv = 0;
 
-    rv = delete_row(csv_file_handle, row);
+    rv = delete_row_(csv_file_handle, row);
 
     if(rv){
         return rv;
     }
     
-    rv = insert_row(csv_file_handle, row+1, width_of_string, data_array_to_insert);
+    rv = insert_row_(csv_file_handle, row, width_of_string, data_array_to_insert);
     
     return rv;
 }
@@ -301,6 +589,20 @@ int update_row(int csv_file_handle, int row, int width_of_string, const char *da
  */
 int insert_row(int csv_file_handle, int row_to_insert_before, int memory_spacing, const char *data_array_to_insert) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int rv = insert_row_(csv_file_handle, row_to_insert_before, memory_spacing, data_array_to_insert);
+
+    stats_record_latency(csv_file_handle, CSV_OP_INSERT_ROW, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of insert_row(), called without recording its latency.
+ * 
+ */
+static int insert_row_(int csv_file_handle, int row_to_insert_before, int memory_spacing, const char *data_array_to_insert) {
+
     long splice_offset = 0;
     FILE *p_temp_file = NULL;
     char read_char = 0;
@@ -311,9 +613,9 @@ int insert_row(int csv_file_handle, int row_to_insert_before, int memory_spacing
         row_to_insert_before = 0;
     }
 
-    /* If -1 just append the data. */
-    if(row_to_insert_before == -1) {
-        append_row(csv_file_handle,memory_spacing, data_array_to_insert);
+    /* If -1, or past the last row, just append the data. */
+    if((row_to_insert_before == -1) || (row_to_insert_before >= get_row_count(csv_file_handle))) {
+        return append_row_(csv_file_handle, memory_spacing, data_array_to_insert);
     }
 
     /* Move cursor in file to where the insertion should be. */    
@@ -324,57 +626,44 @@ int insert_row(int csv_file_handle, int row_to_insert_before, int memory_spacing
 	
     /* Create a temp file to copy old data and insert new data into. */
     sprintf(temp_file_name, "%stemp", s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path);
-    p_temp_file = fopen(temp_file_name, "w+");
+    if((p_temp_file = fopen(temp_file_name, "w+")) == NULL) {
+        return errno;
+    }
+    STATS_ADD(csv_file_handle, temp_files, 1);
 
     /* Reset cursor position to start of file. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 
-    /* Copy the old data into the new file until the splice mark is hit or EOF is reached. */
-    while (((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) && (ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset)) {
-        fprintf(p_temp_file, "%c", read_char);
+    /* Copy the old data, up to and including the new line before the splice mark, into the new file. */
+    while ((ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset) && ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF)) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
-
-	/* Move to a new line. */
-    fprintf(p_temp_file, "\n");
 	
     /* Insert new row data. */
     for (size_t idx = 0; idx < s_csv_files[convert_handle_to_index(csv_file_handle)].number_of_columns; idx++) {
-        fprintf(p_temp_file, "%s,", data_array_to_insert+(idx*memory_spacing));
+        tracked_fprintf(csv_file_handle, p_temp_file, "%s,", data_array_to_insert+(idx*memory_spacing));
     }
     
     /* End with new line. */
-    fprintf(p_temp_file, "\n");
+    tracked_fprintf(csv_file_handle, p_temp_file, "\n");
 
     /* Write out the rest of the data into the new file. */
-    while ((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
-        fprintf(p_temp_file, "%c", read_char);
-    }
-    
-    /* Close the files and assign the pointers null */
-    fclose(p_temp_file);
-    p_temp_file = NULL;
-    fclose(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
-    s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = NULL;
-
-    /* Remove old file. */
-	if(remove(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
-        return errno;
+    while ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
     
-    /* Rename temp file to the old file to "save" the changes. */
-    if(rename(temp_file_name, s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
-        return errno;   
-    }
-
-    /* Reopen the file so that the user can still interact with it. */
-    if((s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = fopen(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path, "a+")) == NULL) {
-
+    /* Swap the temp file in for the old file to "save" the changes. */
+    if(replace_with_temp_file(csv_file_handle, p_temp_file, temp_file_name)) {
         return errno;
     }
+    p_temp_file = NULL;
 
 	/* Increment internal row counter. */
     set_row_count(csv_file_handle, get_row_count(csv_file_handle)+1);
 
+    /* Every cached row from the insertion point on moved down by one. */
+    row_cache_shift_rows(&s_csv_files[convert_handle_to_index(csv_file_handle)].row_cache, row_to_insert_before, 1);
+
     return 0;
 }
 
@@ -387,42 +676,60 @@ int insert_row(int csv_file_handle, int row_to_insert_before, int memory_spacing
  * @return 0 on success, errno on fail.
  */
 int append_row(int csv_file_handle, int memory_spacing, const char *data_array_to_insert) {
+
+    uint64_t start_ns = stats_clock_ns();
+    int rv = append_row_(csv_file_handle, memory_spacing, data_array_to_insert);
+
+    stats_record_latency(csv_file_handle, CSV_OP_APPEND_ROW, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of append_row(), called without recording its latency.
+ * 
+ */
+static int append_row_(int csv_file_handle, int memory_spacing, const char *data_array_to_insert) {
     
+    long row_offset = 0;
+
 	if(get_row_count(csv_file_handle) != 0) {
 		/* Move to the last char in the file */
-	    if(fseek(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, -1, SEEK_END)) {
+	    if(tracked_fseek(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, -1, SEEK_END)) {
 	        return errno;
 	    }
 		
 		/* If last char in the file is not a new line add one. */
-		if(fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != '\n') {
+		if(tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != '\n') {
 			/* Move back to the end of file */
-			fseek(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, 0, SEEK_END);
-			fprintf(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "\n");	
+			tracked_fseek(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, 0, SEEK_END);
+			tracked_fprintf(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "\n");	
 		}
 	}
 
 	/* Move to ensure the cursor is at the end of file */
-	fseek(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, 0, SEEK_END);
+	tracked_fseek(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, 0, SEEK_END);
+	row_offset = ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
 	
     /* Insert new row data. */
     for (size_t idx = 0; idx < s_csv_files[convert_handle_to_index(csv_file_handle)].number_of_columns; idx++) {
 		if(data_array_to_insert) {
-        	fprintf(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "%s,", data_array_to_insert+(idx*memory_spacing));
+        	tracked_fprintf(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "%s,", data_array_to_insert+(idx*memory_spacing));
 		}
 		else {
-        	fprintf(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, ",");
+        	tracked_fprintf(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, ",");
 		}
     }
     
     /* End with new line. */
-    fprintf(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "\n");
+    tracked_fprintf(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, "\n");
    
 	/* Increment internal row counter. */
 	set_row_count(csv_file_handle, get_row_count(csv_file_handle)+1);
 	
-    return (0);
+    /* Make the row durable as the handle's durability level asks. */
+    return sync_appended_bytes(csv_file_handle, (size_t)(ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) - row_offset));
 }
 
 /**
@@ -434,10 +741,31 @@ int append_row(int csv_file_handle, int memory_spacing, const char *data_array_t
  */
 int delete_row(int csv_file_handle, int row_to_delete) {
 
+    uint64_t start_ns = stats_clock_ns();
+    int rv = delete_row_(csv_file_handle, row_to_delete);
+
+    stats_record_latency(csv_file_handle, CSV_OP_DELETE_ROW, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of delete_row(), called without recording its latency.
+ * 
+ */
+static int delete_row_(int csv_file_handle, int row_to_delete) {
+
     long splice_offset = 0;
     FILE *p_temp_file = NULL;
     char read_char = 0;
     char temp_file_name[FILE_PATH_LENGTH] = {0};
+    int skip_char = 0;
+
+    /* Check to ensure the row is valid. */
+    if((row_to_delete < 0) || (row_to_delete >= get_row_count(csv_file_handle))) {
+        errno = EINVAL;
+        return errno;
+    }
 
     /* Move cursor in file to where the insertion should be. */    
     go_to_row(csv_file_handle, row_to_delete);
@@ -447,52 +775,41 @@ int delete_row(int csv_file_handle, int row_to_delete) {
 	
     /* Create a temp file to copy old data and insert new data into. */
     sprintf(temp_file_name, "%stemp", s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path);
-    p_temp_file = fopen(temp_file_name, "w+");
+    if((p_temp_file = fopen(temp_file_name, "w+")) == NULL) {
+        return errno;
+    }
+    STATS_ADD(csv_file_handle, temp_files, 1);
 
     /* Reset cursor position to start of file. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 
-    /* Copy the old data into the new file until the splice mark is hit or EOF is reached. */
-    while (((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) && (ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset)) {
-        fprintf(p_temp_file, "%c", read_char);
+    /* Copy the old data, up to and including the new line before the splice mark, into the new file. */
+    while ((ftell(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != splice_offset) && ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF)) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
 
-    /* Fast forward in the file until we reach the end of the row to delete */
-    while (fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file) != '\n') {
+    /* Fast forward in the file past the new line that ends the row to delete. */
+    while (((skip_char = tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != '\n') && (skip_char != EOF)) {
         continue;
     }
-	
-	/* Back up to before the new line */
-	fseek(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file, -1, SEEK_CUR);
 		  
     /* Write out the rest of the data into the new file. */
-    while ((read_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
-        fprintf(p_temp_file, "%c", read_char);
-    }
-    
-    /* Close the files and assign the pointers null */
-    fclose(p_temp_file);
-    p_temp_file = NULL;
-    fclose(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
-    s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = NULL;
-
-    /* Remove old file. */
-	if(remove(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
-        return errno;
+    while ((read_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
+        tracked_fprintf(csv_file_handle, p_temp_file, "%c", read_char);
     }
     
-    /* Rename temp file to the old file to "save" the changes. */
-    if(rename(temp_file_name, s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path)) {
-        return errno;   
-    }
-
-    /* Reopen the file so that the user can still interact with it. */
-    if((s_csv_files[convert_handle_to_index(csv_file_handle)].p_file = fopen(s_csv_files[convert_handle_to_index(csv_file_handle)].absolute_path, "a+")) == NULL) {
+    /* Swap the temp file in for the old file to "save" the changes. */
+    if(replace_with_temp_file(csv_file_handle, p_temp_file, temp_file_name)) {
         return errno;
     }
+    p_temp_file = NULL;
     
 	/* Decrement the internal row counter. */
     set_row_count(csv_file_handle, get_row_count(csv_file_handle)-1);
+
+    /* Drop the deleted row and move every cached row after it up by one. */
+    row_cache_invalidate_row(&s_csv_files[convert_handle_to_index(csv_file_handle)].row_cache, row_to_delete);
+    row_cache_shift_rows(&s_csv_files[convert_handle_to_index(csv_file_handle)].row_cache, row_to_delete, -1);
 	
 	return 0;
 }
@@ -569,17 +886,17 @@ static int calculate_row_count(int csv_file_handle) {
 	char current_char = 0;
 	
 	/* Rewind to begining of file to make sure we count the rows correctly. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
 	/* Loop until we have seen the correct amount of new lines. */
-    while ((current_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
+    while ((current_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != EOF) {
         if(current_char == '\n') {
 			row_count++;
 		}
     }
 	
 	/* Rewind to begining of file to leave no trace. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
     return row_count;
 }
@@ -596,17 +913,17 @@ static int calculate_column_count(int csv_file_handle) {
 	char current_char = 0;
 	
 	/* Rewind to begining of file to make sure we count the rows correctly. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
 	/* Loop until we have seen the correct amount of new lines. */
-    while (((current_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != '\n') && (current_char != EOF)) {
+    while (((current_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != '\n') && (current_char != EOF)) {
         if(current_char == ',') {
 			column_count++;
 		}
 	}
    
 	/* Rewind to begining of file to leave no trace. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
     return column_count;
 }
@@ -622,7 +939,7 @@ static void go_to_row(int csv_file_handle, int row) {
 	char current_char = 0;
 	
 	/* Rewind to begining of file to make sure we count the rows correctly. */
-    rewind(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
+    tracked_rewind(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file);
 	
 	/* If row zero return after rewind */
 	if (row == 0) {
@@ -630,8 +947,8 @@ static void go_to_row(int csv_file_handle, int row) {
 	}
 	
 	/* Loop until we have seen the correct amount of new lines. */
-    for(size_t file_row = 0; file_row < row; file_row++) {
-        while (((current_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != '\n') && (current_char != EOF)) {
+    for(int file_row = 0; file_row < row; file_row++) {
+        while (((current_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != '\n') && (current_char != EOF)) {
             continue;
         }
     }
@@ -654,8 +971,8 @@ static void go_to_column(int csv_file_handle, int column) {
 	
 	/* This function assumes that we are at the row we want to go into. */
 	/* Loop until we have seen the correct amount of commas. */
-    for(size_t file_column = 0; file_column < column; file_column++) {
-        while (((current_char = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != ',') && (current_char != EOF)) {
+    for(int file_column = 0; file_column < column; file_column++) {
+        while (((current_char = (char)tracked_fgetc(csv_file_handle, s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != ',') && (current_char != EOF)) {
             continue;
         }
     }
@@ -670,17 +987,1863 @@ static void go_to_column(int csv_file_handle, int column) {
  * @return 0 on success.
  */
 int get_cell_contents(int csv_file_handle, char *content_string, cell_t cell) {
+
+    uint64_t start_ns = stats_clock_ns();
+    int rv = get_cell_contents_(csv_file_handle, content_string, cell);
+
+    stats_record_latency(csv_file_handle, CSV_OP_GET_CELL_CONTENTS, start_ns);
+
+    return rv;
+}
+
+/**
+ * @brief Body of get_cell_contents(), called without recording its latency.
+ * 
+ */
+static int get_cell_contents_(int csv_file_handle, char *content_string, cell_t cell) {
     
-    char read_char[2] = {0};
+    csv_row_cache_t *p_cache = &s_csv_files[convert_handle_to_index(csv_file_handle)].row_cache;
+    csv_cached_row_t *p_row = NULL;
+    int is_cached = 1;
+    int rv = 0;
 
-    /* Move cursor in file to the location to copy. */    
-    go_to_row(csv_file_handle, cell.row);
-    go_to_column(csv_file_handle, cell.column);
+    /* Serve the row from memory if it is cached, otherwise read it from the file and try to keep it. */
+    if((p_row = row_cache_find(p_cache, cell.row)) == NULL) {
+        if((rv = load_row(csv_file_handle, cell.row, &p_row)) != 0) {
+            return rv;
+        }
+        is_cached = (row_cache_insert(p_cache, p_row) == 0);
+    }
 
-    /* Fast forward in the file until we reach the end of the cell */
-    while (((read_char[0] = (char)fgetc(s_csv_files[convert_handle_to_index(csv_file_handle)].p_file)) != ',') && read_char != EOF) {
-        strcat(content_string, read_char);
+    /* Append the contents of the cell to the string. Cells past the end of the row are empty. */
+    if(cell.column < p_row->number_of_fields) {
+        strcat(content_string, p_row->p_text + p_row->p_fields[cell.column].offset);
+    }
+
+    /* A row that did not go into the cache was only needed for this call. */
+    if(!is_cached) {
+        free(p_row);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Set the memory budget of the row cache of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param cache_bytes Memory budget in bytes. 0 disables the cache and frees all cached rows.
+ * @return 0 on success, errno on fail.
+ */
+int csv_set_cache_bytes(int csv_file_handle, size_t cache_bytes) {
+
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    s_csv_files[csv_file_index].row_cache.capacity_bytes = cache_bytes;
+
+    /* A disabled cache gives back all of its memory, otherwise drop the least recently used rows until it fits. */
+    if(cache_bytes == 0) {
+        row_cache_clear(&s_csv_files[csv_file_index].row_cache);
+    }
+    else {
+        row_cache_evict(&s_csv_files[csv_file_index].row_cache, cache_bytes);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Get the row cache counters of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_stats Pointer to the struct to fill in.
+ * @return 0 on success, errno on fail.
+ */
+int csv_get_cache_stats(int csv_file_handle, csv_cache_stats_t *p_stats) {
+
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+    csv_row_cache_t *p_cache = NULL;
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    if(p_stats == NULL) {
+        errno = EINVAL;
+        return errno;
+    }
+
+    p_cache = &s_csv_files[csv_file_index].row_cache;
+    p_stats->hits = p_cache->hits;
+    p_stats->misses = p_cache->misses;
+    p_stats->evictions = p_cache->evictions;
+    p_stats->invalidations = p_cache->invalidations;
+    p_stats->cached_rows = p_cache->number_of_rows;
+    p_stats->used_bytes = p_cache->used_bytes;
+    p_stats->capacity_bytes = p_cache->capacity_bytes;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to read a row from the file and split it into fields.
+ * 
+ * The row, its field spans and its text are allocated as a single block so it can be released with one free().
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param row The row to read (0 based index).
+ * @param pp_row Pointer to where the newly allocated row is returned.
+ * @return 0 on success, errno on fail.
+ */
+static int load_row(int csv_file_handle, size_t row, csv_cached_row_t **pp_row) {
+
+    FILE *p_file = s_csv_files[convert_handle_to_index(csv_file_handle)].p_file;
+    csv_cached_row_t *p_row = NULL;
+    char *p_line = NULL;
+    char *p_grown_line = NULL;
+    size_t line_capacity = ROW_READ_BUFFER_LENGTH;
+    size_t line_length = 0;
+    size_t number_of_fields = 1;
+    size_t field = 0;
+    int current_char = 0;
+
+    if((p_line = (char *)malloc(line_capacity)) == NULL) {
+        return ENOMEM;
+    }
+
+    /* Move cursor in file to the start of the row. */
+    go_to_row(csv_file_handle, (int)row);
+
+    /* Read the row up to its new line, counting the fields on the way. */
+    while (((current_char = tracked_fgetc(csv_file_handle, p_file)) != '\n') && (current_char != EOF)) {
+        if(line_length == line_capacity) {
+            if((p_grown_line = (char *)realloc(p_line, line_capacity*2)) == NULL) {
+                free(p_line);
+                return ENOMEM;
+            }
+            p_line = p_grown_line;
+            line_capacity *= 2;
+        }
+        if(current_char == ',') {
+            number_of_fields++;
+        }
+        p_line[line_length++] = (char)current_char;
     }
 
+    /* Allocate the row with room for its field spans and text behind it. */
+    p_row = (csv_cached_row_t *)malloc(sizeof(csv_cached_row_t) + (number_of_fields*sizeof(csv_field_span_t)) + line_length + 1);
+    if(p_row == NULL) {
+        free(p_line);
+        return ENOMEM;
+    }
+
+    memset(p_row, 0, sizeof(csv_cached_row_t));
+    p_row->row = row;
+    p_row->footprint = sizeof(csv_cached_row_t) + (number_of_fields*sizeof(csv_field_span_t)) + line_length + 1;
+    p_row->number_of_fields = number_of_fields;
+    p_row->is_complete = (current_char == '\n');
+    p_row->p_fields = (csv_field_span_t *)(p_row + 1);
+    p_row->p_text = (char *)(p_row->p_fields + number_of_fields);
+    memcpy(p_row->p_text, p_line, line_length);
+    p_row->p_text[line_length] = '\0';
+    free(p_line);
+
+    /* Terminate every field in place and record where it starts and how long it is. */
+    p_row->p_fields[0].offset = 0;
+    for (size_t idx = 0; idx < line_length; idx++) {
+        if(p_row->p_text[idx] == ',') {
+            p_row->p_text[idx] = '\0';
+            p_row->p_fields[field].length = idx - p_row->p_fields[field].offset;
+            field++;
+            p_row->p_fields[field].offset = idx + 1;
+        }
+    }
+    p_row->p_fields[field].length = line_length - p_row->p_fields[field].offset;
+
+    *pp_row = p_row;
+
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Helper function to look up a row in the row cache and mark it as most recently used.
+ * 
+ * @param p_cache Row cache to search.
+ * @param row The row to look up (0 based index).
+ * @return Pointer to the cached row, NULL if it is not cached.
+ */
+static csv_cached_row_t *row_cache_find(csv_row_cache_t *p_cache, size_t row) {
+
+    csv_cached_row_t *p_row = NULL;
+
+    /* Walk the bucket the row hashes to. */
+    if(p_cache->number_of_buckets != 0) {
+        p_row = p_cache->pp_buckets[row & (p_cache->number_of_buckets-1)];
+        while((p_row != NULL) && (p_row->row != row)) {
+            p_row = p_row->p_hash_next;
+        }
+    }
+
+    if(p_row == NULL) {
+        p_cache->misses++;
+        return NULL;
+    }
+
+    p_cache->hits++;
+
+    /* Move the row to the front of the LRU list. */
+    if(p_row != p_cache->p_lru_head) {
+        p_row->p_lru_prev->p_lru_next = p_row->p_lru_next;
+        if(p_row->p_lru_next != NULL) {
+            p_row->p_lru_next->p_lru_prev = p_row->p_lru_prev;
+        }
+        else {
+            p_cache->p_lru_tail = p_row->p_lru_prev;
+        }
+        p_row->p_lru_prev = NULL;
+        p_row->p_lru_next = p_cache->p_lru_head;
+        p_cache->p_lru_head->p_lru_prev = p_row;
+        p_cache->p_lru_head = p_row;
+    }
+
+    return p_row;
+}
+
+/**
+ * @brief Helper function to add a row to the row cache, evicting the least recently used rows to make room.
+ * 
+ * @param p_cache Row cache to add to.
+ * @param p_row Row to add. Owned by the cache on success.
+ * @return 0 if the row was cached, -1 if the caller still owns it.
+ */
+static int row_cache_insert(csv_row_cache_t *p_cache, csv_cached_row_t *p_row) {
+
+    size_t bucket = 0;
+
+    /* A row that ran into EOF can still grow, and a row bigger than the whole budget can never fit. */
+    if((!p_row->is_complete) || (p_row->footprint > p_cache->capacity_bytes)) {
+        return -1;
+    }
+
+    /* Keep the hash chains short by growing the table with the number of rows. */
+    if(p_cache->number_of_rows >= p_cache->number_of_buckets) {
+        if(row_cache_rehash(p_cache, (p_cache->number_of_buckets == 0) ? ROW_CACHE_INITIAL_BUCKETS : (p_cache->number_of_buckets*2))) {
+            return -1;
+        }
+    }
+
+    /* Make room for the new row. */
+    row_cache_evict(p_cache, p_cache->capacity_bytes - p_row->footprint);
+
+    /* Link the row into its bucket and at the front of the LRU list. */
+    bucket = p_row->row & (p_cache->number_of_buckets-1);
+    p_row->p_hash_next = p_cache->pp_buckets[bucket];
+    p_cache->pp_buckets[bucket] = p_row;
+
+    p_row->p_lru_prev = NULL;
+    p_row->p_lru_next = p_cache->p_lru_head;
+    if(p_cache->p_lru_head != NULL) {
+        p_cache->p_lru_head->p_lru_prev = p_row;
+    }
+    else {
+        p_cache->p_lru_tail = p_row;
+    }
+    p_cache->p_lru_head = p_row;
+
+    p_cache->number_of_rows++;
+    p_cache->used_bytes += p_row->footprint;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to take a row out of the row cache without freeing it.
+ * 
+ * @param p_cache Row cache that holds the row.
+ * @param p_row Row to take out.
+ */
+static void row_cache_unlink(csv_row_cache_t *p_cache, csv_cached_row_t *p_row) {
+
+    csv_cached_row_t **pp_link = &p_cache->pp_buckets[p_row->row & (p_cache->number_of_buckets-1)];
+
+    /* Unlink from the hash bucket. */
+    while(*pp_link != p_row) {
+        pp_link = &(*pp_link)->p_hash_next;
+    }
+    *pp_link = p_row->p_hash_next;
+
+    /* Unlink from the LRU list. */
+    if(p_row->p_lru_prev != NULL) {
+        p_row->p_lru_prev->p_lru_next = p_row->p_lru_next;
+    }
+    else {
+        p_cache->p_lru_head = p_row->p_lru_next;
+    }
+    if(p_row->p_lru_next != NULL) {
+        p_row->p_lru_next->p_lru_prev = p_row->p_lru_prev;
+    }
+    else {
+        p_cache->p_lru_tail = p_row->p_lru_prev;
+    }
+
+    p_cache->number_of_rows--;
+    p_cache->used_bytes -= p_row->footprint;
+}
+
+/**
+ * @brief Helper function to free the least recently used rows until the cache fits a budget.
+ * 
+ * @param p_cache Row cache to shrink.
+ * @param budget_bytes Number of bytes the cache may use afterwards.
+ */
+static void row_cache_evict(csv_row_cache_t *p_cache, size_t budget_bytes) {
+
+    csv_cached_row_t *p_row = NULL;
+
+    while((p_cache->used_bytes > budget_bytes) && ((p_row = p_cache->p_lru_tail) != NULL)) {
+        row_cache_unlink(p_cache, p_row);
+        free(p_row);
+        p_cache->evictions++;
+    }
+}
+
+/**
+ * @brief Helper function to rebuild the hash table of the row cache, e.g. after it grew or the row numbers changed.
+ * 
+ * @param p_cache Row cache to rebuild.
+ * @param number_of_buckets New number of buckets (power of 2).
+ * @return 0 on success, errno on fail.
+ */
+static int row_cache_rehash(csv_row_cache_t *p_cache, size_t number_of_buckets) {
+
+    csv_cached_row_t **pp_buckets = NULL;
+    size_t bucket = 0;
+
+    if((pp_buckets = (csv_cached_row_t **)calloc(number_of_buckets, sizeof(csv_cached_row_t *))) == NULL) {
+        return ENOMEM;
+    }
+
+    /* Every cached row is on the LRU list, so rebuild the buckets from it. */
+    for (csv_cached_row_t *p_row = p_cache->p_lru_head; p_row != NULL; p_row = p_row->p_lru_next) {
+        bucket = p_row->row & (number_of_buckets-1);
+        p_row->p_hash_next = pp_buckets[bucket];
+        pp_buckets[bucket] = p_row;
+    }
+
+    free(p_cache->pp_buckets);
+    p_cache->pp_buckets = pp_buckets;
+    p_cache->number_of_buckets = number_of_buckets;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to drop a row whose contents changed in the file.
+ * 
+ * @param p_cache Row cache to update.
+ * @param row The row that changed (0 based index).
+ */
+static void row_cache_invalidate_row(csv_row_cache_t *p_cache, size_t row) {
+
+    csv_cached_row_t *p_row = NULL;
+
+    if(p_cache->number_of_buckets == 0) {
+        return;
+    }
+
+    p_row = p_cache->pp_buckets[row & (p_cache->number_of_buckets-1)];
+    while((p_row != NULL) && (p_row->row != row)) {
+        p_row = p_row->p_hash_next;
+    }
+
+    if(p_row != NULL) {
+        row_cache_unlink(p_cache, p_row);
+        free(p_row);
+        p_cache->invalidations++;
+    }
+}
+
+/**
+ * @brief Helper function to renumber the cached rows after rows were inserted into or deleted from the file.
+ * 
+ * The contents of the moved rows did not change, so they stay cached under their new row numbers.
+ * 
+ * @param p_cache Row cache to update.
+ * @param first_row First row that moved (0 based index).
+ * @param delta Number of rows the rows moved by. Positive for inserts, negative for deletes.
+ */
+static void row_cache_shift_rows(csv_row_cache_t *p_cache, size_t first_row, int delta) {
+
+    int has_moved = 0;
+
+    for (csv_cached_row_t *p_row = p_cache->p_lru_head; p_row != NULL; p_row = p_row->p_lru_next) {
+        if(p_row->row >= first_row) {
+            p_row->row += delta;
+            has_moved = 1;
+        }
+    }
+
+    /* The row numbers are the hash keys so the buckets have to be rebuilt. If that fails, forget everything. */
+    if(has_moved && row_cache_rehash(p_cache, p_cache->number_of_buckets)) {
+        p_cache->invalidations += p_cache->number_of_rows;
+        row_cache_evict(p_cache, 0);
+    }
+}
+
+/**
+ * @brief Helper function to free every row and the hash table of the row cache.
+ * 
+ * @param p_cache Row cache to clear.
+ */
+static void row_cache_clear(csv_row_cache_t *p_cache) {
+
+    csv_cached_row_t *p_next_row = NULL;
+
+    for (csv_cached_row_t *p_row = p_cache->p_lru_head; p_row != NULL; p_row = p_next_row) {
+        p_next_row = p_row->p_lru_next;
+        free(p_row);
+    }
+
+    free(p_cache->pp_buckets);
+    p_cache->pp_buckets = NULL;
+    p_cache->number_of_buckets = 0;
+    p_cache->p_lru_head = NULL;
+    p_cache->p_lru_tail = NULL;
+    p_cache->number_of_rows = 0;
+    p_cache->used_bytes = 0;
+}
+
+/**
+ * @brief Set the durability level of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param durability The new durability level.
+ * @param group_sync_age_us In group commit mode an append also syncs once the oldest unsynced append is this many
+ *        microseconds old. Only checked when appending, so it does not bound how long an idle file stays unsynced. 0 for no age check.
+ * @param group_window_bytes Max number of unsynced appended bytes in group commit mode. 0 for no byte limit.
+ * @return 0 on success, errno on fail.
+ */
+int csv_set_durability(int csv_file_handle, csv_durability_t durability, uint32_t group_sync_age_us, size_t group_window_bytes) {
+
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    if((durability != CSV_DURABILITY_NONE) && (durability != CSV_DURABILITY_PER_OP) && (durability != CSV_DURABILITY_GROUP_COMMIT)) {
+        errno = EINVAL;
+        return errno;
+    }
+
+    /* Whatever the old level left unsynced gets synced before the new level applies. */
+    if((s_csv_files[csv_file_index].pending_bytes != 0) && sync_file(csv_file_handle)) {
+        return errno;
+    }
+
+    s_csv_files[csv_file_index].durability = durability;
+    s_csv_files[csv_file_index].group_sync_age_ns = (uint64_t)group_sync_age_us * 1000u;
+    s_csv_files[csv_file_index].group_window_bytes = group_window_bytes;
+
+    return 0;
+}
+
+/**
+ * @brief Flush and sync everything written to a csv file so far, whatever the durability level.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @return 0 on success, errno on fail.
+ */
+int csv_sync(int csv_file_handle) {
+
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    return sync_file(csv_file_handle);
+}
+
+/**
+ * @brief Split a csv file into one file per distinct value of a key column.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param column Column holding the partition key (0 based index).
+ * @param out_dir Existing directory to write the partition files to. Must not be the directory of the source.
+ * @param max_open_files Max number of partition files open at once.
+ * @return 0 on success, errno on fail.
+ */
+int csv_partition(int csv_file_handle, size_t column, const char *out_dir, size_t max_open_files) {
+
+    csv_partition_options_t options = {0};
+
+    options.column = column;
+    options.p_out_dir = out_dir;
+    options.max_open_files = max_open_files;
+    options.number_of_hash_partitions = 0;
+    options.number_of_threads = 1;
+
+    return csv_partition_with_options(csv_file_handle, &options);
+}
+
+/**
+ * @brief Split a csv file into partition files by the value or hash of a key column.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_options Partitioning options.
+ * @return 0 on success, EINVAL if p_out_dir is the directory of the source, errno on fail.
+ */
+int csv_partition_with_options(int csv_file_handle, const csv_partition_options_t *p_options) {
+
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+    csv_partition_writer_t *p_writers = NULL;
+    CSV_THREAD_TYPE *p_threads = NULL;
+    FILE *p_source = NULL;
+    long file_bytes = 0;
+    long boundary = 0;
+    int read_char = 0;
+    unsigned int number_of_writers = 1;
+    unsigned int number_of_started_threads = 0;
+    int rv = 0;
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    if((p_options == NULL) || (p_options->p_out_dir == NULL) || (p_options->max_open_files == 0)) {
+        errno = EINVAL;
+        return errno;
+    }
+
+    if((rv = partition_check_out_dir(p_options->p_out_dir, s_csv_files[csv_file_index].absolute_path)) != 0) {
+        errno = rv;
+        return errno;
+    }
+
+    /* The source is read through its own streams, so anything still buffered on the handle has to land first. */
+    if(fflush(s_csv_files[csv_file_index].p_file)) {
+        return errno;
+    }
+
+    if((p_source = fopen(s_csv_files[csv_file_index].absolute_path, "rb")) == NULL) {
+        return errno;
+    }
+    if(fseek(p_source, 0, SEEK_END) || ((file_bytes = ftell(p_source)) < 0)) {
+        rv = errno;
+        fclose(p_source);
+        return rv;
+    }
+
+    /* One thread per chunk, but never chunks too small to pay for a thread or more threads than open files. */
+    if(p_options->number_of_threads > 1) {
+        number_of_writers = p_options->number_of_threads;
+        if((size_t)number_of_writers > p_options->max_open_files) {
+            number_of_writers = (unsigned int)p_options->max_open_files;
+        }
+        if((file_bytes / PARTITION_MIN_CHUNK_BYTES) + 1 < (long)number_of_writers) {
+            number_of_writers = (unsigned int)((file_bytes / PARTITION_MIN_CHUNK_BYTES) + 1);
+        }
+    }
+
+    if(((p_writers = (csv_partition_writer_t *)calloc(number_of_writers, sizeof(csv_partition_writer_t))) == NULL)
+       || ((p_threads = (CSV_THREAD_TYPE *)calloc(number_of_writers, sizeof(CSV_THREAD_TYPE))) == NULL)) {
+        free(p_writers);
+        fclose(p_source);
+        return ENOMEM;
+    }
+
+    /* Cut the source into chunks that each start at the beginning of a row. */
+    for (unsigned int chunk = 0; chunk < number_of_writers; chunk++) {
+        p_writers[chunk].p_options = p_options;
+        p_writers[chunk].p_source_path = s_csv_files[csv_file_index].absolute_path;
+        p_writers[chunk].chunk = chunk;
+        p_writers[chunk].is_chunked = (number_of_writers > 1);
+        p_writers[chunk].max_open_files = p_options->max_open_files / number_of_writers;
+        p_writers[chunk].start_offset = boundary;
+
+        if(chunk+1 == number_of_writers) {
+            boundary = file_bytes;
+        }
+        else {
+            boundary = (file_bytes / number_of_writers) * (long)(chunk+1);
+            if(boundary < p_writers[chunk].start_offset) {
+                boundary = p_writers[chunk].start_offset;
+            }
+            /* Move the cut past the end of the row it landed in. */
+            if((boundary > 0) && (fseek(p_source, boundary-1, SEEK_SET) == 0)) {
+                while(((read_char = fgetc(p_source)) != '\n') && (read_char != EOF)) {
+                    continue;
+                }
+                boundary = (read_char == EOF) ? file_bytes : ftell(p_source);
+            }
+        }
+        p_writers[chunk].end_offset = boundary;
+    }
+    fclose(p_source);
+
+    /* Stream the first chunk on the calling thread and the others on their own. */
+    for (unsigned int chunk = 1; chunk < number_of_writers; chunk++) {
+        if(CSV_THREAD_CREATE(&p_threads[chunk], partition_worker, &p_writers[chunk])) {
+            break;
+        }
+        number_of_started_threads++;
+    }
+    partition_run(&p_writers[0]);
+    for (unsigned int chunk = 1; chunk <= number_of_started_threads; chunk++) {
+        CSV_THREAD_JOIN(p_threads[chunk]);
+    }
+    /* Chunks that did not get a thread are streamed here. */
+    for (unsigned int chunk = number_of_started_threads+1; chunk < number_of_writers; chunk++) {
+        partition_run(&p_writers[chunk]);
+    }
+
+    for (unsigned int chunk = 0; (chunk < number_of_writers) && (rv == 0); chunk++) {
+        rv = p_writers[chunk].rv;
+    }
+
+    /* Stitch the per chunk files together in chunk order. */
+    if((rv == 0) && (number_of_writers > 1)) {
+        rv = partition_merge(p_writers, number_of_writers);
+    }
+
+    for (unsigned int chunk = 0; chunk < number_of_writers; chunk++) {
+        STATS_ADD(csv_file_handle, bytes_read, p_writers[chunk].bytes_read);
+        STATS_ADD(csv_file_handle, bytes_written, p_writers[chunk].bytes_written);
+        partition_writer_free(&p_writers[chunk], (rv != 0) && (number_of_writers > 1));
+    }
+    free(p_writers);
+    free(p_threads);
+
+    if(rv) {
+        errno = rv;
+    }
+
+    return rv;
+}
+
+/**
+ * @brief Get a copy of the instrumentation counters of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_stats Pointer to the struct to fill in.
+ * @return 0 on success, ENOTSUP if the module was built without CSV_ENABLE_STATS, errno on fail.
+ */
+int csv_get_stats(int csv_file_handle, csv_stats_t *p_stats) {
+
+#ifdef CSV_ENABLE_STATS
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+
+    /* Check that we have a valid handle to an open file. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        errno = ENOENT;
+        return errno;
+    }
+
+    if(p_stats == NULL) {
+        errno = EINVAL;
+        return errno;
+    }
+
+    memcpy(p_stats, &s_csv_files[csv_file_index].stats, sizeof(csv_stats_t));
+
+    return 0;
+#else
+    (void)csv_file_handle;
+    (void)p_stats;
+    errno = ENOTSUP;
+    return errno;
+#endif
+}
+
+/**
+ * @brief Get the latency below which a percentage of the recorded calls completed.
+ * 
+ * @param p_histogram Histogram to read.
+ * @param percentile Percentage of calls, 0.0 to 100.0.
+ * @return Latency in nanoseconds (upper edge of the bucket), 0 if nothing was recorded.
+ */
+uint64_t csv_histogram_percentile(const csv_latency_histogram_t *p_histogram, double percentile) {
+
+    uint64_t target = 0;
+    uint64_t seen = 0;
+
+    if((p_histogram == NULL) || (p_histogram->count == 0)) {
+        return 0;
+    }
+
+    /* Rank of the call that sits at the percentile, at least the first call. */
+    target = (uint64_t)((percentile / 100.0) * (double)p_histogram->count + 0.5);
+    if(target == 0) {
+        target = 1;
+    }
+
+    for (size_t bucket = 0; bucket < CSV_HISTOGRAM_BUCKETS; bucket++) {
+        seen += p_histogram->buckets[bucket];
+        if(seen >= target) {
+            /* The bucket edge can overshoot what was actually recorded. */
+            return (histogram_bucket_upper_ns(bucket) < p_histogram->max_ns) ? histogram_bucket_upper_ns(bucket) : p_histogram->max_ns;
+        }
+    }
+
+    return p_histogram->max_ns;
+}
+
+/**
+ * @brief Write instrumentation counters as a JSON object.
+ * 
+ * @param p_stats Counters to write.
+ * @param p_buffer Buffer to write the null terminated JSON to. May be NULL if buffer_length is 0.
+ * @param buffer_length Size of the buffer in bytes.
+ * @return Length of the full JSON text (like snprintf), a value >= buffer_length means it was truncated. -1 on fail.
+ */
+int csv_stats_to_json(const csv_stats_t *p_stats, char *p_buffer, size_t buffer_length) {
+
+    static const char *const s_op_names[CSV_OP_COUNT] = {
+        "create_csv_file", "open_csv_file", "update_cell", "clear_cell", "update_row",
+        "insert_row", "append_row", "delete_row", "get_cell_contents",
+    };
+    size_t length = 0;
+    int is_first_bucket = 1;
+
+    if((p_stats == NULL) || ((p_buffer == NULL) && (buffer_length != 0))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if(buffer_length != 0) {
+        p_buffer[0] = '\0';
+    }
+
+    json_append(p_buffer, buffer_length, &length, "{\"bytes_read\":%llu,\"bytes_written\":%llu,\"rewrites\":%llu,\"seeks\":%llu,\"temp_files\":%llu,\"syncs\":%llu,\"latency_ns\":{",
+                (unsigned long long)p_stats->bytes_read, (unsigned long long)p_stats->bytes_written,
+                (unsigned long long)p_stats->rewrites, (unsigned long long)p_stats->seeks, (unsigned long long)p_stats->temp_files,
+                (unsigned long long)p_stats->syncs);
+
+    for (size_t op = 0; op < CSV_OP_COUNT; op++) {
+        const csv_latency_histogram_t *p_histogram = &p_stats->latency[op];
+
+        json_append(p_buffer, buffer_length, &length, "%s\"%s\":{\"count\":%llu,\"min\":%llu,\"max\":%llu,\"mean\":%llu,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"buckets\":[",
+                    (op == 0) ? "" : ",", s_op_names[op],
+                    (unsigned long long)p_histogram->count, (unsigned long long)p_histogram->min_ns, (unsigned long long)p_histogram->max_ns,
+                    (unsigned long long)((p_histogram->count != 0) ? (p_histogram->total_ns / p_histogram->count) : 0),
+                    (unsigned long long)csv_histogram_percentile(p_histogram, 50.0), (unsigned long long)csv_histogram_percentile(p_histogram, 90.0),
+                    (unsigned long long)csv_histogram_percentile(p_histogram, 99.0), (unsigned long long)csv_histogram_percentile(p_histogram, 99.9));
+
+        /* Only the non empty buckets, as [upper edge, count] pairs. */
+        is_first_bucket = 1;
+        for (size_t bucket = 0; bucket < CSV_HISTOGRAM_BUCKETS; bucket++) {
+            if(p_histogram->buckets[bucket] != 0) {
+                json_append(p_buffer, buffer_length, &length, "%s[%llu,%llu]", is_first_bucket ? "" : ",",
+                            (unsigned long long)histogram_bucket_upper_ns(bucket), (unsigned long long)p_histogram->buckets[bucket]);
+                is_first_bucket = 0;
+            }
+        }
+
+        json_append(p_buffer, buffer_length, &length, "]}");
+    }
+
+    json_append(p_buffer, buffer_length, &length, "}}");
+
+    return (int)length;
+}
+
+/**
+ * @brief Thread entry point that streams one chunk of a partitioning run.
+ * 
+ * @param p_arg Pointer to the csv_partition_writer_t of the chunk.
+ * @return Nothing, the result is left in the writer.
+ */
+static CSV_THREAD_RETURN_TYPE partition_worker(void *p_arg) {
+
+    partition_run((csv_partition_writer_t *)p_arg);
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to stream the chunk of a writer and route every row in it to its partition.
+ * 
+ * @param p_writer Writer of the chunk. Its rv is set to the result.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_run(csv_partition_writer_t *p_writer) {
+
+    FILE *p_source = NULL;
+    char *p_read_buffer = NULL;
+    char *p_carry = NULL;
+    char *p_grown_carry = NULL;
+    char *p_new_line = NULL;
+    size_t carry_length = 0;
+    size_t carry_capacity = 0;
+    size_t read_length = 0;
+    size_t row_start = 0;
+    long remaining = p_writer->end_offset - p_writer->start_offset;
+    int rv = 0;
+
+    if((p_read_buffer = (char *)malloc(PARTITION_READ_BUFFER_BYTES)) == NULL) {
+        p_writer->rv = ENOMEM;
+        return p_writer->rv;
+    }
+
+    if(((p_source = fopen(p_writer->p_source_path, "rb")) == NULL) || fseek(p_source, p_writer->start_offset, SEEK_SET)) {
+        rv = errno;
+    }
+
+    while((rv == 0) && (remaining > 0)) {
+        read_length = fread(p_read_buffer, 1, (remaining < PARTITION_READ_BUFFER_BYTES) ? (size_t)remaining : PARTITION_READ_BUFFER_BYTES, p_source);
+        if(read_length == 0) {
+            break;
+        }
+        remaining -= (long)read_length;
+        p_writer->bytes_read += read_length;
+
+        /* Route every complete row in the buffer, finishing the one carried over from the last read first. */
+        row_start = 0;
+        while((rv == 0) && ((p_new_line = (char *)memchr(p_read_buffer+row_start, '\n', read_length-row_start)) != NULL)) {
+            size_t row_end = (size_t)(p_new_line - p_read_buffer);
+
+            if(carry_length != 0) {
+                if(carry_length + (row_end-row_start) > carry_capacity) {
+                    carry_capacity = (carry_length + (row_end-row_start)) * 2;
+                    if((p_grown_carry = (char *)realloc(p_carry, carry_capacity)) == NULL) {
+                        rv = ENOMEM;
+                        break;
+                    }
+                    p_carry = p_grown_carry;
+                }
+                memcpy(p_carry+carry_length, p_read_buffer+row_start, row_end-row_start);
+                rv = partition_route_row(p_writer, p_carry, carry_length + (row_end-row_start));
+                carry_length = 0;
+            }
+            else {
+                rv = partition_route_row(p_writer, p_read_buffer+row_start, row_end-row_start);
+            }
+            row_start = row_end+1;
+        }
+
+        /* Keep the start of a row that continues in the next read. */
+        if((rv == 0) && (row_start < read_length)) {
+            if(carry_length + (read_length-row_start) > carry_capacity) {
+                carry_capacity = (carry_length + (read_length-row_start)) * 2;
+                if((p_grown_carry = (char *)realloc(p_carry, carry_capacity)) == NULL) {
+                    rv = ENOMEM;
+                    break;
+                }
+                p_carry = p_grown_carry;
+            }
+            memcpy(p_carry+carry_length, p_read_buffer+row_start, read_length-row_start);
+            carry_length += read_length-row_start;
+        }
+    }
+
+    if((rv == 0) && (p_source != NULL) && ferror(p_source)) {
+        rv = EIO;
+    }
+
+    /* A last row without a new line is still a row. */
+    if((rv == 0) && (carry_length != 0)) {
+        rv = partition_route_row(p_writer, p_carry, carry_length);
+    }
+
+    /* Write out what is still buffered and close everything. */
+    for (csv_partition_t *p_partition = p_writer->p_first; p_partition != NULL; p_partition = p_partition->p_all_next) {
+        if((rv == 0) && (p_partition->buffer_length != 0)) {
+            rv = partition_flush(p_writer, p_partition);
+        }
+    }
+    for (csv_partition_t *p_partition = p_writer->p_first; p_partition != NULL; p_partition = p_partition->p_all_next) {
+        if((p_partition->p_file != NULL) && fclose(p_partition->p_file) && (rv == 0)) {
+            rv = errno;
+        }
+        p_partition->p_file = NULL;
+    }
+    p_writer->p_lru_head = NULL;
+    p_writer->p_lru_tail = NULL;
+    p_writer->number_of_open_files = 0;
+
+    if(p_source != NULL) {
+        fclose(p_source);
+    }
+    free(p_read_buffer);
+    free(p_carry);
+
+    p_writer->rv = rv;
+
+    return rv;
+}
+
+/**
+ * @brief Helper function to send one row to the partition its key selects.
+ * 
+ * @param p_writer Writer of the chunk the row is in.
+ * @param p_row The row, without its new line.
+ * @param row_length Number of chars in the row.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_route_row(csv_partition_writer_t *p_writer, const char *p_row, size_t row_length) {
+
+    const char *p_key = p_row;
+    const char *p_comma = NULL;
+    size_t key_length = 0;
+    size_t name_length = 0;
+    char file_name[FILE_PATH_LENGTH] = {0};
+    csv_partition_t *p_partition = NULL;
+    int rv = 0;
+
+    /* Skip to the key column. Rows that are too short have an empty key. */
+    for (size_t column = 0; (column < p_writer->p_options->column) && (p_key != NULL); column++) {
+        p_comma = (const char *)memchr(p_key, ',', row_length - (size_t)(p_key-p_row));
+        p_key = (p_comma != NULL) ? (p_comma+1) : NULL;
+    }
+    if(p_key != NULL) {
+        p_comma = (const char *)memchr(p_key, ',', row_length - (size_t)(p_key-p_row));
+        key_length = (p_comma != NULL) ? (size_t)(p_comma-p_key) : (row_length - (size_t)(p_key-p_row));
+    }
+
+    /* The file name is the hash bucket or the escaped key. */
+    if(p_writer->p_options->number_of_hash_partitions != 0) {
+        snprintf(file_name, sizeof(file_name), "part-%05llu.csv",
+                 (unsigned long long)(hash_bytes(p_key, key_length) % p_writer->p_options->number_of_hash_partitions));
+    }
+    else if(key_length == 0) {
+        strcpy(file_name, "_.csv");
+    }
+    else {
+        for (size_t idx = 0; idx < key_length; idx++) {
+            unsigned char key_char = (unsigned char)p_key[idx];
+
+            if(name_length + sizeof("%XX" CSV_EXTENSION_STRING) > sizeof(file_name)) {
+                return ENAMETOOLONG;
+            }
+            if(((key_char >= 'a') && (key_char <= 'z')) || ((key_char >= 'A') && (key_char <= 'Z'))
+               || ((key_char >= '0') && (key_char <= '9')) || (key_char == '-') || (key_char == '.')) {
+                file_name[name_length++] = (char)key_char;
+            }
+            else {
+                name_length += (size_t)sprintf(file_name+name_length, "%%%02X", key_char);
+            }
+        }
+        strcpy(file_name+name_length, CSV_EXTENSION_STRING);
+    }
+
+    if((p_partition = partition_lookup(p_writer, file_name)) == NULL) {
+        return ENOMEM;
+    }
+
+    if((rv = partition_write(p_writer, p_partition, p_row, row_length)) != 0) {
+        return rv;
+    }
+
+    return partition_write(p_writer, p_partition, "\n", 1);
+}
+
+/**
+ * @brief Helper function to find the partition of an output file name, creating it on first use.
+ * 
+ * @param p_writer Writer that owns the partitions.
+ * @param p_file_name Name of the output file.
+ * @return Pointer to the partition, NULL if it could not be created.
+ */
+static csv_partition_t *partition_lookup(csv_partition_writer_t *p_writer, const char *p_file_name) {
+
+    uint64_t name_hash = hash_bytes(p_file_name, strlen(p_file_name));
+    csv_partition_t *p_partition = NULL;
+    csv_partition_t **pp_buckets = NULL;
+    size_t number_of_buckets = 0;
+    size_t bucket = 0;
+
+    if(p_writer->number_of_buckets != 0) {
+        p_partition = p_writer->pp_buckets[name_hash & (p_writer->number_of_buckets-1)];
+        while((p_partition != NULL) && ((p_partition->name_hash != name_hash) || strcmp(p_partition->file_name, p_file_name))) {
+            p_partition = p_partition->p_hash_next;
+        }
+        if(p_partition != NULL) {
+            return p_partition;
+        }
+    }
+
+    /* Keep the hash chains short by growing the table with the number of partitions. */
+    if(p_writer->number_of_partitions >= p_writer->number_of_buckets) {
+        number_of_buckets = (p_writer->number_of_buckets == 0) ? PARTITION_INITIAL_BUCKETS : (p_writer->number_of_buckets*2);
+        if((pp_buckets = (csv_partition_t **)calloc(number_of_buckets, sizeof(csv_partition_t *))) == NULL) {
+            return NULL;
+        }
+        for (csv_partition_t *p_moved = p_writer->p_first; p_moved != NULL; p_moved = p_moved->p_all_next) {
+            bucket = p_moved->name_hash & (number_of_buckets-1);
+            p_moved->p_hash_next = pp_buckets[bucket];
+            pp_buckets[bucket] = p_moved;
+        }
+        free(p_writer->pp_buckets);
+        p_writer->pp_buckets = pp_buckets;
+        p_writer->number_of_buckets = number_of_buckets;
+    }
+
+    if((p_partition = (csv_partition_t *)calloc(1, sizeof(csv_partition_t))) == NULL) {
+        return NULL;
+    }
+    p_partition->name_hash = name_hash;
+    strcpy(p_partition->file_name, p_file_name);
+
+    bucket = name_hash & (p_writer->number_of_buckets-1);
+    p_partition->p_hash_next = p_writer->pp_buckets[bucket];
+    p_writer->pp_buckets[bucket] = p_partition;
+
+    if(p_writer->p_last != NULL) {
+        p_writer->p_last->p_all_next = p_partition;
+    }
+    else {
+        p_writer->p_first = p_partition;
+    }
+    p_writer->p_last = p_partition;
+    p_writer->number_of_partitions++;
+
+    return p_partition;
+}
+
+/**
+ * @brief Helper function to add data to the write buffer of a partition, writing the buffer out when it fills.
+ * 
+ * @param p_writer Writer that owns the partition.
+ * @param p_partition Partition to write to.
+ * @param p_data Data to write.
+ * @param length Number of bytes to write.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_write(csv_partition_writer_t *p_writer, csv_partition_t *p_partition, const char *p_data, size_t length) {
+
+    int rv = 0;
+
+    /* Only open partitions hold a buffer, so the buffers are bounded by max_open_files and not by the number of keys. */
+    if((rv = partition_open(p_writer, p_partition)) != 0) {
+        return rv;
+    }
+    if((p_partition->p_buffer == NULL) && ((p_partition->p_buffer = (char *)malloc(PARTITION_WRITE_BUFFER_BYTES)) == NULL)) {
+        return ENOMEM;
+    }
+
+    if((p_partition->buffer_length + length > PARTITION_WRITE_BUFFER_BYTES) && ((rv = partition_flush(p_writer, p_partition)) != 0)) {
+        return rv;
+    }
+
+    /* Rows bigger than the whole buffer go straight to the file. */
+    if(length > PARTITION_WRITE_BUFFER_BYTES) {
+        if(fwrite(p_data, 1, length, p_partition->p_file) != length) {
+            return errno;
+        }
+        p_writer->bytes_written += length;
+        return 0;
+    }
+
+    memcpy(p_partition->p_buffer+p_partition->buffer_length, p_data, length);
+    p_partition->buffer_length += length;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to write the buffer of a partition to its file.
+ * 
+ * @param p_writer Writer that owns the partition.
+ * @param p_partition Partition to flush.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_flush(csv_partition_writer_t *p_writer, csv_partition_t *p_partition) {
+
+    int rv = 0;
+
+    if(p_partition->buffer_length == 0) {
+        return 0;
+    }
+
+    if((rv = partition_open(p_writer, p_partition)) != 0) {
+        return rv;
+    }
+
+    if(fwrite(p_partition->p_buffer, 1, p_partition->buffer_length, p_partition->p_file) != p_partition->buffer_length) {
+        return errno;
+    }
+    p_writer->bytes_written += p_partition->buffer_length;
+    p_partition->buffer_length = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to make sure the file of a partition is open and most recently used.
+ * 
+ * Opening a file when the writer is at its limit closes the least recently written one first.
+ * 
+ * @param p_writer Writer that owns the partition.
+ * @param p_partition Partition whose file is needed.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_open(csv_partition_writer_t *p_writer, csv_partition_t *p_partition) {
+
+    char path[FILE_PATH_LENGTH] = {0};
+    csv_partition_t *p_closed = NULL;
+    int rv = 0;
+
+    /* Already open, just move it to the front of the LRU list. */
+    if(p_partition->p_file != NULL) {
+        if(p_partition != p_writer->p_lru_head) {
+            p_partition->p_lru_prev->p_lru_next = p_partition->p_lru_next;
+            if(p_partition->p_lru_next != NULL) {
+                p_partition->p_lru_next->p_lru_prev = p_partition->p_lru_prev;
+            }
+            else {
+                p_writer->p_lru_tail = p_partition->p_lru_prev;
+            }
+            p_partition->p_lru_prev = NULL;
+            p_partition->p_lru_next = p_writer->p_lru_head;
+            p_writer->p_lru_head->p_lru_prev = p_partition;
+            p_writer->p_lru_head = p_partition;
+        }
+        return 0;
+    }
+
+    /* Make room by closing the least recently written file. Its buffer is written out and freed with it. */
+    if((p_writer->number_of_open_files >= p_writer->max_open_files) && ((p_closed = p_writer->p_lru_tail) != NULL)) {
+        p_writer->p_lru_tail = p_closed->p_lru_prev;
+        if(p_writer->p_lru_tail != NULL) {
+            p_writer->p_lru_tail->p_lru_next = NULL;
+        }
+        else {
+            p_writer->p_lru_head = NULL;
+        }
+        p_writer->number_of_open_files--;
+        if((p_closed->buffer_length != 0) && (fwrite(p_closed->p_buffer, 1, p_closed->buffer_length, p_closed->p_file) != p_closed->buffer_length)) {
+            rv = errno;
+        }
+        else {
+            p_writer->bytes_written += p_closed->buffer_length;
+        }
+        if(fclose(p_closed->p_file) && (rv == 0)) {
+            rv = errno;
+        }
+        p_closed->p_file = NULL;
+        free(p_closed->p_buffer);
+        p_closed->p_buffer = NULL;
+        p_closed->buffer_length = 0;
+        if(rv) {
+            return rv;
+        }
+    }
+
+    if((rv = partition_path(p_writer, p_partition, path)) != 0) {
+        return rv;
+    }
+
+    /* The first open of a run replaces whatever was there, later ones add to it. */
+    if((p_partition->p_file = fopen(path, p_partition->has_been_created ? "ab" : "wb")) == NULL) {
+        return errno;
+    }
+    p_partition->has_been_created = 1;
+
+    /* Every write is a whole buffer, so stdio buffering would only add a copy. */
+    setvbuf(p_partition->p_file, NULL, _IONBF, 0);
+
+    p_partition->p_lru_prev = NULL;
+    p_partition->p_lru_next = p_writer->p_lru_head;
+    if(p_writer->p_lru_head != NULL) {
+        p_writer->p_lru_head->p_lru_prev = p_partition;
+    }
+    else {
+        p_writer->p_lru_tail = p_partition;
+    }
+    p_writer->p_lru_head = p_partition;
+    p_writer->number_of_open_files++;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to build the path a writer writes a partition to.
+ * 
+ * @param p_writer Writer that owns the partition.
+ * @param p_partition The partition.
+ * @param p_path Buffer of FILE_PATH_LENGTH chars to write the path to.
+ * @return 0 on success, ENAMETOOLONG if the path does not fit.
+ */
+static int partition_path(const csv_partition_writer_t *p_writer, const csv_partition_t *p_partition, char *p_path) {
+
+    int length = 0;
+
+    /* Chunks of a parallel run write next to the final file until they are stitched together. */
+    if(p_writer->is_chunked) {
+        length = snprintf(p_path, FILE_PATH_LENGTH, "%s/%s.chunk%u", p_writer->p_options->p_out_dir, p_partition->file_name, p_writer->chunk);
+    }
+    else {
+        length = snprintf(p_path, FILE_PATH_LENGTH, "%s/%s", p_writer->p_options->p_out_dir, p_partition->file_name);
+    }
+
+    return ((length < 0) || (length >= FILE_PATH_LENGTH)) ? ENAMETOOLONG : 0;
+}
+
+/**
+ * @brief Helper function to stitch the per chunk files of a parallel run into the final partition files.
+ * 
+ * The first chunk that holds rows of a partition is renamed into place, the following chunks are appended to it.
+ * 
+ * @param p_writers Writers of the run, in chunk order.
+ * @param number_of_writers Number of writers.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_merge(csv_partition_writer_t *p_writers, unsigned int number_of_writers) {
+
+    csv_partition_writer_t merged = {0};
+    csv_partition_t *p_final = NULL;
+    char chunk_path[FILE_PATH_LENGTH] = {0};
+    char final_path[FILE_PATH_LENGTH] = {0};
+    int rv = 0;
+
+    /* The merged writer only tracks which final files exist so far. */
+    merged.p_options = p_writers[0].p_options;
+
+    for (unsigned int chunk = 0; (chunk < number_of_writers) && (rv == 0); chunk++) {
+        for (csv_partition_t *p_partition = p_writers[chunk].p_first; (p_partition != NULL) && (rv == 0); p_partition = p_partition->p_all_next) {
+            if((p_final = partition_lookup(&merged, p_partition->file_name)) == NULL) {
+                rv = ENOMEM;
+                break;
+            }
+            if(((rv = partition_path(&p_writers[chunk], p_partition, chunk_path)) != 0) || ((rv = partition_path(&merged, p_final, final_path)) != 0)) {
+                break;
+            }
+
+            if(!p_final->has_been_created) {
+                if(rename(chunk_path, final_path)) {
+                    rv = errno;
+                    break;
+                }
+                p_final->has_been_created = 1;
+            }
+            else {
+                rv = partition_append_file(chunk_path, final_path);
+            }
+        }
+    }
+
+    partition_writer_free(&merged, 0);
+
+    return rv;
+}
+
+/**
+ * @brief Helper function to append one file to another and remove it.
+ * 
+ * @param p_from_path File to append and remove.
+ * @param p_to_path File to append to.
+ * @return 0 on success, errno on fail.
+ */
+static int partition_append_file(const char *p_from_path, const char *p_to_path) {
+
+    FILE *p_from = NULL;
+    FILE *p_to = NULL;
+    char *p_buffer = NULL;
+    size_t length = 0;
+    int rv = 0;
+
+    if((p_buffer = (char *)malloc(PARTITION_READ_BUFFER_BYTES)) == NULL) {
+        return ENOMEM;
+    }
+
+    if(((p_from = fopen(p_from_path, "rb")) == NULL) || ((p_to = fopen(p_to_path, "ab")) == NULL)) {
+        rv = errno;
+    }
+
+    while((rv == 0) && ((length = fread(p_buffer, 1, PARTITION_READ_BUFFER_BYTES, p_from)) != 0)) {
+        if(fwrite(p_buffer, 1, length, p_to) != length) {
+            rv = errno;
+        }
+    }
+
+    if((rv == 0) && ferror(p_from)) {
+        rv = EIO;
+    }
+    if((p_to != NULL) && fclose(p_to) && (rv == 0)) {
+        rv = errno;
+    }
+    if(p_from != NULL) {
+        fclose(p_from);
+    }
+    free(p_buffer);
+
+    if(rv == 0) {
+        remove(p_from_path);
+    }
+
+    return rv;
+}
+
+/**
+ * @brief Helper function to free every partition of a writer.
+ * 
+ * @param p_writer Writer to free.
+ * @param remove_outputs 1 to also delete the files the writer produced, e.g. chunk files of a failed run.
+ */
+static void partition_writer_free(csv_partition_writer_t *p_writer, int remove_outputs) {
+
+    char path[FILE_PATH_LENGTH] = {0};
+    csv_partition_t *p_next_partition = NULL;
+
+    for (csv_partition_t *p_partition = p_writer->p_first; p_partition != NULL; p_partition = p_next_partition) {
+        p_next_partition = p_partition->p_all_next;
+        if(p_partition->p_file != NULL) {
+            fclose(p_partition->p_file);
+        }
+        if(remove_outputs && p_partition->has_been_created && (partition_path(p_writer, p_partition, path) == 0)) {
+            remove(path);
+        }
+        free(p_partition->p_buffer);
+        free(p_partition);
+    }
+
+    free(p_writer->pp_buckets);
+    p_writer->pp_buckets = NULL;
+    p_writer->number_of_buckets = 0;
+    p_writer->number_of_partitions = 0;
+    p_writer->p_first = NULL;
+    p_writer->p_last = NULL;
+}
+
+/**
+ * @brief Helper function to refuse an output directory that holds the source.
+ * 
+ * Partition files are created by truncating, so in the directory of the source a key named like
+ * the source would wipe it out while it is being read.
+ * 
+ * @param p_out_dir Output directory of the run.
+ * @param p_source_path Path of the csv file being partitioned.
+ * @return 0 if the directories differ, EINVAL if they are the same, errno if one can't be resolved.
+ */
+static int partition_check_out_dir(const char *p_out_dir, const char *p_source_path) {
+
+    char source_directory[FILE_PATH_LENGTH] = {0};
+#ifdef _WIN32
+    char resolved_out_dir[FILE_PATH_LENGTH] = {0};
+    char resolved_source_directory[FILE_PATH_LENGTH] = {0};
+    size_t out_dir_length = 0;
+    size_t source_directory_length = 0;
+#else
+    char *p_resolved_out_dir = NULL;
+    char *p_resolved_source_directory = NULL;
+#endif
+    int rv = 0;
+
+    directory_of(p_source_path, source_directory);
+
+#ifdef _WIN32
+    if((_fullpath(resolved_out_dir, p_out_dir, FILE_PATH_LENGTH) == NULL)
+       || (_fullpath(resolved_source_directory, source_directory, FILE_PATH_LENGTH) == NULL)) {
+        return ENAMETOOLONG;
+    }
+
+    /* A trailing separator is kept by _fullpath, "C:\dir\" and "C:\dir" are the same directory. */
+    out_dir_length = strlen(resolved_out_dir);
+    if((out_dir_length > 3) && ((resolved_out_dir[out_dir_length-1] == '\\') || (resolved_out_dir[out_dir_length-1] == '/'))) {
+        out_dir_length--;
+    }
+    source_directory_length = strlen(resolved_source_directory);
+    if((source_directory_length > 3) && ((resolved_source_directory[source_directory_length-1] == '\\') || (resolved_source_directory[source_directory_length-1] == '/'))) {
+        source_directory_length--;
+    }
+
+    if((out_dir_length == source_directory_length) && (_strnicmp(resolved_out_dir, resolved_source_directory, out_dir_length) == 0)) {
+        rv = EINVAL;
+    }
+#else
+    /* Resolve both so "." or a symlink can't hide that they are the same directory. */
+    if(((p_resolved_out_dir = realpath(p_out_dir, NULL)) == NULL) || ((p_resolved_source_directory = realpath(source_directory, NULL)) == NULL)) {
+        rv = errno;
+    }
+    else if(strcmp(p_resolved_out_dir, p_resolved_source_directory) == 0) {
+        rv = EINVAL;
+    }
+    free(p_resolved_out_dir);
+    free(p_resolved_source_directory);
+#endif
+
+    return rv;
+}
+
+/**
+ * @brief Helper function to hash a string of bytes (64 bit FNV-1a).
+ * 
+ * @param p_data Bytes to hash.
+ * @param length Number of bytes.
+ * @return The hash.
+ */
+static uint64_t hash_bytes(const char *p_data, size_t length) {
+
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t idx = 0; idx < length; idx++) {
+        hash ^= (unsigned char)p_data[idx];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Helper function to read the monotonic clock.
+ * 
+ * @return Current time in nanoseconds.
+ */
+static uint64_t clock_ns(void) {
+
+    struct timespec now;
+
+#ifdef _WIN32
+    timespec_get(&now, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+
+    return ((uint64_t)now.tv_sec*1000000000u) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Helper function to flush a csv file and sync its data to the disk.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @return 0 on success, errno on fail.
+ */
+static int sync_file(int csv_file_handle) {
+
+    FILE *p_file = s_csv_files[convert_handle_to_index(csv_file_handle)].p_file;
+
+    /* Move the stdio buffer to the OS, then the OS buffers to the disk. */
+    if(fflush(p_file) || CSV_FDATASYNC(CSV_FILENO(p_file))) {
+        return errno;
+    }
+    STATS_ADD(csv_file_handle, syncs, 1);
+
+    s_csv_files[convert_handle_to_index(csv_file_handle)].pending_bytes = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to sync freshly appended bytes as the durability level of the handle asks.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param appended_bytes Number of bytes the append wrote.
+ * @return 0 on success, errno on fail.
+ */
+static int sync_appended_bytes(int csv_file_handle, size_t appended_bytes) {
+
+    csv_file_t *p_csv_file = &s_csv_files[convert_handle_to_index(csv_file_handle)];
+    uint64_t now_ns = 0;
+
+    switch(p_csv_file->durability) {
+        case CSV_DURABILITY_PER_OP:
+            return sync_file(csv_file_handle);
+
+        case CSV_DURABILITY_GROUP_COMMIT:
+            now_ns = clock_ns();
+
+            /* The first append after a sync opens a new window. */
+            if(p_csv_file->pending_bytes == 0) {
+                p_csv_file->pending_since_ns = now_ns;
+            }
+            p_csv_file->pending_bytes += appended_bytes;
+
+            /* Close the window once it is full or old enough. No limits at all means every append syncs.
+               The age is only looked at here, so an idle file stays unsynced until csv_sync(). */
+            if(((p_csv_file->group_window_bytes == 0) && (p_csv_file->group_sync_age_ns == 0))
+               || ((p_csv_file->group_window_bytes != 0) && (p_csv_file->pending_bytes >= p_csv_file->group_window_bytes))
+               || ((p_csv_file->group_sync_age_ns != 0) && ((now_ns - p_csv_file->pending_since_ns) >= p_csv_file->group_sync_age_ns))) {
+                return sync_file(csv_file_handle);
+            }
+            return 0;
+
+        case CSV_DURABILITY_NONE:
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Helper function to sync the directory of a file so a rename() in it survives a crash.
+ * 
+ * @param p_path Path of a file in the directory.
+ * @return 0 on success, errno on fail.
+ */
+static int sync_directory(const char *p_path) {
+
+#ifdef _WIN32
+    /* Directory entries can't be synced on Windows, MOVEFILE_WRITE_THROUGH covers the rename. */
+    (void)p_path;
+    return 0;
+#else
+    char directory[FILE_PATH_LENGTH] = {0};
+    int directory_descriptor = -1;
+    int rv = 0;
+
+    directory_of(p_path, directory);
+
+    if((directory_descriptor = open(directory, O_RDONLY)) < 0) {
+        return errno;
+    }
+
+    /* Some file systems can't sync a directory, they don't need to. */
+    if(fsync(directory_descriptor) && (errno != EINVAL)) {
+        rv = errno;
+    }
+    close(directory_descriptor);
+
+    return rv;
+#endif
+}
+
+/**
+ * @brief Helper function to strip the file name off a path.
+ * 
+ * @param p_path Path of a file.
+ * @param p_directory Buffer of FILE_PATH_LENGTH chars to write the directory to. "." for a bare file name.
+ */
+static void directory_of(const char *p_path, char *p_directory) {
+
+    char *p_last_separator = NULL;
+    size_t length = strlen(p_path);
+
+    /* Paths come from FILE_PATH_LENGTH buffers, longer ones are cut like everywhere else. */
+    if(length >= FILE_PATH_LENGTH) {
+        length = FILE_PATH_LENGTH-1;
+    }
+    memcpy(p_directory, p_path, length);
+    p_directory[length] = '\0';
+#ifdef _WIN32
+    /* Either separator may be used on Windows. */
+    if((strrchr(p_directory, '\\') != NULL) && ((strrchr(p_directory, '/') == NULL) || (strrchr(p_directory, '\\') > strrchr(p_directory, '/')))) {
+        p_last_separator = strrchr(p_directory, '\\');
+    }
+    else {
+        p_last_separator = strrchr(p_directory, '/');
+    }
+#else
+    p_last_separator = strrchr(p_directory, '/');
+#endif
+
+    /* A bare file name lives in the working directory. */
+    if(p_last_separator == NULL) {
+        strcpy(p_directory, ".");
+    }
+    else if(p_last_separator == p_directory) {
+        p_directory[1] = '\0';
+    }
+    else {
+        *p_last_separator = '\0';
+    }
+}
+
+/**
+ * @brief Helper function to replace a csv file with the temp file a rewrite produced.
+ * 
+ * rename() replaces the file atomically, so a crash leaves the old or the new contents but never
+ * neither. When the handle asks for durability the temp file is synced before the rename and the
+ * directory after it.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_temp_file Temp file holding the new contents. Always closed on return.
+ * @param p_temp_file_name Path of the temp file.
+ * @return 0 on success, errno on fail.
+ */
+static int replace_with_temp_file(int csv_file_handle, FILE *p_temp_file, const char *p_temp_file_name) {
+
+    csv_file_t *p_csv_file = &s_csv_files[convert_handle_to_index(csv_file_handle)];
+    int is_durable = (p_csv_file->durability != CSV_DURABILITY_NONE);
+    int rv = 0;
+
+    /* Get the new contents onto the disk before they can replace the old ones. */
+    if(fflush(p_temp_file) || (is_durable && CSV_FSYNC(CSV_FILENO(p_temp_file)))) {
+        rv = errno;
+        fclose(p_temp_file);
+        remove(p_temp_file_name);
+        errno = rv;
+        return rv;
+    }
+    if(is_durable) {
+        STATS_ADD(csv_file_handle, syncs, 1);
+    }
+    if(fclose(p_temp_file)) {
+        rv = errno;
+        remove(p_temp_file_name);
+        errno = rv;
+        return rv;
+    }
+
+    fclose(p_csv_file->p_file);
+    p_csv_file->p_file = NULL;
+
+    /* Swap the files in one step. */
+#ifdef _WIN32
+    if(!MoveFileExA(p_temp_file_name, p_csv_file->absolute_path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        errno = EACCES;
+        rv = errno;
+    }
+#else
+    if(rename(p_temp_file_name, p_csv_file->absolute_path)) {
+        rv = errno;
+    }
+#endif
+
+    /* On failure the old file is untouched, so keep the handle usable on it. */
+    if(rv) {
+        remove(p_temp_file_name);
+        p_csv_file->p_file = fopen(p_csv_file->absolute_path, "a+");
+        errno = rv;
+        return rv;
+    }
+    STATS_ADD(csv_file_handle, rewrites, 1);
+
+    /* Make the rename itself survive a crash. */
+    if(is_durable) {
+        if(sync_directory(p_csv_file->absolute_path)) {
+            rv = errno;
+        }
+        else {
+            STATS_ADD(csv_file_handle, syncs, 1);
+        }
+    }
+
+    /* Reopen the file so that the user can still interact with it. */
+    if((p_csv_file->p_file = fopen(p_csv_file->absolute_path, "a+")) == NULL) {
+        return errno;
+    }
+
+    if(rv) {
+        errno = rv;
+        return rv;
+    }
+
+    /* The synced temp file held every row appended before the rewrite as well. */
+    if(is_durable) {
+        p_csv_file->pending_bytes = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Helper function to read a char from a stream of a csv file, counting it in the handle stats.
+ * 
+ * @param csv_file_handle Handle of the csv file the stream belongs to.
+ * @param p_stream Stream to read from.
+ * @return The char read, EOF at the end of the stream.
+ */
+static inline int tracked_fgetc(int csv_file_handle, FILE *p_stream) {
+
+    int read_char = fgetc(p_stream);
+
+    if(read_char != EOF) {
+        STATS_ADD(csv_file_handle, bytes_read, 1);
+    }
+    (void)csv_file_handle;
+
+    return read_char;
+}
+
+/**
+ * @brief Helper function to print to a stream of a csv file, counting the chars in the handle stats.
+ * 
+ * @param csv_file_handle Handle of the csv file the stream belongs to.
+ * @param p_stream Stream to print to.
+ * @param p_format printf style format string.
+ * @return Number of chars printed, negative on fail.
+ */
+static int tracked_fprintf(int csv_file_handle, FILE *p_stream, const char *p_format, ...) {
+
+    va_list args;
+    int written = 0;
+
+    va_start(args, p_format);
+    written = vfprintf(p_stream, p_format, args);
+    va_end(args);
+
+    if(written > 0) {
+        STATS_ADD(csv_file_handle, bytes_written, (uint64_t)written);
+    }
+    (void)csv_file_handle;
+
+    return written;
+}
+
+/**
+ * @brief Helper function to seek a stream of a csv file, counting the seek in the handle stats.
+ * 
+ * @param csv_file_handle Handle of the csv file the stream belongs to.
+ * @param p_stream Stream to seek.
+ * @param offset Offset from the origin.
+ * @param origin SEEK_SET, SEEK_CUR or SEEK_END.
+ * @return 0 on success, non zero on fail.
+ */
+static inline int tracked_fseek(int csv_file_handle, FILE *p_stream, long offset, int origin) {
+
+    STATS_ADD(csv_file_handle, seeks, 1);
+    (void)csv_file_handle;
+
+    return fseek(p_stream, offset, origin);
+}
+
+/**
+ * @brief Helper function to rewind a stream of a csv file, counting it as a seek in the handle stats.
+ * 
+ * @param csv_file_handle Handle of the csv file the stream belongs to.
+ * @param p_stream Stream to rewind.
+ */
+static inline void tracked_rewind(int csv_file_handle, FILE *p_stream) {
+
+    STATS_ADD(csv_file_handle, seeks, 1);
+    (void)csv_file_handle;
+
+    rewind(p_stream);
+}
+
+/**
+ * @brief Helper function to read the clock used to time the public functions.
+ * 
+ * @return Monotonic time in nanoseconds, always 0 when instrumentation is compiled out.
+ */
+static inline uint64_t stats_clock_ns(void) {
+
+#ifdef CSV_ENABLE_STATS
+    return clock_ns();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Helper function to record the latency of a public function in the histogram of a handle.
+ * 
+ * @param csv_file_handle Handle of the csv file the call operated on. Ignored if it is not an open handle.
+ * @param op The function that was called.
+ * @param start_ns Time the call started, from stats_clock_ns().
+ */
+static inline void stats_record_latency(int csv_file_handle, csv_op_t op, uint64_t start_ns) {
+
+#ifdef CSV_ENABLE_STATS
+    int csv_file_index = convert_handle_to_index(csv_file_handle);
+    csv_latency_histogram_t *p_histogram = NULL;
+    uint64_t latency_ns = stats_clock_ns() - start_ns;
+
+    /* Invalid and closed handles have no histogram. */
+    if((csv_file_index < 0) || (csv_file_index >= MAX_CONCURRENT_CSV_FILES) || (s_free_indexes[csv_file_index] == 0)) {
+        return;
+    }
+
+    p_histogram = &s_csv_files[csv_file_index].stats.latency[op];
+    if((p_histogram->count == 0) || (latency_ns < p_histogram->min_ns)) {
+        p_histogram->min_ns = latency_ns;
+    }
+    if(latency_ns > p_histogram->max_ns) {
+        p_histogram->max_ns = latency_ns;
+    }
+    p_histogram->count++;
+    p_histogram->total_ns += latency_ns;
+    p_histogram->buckets[histogram_bucket_index(latency_ns)]++;
+#else
+    (void)csv_file_handle;
+    (void)op;
+    (void)start_ns;
+#endif
+}
+
+#ifdef CSV_ENABLE_STATS
+/**
+ * @brief Helper function to find the histogram bucket of a latency.
+ * 
+ * @param latency_ns Latency in nanoseconds.
+ * @return Index of the bucket, clamped to the last bucket.
+ */
+static size_t histogram_bucket_index(uint64_t latency_ns) {
+
+    unsigned int exponent = 0;
+
+    /* Small latencies get a bucket each. */
+    if(latency_ns < (1u << CSV_HISTOGRAM_SUB_BUCKET_BITS)) {
+        return (size_t)latency_ns;
+    }
+
+    /* Position of the highest set bit. */
+#if defined(__GNUC__) || defined(__clang__)
+    exponent = 63u - (unsigned int)__builtin_clzll(latency_ns);
+#else
+    for (uint64_t value = latency_ns; value > 1; value >>= 1) {
+        exponent++;
+    }
+#endif
+
+    if(exponent > CSV_HISTOGRAM_MAX_EXPONENT) {
+        return CSV_HISTOGRAM_BUCKETS - 1;
+    }
+
+    /* Every power of 2 is split by the bits just below the highest set bit. */
+    return ((size_t)(exponent - CSV_HISTOGRAM_SUB_BUCKET_BITS + 1) << CSV_HISTOGRAM_SUB_BUCKET_BITS)
+         + (size_t)((latency_ns >> (exponent - CSV_HISTOGRAM_SUB_BUCKET_BITS)) & ((1u << CSV_HISTOGRAM_SUB_BUCKET_BITS) - 1));
+}
+#endif /* CSV_ENABLE_STATS */
+
+/**
+ * @brief Helper function to get the highest latency that falls into a histogram bucket.
+ * 
+ * @param bucket Index of the bucket.
+ * @return Upper edge of the bucket in nanoseconds.
+ */
+static uint64_t histogram_bucket_upper_ns(size_t bucket) {
+
+    size_t exponent = 0;
+    uint64_t sub_bucket = 0;
+
+    if(bucket < (1u << CSV_HISTOGRAM_SUB_BUCKET_BITS)) {
+        return (uint64_t)bucket;
+    }
+
+    exponent = (bucket >> CSV_HISTOGRAM_SUB_BUCKET_BITS) + CSV_HISTOGRAM_SUB_BUCKET_BITS - 1;
+    sub_bucket = (uint64_t)(bucket & ((1u << CSV_HISTOGRAM_SUB_BUCKET_BITS) - 1));
+
+    return (((1ull << CSV_HISTOGRAM_SUB_BUCKET_BITS) + sub_bucket + 1) << (exponent - CSV_HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+}
+
+/**
+ * @brief Helper function to append formatted text to a JSON buffer, snprintf style.
+ * 
+ * @param p_buffer Buffer to append to.
+ * @param buffer_length Size of the buffer in bytes.
+ * @param p_length Length of the text so far, including what did not fit. Updated on return.
+ * @param p_format printf style format string.
+ */
+static void json_append(char *p_buffer, size_t buffer_length, size_t *p_length, const char *p_format, ...) {
+
+    va_list args;
+    int written = 0;
+
+    va_start(args, p_format);
+    if(*p_length < buffer_length) {
+        written = vsnprintf(p_buffer + *p_length, buffer_length - *p_length, p_format, args);
+    }
+    else {
+        written = vsnprintf(NULL, 0, p_format, args);
+    }
+    va_end(args);
+
+    if(written > 0) {
+        *p_length += (size_t)written;
+    }
+}
@@ -18,12 +18,56 @@
 
 
 /* -------------------- Public Includes -------------------- */
+#include <stddef.h>
 #include <stdint.h>
 
 /* -------------------- Public Macros/Defines -------------------- */
 
+#ifndef CSV_DEFAULT_ROW_CACHE_BYTES
+/** Default memory budget of the per-handle row cache. 0 disables the cache. Override at compile time or with csv_set_cache_bytes(). */
+#define CSV_DEFAULT_ROW_CACHE_BYTES (1024 * 1024)
+#endif
+
+/** Number of bits of a latency kept below its highest set bit. Every power of 2 is split into 2^bits buckets (6.25% resolution). */
+#define CSV_HISTOGRAM_SUB_BUCKET_BITS   (4)
+/** Highest power of 2 (in ns) a latency histogram resolves. Slower calls are counted in the last bucket. */
+#define CSV_HISTOGRAM_MAX_EXPONENT      (36)
+/** Number of buckets in a latency histogram. */
+#define CSV_HISTOGRAM_BUCKETS           ((CSV_HISTOGRAM_MAX_EXPONENT - CSV_HISTOGRAM_SUB_BUCKET_BITS + 2) << CSV_HISTOGRAM_SUB_BUCKET_BITS)
+
 /* -------------------- Public Enums -------------------- */
 
+/**
+ * @brief How hard the module works to get writes onto the disk before returning.
+ * 
+ * Rewrites (update, insert, delete) always replace the file atomically with rename(). With any level
+ * other than CSV_DURABILITY_NONE the temp file and the directory are also synced, so a crash leaves
+ * either the old or the new file.
+ * 
+ */
+typedef enum _csv_durability {
+    CSV_DURABILITY_NONE = 0,        /**< Never sync, leave it to the OS. The default. */
+    CSV_DURABILITY_PER_OP,          /**< Sync the file after every append and every rewrite. */
+    CSV_DURABILITY_GROUP_COMMIT     /**< Appends inside a time/byte window share one data sync. Rewrites sync. */
+}csv_durability_t;
+
+/**
+ * @brief Public functions whose latency is recorded when the module is built with CSV_ENABLE_STATS.
+ * 
+ */
+typedef enum _csv_op {
+    CSV_OP_CREATE_CSV_FILE = 0,     /**< create_csv_file() */
+    CSV_OP_OPEN_CSV_FILE,           /**< open_csv_file() */
+    CSV_OP_UPDATE_CELL,             /**< update_cell() */
+    CSV_OP_CLEAR_CELL,              /**< clear_cell() */
+    CSV_OP_UPDATE_ROW,              /**< update_row() */
+    CSV_OP_INSERT_ROW,              /**< insert_row() */
+    CSV_OP_APPEND_ROW,              /**< append_row() */
+    CSV_OP_DELETE_ROW,              /**< delete_row() */
+    CSV_OP_GET_CELL_CONTENTS,       /**< get_cell_contents() */
+    CSV_OP_COUNT                    /**< Number of timed functions. */
+}csv_op_t;
+
 
 /* -------------------- Public Structs -------------------- */
 
@@ -36,6 +80,61 @@ typedef struct _cell {
     size_t column;      /**< The column; 0 based indexed. */
 }cell_t;
 
+/**
+ * @brief Snapshot of the row cache counters of a csv file handle.
+ * 
+ */
+typedef struct _csv_cache_stats {
+    uint64_t hits;              /**< Number of row lookups served from memory. */
+    uint64_t misses;            /**< Number of row lookups that had to read the file. */
+    uint64_t evictions;         /**< Number of rows dropped to stay within the memory budget. */
+    uint64_t invalidations;     /**< Number of rows dropped because the file contents changed. */
+    size_t cached_rows;         /**< Number of rows currently held in the cache. */
+    size_t used_bytes;          /**< Memory currently charged to the cache. */
+    size_t capacity_bytes;      /**< Memory budget of the cache. */
+}csv_cache_stats_t;
+
+/**
+ * @brief Options of csv_partition_with_options().
+ * 
+ */
+typedef struct _csv_partition_options {
+    size_t column;                      /**< Column holding the partition key (0 based index). */
+    const char *p_out_dir;              /**< Existing directory to write the partition files to, not the one of the source. */
+    size_t max_open_files;              /**< Max number of partition files open at once, across all threads. */
+    size_t number_of_hash_partitions;   /**< 0 for one file per distinct key, otherwise rows go to part-<hash % n>.csv. */
+    unsigned int number_of_threads;     /**< Number of source chunks streamed in parallel. 0 or 1 streams on the calling thread. */
+}csv_partition_options_t;
+
+/**
+ * @brief Log-linear (HDR style) histogram of call latencies in nanoseconds.
+ * 
+ * Latencies below 2^CSV_HISTOGRAM_SUB_BUCKET_BITS ns get a bucket each, above that every power of 2
+ * is split into 2^CSV_HISTOGRAM_SUB_BUCKET_BITS equally wide buckets.
+ * 
+ */
+typedef struct _csv_latency_histogram {
+    uint64_t count;                             /**< Number of recorded calls. */
+    uint64_t total_ns;                          /**< Sum of all recorded latencies. */
+    uint64_t min_ns;                            /**< Fastest recorded call. */
+    uint64_t max_ns;                            /**< Slowest recorded call. */
+    uint64_t buckets[CSV_HISTOGRAM_BUCKETS];    /**< Number of calls per latency bucket. */
+}csv_latency_histogram_t;
+
+/**
+ * @brief Instrumentation counters of a csv file handle. Only collected when built with CSV_ENABLE_STATS.
+ * 
+ */
+typedef struct _csv_stats {
+    uint64_t bytes_read;                        /**< Bytes read from the csv file. */
+    uint64_t bytes_written;                     /**< Bytes written to the csv file or its temp files. */
+    uint64_t rewrites;                          /**< Number of times the whole file was rewritten. */
+    uint64_t seeks;                             /**< Number of seeks, including rewinds. */
+    uint64_t temp_files;                        /**< Number of temp files created. */
+    uint64_t syncs;                             /**< Number of file and directory syncs issued. */
+    csv_latency_histogram_t latency[CSV_OP_COUNT];  /**< Latency of every timed public function, indexed by csv_op_t. */
+}csv_stats_t;
+
 /* -------------------- Public (global) Vars -------------------- */
 
 
@@ -48,7 +147,7 @@ typedef struct _cell {
  * 
  * @param absolute_path_to_file Absolute path to the csv file to be created
  * @param number_of_columns Number of columns for the csv file
- * @return 0 on success, errno on fail.
+ * @return The handle of the file on success, errno on fail.
  */
 int create_csv_file(const char *absolute_path_to_file, int number_of_columns);
 
@@ -56,7 +155,7 @@ int create_csv_file(const char *absolute_path_to_file, int number_of_columns);
  * @brief Opens an already existing csv file
  * 
  * @param absolute_path_to_file Absolute path of the file to be opened.
- * @return 0 on success, errno on fail.
+ * @return The handle of the file on success, errno on fail.
  */
 int open_csv_file(const char *absolute_path_to_file);
 
@@ -64,7 +163,7 @@ int open_csv_file(const char *absolute_path_to_file);
  * @brief Closes a csv file from reading and writing.
  * 
  * @param csv_file_handle Handle of the csv file to operate on.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail. The file is closed even when syncing an open group commit window fails.
  */
 int close_csv_file(int csv_file_handle);
 
@@ -75,7 +174,7 @@ int close_csv_file(int csv_file_handle);
  * 
  * @param csv_file_handle Handle of the csv file to operate on.
  * @param cell Cell struct that specifies the location to clear.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail, EINVAL if the column is not below the column count.
  */
 int clear_cell(int csv_file_handle, cell_t cell);
 
@@ -85,7 +184,7 @@ int clear_cell(int csv_file_handle, cell_t cell);
  * @param csv_file_handle Handle of the csv file to operate on.
  * @param data_to_insert Pointer to the string of data to insert.
  * @param cell Cell struct that specifies the location to update.
- * @return 0 on success, errno on fail.
+ * @return 0 on success, errno on fail, EINVAL if the column is not below the column count.
  */
 int update_cell(int csv_file_handle, const char *data_to_insert, cell_t cell);
 
@@ -173,6 +272,124 @@ int get_row_count(int csv_file_handle);
  */
 int get_cell_contents(int csv_file_handle, char *content_string, cell_t cell);
 
+/* Row cache functions */
+
+/**
+ * @brief Set the memory budget of the row cache of a csv file.
+ * 
+ * Rows read through get_cell_contents() are kept parsed in memory, least recently used first out,
+ * so repeated reads of the same rows never touch the file. Rows are evicted until the cache fits the new budget.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param cache_bytes Memory budget in bytes. 0 disables the cache and frees all cached rows.
+ * @return 0 on success, errno on fail.
+ */
+int csv_set_cache_bytes(int csv_file_handle, size_t cache_bytes);
+
+/**
+ * @brief Get the row cache counters of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_stats Pointer to the struct to fill in.
+ * @return 0 on success, errno on fail.
+ */
+int csv_get_cache_stats(int csv_file_handle, csv_cache_stats_t *p_stats);
+
+/* Durability functions */
+
+/**
+ * @brief Set the durability level of a csv file.
+ * 
+ * In group commit mode a sync is issued by the append that fills the byte window, or by the first append
+ * made once the oldest unsynced append is group_sync_age_us old. The age is only checked on appends and
+ * there is no background flusher, so call csv_sync() when appends stop to bound how long a row stays unsynced.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param durability The new durability level.
+ * @param group_sync_age_us In group commit mode an append also syncs once the oldest unsynced append is this many
+ *        microseconds old. Only checked when appending, so it does not bound how long an idle file stays unsynced. 0 for no age check.
+ * @param group_window_bytes Max number of unsynced appended bytes in group commit mode. 0 for no byte limit.
+ * @return 0 on success, errno on fail.
+ */
+int csv_set_durability(int csv_file_handle, csv_durability_t durability, uint32_t group_sync_age_us, size_t group_window_bytes);
+
+/**
+ * @brief Flush and sync everything written to a csv file so far, whatever the durability level.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @return 0 on success, errno on fail.
+ */
+int csv_sync(int csv_file_handle);
+
+/* Export functions */
+
+/**
+ * @brief Split a csv file into one file per distinct value of a key column.
+ * 
+ * Same as csv_partition_with_options() with one file per key value, streamed on the calling thread.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param column Column holding the partition key (0 based index).
+ * @param out_dir Existing directory to write the partition files to. Must not be the directory of the source.
+ * @param max_open_files Max number of partition files open at once.
+ * @return 0 on success, errno on fail.
+ */
+int csv_partition(int csv_file_handle, size_t column, const char *out_dir, size_t max_open_files);
+
+/**
+ * @brief Split a csv file into partition files by the value or hash of a key column.
+ * 
+ * The source is streamed once. Rows are routed through a write buffer per partition, and the least recently
+ * used partition file is closed whenever max_open_files would be exceeded. Each partition file holds its rows
+ * in source order and replaces any file of the same name. Files are named after the key with every char outside
+ * [A-Za-z0-9.-] written as %XX (an empty key becomes "_.csv"), or part-<n>.csv when hashing.
+ * 
+ * With more than one thread every thread streams its own chunk of the source into per chunk files, which are
+ * then stitched together in chunk order. The partition files are not synced, whatever the durability of the handle.
+ * 
+ * Only open partition files have a write buffer, so memory is bounded by max_open_files and not by the number
+ * of keys. An output directory that resolves to the directory of the source is refused, since a key named
+ * like the source would truncate it.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_options Partitioning options.
+ * @return 0 on success, EINVAL if p_out_dir is the directory of the source, errno on fail.
+ */
+int csv_partition_with_options(int csv_file_handle, const csv_partition_options_t *p_options);
+
+/* Instrumentation functions */
+
+/**
+ * @brief Get a copy of the instrumentation counters of a csv file.
+ * 
+ * @param csv_file_handle Handle of the csv file to operate on.
+ * @param p_stats Pointer to the struct to fill in.
+ * @return 0 on success, ENOTSUP if the module was built without CSV_ENABLE_STATS, errno on fail.
+ */
+int csv_get_stats(int csv_file_handle, csv_stats_t *p_stats);
+
+/**
+ * @brief Get the latency below which a percentage of the recorded calls completed.
+ * 
+ * @param p_histogram Histogram to read.
+ * @param percentile Percentage of calls, 0.0 to 100.0.
+ * @return Latency in nanoseconds (upper edge of the bucket), 0 if nothing was recorded.
+ */
+uint64_t csv_histogram_percentile(const csv_latency_histogram_t *p_histogram, double percentile);
+
+/**
+ * @brief Write instrumentation counters as a JSON object.
+ * 
+ * Every timed function gets its count, min, max, mean, p50/p90/p99/p99.9 and the non empty
+ * histogram buckets as [upper edge ns, count] pairs.
+ * 
+ * @param p_stats Counters to write.
+ * @param p_buffer Buffer to write the null terminated JSON to. May be NULL if buffer_length is 0.
+ * @param buffer_length Size of the buffer in bytes.
+ * @return Length of the full JSON text (like snprintf), a value >= buffer_length means it was truncated. -1 on fail.
+ */
+int csv_stats_to_json(const csv_stats_t *p_stats, char *p_buffer, size_t buffer_length);
+
 
 #ifdef __cplusplus
     }
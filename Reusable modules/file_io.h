@@ -0,0 +1,43 @@
+/**
+ * @file file_io.h
+ * @author Zachary Hoagland (zachary.hoagland@microchip.com)
+ * @brief Common file io definitions shared by the storage modules.
+ * @version 0.1
+ * @date 2025-04-03
+ * 
+ * @copyright Copyright (c) 2025
+ * 
+ */
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+
+/* -------------------- Public Includes -------------------- */
+
+/* -------------------- Public Macros/Defines -------------------- */
+
+#ifndef FILE_PATH_LENGTH
+/** definition for the max length of an absolute file path, including the null terminator. */
+#define FILE_PATH_LENGTH    (256)
+#endif
+
+/* -------------------- Public Enums -------------------- */
+
+/* -------------------- Public Structs -------------------- */
+
+/* -------------------- Public (global) Vars -------------------- */
+
+/* -------------------- Public Function Declarations -------------------- */
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+
+#endif /* FILE_IO_H */